@@ -43,7 +43,6 @@ int source_unique = 0;
 
 
 // searching
-#define MAX_SEARCH 20
 #define SEARCH_TIME 3
 double searchtime = -10;
 
@@ -89,9 +88,10 @@ cvar_t  sb_pingspersec   = {"sb_pingspersec",    "150"}; // Pings per second
 cvar_t  sb_pings         = {"sb_pings",            "3"}; // Number of times to ping a server
 cvar_t  sb_inforetries   = {"sb_inforetries",      "3"};
 cvar_t  sb_infospersec   = {"sb_infospersec",    "100"};
-cvar_t  sb_proxinfopersec= {"sb_proxinfopersec",  "10"};
+cvar_t  sb_proxinfopersec= {"sb_proxinfopersec", "100"};
 cvar_t  sb_proxretries   = {"sb_proxretries",      "3"};
 cvar_t  sb_proxtimeout   = {"sb_proxtimeout",   "1000"};
+cvar_t  sb_proxcachetime = {"sb_proxcachetime",  "600"};
 cvar_t  sb_mastertimeout = {"sb_mastertimeout", "1000"};
 cvar_t  sb_masterretries = {"sb_masterretries",    "3"};
 cvar_t  sb_nosockraw     = {"sb_nosockraw",        "0"}; // when enabled, forces "new ping" (udp qw query packet, multithreaded) to be used
@@ -401,11 +401,13 @@ server_data* Clone_Server(server_data* source)
 
 	new_server->bestping = source->bestping;
 	memcpy(&new_server->display, &source->display, sizeof(source->display));
+	strlcpy(new_server->sortname, source->sortname, sizeof(new_server->sortname));
 	new_server->keysn = source->keysn;
 	for (i = 0; i < new_server->keysn; ++i) {
 		new_server->keys[i] = Q_strdup(source->keys[i]);
 		new_server->values[i] = Q_strdup(source->values[i]);
 	}
+	SB_Server_IndexKeys(new_server);
 	new_server->occupancy = source->occupancy;
 	new_server->passed_filters = source->passed_filters;
 	new_server->ping = source->ping;
@@ -456,6 +458,7 @@ void Reset_Server (server_data *s)
 	}
 
 	s->keysn = 0;
+	memset(s->keyhash, 0, sizeof(s->keyhash));
 
 	for (i = 0; i < s->playersn + s->spectatorsn; i++)
 		Q_free(s->players[i]);
@@ -1021,7 +1024,7 @@ void SB_Servers_Draw (int x, int y, int w, int h)
 	if (searchtype != search_server  ||  searchtime + SEARCH_TIME < cls.realtime)
 		searchtype = search_none;
 
-	if (resort_servers)
+	if (resort_servers || SB_Index_Pending())
 	{
 		Sort_Servers();
 		resort_servers = 0;
@@ -2013,13 +2016,9 @@ void Add_Server_Key(int key, wchar unichar)
 qbool SearchNextServer (int pos)
 {
 	int i;
-	char tmp[1024];
 
 	for (i = pos; i < serversn_passed; i++) {
-		strlcpy (tmp, servers[i]->display.name, sizeof (tmp));
-		FunToSort (tmp);
-
-		if (strstr (tmp, searchstring)) {
+		if (strstr (servers[i]->sortname, searchstring)) {
 			Servers_pos = i;
 			return true;
 		}
@@ -2518,13 +2517,9 @@ int SB_Sources_Key(int key)
 qbool SearchNextPlayer(int pos)
 {
 	int i;
-	char tmp[1024];
 
 	for (i = pos; i < all_players_n; i++) {
-		strlcpy (tmp, all_players[i]->name, sizeof (tmp));
-		FunToSort (tmp);
-
-		if (strstr (tmp, searchstring)) {
+		if (SB_Index_PlayerFound(all_players[i], searchstring)) {
 			Players_pos = i;
 			return true;
 		}
@@ -2837,13 +2832,6 @@ int Servers_Compare_Func(const void * p_s1, const void * p_s2)
 	if (s2->ping < 0  &&  s1->ping >= 0)
 		return -1;
 
-	if (!s1->passed_filters  &&  s2->passed_filters)
-		return 1;
-	if (!s2->passed_filters  &&  s1->passed_filters)
-		return -1;
-	if (!s1->passed_filters  &&  !s2->passed_filters)
-		return s1 - s2;
-
 	if (sort_string[0] == '\0') {
 		return Servers_Compare_Natural(s1, s2);
 	}
@@ -2862,7 +2850,7 @@ int Servers_Compare_Func(const void * p_s1, const void * p_s2)
 		switch (*sort_string++)
 		{
 			case '1':
-				d = funcmp(s1->display.name, s2->display.name);
+				d = strcmp(s1->sortname, s2->sortname);
 				break;
 			case '2':
 				d = memcmp(&(s1->address.ip), &(s2->address.ip), 4);
@@ -2896,55 +2884,60 @@ int Servers_Compare_Func(const void * p_s1, const void * p_s2)
 	}
 }
 
-void Filter_Servers(void)
+// Everything but the search string, that one goes through the list index.
+qbool SB_Server_Passes_Filters(server_data *s)
 {
-	int i;
-	serversn_passed = 0;
-	for (i=0; i < serversn; i++)
-	{
-		char *tmp;
-		server_data *s = servers[i];
-		s->passed_filters = 0;
-
-		if (searchstring[0] && !strstri(s->display.name, searchstring)) {
-			continue;
-		}
+	char *tmp;
 
-		if (sb_showproxies.integer == 0 && (s->qwfwd || s->qizmo))
-			continue; // hide
+	if (sb_showproxies.integer == 0 && (s->qwfwd || s->qizmo))
+		return false; // hide
 
-		if (sb_showproxies.integer == 2 && !(s->qwfwd || s->qizmo))
-			continue; // exclusive
+	if (sb_showproxies.integer == 2 && !(s->qwfwd || s->qizmo))
+		return false; // exclusive
 
-		if (sb_hidedead.value  &&  s->ping < 0)
-			continue;
+	if (sb_hidedead.value  &&  s->ping < 0)
+		return false;
 
-		if (!s->qizmo && !s->qwfwd) {
-			if (sb_hideempty.value  &&  s->playersn + s->spectatorsn <= 0)
-				continue;
+	if (!s->qizmo && !s->qwfwd) {
+		if (sb_hideempty.value  &&  s->playersn + s->spectatorsn <= 0)
+			return false;
 
-			if (sb_hidenotempty.value  &&  s->playersn + s->spectatorsn > 0)
-				continue;
-		}
+		if (sb_hidenotempty.value  &&  s->playersn + s->spectatorsn > 0)
+			return false;
+	}
 
-		if (sb_hidehighping.integer && s->ping > sb_pinglimit.integer)
-			continue;
+	if (sb_hidehighping.integer && s->ping > sb_pinglimit.integer)
+		return false;
 
+	if (sb_hidefull.value) {
 		tmp = ValueForKey(s, "maxclients");
-		if (sb_hidefull.value  &&  s->playersn >= (tmp ? atoi(tmp) : 255))
-			continue;
-
-		s->passed_filters = 1;  // passed
-		serversn_passed++;
+		if (s->playersn >= (tmp ? atoi(tmp) : 255))
+			return false;
 	}
-	return;
+
+	return true;
 }
 
 void Sort_Servers (void)
 {
+	server_data *selected = NULL;
+	int i;
+
 	SB_ServerList_Lock();
-	Filter_Servers();
-	qsort(servers, serversn, sizeof(servers[0]), Servers_Compare_Func);
+
+	if (Servers_pos >= 0 && Servers_pos < serversn_passed)
+		selected = servers[Servers_pos];
+
+	SB_Index_Update(searchstring);
+
+	// keep the cursor on its server while replies move the list around
+	for (i = 0; selected && i < serversn_passed; i++) {
+		if (servers[i] == selected) {
+			Servers_pos = i;
+			break;
+		}
+	}
+
 	SB_ServerList_Unlock();
 }
 
@@ -2984,7 +2977,7 @@ int All_Players_Compare_Func(const void * p_p1, const void * p_p2)
 		switch (*sort_string++)
 		{
 			case '1':
-				d = funcmp(s1->display.name, s2->display.name);
+				d = strcmp(s1->sortname, s2->sortname);
 				break;
 			case '2':
 				d = memcmp(&(s1->address.ip), &(s2->address.ip), 4);
@@ -3010,7 +3003,7 @@ int All_Players_Compare_Func(const void * p_p1, const void * p_p2)
 				d = strcmp2(s1->display.timelimit, s2->display.timelimit);
 				break;
 			case '9':
-				d = funcmp(p1->name, p2->name);
+				d = strcmp(p1->sortname, p2->sortname);
 				break;
 			default:
 				d = p1 - p2;
@@ -3030,23 +3023,20 @@ void Sort_All_Players(void)
 
 void Rebuild_All_Players(void)
 {
+	static player_host *players_data = NULL;
 	int i, j, players = 0;
 
 	// clear
-	if (all_players != NULL)
-	{
-		for (i = 0; i < all_players_n; i++)
-			Q_free(all_players[i]);
-
-		Q_free(all_players);
-	}
+	Q_free(all_players);
+	Q_free(players_data);
 
 	// count players
 	for (i = 0; i < serversn; i++)
 		players += servers[i]->playersn + servers[i]->spectatorsn;
 
-	// alloc memory
-	all_players = (player_host **) Q_malloc (players * sizeof (player_host *));
+	// alloc memory, one block for all of them
+	all_players = (player_host **) Q_malloc (max(players, 1) * sizeof (player_host *));
+	players_data = (player_host *) Q_malloc (max(players, 1) * sizeof (player_host));
 
 	// make players
 	all_players_n = 0;
@@ -3054,15 +3044,18 @@ void Rebuild_All_Players(void)
 	{
 		for (j = 0; j < servers[i]->playersn + servers[i]->spectatorsn; j++)
 		{
-			all_players[all_players_n] = (player_host *) Q_malloc (sizeof (player_host));
-			strlcpy (all_players[all_players_n]->name,
-					servers[i]->players[j]->name,
-					sizeof (all_players[all_players_n]->name));
-			all_players[all_players_n]->serv = servers[i];
-			all_players_n++;
+			player_host *p = &players_data[all_players_n];
+
+			strlcpy (p->name, servers[i]->players[j]->name, sizeof (p->name));
+			strlcpy (p->sortname, p->name, sizeof (p->sortname));
+			FunToSort (p->sortname);
+			p->serv = servers[i];
+			all_players[all_players_n++] = p;
 		}
 	}
 
+	SB_Index_Players(players_data, all_players_n);
+
 	resort_all_players = 1;
 	rebuild_all_players = 0;
 	//Players_pos = 0;
@@ -3080,7 +3073,7 @@ void SB_Sources_Update_f(void)
 // (which is significantly faster than full refresh).
 // Of course users should do full-update of their list after some time so that 
 // new servers have a chance to appear.
-#define SERIALIZE_FILE_VERSION 1003
+#define SERIALIZE_FILE_VERSION 1005
 void SB_Serverlist_Serialize(FILE *f)
 {
 	int version = SERIALIZE_FILE_VERSION;
@@ -3101,6 +3094,7 @@ void SB_Serverlist_Serialize(FILE *f)
 	for (i = 0; i < serversn; i++) {
 		server_data t = *servers[i];
 		t.keysn = 0; // we don't store the keys
+		memset(t.keyhash, 0, sizeof(t.keyhash));
 		fwrite(&t, sizeof(server_data), 1, f);
 	}
 }
@@ -3162,7 +3156,9 @@ int SB_Serverlist_Unserialize(FILE *f)
 		}
 	}
 
+	SB_Index_Servers();
 	rebuild_servers_list = 0;
+	resort_servers = 1;
 
 	return serversn;
 }
@@ -3275,6 +3271,7 @@ void Browser_Init (void)
 	Cvar_Register(&sb_proxinfopersec);
 	Cvar_Register(&sb_proxretries);
 	Cvar_Register(&sb_proxtimeout);
+	Cvar_Register(&sb_proxcachetime);
 	Cvar_Register(&sb_liveupdate);
 	Cvar_Register(&sb_mastertimeout);
 	Cvar_Register(&sb_masterretries);
@@ -3301,6 +3298,8 @@ void Browser_Init (void)
 	Cmd_AddCommand("addserver", AddServer_f);
 	Cmd_AddCommand("sb_refresh", GetServerPingsAndInfos_f);
 	Cmd_AddCommand("sb_pingsdump", SB_PingsDump_f);
+	Cmd_AddCommand("sb_querybench", SB_Query_Bench_f);
+	Cmd_AddCommand("sb_indexbench", SB_Index_Bench_f);
 	Cmd_AddCommand("sb_sourceadd", SB_Source_Add_f);
 	Cmd_AddCommand("sb_sourcesupdate", SB_Sources_Update_f);
 	Cmd_AddCommand("sb_buildpingtree", SB_PingTree_Build);
@@ -24,11 +24,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define MAX_UNBOUND 200
 
 #define MAX_SOURCES 200
-#define MAX_SERVERS 1000
+#define MAX_SERVERS 8192
 
 #define MAX_KEYS    100
+#define KEYHASH_SIZE 256 // power of two, comfortably above MAX_KEYS
 #define MAX_PLAYERS 128
 
+#define MAX_SEARCH  20  // search string typed into the servers and players lists
+
 // column width
 #define COL_PING        3
 #define COL_IP          21
@@ -124,6 +127,10 @@ typedef struct server_data_s
     columns     display;
     char *keys[MAX_KEYS], *values[MAX_KEYS];
     int keysn;
+    byte keyhash[KEYHASH_SIZE]; // open addressed index into keys[], stored +1, 0 is empty
+    char sortname[COL_NAME + 1]; // display.name folded by FunToSort, compared when sorting by name
+    int index_id;                // document of the name in the list's trigram index
+    qbool index_dirty;           // changed since the list's order was last updated
 
     playerinfo *players[MAX_PLAYERS];
     int playersn;
@@ -168,6 +175,7 @@ typedef struct source_data_s
 typedef struct player_host_s
 {
     char name[21];
+    char sortname[21];           // name folded by FunToSort, for sorting and searching
     server_data *serv;
 } player_host;
 
@@ -250,12 +258,29 @@ void GetServerPingsAndInfos_f(void);
 void Start_Autoupdate(server_data *s);
 void Alter_Autoupdate(server_data *s);
 
+void Parse_Serverinfo(server_data *s, char *info);
 char *ValueForKey(server_data *s, char *k);
+void SB_Server_IndexKeys(server_data *s);
 
 void SetPing999(server_data *s);
 void SetPing(server_data *s, int ping);
 void SB_Server_SetBestPing(server_data *s, int bestping);
 
+// query engine
+void SB_Query_Servers(server_data *servs[], int servsn, qbool pings, qbool infos);
+void SB_Query_Bench_f(void);
+
+// list index
+int Servers_Compare_Func(const void *p_s1, const void *p_s2);
+qbool SB_Server_Passes_Filters(server_data *s);
+void SB_Server_Changed(server_data *s);
+void SB_Index_Servers(void);
+qbool SB_Index_Pending(void);
+void SB_Index_Update(const char *find);
+void SB_Index_Players(const player_host *players, int playersn);
+qbool SB_Index_PlayerFound(const player_host *p, const char *find);
+void SB_Index_Bench_f(void);
+
 void SB_Shutdown(void);
 void SB_RootInit(void);    // must be called as root
 
@@ -0,0 +1,601 @@
+/*
+Copyright (C) 2026 ezQuake team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// EX_browser_index.c -- sort order and name search of the server browser lists
+//
+// All servers of the list are kept sorted by the current sb_sortservers whatever the
+// filters are. Servers marked changed by ping and status replies are taken out and put
+// back at their new place, only a new sort string or a new list sorts everything again,
+// and applying the filters is a single pass over that order. Server and player names
+// are searched through trigram indexes, so a search string is only compared against
+// the names that contain all of its trigrams.
+
+#include "quakedef.h"
+#include "EX_browser.h"
+#include "utils.h"
+
+#define SB_TRIGRAM_BUCKETS	4096
+#define SB_TRIGRAM_QUERY	64			// trigrams of a search string looked up at most
+
+typedef struct sb_trigrams_s {
+	int			*postings[SB_TRIGRAM_BUCKETS];	// documents per trigram, ascending and possibly stale
+	int			postingsn[SB_TRIGRAM_BUCKETS];
+	int			postings_max[SB_TRIGRAM_BUCKETS];
+	int			total;							// postings stored, stale ones included
+	int			*hits;							// query trigrams found so far, per document
+	int			docs;
+	int			query_trigrams;
+} sb_trigrams_t;
+
+typedef struct sb_index_s {
+	server_data	**order;				// every server of the list, sorted
+	server_data	**changed;
+	int			ordern;
+	int			*live;					// trigrams of each name as it is now
+	int			live_total;
+	char		*sortstring;			// what the order was sorted by
+	int			findroutes;
+	int			seen_changes;
+	sb_trigrams_t names;
+} sb_index_t;
+
+typedef struct sb_player_index_s {
+	const player_host *players;
+	sb_trigrams_t names;
+	char		query[MAX_SEARCH + 1];
+	qbool		query_valid;
+	qbool		query_indexed;
+} sb_player_index_t;
+
+static volatile int sb_index_changes;
+static sb_index_t sb_servers_index;
+static sb_player_index_t sb_players_index;
+
+//
+// trigrams
+//
+
+static int SB_Trigram_Bucket (const char *s)
+{
+	unsigned int t = (tolower((unsigned char) s[0]) << 16) | (tolower((unsigned char) s[1]) << 8) | tolower((unsigned char) s[2]);
+
+	return (t * 2654435761u) >> 20;
+}
+
+static void SB_Trigrams_Clear (sb_trigrams_t *t, int docs)
+{
+	int i;
+
+	for (i = 0; i < SB_TRIGRAM_BUCKETS; i++)
+	{
+		Q_free(t->postings[i]);
+		t->postingsn[i] = t->postings_max[i] = 0;
+	}
+
+	Q_free(t->hits);
+	if (docs > 0)
+		t->hits = (int *) Q_calloc(docs, sizeof(int));
+
+	t->docs = docs;
+	t->total = 0;
+	t->query_trigrams = 0;
+}
+
+// Returns how many postings the text added.
+static int SB_Trigrams_Add (sb_trigrams_t *t, int doc, const char *text)
+{
+	int i, b, n = 0, len = strlen(text);
+
+	for (i = 0; i + 3 <= len; i++)
+	{
+		b = SB_Trigram_Bucket(text + i);
+
+		// repeated trigram, or another one of this text in the same bucket
+		if (t->postingsn[b] && t->postings[b][t->postingsn[b] - 1] == doc)
+			continue;
+
+		if (t->postingsn[b] == t->postings_max[b])
+		{
+			t->postings_max[b] = max(8, t->postings_max[b] * 2);
+			t->postings[b] = (int *) Q_realloc(t->postings[b], t->postings_max[b] * sizeof(int));
+		}
+
+		t->postings[b][t->postingsn[b]++] = doc;
+		n++;
+	}
+
+	t->total += n;
+	return n;
+}
+
+//
+// Marks the documents which have every trigram of the search string, collisions and
+// stale postings included so the matches still have to be checked against the text.
+// Returns false if the string is too short to narrow anything down.
+//
+static qbool SB_Trigrams_Query (sb_trigrams_t *t, const char *find)
+{
+	int buckets[SB_TRIGRAM_QUERY];
+	int i, j, k, b, n = 0, len = strlen(find);
+
+	t->query_trigrams = 0;
+
+	if (len < 3 || !t->docs)
+		return false;
+
+	memset(t->hits, 0, t->docs * sizeof(int));
+
+	for (i = 0; i + 3 <= len && n < SB_TRIGRAM_QUERY; i++)
+	{
+		b = SB_Trigram_Bucket(find + i);
+		for (j = 0; j < n && buckets[j] != b; j++)
+			;
+		if (j == n)
+			buckets[n++] = b;
+	}
+
+	// a document only moves on to k + 1 if it was in all the buckets before
+	for (k = 0; k < n; k++)
+	{
+		const int *p = t->postings[buckets[k]];
+
+		for (j = 0; j < t->postingsn[buckets[k]]; j++)
+		{
+			if (t->hits[p[j]] == k)
+				t->hits[p[j]] = k + 1;
+		}
+	}
+
+	t->query_trigrams = n;
+	return true;
+}
+
+#define SB_Trigrams_Hit(t, doc) ((t)->hits[(doc)] == (t)->query_trigrams)
+
+//
+// servers
+//
+
+static void SB_Index_AddName (sb_index_t *idx, server_data *s)
+{
+	int n = SB_Trigrams_Add(&idx->names, s->index_id, s->display.name);
+
+	idx->live_total += n - idx->live[s->index_id];
+	idx->live[s->index_id] = n;
+}
+
+// Re-adding changed names leaves the old postings behind, drop them once they pile up.
+static void SB_Index_Compact (sb_index_t *idx)
+{
+	int i;
+
+	SB_Trigrams_Clear(&idx->names, idx->ordern);
+	memset(idx->live, 0, idx->ordern * sizeof(int));
+	idx->live_total = 0;
+
+	for (i = 0; i < idx->ordern; i++)
+		SB_Index_AddName(idx, idx->order[i]);
+}
+
+static qbool SB_Index_SortChanged (const sb_index_t *idx)
+{
+	return !idx->sortstring || strcmp(idx->sortstring, sb_sortservers.string) || idx->findroutes != sb_findroutes.integer;
+}
+
+static void SB_Index_Sort (sb_index_t *idx)
+{
+	qsort(idx->order, idx->ordern, sizeof(*idx->order), Servers_Compare_Func);
+
+	Q_free(idx->sortstring);
+	idx->sortstring = Q_strdup(sb_sortservers.string);
+	idx->findroutes = sb_findroutes.integer;
+}
+
+static void SB_Index_Build (sb_index_t *idx, server_data **servs, int servsn)
+{
+	int i;
+
+	Q_free(idx->order);
+	Q_free(idx->changed);
+	Q_free(idx->live);
+
+	idx->ordern = servsn;
+	idx->order = (server_data **) Q_malloc(max(1, servsn) * sizeof(*idx->order));
+	idx->changed = (server_data **) Q_malloc(max(1, servsn) * sizeof(*idx->changed));
+	idx->live = (int *) Q_calloc(max(1, servsn), sizeof(int));
+	idx->live_total = 0;
+	idx->seen_changes = sb_index_changes;
+
+	SB_Trigrams_Clear(&idx->names, servsn);
+
+	for (i = 0; i < servsn; i++)
+	{
+		idx->order[i] = servs[i];
+		idx->order[i]->index_id = i;
+		idx->order[i]->index_dirty = false;
+		SB_Index_AddName(idx, idx->order[i]);
+	}
+
+	SB_Index_Sort(idx);
+}
+
+static void SB_Index_Free (sb_index_t *idx)
+{
+	SB_Trigrams_Clear(&idx->names, 0);
+	Q_free(idx->order);
+	Q_free(idx->changed);
+	Q_free(idx->live);
+	Q_free(idx->sortstring);
+	idx->ordern = 0;
+}
+
+// Moves the servers changed since the last call to their new place in the order.
+static void SB_Index_Refresh (sb_index_t *idx)
+{
+	int changes = sb_index_changes;
+	int i, n, changedn = 0, lo, hi, mid;
+	qbool resort = SB_Index_SortChanged(idx);
+	server_data *s;
+
+	if (idx->seen_changes == changes && !resort)
+		return;
+
+	idx->seen_changes = changes;
+
+	// take the changed servers out, the rest stays in order
+	for (i = n = 0; i < idx->ordern; i++)
+	{
+		s = idx->order[i];
+		if (s->index_dirty)
+		{
+			s->index_dirty = false;
+			SB_Index_AddName(idx, s);
+			idx->changed[changedn++] = s;
+		}
+		else
+		{
+			idx->order[n++] = s;
+		}
+	}
+
+	if (resort || changedn > idx->ordern / 16)
+	{
+		memcpy(idx->order + n, idx->changed, changedn * sizeof(*idx->order));
+		SB_Index_Sort(idx);
+	}
+	else
+	{
+		for (i = 0; i < changedn; i++, n++)
+		{
+			s = idx->changed[i];
+
+			for (lo = 0, hi = n; lo < hi; )
+			{
+				mid = (lo + hi) / 2;
+				if (Servers_Compare_Func(&idx->order[mid], &s) < 0)
+					lo = mid + 1;
+				else
+					hi = mid;
+			}
+
+			memmove(idx->order + lo + 1, idx->order + lo, (n - lo) * sizeof(*idx->order));
+			idx->order[lo] = s;
+		}
+	}
+
+	if (idx->names.total > 2 * idx->live_total + 1024)
+		SB_Index_Compact(idx);
+}
+
+//
+// Lays the list out in out[], servers passing the filters first, both parts in sort order.
+// Returns the number of servers which passed.
+//
+static int SB_Index_Filter (sb_index_t *idx, const char *find, server_data **out)
+{
+	qbool indexed = SB_Trigrams_Query(&idx->names, find);
+	int i, passed = 0, n;
+	server_data *s;
+
+	for (i = 0; i < idx->ordern; i++)
+	{
+		s = idx->order[i];
+
+		s->passed_filters = 0;
+		if (find[0])
+		{
+			if (indexed && !SB_Trigrams_Hit(&idx->names, s->index_id))
+				continue;
+			if (!strstri(s->display.name, find))
+				continue;
+		}
+
+		if (SB_Server_Passes_Filters(s))
+		{
+			s->passed_filters = 1;
+			out[passed++] = s;
+		}
+	}
+
+	for (i = 0, n = passed; i < idx->ordern; i++)
+	{
+		if (!idx->order[i]->passed_filters)
+			out[n++] = idx->order[i];
+	}
+
+	return passed;
+}
+
+// Called whenever ping or status info of a server changes, from any thread.
+void SB_Server_Changed (server_data *s)
+{
+	s->index_dirty = true;
+	sb_index_changes++;
+}
+
+// The servers table was filled with a new list, must be called with the list locked.
+void SB_Index_Servers (void)
+{
+	SB_Index_Build(&sb_servers_index, servers, serversn);
+}
+
+qbool SB_Index_Pending (void)
+{
+	return sb_servers_index.seen_changes != sb_index_changes || SB_Index_SortChanged(&sb_servers_index);
+}
+
+// Brings the order up to date and applies the filters to the servers table.
+void SB_Index_Update (const char *find)
+{
+	SB_ServerList_Lock();
+
+	if (sb_servers_index.ordern != serversn)
+		SB_Index_Servers();
+
+	SB_Index_Refresh(&sb_servers_index);
+	serversn_passed = SB_Index_Filter(&sb_servers_index, find, servers);
+
+	SB_ServerList_Unlock();
+}
+
+//
+// players
+//
+
+static void SB_Index_BuildPlayers (sb_player_index_t *idx, const player_host *players, int playersn)
+{
+	int i;
+
+	SB_Trigrams_Clear(&idx->names, playersn);
+	for (i = 0; i < playersn; i++)
+		SB_Trigrams_Add(&idx->names, i, players[i].sortname);
+
+	idx->players = players;
+	idx->query_valid = false;
+}
+
+static qbool SB_Index_PlayerMatches (sb_player_index_t *idx, const player_host *p, const char *find)
+{
+	if (!idx->query_valid || strcmp(idx->query, find))
+	{
+		strlcpy(idx->query, find, sizeof(idx->query));
+		idx->query_indexed = SB_Trigrams_Query(&idx->names, idx->query);
+		idx->query_valid = true;
+	}
+
+	if (idx->query_indexed && !SB_Trigrams_Hit(&idx->names, p - idx->players))
+		return false;
+
+	return strstr(p->sortname, find) != NULL;
+}
+
+// The all players list was rebuilt, players is the block all its entries point into.
+void SB_Index_Players (const player_host *players, int playersn)
+{
+	SB_Index_BuildPlayers(&sb_players_index, players, playersn);
+}
+
+qbool SB_Index_PlayerFound (const player_host *p, const char *find)
+{
+	return SB_Index_PlayerMatches(&sb_players_index, p, find);
+}
+
+//
+// benchmark
+//
+
+static const char *sb_index_bench_words[] = {
+	"qw", "duel", "ffa", "ctf", "clan", "arena", "quad", "team", "fortress", "rocket",
+	"euro", "nl", "de", "se", "ru", "us", "br", "pl", "fi", "uk"
+};
+
+#define SB_INDEX_BENCH_WORDS (sizeof(sb_index_bench_words) / sizeof(sb_index_bench_words[0]))
+
+static double SB_Index_Bench_Search (sb_index_t *idx, server_data **out, const char *query, int *found)
+{
+	char find[MAX_SEARCH + 1];
+	double start = Sys_DoubleTime();
+	int i, len = min((int) strlen(query), MAX_SEARCH);
+
+	// typed one key at a time
+	for (i = 1; i <= len; i++)
+	{
+		strlcpy(find, query, i + 1);
+		*found = SB_Index_Filter(idx, find, out);
+	}
+
+	return (Sys_DoubleTime() - start) * 1000 / len;
+}
+
+static double SB_Index_Bench_Scan (server_data **servs, int servsn, const char *query, int *found)
+{
+	char find[MAX_SEARCH + 1];
+	double start = Sys_DoubleTime();
+	int i, j, len = min((int) strlen(query), MAX_SEARCH);
+
+	for (i = 1; i <= len; i++)
+	{
+		strlcpy(find, query, i + 1);
+		for (j = 0, *found = 0; j < servsn; j++)
+		{
+			if (strstri(servs[j]->display.name, find) && SB_Server_Passes_Filters(servs[j]))
+				(*found)++;
+		}
+	}
+
+	return (Sys_DoubleTime() - start) * 1000 / len;
+}
+
+//
+// Builds a list of fake servers and players and times what the browser does with it.
+//
+void SB_Index_Bench_f (void)
+{
+	const char *server_query = "fortress 12", *player_query = "player 77";
+	server_data *fake, **servs, **out;
+	player_host *players;
+	sb_player_index_t *pidx;
+	sb_index_t *idx;
+	int i, j, servsn, per_server, playersn, updates, found, scanned;
+	unsigned int seed = 1;
+	double start, build, sort, update, search, scan;
+
+	if (Cmd_Argc() > 3)
+	{
+		Com_Printf("Usage: %s [servers] [players per server]\n", Cmd_Argv(0));
+		return;
+	}
+
+	servsn = Cmd_Argc() > 1 ? bound(1, Q_atoi(Cmd_Argv(1)), MAX_SERVERS) : 5000;
+	per_server = Cmd_Argc() > 2 ? bound(0, Q_atoi(Cmd_Argv(2)), MAX_PLAYERS) : 8;
+
+	fake = (server_data *) Q_calloc(servsn, sizeof(*fake));
+	servs = (server_data **) Q_malloc(servsn * sizeof(*servs));
+	out = (server_data **) Q_malloc(servsn * sizeof(*out));
+	idx = (sb_index_t *) Q_calloc(1, sizeof(*idx));
+
+	for (i = 0; i < servsn; i++)
+	{
+		server_data *s = &fake[i];
+
+		seed = seed * 1103515245 + 12345;
+		snprintf(s->display.name, sizeof(s->display.name), "%s %s %d %s",
+			sb_index_bench_words[(seed >> 16) % SB_INDEX_BENCH_WORDS], sb_index_bench_words[(seed >> 8) % SB_INDEX_BENCH_WORDS],
+			i, sb_index_bench_words[i % SB_INDEX_BENCH_WORDS]);
+		strlcpy(s->sortname, s->display.name, sizeof(s->sortname));
+		FunToSort(s->sortname);
+		s->ping = (seed >> 4) % 250;
+		s->bestping = -1;
+		s->playersn = i % (per_server * 2 + 1);
+		s->occupancy = s->playersn ? SERVER_NONEMPTY : SERVER_EMPTY;
+		servs[i] = s;
+	}
+
+	start = Sys_DoubleTime();
+	SB_Index_Build(idx, servs, servsn);
+	build = (Sys_DoubleTime() - start) * 1000;
+
+	start = Sys_DoubleTime();
+	SB_Index_Sort(idx);
+	sort = (Sys_DoubleTime() - start) * 1000;
+
+	// replies trickling in, a few per frame
+	updates = 1000;
+	start = Sys_DoubleTime();
+	for (i = 0; i < updates; i++)
+	{
+		for (j = 0; j < 4; j++)
+		{
+			seed = seed * 1103515245 + 12345;
+			fake[(seed >> 8) % servsn].ping = (seed >> 4) % 250;
+			SB_Server_Changed(&fake[(seed >> 8) % servsn]);
+		}
+		SB_Index_Refresh(idx);
+		SB_Index_Filter(idx, "", out);
+	}
+	update = (Sys_DoubleTime() - start) * 1000 / updates;
+
+	search = SB_Index_Bench_Search(idx, out, server_query, &found);
+	scan = SB_Index_Bench_Scan(servs, servsn, server_query, &scanned);
+
+	Com_Printf("%d servers: build %.2f ms, full sort %.2f ms, frame with 4 changed servers %.3f ms\n", servsn, build, sort, update);
+	Com_Printf("server search \"%s\": %.3f ms per key, linear scan %.3f ms per key (%d/%d found)\n", server_query, search, scan, found, scanned);
+
+	// players, one block like the all players list
+	playersn = 0;
+	for (i = 0; i < servsn; i++)
+		playersn += fake[i].playersn;
+
+	players = (player_host *) Q_calloc(max(1, playersn), sizeof(*players));
+	pidx = (sb_player_index_t *) Q_calloc(1, sizeof(*pidx));
+
+	for (i = j = 0; i < servsn; i++)
+	{
+		int k;
+
+		for (k = 0; k < fake[i].playersn; k++, j++)
+		{
+			snprintf(players[j].name, sizeof(players[j].name), "player %d", j);
+			strlcpy(players[j].sortname, players[j].name, sizeof(players[j].sortname));
+			FunToSort(players[j].sortname);
+			players[j].serv = &fake[i];
+		}
+	}
+
+	start = Sys_DoubleTime();
+	SB_Index_BuildPlayers(pidx, players, playersn);
+	build = (Sys_DoubleTime() - start) * 1000;
+
+	start = Sys_DoubleTime();
+	for (i = 1, found = 0; i <= (int) strlen(player_query); i++)
+	{
+		char find[MAX_SEARCH + 1];
+
+		strlcpy(find, player_query, i + 1);
+		for (j = 0, found = 0; j < playersn; j++)
+			found += SB_Index_PlayerMatches(pidx, &players[j], find);
+	}
+	search = (Sys_DoubleTime() - start) * 1000 / strlen(player_query);
+
+	start = Sys_DoubleTime();
+	for (i = 1, scanned = 0; i <= (int) strlen(player_query); i++)
+	{
+		char find[MAX_SEARCH + 1], tmp[sizeof(players[0].name)];
+
+		strlcpy(find, player_query, i + 1);
+		for (j = 0, scanned = 0; j < playersn; j++)
+		{
+			strlcpy(tmp, players[j].name, sizeof(tmp));
+			FunToSort(tmp);
+			scanned += strstr(tmp, find) != NULL;
+		}
+	}
+	scan = (Sys_DoubleTime() - start) * 1000 / strlen(player_query);
+
+	Com_Printf("%d players: build %.2f ms, search \"%s\" %.3f ms per key, linear scan %.3f ms per key (%d/%d found)\n",
+		playersn, build, player_query, search, scan, found, scanned);
+
+	SB_Trigrams_Clear(&pidx->names, 0);
+	Q_free(pidx);
+	Q_free(players);
+	SB_Index_Free(idx);
+	Q_free(idx);
+	Q_free(out);
+	Q_free(servs);
+	Q_free(fake);
+}
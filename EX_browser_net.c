@@ -32,6 +32,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #endif
 #include "menu.h"
 #include "EX_browser.h"
+#include "utils.h"
 #include "sbar.h"
 #include "keys.h"
 
@@ -39,18 +40,11 @@ extern qbool useNewPing;
 int oldPingHost(char *host_to_ping, int count);
 int oldPingHosts(server_data *servs[], int servsn, int count);
 int PingHost(char *host_to_ping, unsigned short port, int count, int time_out);
-int PingHosts(server_data *servs[], int servsn, int count);
 
 extern sem_t serverinfo_semaphore;
 // To prevent several Serverinfo threads to be started at the same time
 static int serverinfo_lock;
 
-typedef struct infohost_s
-{
-    double lastsenttime;
-    int phase;
-} infohost;
-
 int autoupdate_serverinfo = 0;
 
 server_data *autoupdate_server;
@@ -91,12 +85,56 @@ int ReadString (char *playerinfo, char *str)
     return s;
 }
 
+static unsigned int SB_KeyHash(const char *k)
+{
+    unsigned int hash = 0;
+    int c;
+
+    while ((c = *k++))
+        hash = c + (hash << 6) + (hash << 16) - hash;
+
+    return hash;
+}
+
+// Rebuilds the key index, must be called whenever keys[] is filled or reordered.
+void SB_Server_IndexKeys(server_data *s)
+{
+    unsigned int slot;
+    int i;
+
+    memset(s->keyhash, 0, sizeof(s->keyhash));
+
+    for (i = 0; i < s->keysn; i++)
+    {
+        if (!s->keys[i])
+            continue;
+
+        slot = SB_KeyHash(s->keys[i]) & (KEYHASH_SIZE - 1);
+        while (s->keyhash[slot])
+        {
+            // keep the first one, like the linear search did
+            if (!strcmp(s->keys[s->keyhash[slot] - 1], s->keys[i]))
+                break;
+            slot = (slot + 1) & (KEYHASH_SIZE - 1);
+        }
+
+        if (!s->keyhash[slot])
+            s->keyhash[slot] = i + 1;
+    }
+}
+
 char *ValueForKey(server_data *s, char *k)
 {
+    unsigned int slot = SB_KeyHash(k) & (KEYHASH_SIZE - 1);
     int i;
-    for (i=0; i < s->keysn; i++)
-        if (s->keys[i] && !strcmp(k, s->keys[i]))
+
+    while ((i = s->keyhash[slot]))
+    {
+        i--;
+        if (i < s->keysn && s->keys[i] && !strcmp(k, s->keys[i]))
             return s->values[i];
+        slot = (slot + 1) & (KEYHASH_SIZE - 1);
+    }
 
     return NULL;
 }
@@ -121,6 +159,8 @@ void SB_Server_SetBestPing(server_data *s, int bestping)
         snprintf (s->display.bestping, sizeof (s->display.bestping), "%3d", bestping > 999 ? 999 : bestping);
 
     s->bestping = bestping;
+
+    SB_Server_Changed(s);
 }
 
 qbool SB_AllServersDead(void)
@@ -283,14 +323,23 @@ void Parse_Serverinfo(server_data *s, char *info)
             }
     }
 
+    SB_Server_IndexKeys(s);
+
     // fill-in display
 	s->qwfwd = SB_IsServerQWfwd(s);
 
     tmp = ValueForKey(s, "hostname");
     if (tmp != NULL)
+    {
         snprintf (s->display.name, sizeof (s->display.name),"%-.*s", COL_NAME, tmp);
+        strlcpy (s->sortname, s->display.name, sizeof (s->sortname));
+        FunToSort (s->sortname);
+    }
     else
+    {
+        SB_Server_Changed(s);
         return;
+    }
 
     tmp = ValueForKey(s, "fraglimit");
     if (tmp != NULL)
@@ -327,6 +376,8 @@ void Parse_Serverinfo(server_data *s, char *info)
     else { s->occupancy = SERVER_FULL; }
     if (tmp != NULL)
         snprintf(s->display.players, sizeof (s->display.players), "%2d/%-2s", i, tmp==NULL ? "" : tmp);
+
+    SB_Server_Changed(s);
 }
 
 void GetServerInfo(server_data *serv)
@@ -372,165 +423,6 @@ void GetServerInfo(server_data *serv)
     closesocket(newsocket);
 }
 
-//
-// Gets multiple server info simultaneously
-//
-
-int GetServerInfosProc(void * lpParameter)
-{
-    infohost *hosts;   // 0 if not sent yet, -1 if data read
-    double interval, lastsenttime;
-
-    socket_t newsocket;
-    struct sockaddr_storage dest;
-    int ret, i;
-    fd_set fd;
-    struct timeval timeout;
-
-    if (abort_ping)
-        return 0;
-
-    // so we have a socket
-    newsocket = UDP_OpenSocket(PORT_ANY);
-
-    hosts = (infohost *) Q_malloc (serversn * sizeof(infohost));
-    for (i=0; i < serversn; i++)
-    {
-        hosts[i].phase = 0;
-        hosts[i].lastsenttime = -1000;
-        Reset_Server(servers[i]);
-
-        // do not update dead servers
-		if (servers[i]->ping < 0) {
-            hosts[i].phase = -1;//(int)sb_inforetries.value;
-		}
-		// do not update too distant servers
-		else if (sb_hidehighping.integer && servers[i]->ping > sb_pinglimit.integer) {
-			hosts[i].phase = -1;
-		}
-    }
-
-    interval = (1000.0 / sb_infospersec.value) / 1000;
-    lastsenttime = Sys_DoubleTime() - interval;
-    timeout.tv_sec = 0;
-    timeout.tv_usec = (long)(interval * 1000.0 * 1000.0 / 2);
-
-    ping_pos = 0;
-
-    while (1  &&  !abort_ping)
-    {
-        int index = -1;
-        double time = Sys_DoubleTime();
-
-        // if it is time to send next request
-        if (time > lastsenttime + interval)
-        {
-            int finished = 0;
-            int to_ask = 0;
-            int phase = (int)(sb_inforetries.value);
-
-            // find next server to ask
-            for (i=0; i < serversn; i++)
-            {
-                if (hosts[i].phase < phase  &&  hosts[i].phase >= 0  &&
-                    time > hosts[i].lastsenttime + (sb_infotimeout.value / 1000))
-                {
-                    index = i;
-                    phase = hosts[i].phase;
-                }
-
-                if (hosts[i].phase >= (int)sb_inforetries.value)
-                    finished++;
-                else
-                    if (hosts[i].phase >= 0)
-                        to_ask++;
-            }
-            //ping_pos = finished / (double)serversn;
-            ping_pos = (finished+to_ask <= 0) ? 0 :
-            finished / (double)(finished+to_ask);
-        }
-
-        // check if we should finish
-        if (index < 0)
-            if (time > lastsenttime + 1.2 * (sb_infotimeout.value / 1000))
-                break;
-
-        // send status request
-        if (index >= 0)
-        {
-            hosts[index].phase ++;
-            hosts[index].lastsenttime = time;
-            lastsenttime = time;
-
-            NetadrToSockadr (&(servers[index]->address), &dest);
-
-            ret = sendto (newsocket, senddata, sizeof(senddata), 0,
-                          (struct sockaddr *)&dest, sizeof(*(struct sockaddr *)&dest));
-            if(ret < 0)
-            {
-                Com_DPrintf("sendto() gave errno = %d : %s\n", errno, strerror(errno));
-            }
-            if (ret == -1)
-                ;//return;
-
-            // requests_sent++;
-            // ping_pos = requests_total <= 0 ? 0 : requests_sent / (double)requests_total;
-        }
-
-        // check if answer arrived and decode it
-        //fd.fd_count = 1;
-        //fd.fd_array[0] = newsocket;
-        FD_ZERO(&fd);
-        FD_SET(newsocket, &fd);
-
-        ret = select(newsocket+1, &fd, NULL, NULL, &timeout);
-        if (ret < 1)
-        {
-            Com_DPrintf("select() gave errno = %d : %s\n", errno, strerror(errno));
-        }
-
-        if (FD_ISSET(newsocket, &fd))
-        {
-            struct sockaddr_storage hostaddr;
-            netadr_t from;
-            int i;
-            char answer[5000];
-            answer[0] = 0;
-
-            i = sizeof(hostaddr);
-            ret = recvfrom (newsocket, answer, 5000, 0, (struct sockaddr *)&hostaddr, (socklen_t *)&i);
-            answer[max(0, min(ret, 4999))] = 0;
-
-            if (ret > 0)
-            {
-                SockadrToNetadr (&hostaddr, &from);
-
-                for (i=0; i < serversn; i++)
-                    if (from.ip[0] == servers[i]->address.ip[0] &&
-                        from.ip[1] == servers[i]->address.ip[1] &&
-                        from.ip[2] == servers[i]->address.ip[2] &&
-                        from.ip[3] == servers[i]->address.ip[3] &&
-                        from.port == servers[i]->address.port)
-                    {
-                        hosts[i].phase = (int)sb_inforetries.value;
-                        Parse_Serverinfo(servers[i], answer);
-                        break;
-                    }
-            }
-        }
-    }
-
-    // reset pings to 999 if server didn't answer
-    for (i=0; i < serversn; i++)
-        if (servers[i]->keysn <= 0)
-            SetPing(servers[i], -1);
-
-    closesocket(newsocket);
-    Q_free(hosts);
-
-    return 0;
-}
-
 void GetServerPing(server_data *serv)
 {
     int p;
@@ -560,6 +452,9 @@ int GetServerPingsAndInfosProc(void * lpParameter)
 	extern void SB_Serverlist_Serialize_f(void);
 
 	int full = (int) lpParameter;
+	qbool pings = false;
+	server_data **servs;
+	int servsn;
     abort_ping = 0;
 
 	if (full || serversn_passed == 0) {
@@ -570,8 +465,8 @@ int GetServerPingsAndInfosProc(void * lpParameter)
 
 		SB_Sources_Update(true);
 		if (useNewPing) {
-			// New Ping = UPD QW Packet ping using 2 threads (sender and receiver)
-			PingHosts(servers, serversn, sb_pings.integer);
+			// New Ping = UDP QW Packet ping, done by the query engine along with the infos
+			pings = true;
 		}
 		else {
 			// Old Ping = ICMP PING Packet using single thread
@@ -581,8 +476,15 @@ int GetServerPingsAndInfosProc(void * lpParameter)
 
     if (!abort_ping)
     {
-        ping_phase = 2;
-        GetServerInfosProc(NULL);
+		// the list gets resorted while replies come in, query a copy of it
+		SB_ServerList_Lock();
+		servsn = serversn;
+		servs = (server_data **) Q_malloc(max(1, servsn) * sizeof(*servs));
+		memcpy(servs, servers, servsn * sizeof(*servs));
+		SB_ServerList_Unlock();
+
+		SB_Query_Servers(servs, servsn, pings, true);
+		Q_free(servs);
     }
 
     /*
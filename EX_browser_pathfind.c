@@ -45,6 +45,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 extern cvar_t sb_proxinfopersec;
 extern cvar_t sb_proxretries;
 extern cvar_t sb_proxtimeout;
+extern cvar_t sb_proxcachetime;
 extern cvar_t sb_listcache;
 
 // non-leaf = proxy (or users computer) = has more than 1 neighbour
@@ -56,7 +57,6 @@ extern cvar_t sb_listcache;
 #define PROXY_REPLY_ENTRY_LEN 8
 #define PROXY_REPLY_BUFFER_SIZE (PROXY_REPLY_ENTRY_LEN*MAX_SERVERS)
 
-// current amount of qw servers ~ 300... but neighbour count means MAX_SERVERS*MAX_NONLEAVES
 #define INVALID_NODE (-1)
 typedef int nodeid_t;
 
@@ -86,55 +86,90 @@ typedef struct ping_neighbour_t {
 	dist_t dist;
 } ping_neighbour_t;
 
+typedef struct ping_heap_item_t {
+	dist_t dist;
+	nodeid_t id;
+} ping_heap_item_t;
+
 typedef struct proxy_query_request_t {
-	socket_t sock;
 	nodeid_t nodeid;
+	netadr_t adr;
+	int tries;
+	double deadline;         // 0 when it is (again) waiting to be sent
 	qbool done;
 } proxy_query_request_t;
 
-typedef struct proxy_request_queue_t {
-	proxy_query_request_t *data;
-	size_t items;
-	qbool sending_done; // sending thread ended
-	qbool allrecved;	// all proxies have been successfully scanned
-} proxy_request_queue;
-
-static ping_node_t ping_nodes[MAX_SERVERS];
+// last ping list received from each proxy, kept across builds and in proxies_data
+typedef struct proxy_cache_entry_t {
+	netadr_t proxy;
+	double fetched;          // wall clock seconds
+	byte *reply;
+	size_t replylen;
+} proxy_cache_entry_t;
+
+// the graph is rebuilt by the phase 2 thread while the main thread may look up routes,
+// both sides hold the server list lock while touching it
+static ping_node_t *ping_nodes = NULL;
 static nodeid_t ping_nodes_count = 0;
-static ping_neighbour_t ping_neighbours[MAX_SERVERS*MAX_NONLEAVES];
+static nodeid_t ping_nodes_max = 0;
+static ping_neighbour_t *ping_neighbours = NULL;
 static nodeid_t ping_neighbours_count = 0;
+static nodeid_t ping_neighbours_max = 0;
+static nodeid_t *ping_nodes_hash = NULL; // node ids by address, open addressing
+static int ping_nodes_hash_size = 0;
 
 static nodeid_t startnode_id = 0;
 
+static proxy_cache_entry_t *proxy_cache = NULL;
+static int proxy_cache_count = 0;
+static int proxy_cache_max = 0;
+
 static qbool building_pingtree = false; // when true, the pingtree build thread is still working
 static qbool pingtree_built = false;
 
 static sem_t phase2thread_lock;
 
-static void SB_PingTree_Assertions(void)
+static unsigned int SB_PingTree_Hash(ipaddr_t ipaddr)
 {
-	if (ping_nodes_count >= MAX_SERVERS) {
-		Sys_Error("EX_Browser_pathfind: max nodes count reached");
-	}
+	unsigned int h = (ipaddr.data[0] << 24) | (ipaddr.data[1] << 16) | (ipaddr.data[2] << 8) | ipaddr.data[3];
+
+	h ^= h >> 16;
+	h *= 0x45d9f3b;
+	h ^= h >> 16;
+
+	return h & (ping_nodes_hash_size - 1);
+}
+
+static void SB_PingTree_Rehash(void)
+{
+	int i, h;
 
-	if (ping_neighbours_count >= MAX_SERVERS*MAX_NONLEAVES) {
-		Sys_Error("EX_Browser_pathfind: max neighbours count reached");
+	Q_free(ping_nodes_hash);
+	ping_nodes_hash_size = ping_nodes_max * 2;
+	ping_nodes_hash = (nodeid_t *) Q_malloc(ping_nodes_hash_size * sizeof(nodeid_t));
+
+	for (i = 0; i < ping_nodes_hash_size; i++) {
+		ping_nodes_hash[i] = INVALID_NODE;
 	}
 
-	if (startnode_id != 0) {
-		// a bit paranoid check, startnode is always the first node
-		Sys_Error("EX_browser_pathfind: startnode_id != 0");
+	for (i = 0; i < ping_nodes_count; i++) {
+		for (h = SB_PingTree_Hash(ping_nodes[i].ipaddr); ping_nodes_hash[h] != INVALID_NODE; h = (h + 1) & (ping_nodes_hash_size - 1))
+			;
+		ping_nodes_hash[h] = i;
 	}
 }
 
 static int SB_PingTree_FindIp(ipaddr_t ipaddr)
 {
-	int i;
+	int h;
 
-	// xxx make the lookup faster than linear
-	for (i = 0; i < ping_nodes_count; i++) {
-		if (memcmp(&ping_nodes[i].ipaddr, &ipaddr, sizeof(ipaddr_t)) == 0) {
-			return i;
+	if (!ping_nodes_hash_size) {
+		return INVALID_NODE;
+	}
+
+	for (h = SB_PingTree_Hash(ipaddr); ping_nodes_hash[h] != INVALID_NODE; h = (h + 1) & (ping_nodes_hash_size - 1)) {
+		if (memcmp(&ping_nodes[ping_nodes_hash[h]].ipaddr, &ipaddr, sizeof(ipaddr_t)) == 0) {
+			return ping_nodes_hash[h];
 		}
 	}
 
@@ -144,6 +179,7 @@ static int SB_PingTree_FindIp(ipaddr_t ipaddr)
 static int SB_PingTree_AddNode(ipaddr_t ipaddr, unsigned short proxport)
 {
 	int id = SB_PingTree_FindIp(ipaddr);
+	int h;
 
 	if (id != INVALID_NODE) {
 		if (proxport && !ping_nodes[id].proxport) {
@@ -152,9 +188,14 @@ static int SB_PingTree_AddNode(ipaddr_t ipaddr, unsigned short proxport)
 		return id;
 	}
 
+	if (ping_nodes_count == ping_nodes_max) {
+		ping_nodes_max = max(256, ping_nodes_max * 2);
+		ping_nodes = (ping_node_t *) Q_realloc(ping_nodes, ping_nodes_max * sizeof(ping_node_t));
+		SB_PingTree_Rehash();
+	}
+
 	id = ping_nodes_count++;
 
-	SB_PingTree_Assertions();
 	ping_nodes[id].ipaddr = ipaddr;
 	ping_nodes[id].prev = INVALID_NODE;
 	ping_nodes[id].nlist_start = INVALID_NODE;
@@ -162,19 +203,26 @@ static int SB_PingTree_AddNode(ipaddr_t ipaddr, unsigned short proxport)
 	ping_nodes[id].dist = DIST_INFINITY;
 	ping_nodes[id].proxport = proxport;
 	ping_nodes[id].visited = false;
-	SB_PingTree_Assertions();
+
+	for (h = SB_PingTree_Hash(ipaddr); ping_nodes_hash[h] != INVALID_NODE; h = (h + 1) & (ping_nodes_hash_size - 1))
+		;
+	ping_nodes_hash[h] = id;
 
 	return id;
 }
 
 static int SB_PingTree_AddNeighbour(nodeid_t neighbour_id, dist_t dist)
 {
-	int id = ping_neighbours_count++;
+	int id;
 
-	SB_PingTree_Assertions();
+	if (ping_neighbours_count == ping_neighbours_max) {
+		ping_neighbours_max = max(1024, ping_neighbours_max * 2);
+		ping_neighbours = (ping_neighbour_t *) Q_realloc(ping_neighbours, ping_neighbours_max * sizeof(ping_neighbour_t));
+	}
+
+	id = ping_neighbours_count++;
 	ping_neighbours[id].id = neighbour_id;
 	ping_neighbours[id].dist = dist;
-	SB_PingTree_Assertions();
 
 	return id;
 }
@@ -192,9 +240,19 @@ static void SB_PingTree_AddSelf(void)
 
 static void SB_PingTree_Clear(void)
 {
+	int i;
+
 	ping_nodes_count = 0;
 	ping_neighbours_count = 0;
+	for (i = 0; i < ping_nodes_hash_size; i++) {
+		ping_nodes_hash[i] = INVALID_NODE;
+	}
 	SB_PingTree_AddSelf();
+
+	if (startnode_id != 0) {
+		// a bit paranoid check, startnode is always the first node
+		Sys_Error("EX_browser_pathfind: startnode_id != 0");
+	}
 }
 
 static ipaddr_t SB_Netaddr2Ipaddr(const netadr_t *netadr)
@@ -361,254 +419,365 @@ static netadr_t SB_NodeNetadr_Get(nodeid_t id)
 	return ret;
 }
 
-int SB_PingTree_SendQueryThread(void *thread_arg)
+static proxy_cache_entry_t *SB_ProxyCache_Find(const netadr_t *proxy)
 {
-	proxy_request_queue *queue = (proxy_request_queue *) thread_arg;
-	int i, ret;
-	double interval_ms = (1.0 / sb_proxinfopersec.value) * 1000.0;
-#ifdef _WIN32
-	timerresolution_session_t timersession = {0, 0};
-#endif
-
-	Sys_TimerResolution_InitSession(&timersession);
-	Sys_TimerResolution_RequestMinimum(&timersession);
-
-	for (i = 0; i < queue->items; i++) {
-		if (!queue->data[i].done) {
-			struct sockaddr_storage addr_to;
-			netadr_t netadr = SB_NodeNetadr_Get(queue->data[i].nodeid);
+	int i;
 
-			NetadrToSockadr(&netadr, &addr_to);
-			ret = sendto(queue->data[i].sock,
-				PROXY_PINGLIST_QUERY, PROXY_PINGLIST_QUERY_LEN, 0,
-				(struct sockaddr *) &addr_to, sizeof (struct sockaddr));
-			if (ret < 0) {
-				Com_DPrintf("SB_PingTree_SendQueryThread sendto returned %d\n", ret);
-			}
-			Sys_MSleep(interval_ms);
+	for (i = 0; i < proxy_cache_count; i++) {
+		if (NET_CompareAdr(proxy_cache[i].proxy, *proxy)) {
+			return &proxy_cache[i];
 		}
-
-		if (queue->allrecved) break;
 	}
 
-	Sys_TimerResolution_Clear(&timersession);
-
-	queue->sending_done = true;
-
-	return 0;
+	return NULL;
 }
 
-#define PROXY_SERIALIZE_FILE_VERSION 1
-void SB_Proxylist_Serialize_Start(FILE *f)
+static void SB_ProxyCache_Store(const netadr_t *proxy, double fetched, const byte *reply, size_t replylen)
 {
-	int version = PROXY_SERIALIZE_FILE_VERSION;
+	proxy_cache_entry_t *entry = SB_ProxyCache_Find(proxy);
 
-	// header
-	// - version
-	fwrite(&version, sizeof(int), 1, f);
+	if (!entry) {
+		if (proxy_cache_count == proxy_cache_max) {
+			proxy_cache_max = max(16, proxy_cache_max * 2);
+			proxy_cache = (proxy_cache_entry_t *) Q_realloc(proxy_cache, proxy_cache_max * sizeof(proxy_cache_entry_t));
+		}
+		entry = &proxy_cache[proxy_cache_count++];
+		entry->proxy = *proxy;
+		entry->reply = NULL;
+	}
+
+	Q_free(entry->reply);
+	entry->reply = (byte *) Q_malloc(max(1, replylen));
+	memcpy(entry->reply, reply, replylen);
+	entry->replylen = replylen;
+	entry->fetched = fetched;
 }
 
-void SB_Proxylist_Serialize_Reply(FILE *f, netadr_t proxy, void *buf, size_t buflen)
+// Adds the edges from a proxy to everything it reported, all of them in one run of neighbours.
+static void SB_PingTree_AddProxyReply(nodeid_t id, const byte *reply, size_t replylen)
 {
-	fwrite(&proxy, sizeof(netadr_t), 1, f);
-	fwrite(&buflen, sizeof(size_t), 1, f);
-	fwrite(buf, buflen, 1, f);
+	SB_ServerList_Lock();
+	ping_nodes[id].nlist_start = ping_neighbours_count;
+	SB_Proxy_ParseReply(reply, replylen, SB_PingTree_AddProxyPing);
+	ping_nodes[id].nlist_end = ping_neighbours_count;
+	SB_ServerList_Unlock();
 }
 
-void SB_Proxylist_Serialize_End(FILE *f)
+static proxy_query_request_t *SB_PingTree_FindRequest(proxy_query_request_t *requests, int count, const netadr_t *from)
 {
-	netadr_t invalid;
+	int i;
 
-	invalid.type = NA_INVALID;
-	fwrite(&invalid, sizeof(netadr_t), 1, f);
+	for (i = 0; i < count; i++) {
+		if (!requests[i].done && NET_CompareAdr(requests[i].adr, *from)) {
+			return &requests[i];
+		}
+	}
+
+	return NULL;
 }
 
-static qbool SB_PingTree_RecvQuery(proxy_request_queue *queue, FILE *f)
+//
+// Asks all the proxies at once through one socket. Sends are paced at sb_proxinfopersec,
+// each proxy gets sb_proxretries tries of sb_proxtimeout ms and a reply is added to the
+// graph as soon as it comes in. Returns the number of proxies which answered.
+//
+static int SB_PingTree_QueryProxies(proxy_query_request_t *requests, int count)
 {
-	qbool last_cycle = false;
-	fd_set recvset;
-	int maxsock = 0;
-	int i, ret;
-	struct timeval timeout;
-	qbool allrecved = false;
+	double timeout = max(sb_proxtimeout.integer, 1) / 1000.0;
+	double interval = 1.0 / max(sb_proxinfopersec.value, 1);
+	double now, next_send = 0, wake;
+	int i, ret, pending = count, answered = 0;
+	byte *buf;
+	socket_t sock;
+
+	if ((sock = UDP_OpenSocket(PORT_ANY)) == INVALID_SOCKET) {
+		return 0;
+	}
 
-	timeout.tv_sec = 0;
-	timeout.tv_usec = sb_proxtimeout.integer * 1000;
+	buf = (byte *) Q_malloc(PROXY_REPLY_BUFFER_SIZE);
 
-	for (;;) {
-		if (queue->sending_done) {
-			last_cycle = true;
-		}
-		
-		allrecved = true;
-		FD_ZERO(&recvset);
-		for (i = 0; i < queue->items; i++) {
-			if (!queue->data[i].done) {
-				socket_t sock = queue->data[i].sock;
-				FD_SET(sock, &recvset);
-				if ((int) sock > maxsock) {
-					maxsock = (int) sock;
+	while (pending > 0) {
+		proxy_query_request_t *unsent = NULL;
+		struct timeval tv;
+		fd_set fd;
+
+		now = Sys_DoubleTime();
+
+		for (i = 0; i < count; i++) {
+			proxy_query_request_t *r = &requests[i];
+
+			if (r->done) {
+				continue;
+			}
+
+			if (r->deadline && now >= r->deadline) {
+				if (r->tries >= sb_proxretries.integer) {
+					Com_DPrintf("Proxy %s didn't answer\n", NET_AdrToString(r->adr));
+					r->done = true;
+					pending--;
+					continue;
 				}
-				allrecved = false;
+				r->deadline = 0;
+			}
+
+			if (!r->deadline && !unsent) {
+				unsent = r;
 			}
 		}
-		if (allrecved) {
-			queue->allrecved = true;
+
+		if (!pending) {
 			break;
 		}
 
-		ret = select((maxsock + 1), &recvset, NULL, NULL, &timeout);
+		if (unsent && now >= next_send) {
+			struct sockaddr_storage addr_to;
+
+			NetadrToSockadr(&unsent->adr, &addr_to);
+			ret = sendto(sock, PROXY_PINGLIST_QUERY, PROXY_PINGLIST_QUERY_LEN, 0, (struct sockaddr *) &addr_to, sizeof(struct sockaddr_in));
+			if (ret < 0) {
+				Com_DPrintf("SB_PingTree_QueryProxies sendto returned %d\n", ret);
+			}
 
-		if (ret == 0 && last_cycle == true) {
-			break; // ret = 0 means we got timeout
+			unsent->tries++;
+			unsent->deadline = now + timeout;
+			next_send = now + interval;
+			unsent = NULL;
+			for (i = 0; i < count && !unsent; i++) {
+				if (!requests[i].done && !requests[i].deadline) {
+					unsent = &requests[i];
+				}
+			}
 		}
 
-		if (ret == 0) {
-			continue; // not all proxies were queried yet
+		// sleep until a reply, the next send or the first deadline
+		wake = now + timeout;
+		if (unsent) {
+			wake = min(wake, next_send);
+		}
+		for (i = 0; i < count; i++) {
+			if (!requests[i].done && requests[i].deadline) {
+				wake = min(wake, requests[i].deadline);
+			}
 		}
+		wake = max(wake - now, 0.001);
 
-		if (ret < 0) {
-			Com_DPrintf("select returned %d\n", ret);
-			break;
+		FD_ZERO(&fd);
+		FD_SET(sock, &fd);
+		tv.tv_sec = (long) wake;
+		tv.tv_usec = (long) ((wake - tv.tv_sec) * 1000000);
+		if (select((int) sock + 1, &fd, NULL, NULL, &tv) <= 0) {
+			continue;
 		}
 
-		for (i = 0; i < queue->items; i++) {
-			if (!queue->data[i].done && FD_ISSET(queue->data[i].sock, &recvset)) {
-				byte buf[PROXY_REPLY_BUFFER_SIZE];
-				struct sockaddr_storage addr_from;
-				socklen_t addr_from_len = sizeof(struct sockaddr_in);
+		for (;;) {
+			struct sockaddr_storage addr_from;
+			socklen_t addr_from_len = sizeof(addr_from);
+			proxy_query_request_t *r;
+			netadr_t from;
 
-				ret = recvfrom(queue->data[i].sock, (char *) buf, PROXY_REPLY_BUFFER_SIZE, 0, (struct sockaddr *) &addr_from, &addr_from_len);
-				if (ret == -1) {
-					Com_DPrintf("SB_PingTree_RecvQuery recvfrom failed\n");
-					continue;
-				}
+			ret = recvfrom(sock, (char *) buf, PROXY_REPLY_BUFFER_SIZE, 0, (struct sockaddr *) &addr_from, &addr_from_len);
+			if (ret <= 0) {
+				break;
+			}
 
-				if (strncmp("\xff\xff\xff\xffn", (char *) buf, 5) == 0) {
-					nodeid_t id = queue->data[i].nodeid;
-					queue->data[i].done = true;
-					ping_nodes[id].nlist_start = ping_neighbours_count;
-					if (f && ret > 5)
-							SB_Proxylist_Serialize_Reply(f, SB_NodeNetadr_Get(id), buf+5, ret-5);
-					SB_Proxy_ParseReply(buf+5, ret-5, SB_PingTree_AddProxyPing);
-					ping_nodes[id].nlist_end = ping_neighbours_count;
-				}
-				else {
-					Com_DPrintf("Invalid reply received\n");
-				}
+			SockadrToNetadr(&addr_from, &from);
+			if (!(r = SB_PingTree_FindRequest(requests, count, &from))) {
+				continue; // late duplicate or a martian
 			}
+
+			if (ret < 5 || strncmp("\xff\xff\xff\xffn", (char *) buf, 5) != 0) {
+				Com_DPrintf("Invalid reply received\n");
+				continue;
+			}
+
+			SB_ProxyCache_Store(&r->adr, (double) time(NULL), buf + 5, ret - 5);
+			SB_PingTree_AddProxyReply(r->nodeid, buf + 5, ret - 5);
+			r->done = true;
+			pending--;
+			answered++;
 		}
 	}
 
-	return allrecved;
+	closesocket(sock);
+	Q_free(buf);
+
+	return answered;
 }
 
-static void SB_PingTree_ScanProxies(void)
+#define PROXY_SERIALIZE_FILE_VERSION 2
+static void SB_Proxylist_Serialize(FILE *f)
 {
+	int version = PROXY_SERIALIZE_FILE_VERSION;
+	netadr_t invalid;
 	int i;
-	proxy_request_queue queue = { NULL, 0, false };
-	size_t request = 0;
-	FILE *f = NULL;
 
-	for (i = 0; i < ping_nodes_count; i++) {
-		if (ping_nodes[i].proxport) {
-			queue.items++;
-		}
+	// header
+	// - version
+	fwrite(&version, sizeof(int), 1, f);
+
+	// body
+	for (i = 0; i < proxy_cache_count; i++) {
+		fwrite(&proxy_cache[i].proxy, sizeof(netadr_t), 1, f);
+		fwrite(&proxy_cache[i].fetched, sizeof(double), 1, f);
+		fwrite(&proxy_cache[i].replylen, sizeof(size_t), 1, f);
+		fwrite(proxy_cache[i].reply, proxy_cache[i].replylen, 1, f);
+	}
+
+	memset(&invalid, 0, sizeof(invalid));
+	invalid.type = NA_INVALID;
+	fwrite(&invalid, sizeof(netadr_t), 1, f);
+}
+
+static void SB_Proxylist_Serialize_f(void)
+{
+	char prx_data_path[MAX_OSPATH] = {0};
+	FILE *f;
+
+	snprintf(&prx_data_path[0], sizeof(prx_data_path), "%s/%s", com_homedir, "proxies_data");
+	if ((f = fopen(prx_data_path, "wb"))) {
+		SB_Proxylist_Serialize(f);
+		fclose(f);
 	}
+}
 
-	if (!queue.items) return;
+//
+// Gets the ping lists of all proxies in the graph into it. Lists younger than
+// sb_proxcachetime seconds are taken from the cache, the rest are asked for again and
+// a proxy which doesn't answer falls back to its last known list, however old.
+//
+static void SB_PingTree_ScanProxies(void)
+{
+	proxy_query_request_t *requests;
+	double now = (double) time(NULL);
+	int i, count = 0, cached = 0, answered = 0, stale = 0;
 
-	queue.data = (proxy_query_request_t *) Q_malloc(sizeof(proxy_query_request_t) * queue.items);
+	requests = (proxy_query_request_t *) Q_malloc(max(1, ping_nodes_count) * sizeof(proxy_query_request_t));
 
 	for (i = 0; i < ping_nodes_count; i++) {
-		if (ping_nodes[i].proxport) {
-			queue.data[request].done = false;
-			queue.data[request].nodeid = i;
-			queue.data[request].sock = UDP_OpenSocket(PORT_ANY);
-			request++;
+		netadr_t adr;
+		proxy_cache_entry_t *entry;
+
+		if (!ping_nodes[i].proxport) {
+			continue;
 		}
-	}
 
-	if (sb_listcache.value) {
-		char prx_data_path[MAX_OSPATH] = {0};
+		adr = SB_NodeNetadr_Get(i);
+		entry = SB_ProxyCache_Find(&adr);
+
+		if (entry && now - entry->fetched < sb_proxcachetime.value) {
+			SB_PingTree_AddProxyReply(i, entry->reply, entry->replylen);
+			cached++;
+			continue;
+		}
 
-		snprintf(&prx_data_path[0], sizeof(prx_data_path), "%s/%s", com_homedir, "proxies_data");
-		f = fopen(prx_data_path, "wb");
-		if (f)
-			SB_Proxylist_Serialize_Start(f);
+		requests[count].nodeid = i;
+		requests[count].adr = adr;
+		requests[count].tries = 0;
+		requests[count].deadline = 0;
+		requests[count].done = false;
+		count++;
 	}
 
-	for (i = 0; i < sb_proxretries.integer; i++) {
-		queue.sending_done = false;
-		if (Sys_CreateDetachedThread(SB_PingTree_SendQueryThread, (void *) &queue) < 0) {
-			Com_Printf("Failed to create SB_PingTree_SendQueryThread thread\n");
+	if (count) {
+		answered = SB_PingTree_QueryProxies(requests, count);
+
+		for (i = 0; i < count; i++) {
+			proxy_cache_entry_t *entry = SB_ProxyCache_Find(&requests[i].adr);
+
+			if (entry && entry->fetched < now) {
+				SB_PingTree_AddProxyReply(requests[i].nodeid, entry->reply, entry->replylen);
+				stale++;
+			}
 		}
-		SB_PingTree_RecvQuery(&queue, f);
-		if (queue.allrecved) {
-			break;
+
+		if (sb_listcache.integer) {
+			SB_Proxylist_Serialize_f();
 		}
 	}
 
-	if (f) {
-		SB_Proxylist_Serialize_End(f);
-		fclose(f);
-	}
+	Com_DPrintf("Ping Tree: %d proxies cached, %d answered, %d from outdated cache, %d unreachable\n",
+		cached, answered, stale, count - answered - stale);
 
-	while (!queue.sending_done) {
-		// XXX: use semaphore instead
-		Sys_MSleep(100);
-	}
+	Q_free(requests);
+}
 
-	for (i = 0; i < queue.items; i++) {
-		closesocket(queue.data[i].sock);
+static void SB_PingTree_HeapPush(ping_heap_item_t *heap, int *heapn, dist_t dist, nodeid_t id)
+{
+	int i = (*heapn)++, parent;
+
+	for ( ; i > 0 && heap[(parent = (i - 1) / 2)].dist > dist; i = parent) {
+		heap[i] = heap[parent];
 	}
 
-	Q_free(queue.data);
+	heap[i].dist = dist;
+	heap[i].id = id;
 }
 
-static nodeid_t SB_PingTree_NearestNodeGet(void)
+static ping_heap_item_t SB_PingTree_HeapPop(ping_heap_item_t *heap, int *heapn)
 {
-	// XXX: implement using binary/fibonacci heap...
-	int i;
-	nodeid_t ret = INVALID_NODE;
-	dist_t minimum = DIST_INFINITY;
+	ping_heap_item_t top = heap[0], last = heap[--(*heapn)];
+	int i, child;
 
-	for (i = 0; i < ping_nodes_count; i++) {
-		if (!ping_nodes[i].visited && ping_nodes[i].dist < minimum) {
-			ret = i;
-			minimum = ping_nodes[i].dist;
+	for (i = 0; (child = 2 * i + 1) < *heapn; i = child) {
+		if (child + 1 < *heapn && heap[child + 1].dist < heap[child].dist) {
+			child++;
+		}
+		if (last.dist <= heap[child].dist) {
+			break;
 		}
+		heap[i] = heap[child];
 	}
+	heap[i] = last;
 
-	return ret;
+	return top;
 }
 
 static void SB_PingTree_Dijkstra(void)
 {
-	int i;
+	ping_heap_item_t *heap;
+	int i, heapn = 0;
+
+	SB_ServerList_Lock();
+
+	// every relaxation pushes at most one item, stale ones are skipped when popped
+	heap = (ping_heap_item_t *) Q_malloc((ping_neighbours_count + 1) * sizeof(ping_heap_item_t));
 
 	ping_nodes[startnode_id].dist = 0;
+	SB_PingTree_HeapPush(heap, &heapn, 0, startnode_id);
+
+	while (heapn > 0) {
+		ping_heap_item_t item = SB_PingTree_HeapPop(heap, &heapn);
+		nodeid_t cur = item.id;
 
-	for (;;) {
-		nodeid_t cur = SB_PingTree_NearestNodeGet();
-		if (cur == INVALID_NODE) break;
+		if (ping_nodes[cur].visited) {
+			continue;
+		}
 
 		ping_nodes[cur].visited = true;
 		for (i = ping_nodes[cur].nlist_start; i < ping_nodes[cur].nlist_end; i++) {
-			dist_t altdist = ping_nodes[cur].dist + ping_neighbours[i].dist;
-			if (altdist < ping_nodes[ping_neighbours[i].id].dist) {
+			nodeid_t next = ping_neighbours[i].id;
+			int altdist = ping_nodes[cur].dist + ping_neighbours[i].dist;
+
+			if (altdist < ping_nodes[next].dist) {
 				// so-called Relax()
-				ping_nodes[ping_neighbours[i].id].dist = altdist;
-				ping_nodes[ping_neighbours[i].id].prev = cur;
+				ping_nodes[next].dist = altdist;
+				ping_nodes[next].prev = cur;
+				SB_PingTree_HeapPush(heap, &heapn, altdist, next);
 			}
 		}
 	}
+
+	Q_free(heap);
+
+	SB_ServerList_Unlock();
 }
 
 static void SB_PingTree_Phase1(void)
 {
+	SB_ServerList_Lock();
 	SB_PingTree_Clear();
 	SB_PingTree_AddNodes();
+	SB_ServerList_Unlock();
 }
 
 static void SB_PingTree_UpdateServerList(void)
@@ -629,10 +798,15 @@ static void SB_PingTree_UpdateServerList(void)
 
 int SB_PingTree_Phase2(void *ignored_arg)
 {
+	double start = Sys_DoubleTime();
+
 	SB_PingTree_ScanProxies();
 	SB_PingTree_Dijkstra();
 	SB_PingTree_UpdateServerList();
 
+	Com_DPrintf("Ping Tree: %d nodes, %d edges, built in %.0f ms\n",
+		ping_nodes_count, ping_neighbours_count, (Sys_DoubleTime() - start) * 1000);
+
 	sb_queuedtriggers |= SB_TRIGGER_NOTIFY_PINGTREE;
 	Sys_SemPost(&phase2thread_lock);
 	building_pingtree = false;
@@ -671,7 +845,10 @@ void SB_PingTree_Build(void)
 /// Prints the shortest path to given IP address
 void SB_PingTree_DumpPath(const netadr_t *addr)
 {
-	nodeid_t target = SB_PingTree_FindIp(SB_Netaddr2Ipaddr(addr));
+	nodeid_t target;
+
+	SB_ServerList_Lock();
+	target = SB_PingTree_FindIp(SB_Netaddr2Ipaddr(addr));
 
 	if (target == INVALID_NODE) {
 		Com_Printf("No route found to given host\n");
@@ -688,36 +865,45 @@ void SB_PingTree_DumpPath(const netadr_t *addr)
 		}
 		Com_Printf("%4d ms  localhost (your machine)\n", 0);
 	}
+	SB_ServerList_Unlock();
 }
 
 int SB_PingTree_GetPathLen(const netadr_t *addr)
 {
-	nodeid_t target = SB_PingTree_FindIp(SB_Netaddr2Ipaddr(addr));
+	nodeid_t target;
+	int proxies = -1;
+
+	SB_ServerList_Lock();
+	target = SB_PingTree_FindIp(SB_Netaddr2Ipaddr(addr));
 
 	if (target == INVALID_NODE || ping_nodes[target].prev == INVALID_NODE) {
-		return -1;
+		proxies = -1;
 	}
 	else if (ping_nodes[target].prev == startnode_id) {
-		return 0;
+		proxies = 0;
 	}
 	else {
 		nodeid_t current = ping_nodes[target].prev;
-		int proxies = 0;
 
+		proxies = 0;
 		while (current != startnode_id && current != INVALID_NODE) {
 			proxies++;
 			current = ping_nodes[current].prev;
 		}
-
-		return proxies;
 	}
+	SB_ServerList_Unlock();
+
+	return proxies;
 }
 
 /// Connects to given QW server using the best available route
 void SB_PingTree_ConnectBestPath(const netadr_t *addr)
 {
 	extern cvar_t cl_proxyaddr;
-	nodeid_t target = SB_PingTree_FindIp(SB_Netaddr2Ipaddr(addr));
+	nodeid_t target;
+
+	SB_ServerList_Lock();
+	target = SB_PingTree_FindIp(SB_Netaddr2Ipaddr(addr));
 
 	if (target == INVALID_NODE || ping_nodes[target].prev == INVALID_NODE) {
 		Com_Printf("No route found, trying to connect directly...\n");
@@ -748,6 +934,7 @@ void SB_PingTree_ConnectBestPath(const netadr_t *addr)
 			proxies, ((proxies == 1) ? "proxy" : "proxies"), ping_nodes[target].dist);
 		Cvar_Set(&cl_proxyaddr, proxylist_buf);
 	}
+	SB_ServerList_Unlock();
 
 	/* FIXME: Create a Cbuf_AddTextFmt? */
 	Cbuf_AddText("connect ");
@@ -755,53 +942,52 @@ void SB_PingTree_ConnectBestPath(const netadr_t *addr)
 	Cbuf_AddText("\n");
 }
 
+// Reads proxies_data into the proxy cache.
 int SB_Proxylist_Unserialize(FILE *f)
 {
 	int version, count = 0;
+	byte *buf;
 
 	if (fread(&version, sizeof(int), 1, f) != 1)
 		return -1;
 	if (version != PROXY_SERIALIZE_FILE_VERSION)
 		return -1;
 
+	buf = (byte *) Q_malloc(PROXY_REPLY_BUFFER_SIZE);
+
 	while (!ferror(f) && !feof(f)) {
 		netadr_t proxy;
+		double fetched;
 		size_t buflen;
-		byte buf[PROXY_REPLY_BUFFER_SIZE];
-		nodeid_t id;
 
 		if (fread(&proxy, sizeof(netadr_t), 1, f) != 1)
-			return -3;
-
-		if (proxy.type == NA_INVALID)
 			break;
 
-		if (fread(&buflen, sizeof(size_t), 1, f) != 1)
-			return -3;
-		if (buflen > PROXY_REPLY_BUFFER_SIZE)
-			return -3;
-		if (fread(buf, buflen, 1, f) != 1)
-			return -3;
-
-		id = SB_PingTree_FindIp(SB_Netaddr2Ipaddr(&proxy));
-		if (id == INVALID_NODE)
-			return -3;
+		if (proxy.type == NA_INVALID) {
+			Q_free(buf);
+			return count;
+		}
 
-		ping_nodes[id].nlist_start = ping_neighbours_count;
-		SB_Proxy_ParseReply(buf, buflen, SB_PingTree_AddProxyPing);
-		ping_nodes[id].nlist_end = ping_neighbours_count;
+		if (fread(&fetched, sizeof(double), 1, f) != 1 || fread(&buflen, sizeof(size_t), 1, f) != 1)
+			break;
+		if (buflen > PROXY_REPLY_BUFFER_SIZE)
+			break;
+		if (buflen && fread(buf, buflen, 1, f) != 1)
+			break;
 
+		SB_ProxyCache_Store(&proxy, fetched, buf, buflen);
 		count++;
 	}
 
-	return count;
+	Q_free(buf);
+	return -3;
 }
 
 void SB_Proxylist_Unserialize_f(void)
 {
 	char filename[MAX_OSPATH] = {0};
 	FILE *f;
-	int err;
+	int err, i;
 	
 	snprintf(&filename[0], sizeof(filename), "%s/%s", com_homedir, "proxies_data");
 
@@ -815,6 +1001,20 @@ void SB_Proxylist_Unserialize_f(void)
 	err = SB_Proxylist_Unserialize(f);
 	if (err > 0) {
 		Com_Printf("Successfully read %d proxies\n", err);
+
+		// whatever their age, it's better than no routes until the next build
+		for (i = 0; i < ping_nodes_count; i++) {
+			netadr_t adr;
+			proxy_cache_entry_t *entry;
+
+			if (!ping_nodes[i].proxport)
+				continue;
+
+			adr = SB_NodeNetadr_Get(i);
+			if ((entry = SB_ProxyCache_Find(&adr)))
+				SB_PingTree_AddProxyReply(i, entry->reply, entry->replylen);
+		}
+
 		SB_PingTree_Dijkstra();
 		SB_PingTree_UpdateServerList();
 		pingtree_built = true;
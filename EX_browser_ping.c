@@ -136,14 +136,9 @@ typedef struct {
 // =============================================================================
 //  Global variables
 // =============================================================================
-qbool useNewPing = false; // New Ping = UDP QW Packet multithreaded ping
+qbool useNewPing = false; // New Ping = UDP QW Packet ping, see EX_browser_query.c
 
 socket_t sock;
-socket_t ping_sock;
-
-/* Used for thread syncronisation */
-static qbool ping_finished = false;
-static sem_t ping_semaphore;
 
 // =============================================================================
 //  Local Functions
@@ -598,101 +593,6 @@ int oldPingHosts(server_data *servs[], int servsn, int count)
     return success;
 }
 
-/**
- * Pings multiple hosts in parrallel, each host is pingged count times
- */
-void PingSendParrallelMultiHosts(pinghost_t *phosts, int nelms, int count) {
-	struct sockaddr_in to;
-	int interval; 
-	int i, j;
-	int ret;
-	timerresolution_session_t timer_session;
-	
-	memset(&timer_session, 0, sizeof(timer_session));
-
-	count = bound(1, count, 6);
-	interval = 1000.0 / sb_pingspersec.integer;
-
-	Sys_TimerResolution_InitSession(&timer_session);
-	Sys_TimerResolution_RequestMinimum(&timer_session);
-
-	for (i = 0; i < count && !abort_ping; i++) {
-		for (j = 0; j < nelms && !abort_ping; j++) {
-			char *packet = PING_PACKET_DATA;
-
-			ping_pos = min(1, (j / (double)(nelms * count))) + (i / (double)count);
-
-			to.sin_family = AF_INET;
-			to.sin_port = htons(phosts[j].port);
-			to.sin_addr.s_addr = phosts[j].ip;
-
-			ret = sendto(ping_sock, packet, strlen(packet), 0, (struct sockaddr *)&to, sizeof(struct sockaddr));
-
-			if (ret == -1) {
-				continue;
-			}
-
-			phosts[j].stime[phosts[j].send] = Sys_DoubleTime();
-			phosts[j].send++;
-
-			Sys_MSleep(interval);
-
-		}
-	}
-
-	Sys_TimerResolution_Clear(&timer_session);
-}
-
-/**
- * Thread entry point for parrallel recving of ping responses
- */
-int PingRecvProc(void *lpParameter)
-{
-	socklen_t inaddrlen;
-	struct sockaddr_in from;
-	fd_set fd;
-	int k, ret;
-	struct timeval timeout;
-	pinghost_list_t *host_list = (pinghost_list_t *)lpParameter;
-
-	while (!ping_finished && !abort_ping) {
-		FD_ZERO(&fd);
-		FD_SET(ping_sock, &fd);
-		timeout.tv_sec = 0;
-		timeout.tv_usec = 100 * 1000;
-
-		ret = select(ping_sock+1, &fd, NULL, NULL, &timeout);
-		if (ret <= 0) // error or timeout
-			continue;
-
-		while (1) {
-			char buf[16];
-
-			inaddrlen = sizeof(struct sockaddr_in);
-			ret = recvfrom(ping_sock, buf, sizeof(buf), 0, (struct sockaddr *)&from, &inaddrlen);
-			if (ret <= 0) // socket is asynch, so most likely this means there is no data to read
-				break;
-			if (buf[0] != 'l') // not A2A_ACK
-				continue;
-	
-			for (k = 0; k < host_list->nelms; k++) {
-				if (host_list->hosts[k].ip == (int) from.sin_addr.s_addr &&
-				    host_list->hosts[k].port == ntohs(from.sin_port)) {
-					host_list->hosts[k].ping += Sys_DoubleTime() 
-									- host_list->hosts[k]
-											.stime[host_list->hosts[k].recv];
-					host_list->hosts[k].recv++;
-					break;
-				}
-			}
-		}
-	}
-
-	Sys_SemPost(&ping_semaphore);
-
-	return 0;
-}
-
 /**
  * Ping a single host count times, returns the average of the responses
  */
@@ -747,58 +647,6 @@ _select:
 	return pings ? (int)((ping * 1000) / pings) : 0;
 }
 
-/**
- * Send several ping requests at once, start another thread to recieve
- * the responses.
- * FIXME: error handling is in rly bad shape
- */
-int PingHosts(server_data *servs[], int servsn, int count)
-{
-	u_int arg;
-	pinghost_list_t host_list;
-
-	host_list.hosts = ParseServerList(servs, servsn, &host_list.nelms);
-	ping_finished = false;
-
-	ping_sock = UDP_OpenSocket(PORT_ANY);
-
-#ifndef _WIN32
-	if ((fcntl (ping_sock, F_SETFL, O_NONBLOCK)) == -1) { // O'Rly?! @@@
-		Com_Printf ("TCP_OpenStream: fcntl: (%i): %s\n", qerrno, strerror(qerrno));
-		//closesocket(ping_sock);
-	}
-#endif
-
-	arg = 1;
-	if (ioctlsocket (ping_sock, FIONBIO, (u_long *)&arg) == -1) { // make asynchronous
-		Com_Printf ("PingHosts: ioctl: (%i): %s\n", qerrno, strerror(qerrno));
-		//closesocket(newsocket);
-	}
-
-	Sys_SemInit(&ping_semaphore, 0, 1);
-
-	if (Sys_CreateDetachedThread(PingRecvProc, (void *)&host_list) < 0) {
-		Com_Printf("Failed to create Ping receiver thread\n");
-	}
-
-	PingSendParrallelMultiHosts(host_list.hosts, host_list.nelms, count);
-
-	Sys_MSleep(500); // Wait for slow pings
-
-	ping_finished = true; // let thread know we are done
-	Sys_SemWait(&ping_semaphore);
-	Sys_SemDestroy(&ping_semaphore);
-	closesocket(ping_sock);
-
-	if (!abort_ping) {
-		FillServerListPings(servs, servsn, host_list.hosts, host_list.nelms);
-	}
-
-	Q_free(host_list.hosts);
-
-	return 1;
-}
-
 //
 // ----------------------------------------------
 //  connection test
@@ -0,0 +1,784 @@
+/*
+Copyright (C) 2026 ezQuake team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// EX_browser_query.c -- non-blocking ping and status query engine of the server browser
+//
+// Every host of a refresh gets a slot in one flat array. Hosts waiting to send sit in a
+// FIFO per request type which a token bucket drains at sb_pingspersec / sb_infospersec,
+// requests in flight sit on a timing wheel slot picked by their deadline, and replies
+// are matched back to their host through an open hash of ip:port. A host runs through
+// its pings and then straight on to its status request, so results reach the list while
+// other servers are still being asked instead of after one pass over everything.
+
+#include "quakedef.h"
+#ifndef _WIN32
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netdb.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <unistd.h>
+#endif
+#include "EX_browser.h"
+
+#define SBQ_WHEEL_SLOTS		1024		// power of two
+#define SBQ_WHEEL_TICK		0.005		// seconds per slot, so one turn is ~5 seconds
+#define SBQ_MIN_WAIT		0.001
+#define SBQ_MAX_PINGS		6
+#define SBQ_MAX_REPLY		8192
+
+typedef enum {
+	SBQ_PING,
+	SBQ_STATUS,
+	SBQ_NUMREQUESTS,
+	SBQ_DONE = SBQ_NUMREQUESTS
+} sbq_state_t;
+
+typedef struct sbq_host_s {
+	server_data		*server;
+	netadr_t		addr;
+	sbq_state_t		state;
+	int				tries;			// requests sent in the current state
+	int				replies;		// ping replies received
+	double			ping_total;
+	double			sent_time;
+	qbool			in_flight;
+	unsigned int	deadline;		// wheel tick the request in flight times out on
+	int				hash_next;
+	int				wheel_next, wheel_prev;
+	int				queue_next;
+} sbq_host_t;
+
+typedef struct sbq_bucket_s {
+	double			tokens;
+	double			rate;			// tokens per second
+	double			burst;
+	double			last;
+} sbq_bucket_t;
+
+typedef struct sbq_queue_s {
+	int				head, tail;
+} sbq_queue_t;
+
+// Where the packets go. The browser uses a udp socket, the benchmark a simulated network.
+typedef struct sbq_transport_s {
+	double			(*time) (void *ctx);
+	int				(*send) (void *ctx, const netadr_t *to, const char *data, int len);
+	int				(*recv) (void *ctx, netadr_t *from, char *buf, int size); // non-blocking
+	void			(*wait) (void *ctx, double seconds); // until a packet arrives or time is up
+	void			*ctx;
+} sbq_transport_t;
+
+typedef struct sbq_stats_s {
+	int				sent[SBQ_NUMREQUESTS];
+	int				received[SBQ_NUMREQUESTS];
+	int				timeouts[SBQ_NUMREQUESTS];
+	int				stray;			// replies nobody was waiting for
+} sbq_stats_t;
+
+typedef struct sbq_s {
+	const sbq_transport_t *net;
+	qbool			live;			// drives the browser ui
+
+	sbq_host_t		*hosts;
+	int				hostsn;
+	int				done;
+	int				pinging;		// hosts not past their pings yet
+
+	int				*hash;
+	unsigned int	hash_mask;
+
+	int				wheel[SBQ_WHEEL_SLOTS];
+	unsigned int	tick;			// last wheel tick processed
+	double			start;
+
+	sbq_queue_t		queue[SBQ_NUMREQUESTS];
+	sbq_bucket_t	bucket[SBQ_NUMREQUESTS];
+	double			timeout[SBQ_NUMREQUESTS];
+	int				tries[SBQ_NUMREQUESTS];
+	qbool			infos;			// ask for status after pinging
+
+	sbq_stats_t		stats;
+} sbq_t;
+
+static const char sbq_ping_packet[] = "\xff\xff\xff\xffk\n"; // A2A_PING, answered by A2A_ACK
+static const char sbq_status_packet[] = "\xff\xff\xff\xffstatus 23\n";
+
+static unsigned int SBQ_HashAdr (const netadr_t *a)
+{
+	unsigned int h = (a->ip[0] << 24) | (a->ip[1] << 16) | (a->ip[2] << 8) | a->ip[3];
+
+	h ^= a->port * 0x9E3779B1;
+	h ^= h >> 15;
+	h *= 0x85EBCA6B;
+	h ^= h >> 13;
+
+	return h;
+}
+
+static int SBQ_FindHost (sbq_t *q, const netadr_t *a)
+{
+	int i;
+
+	for (i = q->hash[SBQ_HashAdr(a) & q->hash_mask]; i >= 0; i = q->hosts[i].hash_next)
+	{
+		if (q->hosts[i].addr.port == a->port && !memcmp(q->hosts[i].addr.ip, a->ip, sizeof(a->ip)))
+			return i;
+	}
+
+	return -1;
+}
+
+static unsigned int SBQ_Tick (sbq_t *q, double time)
+{
+	return (unsigned int) ((time - q->start) / SBQ_WHEEL_TICK);
+}
+
+static void SBQ_WheelInsert (sbq_t *q, int i)
+{
+	sbq_host_t *h = &q->hosts[i];
+	int *slot = &q->wheel[h->deadline & (SBQ_WHEEL_SLOTS - 1)];
+
+	h->wheel_prev = -1;
+	h->wheel_next = *slot;
+	if (*slot >= 0)
+		q->hosts[*slot].wheel_prev = i;
+	*slot = i;
+}
+
+static void SBQ_WheelRemove (sbq_t *q, int i)
+{
+	sbq_host_t *h = &q->hosts[i];
+
+	if (h->wheel_prev >= 0)
+		q->hosts[h->wheel_prev].wheel_next = h->wheel_next;
+	else
+		q->wheel[h->deadline & (SBQ_WHEEL_SLOTS - 1)] = h->wheel_next;
+
+	if (h->wheel_next >= 0)
+		q->hosts[h->wheel_next].wheel_prev = h->wheel_prev;
+
+	h->wheel_next = h->wheel_prev = -1;
+	h->in_flight = false;
+}
+
+static void SBQ_Enqueue (sbq_t *q, int i, sbq_state_t state)
+{
+	sbq_queue_t *queue = &q->queue[state];
+
+	if (q->hosts[i].state != state)
+		q->hosts[i].tries = 0;
+
+	q->hosts[i].state = state;
+	q->hosts[i].queue_next = -1;
+
+	if (queue->tail >= 0)
+		q->hosts[queue->tail].queue_next = i;
+	else
+		queue->head = i;
+	queue->tail = i;
+}
+
+static int SBQ_Dequeue (sbq_t *q, sbq_state_t state)
+{
+	sbq_queue_t *queue = &q->queue[state];
+	int i = queue->head;
+
+	if (i >= 0)
+	{
+		queue->head = q->hosts[i].queue_next;
+		if (queue->head < 0)
+			queue->tail = -1;
+	}
+
+	return i;
+}
+
+static void SBQ_Finish (sbq_t *q, int i)
+{
+	q->hosts[i].state = SBQ_DONE;
+	q->done++;
+}
+
+// Doesn't answer or isn't worth asking, same outcome as an empty status reply used to have.
+static void SBQ_Drop (sbq_t *q, int i)
+{
+	Reset_Server(q->hosts[i].server);
+	SetPing(q->hosts[i].server, -1);
+	SBQ_Finish(q, i);
+}
+
+static void SBQ_PingsDone (sbq_t *q, int i)
+{
+	sbq_host_t *h = &q->hosts[i];
+	int ping = h->replies ? (int) (h->ping_total / h->replies * 1000) : -1;
+
+	q->pinging--;
+	SetPing(h->server, ping);
+
+	if (!q->infos)
+		SBQ_Finish(q, i);
+	else if (ping < 0 || (sb_hidehighping.integer && ping > sb_pinglimit.integer))
+		SBQ_Drop(q, i);
+	else
+		SBQ_Enqueue(q, i, SBQ_STATUS);
+}
+
+static void SBQ_Send (sbq_t *q, int i, double time)
+{
+	sbq_host_t *h = &q->hosts[i];
+
+	if (h->state == SBQ_PING)
+		q->net->send(q->net->ctx, &h->addr, sbq_ping_packet, sizeof(sbq_ping_packet) - 1);
+	else
+		q->net->send(q->net->ctx, &h->addr, sbq_status_packet, sizeof(sbq_status_packet) - 1);
+
+	// a failed send is left to time out like a lost packet
+	q->stats.sent[h->state]++;
+	h->tries++;
+	h->sent_time = time;
+	h->in_flight = true;
+	h->deadline = SBQ_Tick(q, time + q->timeout[h->state]) + 1;
+	SBQ_WheelInsert(q, i);
+}
+
+static void SBQ_Timeout (sbq_t *q, int i, double time)
+{
+	sbq_host_t *h = &q->hosts[i];
+
+	q->stats.timeouts[h->state]++;
+
+	if (h->tries < q->tries[h->state])
+		SBQ_Enqueue(q, i, h->state);
+	else if (h->state == SBQ_PING)
+		SBQ_PingsDone(q, i);
+	else
+		SBQ_Drop(q, i);
+}
+
+static void SBQ_Reply (sbq_t *q, const netadr_t *from, char *data, int len, double time)
+{
+	qbool ack, status;
+	sbq_host_t *h;
+	int i;
+
+	// servers answer A2A_PING with a bare 'l', some proxies prefix it
+	ack = (len >= 1 && data[0] == 'l') || (len >= 5 && !memcmp(data, "\xff\xff\xff\xffl", 5));
+	status = (len >= 5 && !memcmp(data, "\xff\xff\xff\xffn", 5));
+
+	if ((i = SBQ_FindHost(q, from)) < 0 || !q->hosts[i].in_flight)
+	{
+		q->stats.stray++;
+		return;
+	}
+	h = &q->hosts[i];
+
+	if (h->state == SBQ_PING && ack)
+	{
+		SBQ_WheelRemove(q, i);
+		q->stats.received[SBQ_PING]++;
+		h->replies++;
+		h->ping_total += time - h->sent_time;
+
+		if (h->tries < q->tries[SBQ_PING])
+			SBQ_Enqueue(q, i, SBQ_PING);
+		else
+			SBQ_PingsDone(q, i);
+	}
+	else if (h->state == SBQ_STATUS && status)
+	{
+		SBQ_WheelRemove(q, i);
+		q->stats.received[SBQ_STATUS]++;
+
+		Reset_Server(h->server);
+		Parse_Serverinfo(h->server, data);
+		SBQ_Finish(q, i);
+	}
+	else
+	{
+		q->stats.stray++;
+	}
+}
+
+// Expire everything whose deadline has passed, a full turn at most covers every slot.
+static void SBQ_Advance (sbq_t *q, double time)
+{
+	unsigned int now = SBQ_Tick(q, time), steps, s;
+	int i, next;
+
+	steps = min(now - q->tick, SBQ_WHEEL_SLOTS);
+
+	for (s = 1; s <= steps; s++)
+	{
+		for (i = q->wheel[(q->tick + s) & (SBQ_WHEEL_SLOTS - 1)]; i >= 0; i = next)
+		{
+			next = q->hosts[i].wheel_next;
+
+			if ((int) (q->hosts[i].deadline - now) <= 0)
+			{
+				SBQ_WheelRemove(q, i);
+				SBQ_Timeout(q, i, time);
+			}
+		}
+	}
+
+	q->tick = now;
+}
+
+static void SBQ_Refill (sbq_bucket_t *b, double time)
+{
+	b->tokens = min(b->burst, b->tokens + (time - b->last) * b->rate);
+	b->last = time;
+}
+
+static void SBQ_Run (sbq_t *q)
+{
+	char buf[SBQ_MAX_REPLY];
+	netadr_t from;
+	double time, wait, need;
+	int i, len, r;
+
+	while (q->done < q->hostsn)
+	{
+		if (q->live && abort_ping)
+			break;
+
+		time = q->net->time(q->net->ctx);
+
+		for (r = 0; r < SBQ_NUMREQUESTS; r++)
+		{
+			SBQ_Refill(&q->bucket[r], time);
+
+			while (q->bucket[r].tokens >= 1 && (i = SBQ_Dequeue(q, r)) >= 0)
+			{
+				SBQ_Send(q, i, time);
+				q->bucket[r].tokens -= 1;
+			}
+		}
+
+		while ((len = q->net->recv(q->net->ctx, &from, buf, sizeof(buf) - 1)) > 0)
+		{
+			buf[len] = 0;
+			SBQ_Reply(q, &from, buf, len, q->net->time(q->net->ctx));
+		}
+
+		SBQ_Advance(q, q->net->time(q->net->ctx));
+
+		if (q->live)
+		{
+			ping_pos = q->done / (double) q->hostsn;
+			if (!q->pinging && ping_phase == 1)
+				ping_phase = 2;
+		}
+
+		// sleep until the next token or the next wheel tick, whichever comes first,
+		// a bucket left a rounding error short of a token would otherwise spin
+		wait = SBQ_WHEEL_TICK;
+		for (r = 0; r < SBQ_NUMREQUESTS; r++)
+		{
+			if (q->queue[r].head < 0)
+				continue;
+
+			need = (1 - q->bucket[r].tokens) / q->bucket[r].rate;
+			wait = bound(SBQ_MIN_WAIT, need, wait);
+		}
+
+		q->net->wait(q->net->ctx, wait);
+	}
+}
+
+static void SBQ_Init (sbq_t *q, const sbq_transport_t *net, server_data *servs[], int servsn, qbool pings, qbool infos, double pingspersec, double infospersec)
+{
+	unsigned int size, slot;
+	sbq_host_t *h;
+	int i, r;
+
+	memset(q, 0, sizeof(*q));
+	q->net = net;
+	q->infos = infos;
+	q->start = net->time(net->ctx);
+
+	for (size = 256; size < 2 * (unsigned int) servsn; size <<= 1)
+		;
+	q->hash = (int *) Q_malloc(size * sizeof(int));
+	q->hash_mask = size - 1;
+	memset(q->hash, -1, size * sizeof(int));
+	memset(q->wheel, -1, sizeof(q->wheel));
+
+	q->timeout[SBQ_PING] = max(10, sb_pingtimeout.value) / 1000;
+	q->timeout[SBQ_STATUS] = max(10, sb_infotimeout.value) / 1000;
+	q->tries[SBQ_PING] = bound(1, sb_pings.integer, SBQ_MAX_PINGS);
+	q->tries[SBQ_STATUS] = max(1, sb_inforetries.integer);
+	q->bucket[SBQ_PING].rate = max(1, pingspersec);
+	q->bucket[SBQ_STATUS].rate = max(1, infospersec);
+
+	for (r = 0; r < SBQ_NUMREQUESTS; r++)
+	{
+		q->queue[r].head = q->queue[r].tail = -1;
+		q->bucket[r].burst = max(1, q->bucket[r].rate * SBQ_WHEEL_TICK * 4);
+		q->bucket[r].tokens = 1;
+		q->bucket[r].last = q->start;
+	}
+
+	q->hosts = (sbq_host_t *) Q_malloc(max(1, servsn) * sizeof(sbq_host_t));
+
+	for (i = 0; i < servsn; i++)
+	{
+		h = &q->hosts[q->hostsn];
+		h->server = servs[i];
+		h->addr = servs[i]->address;
+		h->wheel_next = h->wheel_prev = -1;
+
+		if (SBQ_FindHost(q, &h->addr) >= 0)
+			continue; // listed twice, once is enough
+
+		slot = SBQ_HashAdr(&h->addr) & q->hash_mask;
+		h->hash_next = q->hash[slot];
+		q->hash[slot] = q->hostsn++;
+	}
+
+	for (i = 0; i < q->hostsn; i++)
+	{
+		h = &q->hosts[i];
+		h->state = SBQ_NUMREQUESTS; // so the first enqueue starts counting tries
+
+		if (pings)
+		{
+			q->pinging++;
+			SBQ_Enqueue(q, i, SBQ_PING);
+		}
+		else if (h->server->ping < 0 || (sb_hidehighping.integer && h->server->ping > sb_pinglimit.integer))
+		{
+			SBQ_Drop(q, i);
+		}
+		else
+		{
+			SBQ_Enqueue(q, i, SBQ_STATUS);
+		}
+	}
+}
+
+static void SBQ_Shutdown (sbq_t *q)
+{
+	Q_free(q->hosts);
+	Q_free(q->hash);
+}
+
+//
+// udp transport
+//
+
+static double SBQ_UDP_Time (void *ctx)
+{
+	return Sys_DoubleTime();
+}
+
+static int SBQ_UDP_Send (void *ctx, const netadr_t *to, const char *data, int len)
+{
+	struct sockaddr_storage dest;
+	int ret;
+
+	NetadrToSockadr(to, &dest);
+
+	ret = sendto(*(socket_t *) ctx, data, len, 0, (struct sockaddr *) &dest, sizeof(struct sockaddr_in));
+	if (ret < 0)
+		Com_DPrintf("sendto() gave errno = %d : %s\n", qerrno, strerror(qerrno));
+
+	return ret;
+}
+
+static int SBQ_UDP_Recv (void *ctx, netadr_t *from, char *buf, int size)
+{
+	struct sockaddr_storage addr;
+	socklen_t addrlen = sizeof(addr);
+	int ret;
+
+	ret = recvfrom(*(socket_t *) ctx, buf, size, 0, (struct sockaddr *) &addr, &addrlen);
+	if (ret > 0)
+		SockadrToNetadr(&addr, from);
+
+	return ret;
+}
+
+static void SBQ_UDP_Wait (void *ctx, double seconds)
+{
+	socket_t sock = *(socket_t *) ctx;
+	struct timeval timeout;
+	fd_set fd;
+
+	FD_ZERO(&fd);
+	FD_SET(sock, &fd);
+	timeout.tv_sec = 0;
+	timeout.tv_usec = (long) (seconds * 1000000);
+
+	select(sock + 1, &fd, NULL, NULL, &timeout);
+}
+
+//
+// Pings the servers if asked to, then gets the status of the ones worth it.
+// Blocks until every server answered or ran out of tries, so run it from a thread.
+//
+void SB_Query_Servers (server_data *servs[], int servsn, qbool pings, qbool infos)
+{
+	sbq_transport_t net = { SBQ_UDP_Time, SBQ_UDP_Send, SBQ_UDP_Recv, SBQ_UDP_Wait, NULL };
+	socket_t sock;
+	sbq_t q;
+
+	if (servsn <= 0)
+		return;
+
+	if ((sock = UDP_OpenSocket(PORT_ANY)) == INVALID_SOCKET)
+	{
+		Com_Printf("SB_Query_Servers: couldn't open socket\n");
+		return;
+	}
+	net.ctx = &sock;
+
+	ping_phase = pings ? 1 : 2;
+
+	SBQ_Init(&q, &net, servs, servsn, pings, infos, sb_pingspersec.value, sb_infospersec.value);
+	q.live = true;
+	SBQ_Run(&q);
+
+	Com_DPrintf("sb: %d servers, %d/%d pings, %d/%d infos answered, %d stray\n", q.hostsn,
+		q.stats.received[SBQ_PING], q.stats.sent[SBQ_PING],
+		q.stats.received[SBQ_STATUS], q.stats.sent[SBQ_STATUS], q.stats.stray);
+
+	SBQ_Shutdown(&q);
+	closesocket(sock);
+}
+
+//
+// simulated network for the benchmark
+//
+// Fake servers live at 10.x.y.z:27500, each with its own latency. Time is virtual,
+// waiting jumps straight to the next delivery, so a refresh paced to take minutes at
+// the configured rates is simulated in well under a second of real time.
+//
+
+typedef struct sbq_sim_packet_s {
+	double			time;
+	int				server;
+	qbool			status;
+} sbq_sim_packet_t;
+
+typedef struct sbq_sim_s {
+	double			time;
+	sbq_sim_packet_t *heap;			// replies on their way, earliest first
+	int				heapn, heapmax;
+	int				serversn;
+	int				loss;			// percent, applied each way
+	unsigned int	seed;
+} sbq_sim_t;
+
+static unsigned int SBQ_Sim_Rand (sbq_sim_t *sim)
+{
+	sim->seed = sim->seed * 1103515245 + 12345;
+	return (sim->seed >> 16) & 0x7fff;
+}
+
+static double SBQ_Sim_Latency (int server)
+{
+	return (20 + (server * 2654435761u >> 8) % 180) / 1000.0;
+}
+
+static netadr_t SBQ_Sim_Adr (int server)
+{
+	netadr_t a;
+
+	memset(&a, 0, sizeof(a));
+	a.type = NA_IP;
+	a.ip[0] = 10;
+	a.ip[1] = (server >> 16) & 0xff;
+	a.ip[2] = (server >> 8) & 0xff;
+	a.ip[3] = server & 0xff;
+	a.port = htons(27500);
+
+	return a;
+}
+
+static void SBQ_Sim_Push (sbq_sim_t *sim, const sbq_sim_packet_t *p)
+{
+	sbq_sim_packet_t tmp;
+	int i, parent;
+
+	if (sim->heapn == sim->heapmax)
+	{
+		sim->heapmax = max(256, sim->heapmax * 2);
+		sim->heap = (sbq_sim_packet_t *) Q_realloc(sim->heap, sim->heapmax * sizeof(*sim->heap));
+	}
+
+	i = sim->heapn++;
+	sim->heap[i] = *p;
+
+	for ( ; i > 0; i = parent)
+	{
+		parent = (i - 1) / 2;
+		if (sim->heap[parent].time <= sim->heap[i].time)
+			break;
+		tmp = sim->heap[parent];
+		sim->heap[parent] = sim->heap[i];
+		sim->heap[i] = tmp;
+	}
+}
+
+static void SBQ_Sim_Pop (sbq_sim_t *sim)
+{
+	sbq_sim_packet_t tmp;
+	int i, child;
+
+	sim->heap[0] = sim->heap[--sim->heapn];
+
+	for (i = 0; (child = 2 * i + 1) < sim->heapn; i = child)
+	{
+		if (child + 1 < sim->heapn && sim->heap[child + 1].time < sim->heap[child].time)
+			child++;
+		if (sim->heap[i].time <= sim->heap[child].time)
+			break;
+		tmp = sim->heap[i];
+		sim->heap[i] = sim->heap[child];
+		sim->heap[child] = tmp;
+	}
+}
+
+static double SBQ_Sim_Time (void *ctx)
+{
+	return ((sbq_sim_t *) ctx)->time;
+}
+
+static int SBQ_Sim_Send (void *ctx, const netadr_t *to, const char *data, int len)
+{
+	sbq_sim_t *sim = (sbq_sim_t *) ctx;
+	sbq_sim_packet_t p;
+	int server = (to->ip[1] << 16) | (to->ip[2] << 8) | to->ip[3];
+
+	if (server >= sim->serversn)
+		return len;
+
+	// lost either on the way there or on the way back
+	if ((int) (SBQ_Sim_Rand(sim) % 100) < sim->loss || (int) (SBQ_Sim_Rand(sim) % 100) < sim->loss)
+		return len;
+
+	p.server = server;
+	p.status = (len > 5 && data[4] == 's');
+	p.time = sim->time + SBQ_Sim_Latency(server) + (SBQ_Sim_Rand(sim) % 10) / 1000.0;
+	SBQ_Sim_Push(sim, &p);
+
+	return len;
+}
+
+static int SBQ_Sim_Recv (void *ctx, netadr_t *from, char *buf, int size)
+{
+	sbq_sim_t *sim = (sbq_sim_t *) ctx;
+	sbq_sim_packet_t p;
+	int i, len;
+
+	if (!sim->heapn || sim->heap[0].time > sim->time)
+		return 0;
+
+	p = sim->heap[0];
+	SBQ_Sim_Pop(sim);
+
+	*from = SBQ_Sim_Adr(p.server);
+
+	if (!p.status)
+	{
+		buf[0] = 'l';
+		return 1;
+	}
+
+	len = snprintf(buf, size, "\xff\xff\xff\xffn\\hostname\\fake server %d\\map\\dm%d\\maxclients\\16"
+		"\\maxspectators\\8\\deathmatch\\1\\teamplay\\2\\timelimit\\20\\fraglimit\\0\\*version\\MVDSV 0.36\n",
+		p.server, 1 + p.server % 6);
+
+	for (i = 0; i < p.server % 9 && len < size; i++)
+	{
+		len += snprintf(buf + len, size - len, "%d %d %d %d \"player%d\" \"base\" %d %d \"%s\"\n",
+			i + 1, 10 * i, 5, 20 + i, i, i % 14, (i & 1) ? 13 : 4, (i & 1) ? "blue" : "red");
+	}
+
+	return min(len, size - 1);
+}
+
+static void SBQ_Sim_Wait (void *ctx, double seconds)
+{
+	sbq_sim_t *sim = (sbq_sim_t *) ctx;
+
+	if (sim->heapn && sim->heap[0].time < sim->time + seconds)
+		sim->time = max(sim->time, sim->heap[0].time);
+	else
+		sim->time += seconds;
+}
+
+//
+// Refreshes a list of simulated servers through the real engine and reports how long it took.
+//
+void SB_Query_Bench_f (void)
+{
+	sbq_transport_t net = { SBQ_Sim_Time, SBQ_Sim_Send, SBQ_Sim_Recv, SBQ_Sim_Wait, NULL };
+	double pingspersec, infospersec, cpu;
+	server_data **servs;
+	int i, count, answered;
+	sbq_sim_t sim;
+	sbq_t q;
+
+	if (Cmd_Argc() > 5)
+	{
+		Com_Printf("Usage: %s [servers] [loss%%] [pingspersec] [infospersec]\n", Cmd_Argv(0));
+		return;
+	}
+
+	count = Cmd_Argc() > 1 ? bound(1, Q_atoi(Cmd_Argv(1)), 1 << 24) : 5000;
+	pingspersec = Cmd_Argc() > 3 ? Q_atof(Cmd_Argv(3)) : sb_pingspersec.value;
+	infospersec = Cmd_Argc() > 4 ? Q_atof(Cmd_Argv(4)) : sb_infospersec.value;
+
+	memset(&sim, 0, sizeof(sim));
+	sim.serversn = count;
+	sim.loss = Cmd_Argc() > 2 ? bound(0, Q_atoi(Cmd_Argv(2)), 100) : 2;
+	sim.seed = 1;
+	net.ctx = &sim;
+
+	servs = (server_data **) Q_malloc(count * sizeof(*servs));
+	for (i = 0; i < count; i++)
+		servs[i] = Create_Server2(SBQ_Sim_Adr(i));
+
+	cpu = Sys_DoubleTime();
+	SBQ_Init(&q, &net, servs, count, true, true, pingspersec, infospersec);
+	SBQ_Run(&q);
+	cpu = Sys_DoubleTime() - cpu;
+
+	for (i = 0, answered = 0; i < count; i++)
+	{
+		if (servs[i]->keysn > 0)
+			answered++;
+		Delete_Server(servs[i]);
+	}
+
+	Com_Printf("%d servers, %d%% loss, %.0f pings/s, %.0f infos/s\n", count, sim.loss, q.bucket[SBQ_PING].rate, q.bucket[SBQ_STATUS].rate);
+	Com_Printf("refresh took %.2f s, %d servers listed\n", sim.time - q.start, answered);
+	Com_Printf("pings: %d sent, %d answered, %d timed out\n", q.stats.sent[SBQ_PING], q.stats.received[SBQ_PING], q.stats.timeouts[SBQ_PING]);
+	Com_Printf("infos: %d sent, %d answered, %d timed out\n", q.stats.sent[SBQ_STATUS], q.stats.received[SBQ_STATUS], q.stats.timeouts[SBQ_STATUS]);
+	Com_Printf("engine cpu time %.3f s (%.2f us per packet)\n", cpu,
+		cpu * 1e6 / max(1, q.stats.sent[SBQ_PING] + q.stats.sent[SBQ_STATUS] + q.stats.received[SBQ_PING] + q.stats.received[SBQ_STATUS]));
+
+	SBQ_Shutdown(&q);
+	Q_free(servs);
+	Q_free(sim.heap);
+}
@@ -97,7 +97,7 @@ qbool Update_Source_From_File(source_data *s, char *fname, server_data **servers
 	f = FS_OpenVFS(fname, "rb", FS_ANY);
 
     if (f) {
-		while (VFS_GETS(f, line, sizeof(line)))
+		while (*pserversn < MAX_SERVERS && VFS_GETS(f, line, sizeof(line)))
 		{
 			netadr_t addr;
 
@@ -157,7 +157,7 @@ static void Precache_Source(source_data *s)
 {
     int i;
     char name[1024];
-    server_data *servers[MAX_SERVERS];
+    server_data **servers;
     int serversn = 0;
 
 	if (s->type == type_url) {
@@ -179,6 +179,8 @@ static void Precache_Source(source_data *s)
 		return;
 	}
 
+	// too big for the stack of the thread this may run on
+	servers = (server_data **) Q_malloc(MAX_SERVERS * sizeof(server_data *));
 	Update_Source_From_File(s, name, servers, &serversn);
 
 	if (serversn > 0)
@@ -202,6 +204,8 @@ static void Precache_Source(source_data *s)
 			memcpy(&s->last_update, &tm, sizeof(SYSTEMTIME));
 		}
 	}
+
+	Q_free(servers);
 }
 
 static void SB_Process_URL_Buffer(const struct curl_buf *curl_buf, server_data *servers[], int *serversn)
@@ -214,7 +218,7 @@ static void SB_Process_URL_Buffer(const struct curl_buf *curl_buf, server_data *
 	memcpy(buf, curl_buf->ptr, sizeof(char) * curl_buf->len);
 
 	// Not using strtok as it's not thread safe
-	for (p0 = buf, p1 = buf; p1 < buf + curl_buf->len; p1++) {
+	for (p0 = buf, p1 = buf; p1 < buf + curl_buf->len && *serversn < MAX_SERVERS; p1++) {
 		if (*p1 == '\n') {
 			*p1 = '\0';
 			NET_StringToAdr(p0, &addr);
@@ -341,12 +345,15 @@ void Update_Source(source_data *s)
 {
 	int i;
 	qbool should_dump = false;
-	server_data *servers[MAX_SERVERS];
+	server_data **servers;
 	int serversn = 0;
 
 	if (s->type == type_dummy)
 		return;
 
+	// runs on the sources update thread, keep this off its stack
+	servers = (server_data **) Q_malloc(MAX_SERVERS * sizeof(server_data *));
+
 	if (s->type == type_file)
 	{
 		// read servers from file
@@ -386,8 +393,10 @@ void Update_Source(source_data *s)
 					(struct sockaddr *)&server, sizeof(server) );
 		}
 
-		if (ret < 0)
+		if (ret < 0) {
+			Q_free(servers);
 			return;
+		}
 
 		timeout = Sys_DoubleTime() + (sb_mastertimeout.value / 1000.0);
 		while (Sys_DoubleTime() < timeout) {
@@ -410,11 +419,12 @@ void Update_Source(source_data *s)
 				if (memcmp(answer, "\xff\xff\xff\xff\x64\x0a", 6))
 				{
 					closesocket(newsocket);
+					Q_free(servers);
 					return;
 				}
 
 				// create servers avoiding duplicates
-				for (i=6; i+5 < ret; i+=6)
+				for (i=6; i+5 < ret && serversn < MAX_SERVERS; i+=6)
 				{
 					char buf[32];
 					server_data* server;
@@ -476,6 +486,7 @@ void Update_Source(source_data *s)
 	}
 
 	SB_ServerList_Unlock();
+	Q_free(servers);
 	if (should_dump)
 		DumpSource(s);
 	//Com_Printf ("Updating %15.15s: %d servers\n", s->name, serversn);
@@ -508,6 +519,7 @@ int Update_Multiple_Sources_Proc(void * lpParameter)
     int total_masters = 0;
     int updated = 0;
     int d1, d2;
+    server_data **servers;
 
     GetLocalTime(&lt);
     d1 = lt.wSecond + 60*(lt.wMinute + 60*(lt.wHour + 24*(lt.wDay)));
@@ -535,10 +547,10 @@ int Update_Multiple_Sources_Proc(void * lpParameter)
 	
     // update master sources
     newsocket = UDP_OpenSocket(PORT_ANY);
+    servers = (server_data **) Q_malloc(MAX_SERVERS * sizeof(server_data *));
 
     for (sourcenum = 0; sourcenum < psourcesn  &&  !abort_ping; sourcenum++)
     {
-        server_data *servers[MAX_SERVERS];
         int serversn = 0;
         int trynum = 0;
         source_data *s = psources[sourcenum];
@@ -603,7 +615,7 @@ int Update_Multiple_Sources_Proc(void * lpParameter)
                     }
 
                     // create servers avoiding duplicates
-					for (i=6; i+5 < ret; i+=6)
+					for (i=6; i+5 < ret && serversn < MAX_SERVERS; i+=6)
 					{
 						char buf[32];
 						server_data* server;
@@ -659,6 +671,7 @@ int Update_Multiple_Sources_Proc(void * lpParameter)
     }
 
     closesocket(newsocket);
+    Q_free(servers);
 
 	// Not having this here leads to crash almost always when some
 	// other action with servers list happens right after this function.
@@ -984,16 +997,28 @@ void Reload_Sources(void)
 
 int rebuild_servers_list = 0;
 
+#define SERVERS_HASH_SIZE (MAX_SERVERS * 2) // power of two
+
+static unsigned int Servers_Hash(const netadr_t *a)
+{
+    unsigned int h = (a->ip[0] << 24) | (a->ip[1] << 16) | (a->ip[2] << 8) | a->ip[3];
+
+    return ((h ^ a->port) * 2654435761u) & (SERVERS_HASH_SIZE - 1);
+}
+
 void Rebuild_Servers_List(void)
 {
+    static int hash[SERVERS_HASH_SIZE]; // index into servers[] + 1, 0 is empty
     int i;
     int suppressed_servers = 0;
     int server_limit = sizeof(servers) / sizeof(servers[0]);
-    serversn = 0;
-	
+
     rebuild_servers_list = 0;
 	SB_ServerList_Lock();
 
+    serversn = 0;
+    memset(hash, 0, sizeof(hash));
+
     for (i=0; i < sourcesn; i++)
     {
         if (sources[i]->checked)
@@ -1001,15 +1026,16 @@ void Rebuild_Servers_List(void)
             int j;
             for (j=0; j < sources[i]->serversn; j++)
             {
-                int k;
+                server_data *s = sources[i]->servers[j];
+                unsigned int h;
                 qbool found_duplicate = false;
 
-				if (sources[i]->servers[j] == NULL)
+				if (s == NULL)
 					continue;
 
                 // Try and find a matching address
-                for (k = 0; k < serversn && k < server_limit; k++) {
-                    if (!memcmp(&(servers[k]->address), &(sources[i]->servers[j]->address), sizeof(netadr_t))) {
+                for (h = Servers_Hash(&s->address); hash[h]; h = (h + 1) & (SERVERS_HASH_SIZE - 1)) {
+                    if (!memcmp(&(servers[hash[h] - 1]->address), &(s->address), sizeof(netadr_t))) {
                         found_duplicate = true;
                         break;
                     }
@@ -1018,7 +1044,8 @@ void Rebuild_Servers_List(void)
                 if (! found_duplicate) {
                     // if not on list yet
                     if (serversn < server_limit) {
-                        servers[serversn++] = sources[i]->servers[j];
+                        servers[serversn++] = s;
+                        hash[h] = serversn;
                     }
                     else {
                         ++suppressed_servers;
@@ -1028,6 +1055,8 @@ void Rebuild_Servers_List(void)
         }
     }
 
+    SB_Index_Servers();
+
     resort_servers = 1;
     rebuild_all_players = 1;
     Servers_pos = 0;
@@ -358,12 +358,11 @@ void CL_Say_f (void) {
 
         len = bound(0, len, sizeof(c_fn));
 
-		// TP_ParseFunChars wants a string < 1024 chars (fix it?)
+		// TP_ParseFunChars takes any length and returns a copy from the frame arena
         strlcpy (c_fn, cl_fakename.string, sizeof(c_fn));
         strlcpy (c_fna, cl_fakename_suffix.string, sizeof(c_fna));
 		
-        // 1) save the message text, because TP_ParseFunChars will overwrite the temp memory
-        // 2) cut the leading quote (+1) and also the trailing quote (len is 1 char shorter)
+        // copy the message text without the leading quote (+1) and the trailing quote (len is 1 char shorter)
         strlcpy (c_msg, s+1, len);
 
 		snprintf (msg, sizeof(msg), "\x0d%s%s", TP_ParseFunChars(strcat(c_fn, c_fna), true), c_msg);
@@ -715,6 +714,95 @@ void CL_Users_f (void) {
 	Com_Printf ("%i total users\n", c);
 }
 
+// Times the info lookups a scoreboard frame does, walking the strings against the hashed mirrors.
+// Uses the players of the running game or demo (a 32 player mvd is the case to look at),
+// or makes up a full server when there is nobody around.
+void CL_InfoBench_f (void) {
+	static char *player_keys[] = { "name", "team", "skin", "topcolor", "bottomcolor", "*spectator", "chat" };
+	static char *server_keys[] = { "teamplay", "deathmatch", "status", "timelimit", "fraglimit", "*qvm" };
+	static char userinfo[MAX_CLIENTS][MAX_INFO_STRING], serverinfo[MAX_SERVERINFO_STRING];
+	static ctxinfo_t user_ctx[MAX_CLIENTS], server_ctx;
+	int i, j, k, frames, numplayers = 0, lookups;
+	char buf[MAX_INFO_STRING];
+	unsigned int sink = 0;
+	double start, string_time, hash_time, cached_time, rebuilt_time;
+
+	frames = (Cmd_Argc() > 1) ? max (1, Q_atoi (Cmd_Argv(1))) : 1000;
+
+	for (i = 0; i < MAX_CLIENTS; i++) {
+		if (cl.players[i].name[0] && cl.players[i].userinfo[0])
+			strlcpy (userinfo[numplayers++], cl.players[i].userinfo, sizeof (userinfo[0]));
+	}
+
+	if (!numplayers) {
+		for (numplayers = 0; numplayers < 32; numplayers++) {
+			snprintf (userinfo[numplayers], sizeof (userinfo[0]),
+				"\\*client\\ezQuake 7000\\rate\\25000\\msg\\1\\w_switch\\2\\b_switch\\2\\chat\\0"
+				"\\team\\%s\\skin\\base\\topcolor\\%d\\bottomcolor\\%d\\*spectator\\%d\\name\\player%02d",
+				(numplayers & 1) ? "blue" : "red", numplayers % 14, (numplayers & 1) ? 13 : 4,
+				numplayers >= 16, numplayers);
+		}
+	}
+
+	if (cl.serverinfo[0])
+		strlcpy (serverinfo, cl.serverinfo, sizeof (serverinfo));
+	else
+		strlcpy (serverinfo, "\\maxfps\\77\\pm_ktjump\\1\\*version\\MVDSV 0.36\\*z_ext\\511\\*admin\\admin"
+			"\\ktxver\\1.42\\maxspectators\\12\\hostname\\bench\\deathmatch\\1\\teamplay\\2"
+			"\\timelimit\\20\\fraglimit\\0\\status\\Countdown\\*qvm\\so\\map\\dm3", sizeof (serverinfo));
+
+	for (i = 0; i < numplayers; i++)
+		Info_Mirror (&user_ctx[i], userinfo[i]);
+	Info_Mirror (&server_ctx, serverinfo);
+
+	start = Sys_DoubleTime ();
+	for (k = 0; k < frames; k++) {
+		for (i = 0; i < numplayers; i++)
+			for (j = 0; j < sizeof (player_keys) / sizeof (player_keys[0]); j++)
+				sink += Info_ValueForKey (userinfo[i], player_keys[j])[0];
+		for (j = 0; j < sizeof (server_keys) / sizeof (server_keys[0]); j++)
+			sink += Info_ValueForKey (serverinfo, server_keys[j])[0];
+	}
+	string_time = Sys_DoubleTime () - start;
+
+	start = Sys_DoubleTime ();
+	for (k = 0; k < frames; k++) {
+		for (i = 0; i < numplayers; i++)
+			for (j = 0; j < sizeof (player_keys) / sizeof (player_keys[0]); j++)
+				sink += Info_Get (&user_ctx[i], player_keys[j])[0];
+		for (j = 0; j < sizeof (server_keys) / sizeof (server_keys[0]); j++)
+			sink += Info_Get (&server_ctx, server_keys[j])[0];
+	}
+	hash_time = Sys_DoubleTime () - start;
+
+	// serialisation, unchanged against changed every time
+	start = Sys_DoubleTime ();
+	for (k = 0; k < frames; k++)
+		for (i = 0; i < numplayers; i++)
+			sink += Info_ReverseConvert (&user_ctx[i], buf, sizeof (buf));
+	cached_time = Sys_DoubleTime () - start;
+
+	start = Sys_DoubleTime ();
+	for (k = 0; k < frames; k++) {
+		for (i = 0; i < numplayers; i++) {
+			user_ctx[i].serialized_valid = false;
+			sink += Info_ReverseConvert (&user_ctx[i], buf, sizeof (buf));
+		}
+	}
+	rebuilt_time = Sys_DoubleTime () - start;
+
+	lookups = frames * (numplayers * sizeof (player_keys) / sizeof (player_keys[0]) + sizeof (server_keys) / sizeof (server_keys[0]));
+	Com_Printf ("%d players, %d frames (%u)\n", numplayers, frames, sink & 1);
+	Com_Printf ("scoreboard lookups: string %.3f ms, hashed %.3f ms per frame (%.1f / %.1f ns per lookup)\n",
+		string_time * 1000 / frames, hash_time * 1000 / frames, string_time * 1e9 / lookups, hash_time * 1e9 / lookups);
+	Com_Printf ("userinfo serialise: cached %.1f ns, rebuilt %.1f ns\n",
+		cached_time * 1e9 / (frames * numplayers), rebuilt_time * 1e9 / (frames * numplayers));
+
+	for (i = 0; i < numplayers; i++)
+		Info_RemoveAll (&user_ctx[i]);
+	Info_RemoveAll (&server_ctx);
+}
+
 void CL_Color_f (void) {
 	extern cvar_t topcolor, bottomcolor;
 	int top, bottom;
@@ -926,6 +1014,7 @@ void CL_InitCommands (void) {
 	Cmd_AddCommand ("showskins", Skin_ShowSkins_f);
 	Cmd_AddCommand ("user", CL_User_f);
 	Cmd_AddCommand ("users", CL_Users_f);
+	Cmd_AddCommand ("infobench", CL_InfoBench_f);
 	Cmd_AddCommand ("version", CL_Version_f);
 
 	// client info setting
@@ -1011,8 +1100,9 @@ void CL_FullServerinfo_f (void) {
 		return;
 
 	strlcpy (cl.serverinfo, Cmd_Argv(1), sizeof(cl.serverinfo));
+	Info_Mirror(&cl._serverinfo_ctx_, cl.serverinfo);
 
-	p = Info_ValueForKey (cl.serverinfo, "*cheats");
+	p = Info_Get(&cl._serverinfo_ctx_, "*cheats");
 	if (*p)
 		Com_Printf ("== Cheats are enabled ==\n");
 
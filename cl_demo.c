@@ -933,6 +933,14 @@ void CL_WriteMVDStartupData(void)
 	}
 	#endif // PROTOCOL_VERSION_FTE2
 
+	#ifdef PROTOCOL_VERSION_MVD1
+	if (cls.mvdprotocolextensions1)
+	{
+		MSG_WriteLong (&buf, PROTOCOL_VERSION_MVD1);
+		MSG_WriteLong (&buf, cls.mvdprotocolextensions1);
+	}
+	#endif // PROTOCOL_VERSION_MVD1
+
 	MSG_WriteLong (&buf, PROTOCOL_VERSION);
 	MSG_WriteLong (&buf, cl.servercount);
 
@@ -1255,8 +1263,9 @@ void CL_WriteMVDStartupData(void)
 	for (i = 0; i < MAX_CLIENTS; i++)
 	{
 		vec3_t origin, angles;
-		int j, flags;
+		int j, flags, back;
 		player_state_t *state;
+		mvd_predict_t predict;
 
 		player = cl.players + i;
 
@@ -1278,31 +1287,54 @@ void CL_WriteMVDStartupData(void)
 		VectorCopy(state->origin, origin);
 		VectorCopy(state->viewangles, angles);
 
-		MSG_WriteByte (&buf, svc_playerinfo);
-		MSG_WriteByte (&buf, i);
-		MSG_WriteShort (&buf, flags);
+		// The stream goes on predicting players from what has been read so far,
+		// so the demo has to leave its reader with the same history: the older
+		// origin first if there is one, then the last.
+		back = 0;
+		if (cls.mvdprotocolextensions1 & MVD_PEXT1_PREDICTEDPLAYERS)
+		{
+			flags |= DF_PREDICTRESET;
+			back = max (cl_mvdpredict[i].history - 1, 0);
+		}
 
-		MSG_WriteByte (&buf, state->frame);
+		for ( ; back >= 0; back--)
+		{
+			MSG_WriteByte (&buf, svc_playerinfo);
+			MSG_WriteByte (&buf, i);
+			MSG_WriteShort (&buf, flags);
 
-		for (j = 0 ; j < 3 ; j++)
-			if (flags & (DF_ORIGIN << j))
-				MSG_WriteCoord (&buf, origin[j]);
+			MSG_WriteByte (&buf, state->frame);
 
-		for (j = 0 ; j < 3 ; j++)
-			if (flags & (DF_ANGLES << j))
-				MSG_WriteAngle16 (&buf, angles[j]);
+			if (cls.mvdprotocolextensions1 & MVD_PEXT1_PREDICTEDPLAYERS)
+			{
+				if (cl_mvdpredict[i].history)
+					MSG_PredictHistory (&cl_mvdpredict[i], back, origin, angles);
+				MSG_WritePredicted (&buf, &predict, flags, origin, angles);
+				flags &= ~DF_PREDICTRESET;
+			}
+			else
+			{
+				for (j = 0 ; j < 3 ; j++)
+					if (flags & (DF_ORIGIN << j))
+						MSG_WriteCoord (&buf, origin[j]);
 
-		if (flags & DF_MODEL)
-			MSG_WriteByte (&buf, state->modelindex);
+				for (j = 0 ; j < 3 ; j++)
+					if (flags & (DF_ANGLES << j))
+						MSG_WriteAngle16 (&buf, angles[j]);
+			}
 
-		if (flags & DF_SKINNUM)
-			MSG_WriteByte (&buf, state->skinnum);
+			if (flags & DF_MODEL)
+				MSG_WriteByte (&buf, state->modelindex);
 
-		if (flags & DF_EFFECTS)
-			MSG_WriteByte (&buf, state->effects);
+			if (flags & DF_SKINNUM)
+				MSG_WriteByte (&buf, state->skinnum);
 
-		if (flags & DF_WEAPONFRAME)
-			MSG_WriteByte (&buf, state->weaponframe);
+			if (flags & DF_EFFECTS)
+				MSG_WriteByte (&buf, state->effects);
+
+			if (flags & DF_WEAPONFRAME)
+				MSG_WriteByte (&buf, state->weaponframe);
+		}
 
 		if (buf.cursize > MAX_MSGLEN/2)
 		{
@@ -3018,54 +3050,12 @@ static int CL_GetUnpackedDemoPath (char *play_path, char *unpacked_path, int unp
 {
 	//
 	// Check if the demo is in a zip file and if so, try to extract it before playing.
+	// GZipped demos are not unpacked to a file, CL_Play_f inflates them into memory.
 	//
 	int retval = 0;
 	char archive_path[MAX_PATH];
 	char inzip_path[MAX_PATH];
 
-	//
-	// Is it a GZip file?
-	//
-	if (!strcmp (COM_FileExtension (play_path), "gz"))
-	{
-		int i = 0;
-		int ext_len = 0;
-		char ext[5];
-
-		//
-		// Find the extension with .gz removed.
-		//
-		{
-			for (i = strlen(play_path) - 4; i > 0; i--)
-			{
-				if (play_path[i] == '.' || ext_len >= 4)
-				{
-					break;
-				}
-
-				ext_len++;
-			}
-
-			if (ext_len <= 4)
-			{
-				strlcpy (ext, play_path + strlen(play_path) - 4 - ext_len, sizeof(ext));
-			}
-			else
-			{
-				// Default to MVD.
-				strlcpy (ext, ".mvd", sizeof(ext));
-			}
-		}
-
-		// Unpack the file.
-		if (!FS_GZipUnpackToTemp (play_path, unpacked_path, unpacked_path_size, ext))
-		{
-			return 0;
-		}
-
-		return 1;
-	}
-
 	//
 	// Check if the path is in the format "c:\quake\bla\demo.zip\some_demo.mvd" and split it up.
 	//
@@ -3542,6 +3532,7 @@ void CL_Play_f (void)
 	char *real_name;
 	char name[MAX_OSPATH], **s;
 	static char *ext[] = {"qwd", "mvd", "dem", NULL};
+	qbool in_memory = false;
 
 	// Show usage.
 	if (Cmd_Argc() != 2)
@@ -3598,6 +3589,23 @@ void CL_Play_f (void)
 	#endif // WIN32
 
 	#ifndef WITH_VFS_ARCHIVE_LOADING
+	#ifdef WITH_ZLIB
+	if (!strcasecmp(COM_FileExtension(name), "gz"))
+	{
+		//
+		// Inflate gzipped demos straight into memory, they are read into memory anyway.
+		//
+		if ((playbackfile = CL_Open_Demo_File(name, true, NULL)))
+		{
+			playbackfile = FS_GZipUnpackToMemory(playbackfile);
+			in_memory = true;
+		}
+
+		// Play it as the demo it was before it was compressed.
+		COM_StripExtension(name, name, sizeof(name));
+	}
+	else
+	#endif // WITH_ZLIB
 	{
 		//
 		// Find the demo path, trying different extensions if needed.
@@ -3663,7 +3671,7 @@ void CL_Play_f (void)
 	#endif // WITH_VFS_ARCHIVE_LOADING else
 
 	// Read the file completely into memory
-	if (playbackfile) 
+	if (playbackfile && !in_memory) 
 	{
 		size_t len;
 		void *buf;
@@ -26,6 +26,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 
 static int MVD_TranslateFlags(int src);
+static void CL_MVDPredictStats_f (void);
 void TP_ParsePlayerInfo(player_state_t *, player_state_t *, player_info_t *info);	
 
 extern cvar_t cl_predict_players, cl_solid_players, cl_rocket2grenade;
@@ -35,6 +36,10 @@ extern cvar_t cl_nolerp, cl_lerp_monsters, cl_newlerp;
 extern cvar_t r_drawvweps;		
 extern  unsigned int     cl_dlight_active[MAX_DLIGHTS/32];       
 
+static entity_t *cl_sortbuffer;
+static unsigned *cl_sortkeys;
+static int *cl_sortorder;
+
 static struct predicted_player {
 	int flags;
 	qbool active;
@@ -48,6 +53,22 @@ static struct predicted_player {
 
 } predicted_players[MAX_CLIENTS];
 
+mvd_predict_t cl_mvdpredict[MAX_CLIENTS];
+
+// demo_predictstats: what the player origins and angles of the mvd being played
+// cost as plain fields and as MVD_PEXT1_PREDICTEDPLAYERS, however it was recorded,
+// and the same summed over every mvd played since the last reset
+static struct {
+	mvd_predict_t	predict[MAX_CLIENTS];
+	vec3_t			origin[MAX_CLIENTS];
+	vec3_t			angles[MAX_CLIENTS];
+	int				plain;
+	int				predicted;
+	double			start, end;
+	int				demos;
+	double			total_plain, total_predicted, total_time;
+} mvd_predictstats;
+
 char *cl_modelnames[cl_num_modelindices];
 int cl_modelindices[cl_num_modelindices];
 model_t *cl_flame0_model;
@@ -155,7 +176,14 @@ void CL_InitEnts(void) {
 	cl_visents.list = (entity_t *) memalloc + cl_firstpassents.max;
 	cl_alphaents.list = (entity_t *) memalloc + cl_firstpassents.max + cl_visents.max;
 
+	// scratch space for CL_SortEntities, two key and index buffers to ping-pong between
+	cl_sortbuffer = (entity_t *) Hunk_AllocName(cl_visents.max * sizeof(entity_t), "visents");
+	cl_sortkeys = (unsigned *) Hunk_AllocName(2 * cl_visents.max * sizeof(unsigned), "visents");
+	cl_sortorder = (int *) Hunk_AllocName(2 * cl_visents.max * sizeof(int), "visents");
+
 	CL_ClearScene();
+
+	Cmd_AddCommand ("demo_predictstats", CL_MVDPredictStats_f);
 }
 
 static qbool is_monster (int modelindex)
@@ -1279,6 +1307,108 @@ static int MVD_WeaponModelNumber (int cweapon)
 	return 0;
 }
 
+// Adds what the last demo (or map of it) cost to the totals.
+static void CL_MVDPredictStatsFinish (void)
+{
+	if (mvd_predictstats.end > mvd_predictstats.start)
+	{
+		mvd_predictstats.demos++;
+		mvd_predictstats.total_plain += mvd_predictstats.plain;
+		mvd_predictstats.total_predicted += mvd_predictstats.predicted;
+		mvd_predictstats.total_time += mvd_predictstats.end - mvd_predictstats.start;
+	}
+
+	mvd_predictstats.start = mvd_predictstats.end = 0;
+	mvd_predictstats.plain = mvd_predictstats.predicted = 0;
+	memset (mvd_predictstats.origin, 0, sizeof (mvd_predictstats.origin));
+	memset (mvd_predictstats.angles, 0, sizeof (mvd_predictstats.angles));
+}
+
+// A new serverdata, writers start over as well.
+void CL_MVDPredictReset (void)
+{
+	int i;
+
+	CL_MVDPredictStatsFinish ();
+
+	for (i = 0; i < MAX_CLIENTS; i++)
+	{
+		MSG_PredictReset (&cl_mvdpredict[i]);
+		MSG_PredictReset (&mvd_predictstats.predict[i]);
+	}
+}
+
+static void CL_MVDPredictStatsAdd (int num, const vec3_t origin, const vec3_t angles)
+{
+	byte buf_data[32];
+	sizebuf_t buf;
+	int i;
+
+	// predicted coding is only used for 1/8 unit coords, see SV_MVD_Record
+	if (msg_coordsize != 2)
+		return;
+
+	// the demo was restarted or rewound
+	if (cls.demotime < mvd_predictstats.end)
+		mvd_predictstats.start = mvd_predictstats.plain = mvd_predictstats.predicted = 0;
+
+	if (!mvd_predictstats.start)
+		mvd_predictstats.start = cls.demotime;
+	mvd_predictstats.end = cls.demotime;
+
+	// like SV_MVDWritePacketsEx without the extension
+	for (i = 0; i < 3; i++)
+	{
+		if (origin[i] != mvd_predictstats.origin[num][i])
+			mvd_predictstats.plain += msg_coordsize;
+		if (angles[i] != mvd_predictstats.angles[num][i])
+			mvd_predictstats.plain += 2;
+	}
+	VectorCopy (origin, mvd_predictstats.origin[num]);
+	VectorCopy (angles, mvd_predictstats.angles[num]);
+
+	SZ_Init (&buf, buf_data, sizeof (buf_data));
+	MSG_WritePredicted (&buf, &mvd_predictstats.predict[num], MSG_PredictFlags (&mvd_predictstats.predict[num], origin, angles), origin, angles);
+	mvd_predictstats.predicted += buf.cursize;
+}
+
+static void CL_MVDPredictStats_Print (const char *what, double time, double plain, double predicted)
+{
+	Com_Printf ("player origins and angles over %.0f seconds of %s:\n", time, what);
+	Com_Printf ("plain fields %8.0f bytes/s\n", plain / time);
+	Com_Printf ("predicted    %8.0f bytes/s, %.0f%% of plain\n", predicted / time, 100.0 * predicted / max (plain, 1));
+}
+
+static void CL_MVDPredictStats_f (void)
+{
+	double time = mvd_predictstats.end - mvd_predictstats.start;
+	int demos = mvd_predictstats.demos + (time > 0);
+
+	if (Cmd_Argc() > 1 && !strcmp (Cmd_Argv(1), "reset"))
+	{
+		mvd_predictstats.demos = 0;
+		mvd_predictstats.total_plain = mvd_predictstats.total_predicted = mvd_predictstats.total_time = 0;
+		mvd_predictstats.start = mvd_predictstats.end = 0;
+		mvd_predictstats.plain = mvd_predictstats.predicted = 0;
+		return;
+	}
+
+	if (!demos)
+	{
+		Com_Printf ("%s: play an mvd first\n", Cmd_Argv(0));
+		return;
+	}
+
+	if (time > 0)
+		CL_MVDPredictStats_Print ("this demo", time, mvd_predictstats.plain, mvd_predictstats.predicted);
+
+	if (demos > 1)
+	{
+		CL_MVDPredictStats_Print (va ("%d demos", demos), mvd_predictstats.total_time + max (time, 0),
+			mvd_predictstats.total_plain + mvd_predictstats.plain, mvd_predictstats.total_predicted + mvd_predictstats.predicted);
+	}
+}
+
 void CL_ParsePlayerinfo (void) 
 {
 	extern cvar_t cl_fix_mvd;
@@ -1334,19 +1464,28 @@ void CL_ParsePlayerinfo (void)
 		state->state_time = parsecounttime;
 		state->command.msec = 0;
 
-		for (i = 0; i < 3; i++) 
+		if (cls.mvdprotocolextensions1 & MVD_PEXT1_PREDICTEDPLAYERS)
 		{
-			if (flags & (DF_ORIGIN << i)) {
-				state->origin[i] = MSG_ReadCoord();
-			}
+			MSG_ReadPredicted (&cl_mvdpredict[num], flags, state->origin, state->command.angles);
 		}
-
-		for (i = 0; i < 3; i++) 
+		else
 		{
-			if (flags & (DF_ANGLES << i))
-				state->command.angles[i] = MSG_ReadAngle16 ();
+			for (i = 0; i < 3; i++) 
+			{
+				if (flags & (DF_ORIGIN << i)) {
+					state->origin[i] = MSG_ReadCoord();
+				}
+			}
+
+			for (i = 0; i < 3; i++) 
+			{
+				if (flags & (DF_ANGLES << i))
+					state->command.angles[i] = MSG_ReadAngle16 ();
+			}
 		}
 
+		CL_MVDPredictStatsAdd (num, state->origin, state->command.angles);
+
 		if (flags & DF_MODEL)
 			state->modelindex = MSG_ReadByte ();
 		else // check for possible bug in mvd/qtv
@@ -2085,52 +2224,67 @@ void CL_SetSolidPlayers (int playernum)
 	}
 }
 
-static float VectorDistance(const vec3_t x, const vec3_t y)
+// Alpha entities go after the opaque ones, furthest first. Squared distances are positive floats,
+// whose bit patterns order like unsigned ints, so inverting them gives furthest first keys and opaque
+// entities get key 0. The LSD radix sort is stable, opaque entities keep the order they were emitted in.
+static void CL_SortEntities(void)
 {
-	vec3_t diff = { x[0] - y[0], x[1] - y[1], x[2] - y[2] };
+	unsigned *keys[2] = { cl_sortkeys, cl_sortkeys + cl_visents.max };
+	int *order[2] = { cl_sortorder, cl_sortorder + cl_visents.max };
+	int histogram[256];
+	int i, b, pos, shift, src = 0, count = cl_visents.count;
+	union { float f; unsigned u; } dist;
+	qbool sorted = true;
+	entity_t *ent;
+	float dx, dy, dz;
+
+	if (Cam_TrackNum() < 0 || !cl.racing || count < 2)
+		return;
 
-	return VectorLength(diff);
-}
+	for (i = 0, ent = cl_visents.list; i < count; i++, ent++) {
+		order[0][i] = i;
+		if (ent->alpha == 0 || ent->alpha == 1) {
+			keys[0][i] = 0;
+		} else {
+			dx = ent->origin[0] - cl.simorg[0];
+			dy = ent->origin[1] - cl.simorg[1];
+			dz = ent->origin[2] - cl.simorg[2];
+			dist.f = dx * dx + dy * dy + dz * dz;
+			keys[0][i] = ~dist.u;
+		}
+		if (i && keys[0][i] < keys[0][i - 1])
+			sorted = false;
+	}
 
-static int AlphaEntityComparer(const void* lhs_, const void* rhs_)
-{
-	const entity_t* lhs = (entity_t*)lhs_;
-	const entity_t* rhs = (entity_t*)rhs_;
+	if (sorted)
+		return;
 
-	float alpha_lhs = lhs->alpha == 0 ? 0 : 1 - lhs->alpha;
-	float alpha_rhs = rhs->alpha == 0 ? 0 : 1 - rhs->alpha;
+	for (shift = 0; shift < 32; shift += 8) {
+		memset(histogram, 0, sizeof(histogram));
+		for (i = 0; i < count; i++)
+			histogram[(keys[src][i] >> shift) & 255]++;
 
-	float distance_lhs;
-	float distance_rhs;
+		// every key has the same byte here
+		if (histogram[(keys[src][0] >> shift) & 255] == count)
+			continue;
 
-	// Try not to bother with distance calculation
-	if (alpha_lhs == alpha_rhs && alpha_lhs == 0) {
-		return 0;
-	}
-	if (alpha_lhs == 0) {
-		return -1;
-	}
-	if (alpha_rhs == 0) {
-		return 1;
-	}
+		for (b = 0, pos = 0; b < 256; b++) {
+			int n = histogram[b];
+			histogram[b] = pos;
+			pos += n;
+		}
 
-	// Furthest first
-	distance_lhs = VectorDistance(cl.simorg, lhs->origin);
-	distance_rhs = VectorDistance(cl.simorg, rhs->origin);
-	if (distance_lhs > distance_rhs) {
-		return -1;
-	}
-	else if (distance_lhs == distance_rhs) {
-		return 0;
+		for (i = 0; i < count; i++) {
+			pos = histogram[(keys[src][i] >> shift) & 255]++;
+			keys[!src][pos] = keys[src][i];
+			order[!src][pos] = order[src][i];
+		}
+		src = !src;
 	}
-	return 1;
-}
 
-static void CL_SortEntities(void)
-{
-	if (Cam_TrackNum() >= 0 && cl.racing) {
-		qsort(cl_visents.list, cl_visents.count, sizeof(cl_visents.list[0]), AlphaEntityComparer);
-	}
+	for (i = 0; i < count; i++)
+		cl_sortbuffer[i] = cl_visents.list[order[src][i]];
+	memcpy(cl_visents.list, cl_sortbuffer, count * sizeof(entity_t));
 }
 
 // Builds the visedicts array for cl.time
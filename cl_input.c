@@ -871,7 +871,7 @@ void CL_FinishMove(usercmd_t *cmd)
 	// shaman RFE 1030281 {
 	// KTPro's KFJump == impulse 156
 	// KTPro's KRJump == impulse 164
-	if ( *Info_ValueForKey(cl.serverinfo, "kmod") && (
+	if ( *Info_Get(&cl._serverinfo_ctx_, "kmod") && (
 		((in_impulse == 156) && (cl.fpd & FPD_LIMIT_YAW || allow_scripts.value < 2)) ||
 		((in_impulse == 164) && (cl.fpd & FPD_LIMIT_PITCH || allow_scripts.value == 0))
 		)
@@ -917,6 +917,57 @@ void CL_SendClientCommand(qbool reliable, char *format, ...)
 
 int cmdtime_msec = 0;
 
+// Input-to-packet latency. A move command carries whatever input was sampled
+// since the previous one was sent, so assuming input arrives evenly between
+// samples, its average latency is measured from the middle of that span.
+static struct {
+	double	sampled;	// last time the input devices were read
+	double	sent;		// sample time covered by the last command sent
+	double	total, worst, max;
+	int		count;
+} inputlatency;
+
+void CL_InputSampled(void)
+{
+	inputlatency.sampled = Sys_DoubleTime();
+}
+
+static void CL_InputLatency_Sent(void)
+{
+	double now = Sys_DoubleTime();
+
+	if (inputlatency.sampled <= inputlatency.sent) {
+		return; // nothing new in this command
+	}
+
+	// skip the first command after a stall (connecting, map change, alt-tab)
+	if (inputlatency.sent && now - inputlatency.sent < 1) {
+		inputlatency.total += now - (inputlatency.sent + inputlatency.sampled) / 2;
+		inputlatency.worst += now - inputlatency.sent;
+		inputlatency.max = max(inputlatency.max, now - inputlatency.sent);
+		inputlatency.count++;
+	}
+
+	inputlatency.sent = inputlatency.sampled;
+}
+
+static void CL_InputLatency_f(void)
+{
+	if (!inputlatency.count) {
+		Com_Printf("No move commands sent since the last report\n");
+		return;
+	}
+
+	Com_Printf("Input-to-packet latency over %d commands:\n", inputlatency.count);
+	Com_Printf("  average %.2f ms, worst case average %.2f ms, max %.2f ms\n",
+		inputlatency.total * 1000 / inputlatency.count,
+		inputlatency.worst * 1000 / inputlatency.count,
+		inputlatency.max * 1000);
+
+	inputlatency.total = inputlatency.worst = inputlatency.max = 0;
+	inputlatency.count = 0;
+}
+
 void CL_SendCmd(void)
 {
 	sizebuf_t buf;
@@ -1086,6 +1137,8 @@ void CL_SendCmd(void)
 
 	// deliver the message
 	Netchan_Transmit (&cls.netchan, buf.cursize, buf.data);
+
+	CL_InputLatency_Sent();
 }
 
 void CL_InitInput(void)
@@ -1131,6 +1184,7 @@ void CL_InitInput(void)
 	Cmd_AddCommand("+mlook", IN_MLookDown);
 	Cmd_AddCommand("-mlook", IN_MLookUp);
 	Cmd_AddCommand ("rotate",CL_Rotate_f);
+	Cmd_AddCommand ("cl_inputlatency", CL_InputLatency_f);
 
 	Cvar_SetCurrentGroup(CVAR_GROUP_INPUT_KEYBOARD);
 
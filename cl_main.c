@@ -112,6 +112,7 @@ cvar_t	cl_maxfps	= {"cl_maxfps", "0"};
 cvar_t	cl_physfps	= {"cl_physfps", "0"};	//#fps
 cvar_t	cl_physfps_spectator = {"cl_physfps_spectator", "30"};
 cvar_t  cl_independentPhysics = {"cl_independentPhysics", "1", 0, Rulesets_OnChange_indphys};
+cvar_t	cl_inputpoll = {"cl_inputpoll", "0"};
 
 cvar_t	cl_predict_players = {"cl_predict_players", "1"};
 cvar_t	cl_solid_players = {"cl_solid_players", "1"};
@@ -246,6 +247,8 @@ int		fps_count;
 double		lastfps;
 qbool physframe;
 double physframetime;
+static double extraphysframetime;	//#fps
+static qbool inputpoll_allowed;		// only poll while CL_Frame is drawing
 
 // emodel and pmodel are encrypted to prevent llamas from easily hacking them
 char emodel_name[] = { 'e'^0xe5, 'm'^0xe5, 'o'^0xe5, 'd'^0xe5, 'e'^0xe5, 'l'^0xe5, 0 };
@@ -1098,6 +1101,11 @@ void CL_ClearState (void)
 
 	CL_ClearPredict();
 
+	// The info mirrors own heap memory, release it before the wipe.
+	Info_RemoveAll(&cl._serverinfo_ctx_);
+	for (i = 0; i < MAX_CLIENTS; i++)
+		Info_RemoveAll(&cl.players[i]._userinfo_ctx_);
+
 	// Wipe the entire cl structure.
 	memset(&cl, 0, sizeof(cl));
 
@@ -1231,6 +1239,7 @@ void CL_Disconnect (void)
 
 	// So join/observe not confused
 	Info_SetValueForStarKey (cl.serverinfo, "*z_ext", "", sizeof(cl.serverinfo));
+	Info_Mirror(&cl._serverinfo_ctx_, cl.serverinfo);
 	cl.z_ext = 0;
 
 	// well, we need free qtv users before new connection
@@ -1694,6 +1703,7 @@ void CL_InitLocal (void)
 	Cvar_Register (&hud_fps_min_reset_interval);
 	Cvar_Register (&cl_physfps_spectator);
 	Cvar_Register (&cl_independentPhysics);
+	Cvar_Register (&cl_inputpoll);
 	Cvar_Register (&cl_deadbodyfilter);
 	Cvar_Register (&cl_gibfilter);
 	Cvar_Register (&cl_backpackfilter);
@@ -2077,6 +2087,50 @@ static double MinPhysFrameTime (void)
 	return 1 / fpscap;
 }
 
+//
+// Called by the renderer at points where it is safe to send a move command.
+// With independent physics the command rate doesn't depend on the render rate,
+// so if a physics frame fell due while drawing, sample the mouse and send it now
+// instead of making it wait for the next CL_Frame.
+//
+void CL_InputPoll (void)
+{
+	extern double render_frame_start;
+	double minphysframetime, oldphysframetime, oldrealtime;
+	qbool oldphysframe;
+
+	if (!inputpoll_allowed || !cl_inputpoll.integer || !cl_independentPhysics.value)
+		return;
+
+	if (cls.state != ca_active || cls.demoplayback || ISPAUSED || Movie_IsCapturing() || CL_MultiviewEnabled())
+		return;
+
+	minphysframetime = MinPhysFrameTime();
+	if (extraphysframetime + (Sys_DoubleTime() - render_frame_start) < minphysframetime)
+		return;
+
+	// CL_Frame adds the whole frame time at the start of the next frame,
+	// so taking the tick out here keeps the overall rate unchanged.
+	extraphysframetime -= minphysframetime;
+
+	oldphysframe = physframe;
+	oldphysframetime = physframetime;
+	physframe = true;
+	physframetime = minphysframetime;
+
+	// cls.realtime only advances at the start of CL_Frame, so move it on by
+	// the time spent drawing to give the command a true send time for ping
+	oldrealtime = cls.realtime;
+	cls.realtime += Sys_DoubleTime() - render_frame_start;
+
+	IN_PollMouse();
+	CL_SendCmd();
+
+	cls.realtime = oldrealtime;
+	physframe = oldphysframe;
+	physframetime = oldphysframetime;
+}
+
 void CL_CalcFPS(void)
 {
 	double t;
@@ -2178,7 +2232,6 @@ void CL_Frame (double time)
 {
 	static double extratime = 0.001;
 	double minframetime;
-	static double	extraphysframetime;	//#fps
 	qbool need_server_frame = false;
 
 	extern double render_frame_start;
@@ -2439,6 +2492,8 @@ void CL_Frame (double time)
 
 	CL_MultiviewPreUpdateScreen ();
 
+	inputpoll_allowed = true;
+
 	// update video
 	if (CL_MultiviewEnabled())
 	{
@@ -2470,6 +2525,8 @@ void CL_Frame (double time)
 		CL_SoundFrame ();
 	}
 
+	inputpoll_allowed = false;
+
 	CL_DecayLights();
 
 	CDAudio_Update();
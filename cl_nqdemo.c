@@ -369,6 +369,7 @@ static void NQD_ParseUpdatecolors (void)
 		Info_SetValueForKey (cl.players[i].userinfo, "team", bottom_as_string, MAX_INFO_KEY);
 		strlcpy(cl.players[i].team, bottom_as_string, sizeof(cl.players[i].team));
 	}
+	Info_Mirror(&cl.players[i]._userinfo_ctx_, cl.players[i].userinfo);
 
 	// Update skins
 	if (TP_NeedRefreshSkins() && client_team_changed)
@@ -845,7 +845,7 @@ void CL_SendChunkDownloadReq(void)
 
 		if (i < 0)
 		{
-			if (strstr(Info_ValueForKey(cl.serverinfo, "*version"), "MVDSV"))
+			if (strstr(Info_Get(&cl._serverinfo_ctx_, "*version"), "MVDSV"))
 				CL_SendClientCommand(true, "nextdl %d %d %d", i, cls.downloadpercent, chunked_download_number);
 			else
 				CL_SendClientCommand(true, "stopdownload");
@@ -1401,6 +1401,7 @@ void CL_ParseServerData (void)
 #ifdef PROTOCOL_VERSION_MVD1
 	cls.mvdprotocolextensions1 = 0;
 #endif
+	CL_MVDPredictReset ();
 
 	for(;;)
 	{
@@ -2060,19 +2061,22 @@ void CL_ProcessUserInfo(int slot, player_info_t *player, char *key)
 	qbool update_skin;
 	int mynum;
 
-	strlcpy(player->name, Info_ValueForKey(player->userinfo, "name"), sizeof(player->name));
+	// every userinfo change ends up here, keep the hashed copy in step with the string
+	Info_Mirror(&player->_userinfo_ctx_, player->userinfo);
+
+	strlcpy(player->name, Info_Get(&player->_userinfo_ctx_, "name"), sizeof(player->name));
 
 	if (!player->name[0] && player->userid && strlen(player->userinfo) >= MAX_INFO_STRING - 17) {
 		// Somebody's trying to hide himself by overloading userinfo.
 		strlcpy(player->name, " ", sizeof(player->name));
 	}
 
-	player->real_topcolor = atoi(Info_ValueForKey(player->userinfo, "topcolor"));
-	player->real_bottomcolor = atoi(Info_ValueForKey(player->userinfo, "bottomcolor"));
+	player->real_topcolor = atoi(Info_Get(&player->_userinfo_ctx_, "topcolor"));
+	player->real_bottomcolor = atoi(Info_Get(&player->_userinfo_ctx_, "bottomcolor"));
 
-	strlcpy(player->team, Info_ValueForKey(player->userinfo, "team"), sizeof(player->team));
+	strlcpy(player->team, Info_Get(&player->_userinfo_ctx_, "team"), sizeof(player->team));
 
-	if (atoi(Info_ValueForKey(player->userinfo, "*spectator"))) {
+	if (atoi(Info_Get(&player->_userinfo_ctx_, "*spectator"))) {
 		player->spectator = true;
 	} else {
 		player->spectator = false;
@@ -2107,7 +2111,7 @@ void CL_ProcessUserInfo(int slot, player_info_t *player, char *key)
 void CL_NotifyOnFull(void)
 {
 	if (!cl.spectator && !cls.demoplayback) {
-		int limit = Q_atoi(Info_ValueForKey(cl.serverinfo, "maxclients"));
+		int limit = Q_atoi(Info_Get(&cl._serverinfo_ctx_, "maxclients"));
 		int players = 0;
 		int i;
 
@@ -2206,7 +2210,7 @@ void CL_SetInfo (void)
 static void CL_PEXT_Fix(void)
 {
 	char version_bugged[] = "MVDSV 0.30";
-	char *version = Info_ValueForKey(cl.serverinfo, "*version");
+	char *version = Info_Get(&cl._serverinfo_ctx_, "*version");
 
 	if (!strncmp(version, version_bugged, sizeof(version_bugged)-1))
 	{
@@ -2261,14 +2265,14 @@ void CL_ProcessServerInfo (void)
 	CL_PEXT_Fix(); // must be called once from CL_FullServerinfo_f() but should be ok here too.
 
 	// game type (sbar code checks it) (GAME_DEATHMATCH default)
-	cl.gametype = *(p = Info_ValueForKey(cl.serverinfo, "deathmatch")) ? (atoi(p) ? GAME_DEATHMATCH : GAME_COOP) : GAME_DEATHMATCH;
+	cl.gametype = *(p = Info_Get(&cl._serverinfo_ctx_, "deathmatch")) ? (atoi(p) ? GAME_DEATHMATCH : GAME_COOP) : GAME_DEATHMATCH;
 
 	// server side fps restriction
-	cl.maxfps = Q_atof(Info_ValueForKey(cl.serverinfo, "maxfps"));
+	cl.maxfps = Q_atof(Info_Get(&cl._serverinfo_ctx_, "maxfps"));
 
-	newfpd = cls.demoplayback ? 0 : atoi(Info_ValueForKey(cl.serverinfo, "fpd"));
+	newfpd = cls.demoplayback ? 0 : atoi(Info_Get(&cl._serverinfo_ctx_, "fpd"));
 
-	p = Info_ValueForKey(cl.serverinfo, "status");
+	p = Info_Get(&cl._serverinfo_ctx_, "status");
 	standby = !strcasecmp(p, "standby");
 	countdown = !strcasecmp(p, "countdown");
 
@@ -2285,42 +2289,42 @@ void CL_ProcessServerInfo (void)
 	cl.standby = standby;
 	cl.countdown = countdown;
 
-	cl.minlight = (strlen(minlight = Info_ValueForKey(cl.serverinfo, "minlight")) ? bound(0, Q_atoi(minlight), 255) : 4);
+	cl.minlight = (strlen(minlight = Info_Get(&cl._serverinfo_ctx_, "minlight")) ? bound(0, Q_atoi(minlight), 255) : 4);
 
 	// Get the server's ZQuake extension bits
-	cl.z_ext = atoi(Info_ValueForKey(cl.serverinfo, "*z_ext"));
+	cl.z_ext = atoi(Info_Get(&cl._serverinfo_ctx_, "*z_ext"));
 
 	// Initialize cl.maxpitch & cl.minpitch
-	p = (cl.z_ext & Z_EXT_PITCHLIMITS) ? Info_ValueForKey (cl.serverinfo, "maxpitch") : "";
+	p = (cl.z_ext & Z_EXT_PITCHLIMITS) ? Info_Get(&cl._serverinfo_ctx_, "maxpitch") : "";
 	cl.maxpitch = *p ? Q_atof(p) : 80.0f;
-	p = (cl.z_ext & Z_EXT_PITCHLIMITS) ? Info_ValueForKey (cl.serverinfo, "minpitch") : "";
+	p = (cl.z_ext & Z_EXT_PITCHLIMITS) ? Info_Get(&cl._serverinfo_ctx_, "minpitch") : "";
 	cl.minpitch = *p ? Q_atof(p) : -70.0f;
 
 	// movement vars for prediction
-	cl.bunnyspeedcap = Q_atof(Info_ValueForKey(cl.serverinfo, "pm_bunnyspeedcap"));
-	movevars.slidefix = (Q_atof(Info_ValueForKey(cl.serverinfo, "pm_slidefix")) != 0);
-	movevars.airstep = (Q_atof(Info_ValueForKey(cl.serverinfo, "pm_airstep")) != 0);
-	movevars.pground = (Q_atof(Info_ValueForKey(cl.serverinfo, "pm_pground")) != 0)
+	cl.bunnyspeedcap = Q_atof(Info_Get(&cl._serverinfo_ctx_, "pm_bunnyspeedcap"));
+	movevars.slidefix = (Q_atof(Info_Get(&cl._serverinfo_ctx_, "pm_slidefix")) != 0);
+	movevars.airstep = (Q_atof(Info_Get(&cl._serverinfo_ctx_, "pm_airstep")) != 0);
+	movevars.pground = (Q_atof(Info_Get(&cl._serverinfo_ctx_, "pm_pground")) != 0)
 		&& (cl.z_ext & Z_EXT_PF_ONGROUND) /* pground doesn't make sense without this */;
-	movevars.ktjump = *(p = Info_ValueForKey(cl.serverinfo, "pm_ktjump")) ?
+	movevars.ktjump = *(p = Info_Get(&cl._serverinfo_ctx_, "pm_ktjump")) ?
 		Q_atof(p) : cl.teamfortress ? 0 : 1;
 
 	// Deathmatch and teamplay.
-	cl.deathmatch = atoi(Info_ValueForKey(cl.serverinfo, "deathmatch"));
-	new_teamplay = atoi(Info_ValueForKey(cl.serverinfo, "teamplay"));
+	cl.deathmatch = atoi(Info_Get(&cl._serverinfo_ctx_, "deathmatch"));
+	new_teamplay = atoi(Info_Get(&cl._serverinfo_ctx_, "teamplay"));
 
 	// Timelimit and fraglimit.
-	cl.timelimit = atoi(Info_ValueForKey(cl.serverinfo, "timelimit"));
-	cl.fraglimit = atoi(Info_ValueForKey(cl.serverinfo, "fraglimit"));
+	cl.timelimit = atoi(Info_Get(&cl._serverinfo_ctx_, "timelimit"));
+	cl.fraglimit = atoi(Info_Get(&cl._serverinfo_ctx_, "fraglimit"));
 
-	cl.racing = !strcmp(Info_ValueForKey(cl.serverinfo, "ktxmode"), "race");
-	cl.scoring_system = atoi(Info_ValueForKey(cl.serverinfo, "scoring"));
+	cl.racing = !strcmp(Info_Get(&cl._serverinfo_ctx_, "ktxmode"), "race");
+	cl.scoring_system = atoi(Info_Get(&cl._serverinfo_ctx_, "scoring"));
 
 	// Update fakeshaft limits
 	{
-		char* p = Info_ValueForKey(cl.serverinfo, "fakeshaft");
+		char* p = Info_Get(&cl._serverinfo_ctx_, "fakeshaft");
 		if (!p[0]) {
-			p = Info_ValueForKey(cl.serverinfo, "truelightning");
+			p = Info_Get(&cl._serverinfo_ctx_, "truelightning");
 		}
 
 		if (p[0]) {
@@ -2423,6 +2427,7 @@ void CL_ParseServerInfoChange (void)
 	}
 
 	Info_SetValueForKey (cl.serverinfo, key, value, MAX_SERVERINFO_STRING);
+	Info_Mirror(&cl._serverinfo_ctx_, cl.serverinfo);
 
 	CL_ProcessServerInfo ();
 }
@@ -2628,7 +2633,7 @@ int SeparateChat(char *chat, int *out_type, char **out_msg)
             if (!cl.players[i].name[0])
                 continue;
 
-            snprintf(buf,  sizeof (buf), "%.*s: ", server_cut, Info_ValueForKey(cl.players[i].userinfo, "name"));
+            snprintf(buf,  sizeof (buf), "%.*s: ", server_cut, Info_Get(&cl.players[i]._userinfo_ctx_, "name"));
 
 			if (!strncmp(chat, buf, strlen(buf)))
             {
@@ -2637,7 +2642,7 @@ int SeparateChat(char *chat, int *out_type, char **out_msg)
                 msg = chat + strlen(buf);
             }
 
-            snprintf(buf,  sizeof (buf), "(%.*s): ", server_cut, Info_ValueForKey(cl.players[i].userinfo, "name"));
+            snprintf(buf,  sizeof (buf), "(%.*s): ", server_cut, Info_Get(&cl.players[i]._userinfo_ctx_, "name"));
 
 			if (!strncmp(chat, buf, strlen(buf)))
             {
@@ -2646,7 +2651,7 @@ int SeparateChat(char *chat, int *out_type, char **out_msg)
                 msg = chat + strlen(buf);
             }
 
-            snprintf(buf,  sizeof (buf), "[SPEC] %.*s: ", server_cut, Info_ValueForKey(cl.players[i].userinfo, "name"));
+            snprintf(buf,  sizeof (buf), "[SPEC] %.*s: ", server_cut, Info_Get(&cl.players[i]._userinfo_ctx_, "name"));
 
 			if (!strncmp(chat, buf, strlen(buf)))
             {
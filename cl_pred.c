@@ -23,6 +23,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 cvar_t	cl_nopred	= {"cl_nopred", "0"};
 cvar_t cl_pushlatency = {"pushlatency", "-999"};
+cvar_t	cl_predict_cache = {"cl_predict_cache", "1"};
+cvar_t	cl_showpredict = {"cl_showpredict", "0"};
 
 extern cvar_t cl_independentPhysics;
 
@@ -35,6 +37,163 @@ static vec3_t saved_angles;
 qbool clpred_newpos = false;
 #endif
 
+// Predicted states of our own player by command sequence. Every entry continues
+// from the one before it, so as long as the server agrees with where we expected
+// to be at cl.validsequence, only commands that weren't predicted yet need pmove.
+typedef struct predicted_state_s {
+	int				sequence;
+	usercmd_t		cmd;
+	player_state_t	state;
+	int				waterlevel;
+	int				groundent;
+} predicted_state_t;
+
+static predicted_state_t	predicted[UPDATE_BACKUP];
+static int					predicted_last;			// newest sequence in the chain
+static int					predicted_playernum = -1;
+static float				predicted_movevars[3];	// entgravity, maxspeed, bunnyspeedcap
+static physent_t			predicted_physents[MAX_PHYSENTS];	// what the chain was predicted against
+static int					predicted_numphysent;
+
+static int					pmove_count;			// PM_PlayerMove calls, for cl_showpredict
+
+// The server sends origins in 1/8 units and velocities as whole numbers,
+// so a correct prediction only agrees with it up to that precision.
+#define PREDICT_ORIGIN_EPSILON		0.125
+#define PREDICT_VELOCITY_EPSILON	1
+
+// Moves captured by "pmovebench record", replayed by "pmovebench".
+#define PMOVEBENCH_MAX_MOVES	4096
+
+typedef struct pmovebench_move_s {
+	playermove_t	pm;
+	movevars_t		mv;
+} pmovebench_move_t;
+
+typedef struct pmovebench_result_s {
+	vec3_t			origin;
+	vec3_t			velocity;
+	qbool			onground;
+	int				numtouch;
+} pmovebench_result_t;
+
+static pmovebench_move_t	*pmovebench_moves;
+static int					pmovebench_count;
+static qbool				pmovebench_recording;
+static unsigned				pmovebench_checksum;	// the physents point into this map
+
+static void CL_PMoveBench_Capture (void)
+{
+	if (!pmovebench_recording)
+		return;
+
+	if (pmovebench_count >= PMOVEBENCH_MAX_MOVES) {
+		pmovebench_recording = false;
+		Com_Printf ("pmovebench: recorded %i moves\n", pmovebench_count);
+		return;
+	}
+
+	pmovebench_moves[pmovebench_count].pm = pmove;
+	pmovebench_moves[pmovebench_count].mv = movevars;
+	pmovebench_count++;
+}
+
+static double CL_PMoveBench_Run (qbool broadphase, int repeats, pmovebench_result_t *results)
+{
+	pmovebench_move_t *m;
+	double start;
+	int r, i;
+
+	pm_broadphase = broadphase;
+	start = Sys_DoubleTime ();
+
+	for (r = 0; r < repeats; r++) {
+		for (i = 0, m = pmovebench_moves; i < pmovebench_count; i++, m++) {
+			// copy only the physents in use
+			memcpy (&pmove, &m->pm, (byte *) &pmove.physents[m->pm.numphysent] - (byte *) &pmove);
+			pmove.cmd = m->pm.cmd;
+			movevars = m->mv;
+
+			PM_PlayerMove ();
+
+			if (!r) {
+				VectorCopy (pmove.origin, results[i].origin);
+				VectorCopy (pmove.velocity, results[i].velocity);
+				results[i].onground = pmove.onground;
+				results[i].numtouch = pmove.numtouch;
+			}
+		}
+	}
+
+	pm_broadphase = true;
+
+	return Sys_DoubleTime () - start;
+}
+
+static void CL_PMoveBench_f (void)
+{
+	pmovebench_result_t *brute, *broad;
+	playermove_t saved_pmove;
+	movevars_t saved_movevars;
+	double brute_time, broad_time;
+	int i, repeats, differ = 0;
+
+	if (Cmd_Argc () > 1 && !strcasecmp (Cmd_Argv (1), "record")) {
+		if (!pmovebench_moves)
+			pmovebench_moves = (pmovebench_move_t *) Q_malloc (PMOVEBENCH_MAX_MOVES * sizeof (pmovebench_move_t));
+		pmovebench_count = 0;
+		pmovebench_recording = true;
+		pmovebench_checksum = cl.map_checksum2;
+		Com_Printf ("pmovebench: recording the next %i predicted moves\n", PMOVEBENCH_MAX_MOVES);
+		return;
+	}
+
+	if (Cmd_Argc () > 1 && !strcasecmp (Cmd_Argv (1), "stop")) {
+		pmovebench_recording = false;
+		Com_Printf ("pmovebench: recorded %i moves\n", pmovebench_count);
+		return;
+	}
+
+	if (!pmovebench_count) {
+		Com_Printf ("Usage: %s record | stop | [repeats]\n", Cmd_Argv (0));
+		Com_Printf ("Record moves while playing or watching a demo, then run without arguments to replay them\n");
+		return;
+	}
+
+	if (pmovebench_recording || !cl.worldmodel || cl.map_checksum2 != pmovebench_checksum) {
+		Com_Printf ("pmovebench: stop recording first and replay on the map the moves were recorded on\n");
+		return;
+	}
+
+	repeats = (Cmd_Argc () > 1 ? Q_atoi (Cmd_Argv (1)) : 100);
+	repeats = max (repeats, 1);
+
+	brute = (pmovebench_result_t *) Q_malloc (pmovebench_count * sizeof (pmovebench_result_t));
+	broad = (pmovebench_result_t *) Q_malloc (pmovebench_count * sizeof (pmovebench_result_t));
+	saved_pmove = pmove;
+	saved_movevars = movevars;
+
+	brute_time = CL_PMoveBench_Run (false, repeats, brute);
+	broad_time = CL_PMoveBench_Run (true, repeats, broad);
+
+	pmove = saved_pmove;
+	movevars = saved_movevars;
+
+	for (i = 0; i < pmovebench_count; i++) {
+		if (!VectorCompare (brute[i].origin, broad[i].origin) || !VectorCompare (brute[i].velocity, broad[i].velocity)
+			|| brute[i].onground != broad[i].onground || brute[i].numtouch != broad[i].numtouch)
+			differ++;
+	}
+
+	Com_Printf ("%i moves x %i:\n", pmovebench_count, repeats);
+	Com_Printf ("  all physents:  %.3f us/move\n", brute_time * 1000000 / (pmovebench_count * repeats));
+	Com_Printf ("  broad phase:   %.3f us/move\n", broad_time * 1000000 / (pmovebench_count * repeats));
+	Com_Printf ("  %i results differ\n", differ);
+
+	Q_free (brute);
+	Q_free (broad);
+}
+
 void CL_PredictUsercmd (player_state_t *from, player_state_t *to, usercmd_t *u) {
 	// split up very long moves
 	if (u->msec > 50) {
@@ -73,7 +232,9 @@ void CL_PredictUsercmd (player_state_t *from, player_state_t *to, usercmd_t *u)
 	movevars.maxspeed = cl.maxspeed;
 	movevars.bunnyspeedcap = cl.bunnyspeedcap;
 
+	CL_PMoveBench_Capture();
 	PM_PlayerMove();
+	pmove_count++;
 
 	to->waterjumptime = pmove.waterjumptime;
 	to->pm_type = pmove.pm_type;
@@ -277,23 +438,109 @@ static void CL_LerpMove (qbool angles_lerp)
 }
 
 qbool cl_nolerp_on_entity_flag = false;
-// function check_standing_on_entity(void)
+// function check_standing_on_entity(onground, groundent)
 // raises flag cl_nolerp_on_entity_flag if standing on entity
 // and cl_nolerp_on_entity.value is 1
-static void check_standing_on_entity(void)
+static void check_standing_on_entity(qbool onground, int groundent)
 {
   extern cvar_t cl_nolerp;
   extern cvar_t cl_nolerp_on_entity;
   extern cvar_t cl_independentPhysics;
   cl_nolerp_on_entity_flag = 
-       (pmove.onground && pmove.groundent > 0 &&
+       (onground && groundent > 0 &&
         cl_nolerp_on_entity.value &&
         cl_independentPhysics.value);
 }
 
+static qbool CL_PredictionMatches (const player_state_t *predicted, const player_state_t *server)
+{
+	int i;
+
+	if (predicted->pm_type != server->pm_type)
+		return false;
+	if ((cl.z_ext & Z_EXT_PF_ONGROUND) && predicted->onground != server->onground)
+		return false;
+	if ((cl.z_ext & Z_EXT_PM_TYPE) && predicted->jump_held != server->jump_held)
+		return false;
+
+	for (i = 0; i < 3; i++) {
+		if (fabs(predicted->origin[i] - server->origin[i]) > PREDICT_ORIGIN_EPSILON)
+			return false;
+		if (fabs(predicted->velocity[i] - server->velocity[i]) > PREDICT_VELOCITY_EPSILON)
+			return false;
+	}
+
+	return true;
+}
+
+// Bmodels move and other players are placed again with every packet, and states
+// predicted against the old ones can't be reused.
+static qbool CL_PredictCache_PhysentsMatch (void)
+{
+	physent_t *a, *b;
+	int i;
+
+	if (pmove.numphysent != predicted_numphysent)
+		return false;
+
+	for (i = 0; i < pmove.numphysent; i++) {
+		a = &pmove.physents[i];
+		b = &predicted_physents[i];
+
+		if (a->model != b->model || !VectorCompare(a->origin, b->origin))
+			return false;
+		if (!a->model && (!VectorCompare(a->mins, b->mins) || !VectorCompare(a->maxs, b->maxs)))
+			return false;
+	}
+
+	return true;
+}
+
+// Returns the first command sequence that has to go through pmove again.
+// pmove.physents must already hold everything the player clips against.
+static int CL_PredictCache_Start (player_state_t *base)
+{
+	predicted_state_t *p = &predicted[cl.validsequence & UPDATE_MASK];
+	int seq;
+
+	if (!cl_predict_cache.integer
+#ifdef JSS_CAM
+		|| cam_lockdir.value
+#endif
+		|| predicted_playernum != cl.playernum
+		|| predicted_movevars[0] != cl.entgravity
+		|| predicted_movevars[1] != cl.maxspeed
+		|| predicted_movevars[2] != cl.bunnyspeedcap
+		|| p->sequence != cl.validsequence
+		|| predicted_last < cl.validsequence
+		|| !CL_PredictCache_PhysentsMatch()
+		|| !CL_PredictionMatches(&p->state, base)) {
+		// start a new chain from what the server told us
+		p->sequence = cl.validsequence;
+		p->state = *base;
+		predicted_last = cl.validsequence;
+		predicted_playernum = cl.playernum;
+		predicted_movevars[0] = cl.entgravity;
+		predicted_movevars[1] = cl.maxspeed;
+		predicted_movevars[2] = cl.bunnyspeedcap;
+		predicted_numphysent = pmove.numphysent;
+		memcpy(predicted_physents, pmove.physents, pmove.numphysent * sizeof(physent_t));
+		return cl.validsequence + 1;
+	}
+
+	for (seq = cl.validsequence + 1; seq <= predicted_last && seq < cls.netchan.outgoing_sequence; seq++) {
+		p = &predicted[seq & UPDATE_MASK];
+		if (p->sequence != seq || memcmp(&p->cmd, &cl.frames[seq & UPDATE_MASK].cmd, sizeof(p->cmd)))
+			break;
+	}
+
+	return seq;
+}
+
 void CL_PredictMove (qbool physframe) {
-	int i, oldphysent;
-	frame_t *from = NULL, *to;
+	int seq, start, oldphysent;
+	frame_t *to;
+	predicted_state_t *p;
 	qbool angles_lerp = false;
 
 	if (cl.paused && !CL_MultiviewEnabled())
@@ -355,21 +602,40 @@ void CL_PredictMove (qbool physframe) {
 		oldphysent = pmove.numphysent;
 		CL_SetSolidPlayers (cl.playernum);
 
-		// run frames
-		for (i = 1; i < UPDATE_BACKUP - 1 && cl.validsequence + i < cls.netchan.outgoing_sequence; i++) {
-			from = to;
-			to = &cl.frames[(cl.validsequence + i) & UPDATE_MASK];
-			CL_PredictUsercmd (&from->playerstate[cl.playernum], &to->playerstate[cl.playernum], &to->cmd);
-		}
+		start = CL_PredictCache_Start (&to->playerstate[cl.playernum]);
+		pmove_count = 0;
+
+		// run the frames we don't have yet
+		if (start < cls.netchan.outgoing_sequence) {
+			for (seq = start; seq < cls.netchan.outgoing_sequence; seq++) {
+				to = &cl.frames[seq & UPDATE_MASK];
+				p = &predicted[seq & UPDATE_MASK];
 
+				CL_PredictUsercmd (&predicted[(seq - 1) & UPDATE_MASK].state, &to->playerstate[cl.playernum], &to->cmd);
+
+				p->sequence = seq;
+				p->cmd = to->cmd;
+				p->state = to->playerstate[cl.playernum];
+				p->waterlevel = pmove.waterlevel;
+				p->groundent = pmove.groundent;
+			}
+		}
 		pmove.numphysent = oldphysent;
+		predicted_last = cls.netchan.outgoing_sequence - 1;
+
+		if (cl_showpredict.integer) {
+			Print_flags[Print_current] |= PR_TR_SKIP;
+			Com_Printf ("%i unacked cmds: %i reused, %i pmoves\n", cls.netchan.outgoing_sequence - cl.validsequence - 1,
+				start - cl.validsequence - 1, pmove_count);
+		}
 
 		// save results
-		VectorCopy (to->playerstate[cl.playernum].velocity, cl.simvel);
-		VectorCopy (to->playerstate[cl.playernum].origin, cl.simorg);
-		cl.onground = pmove.onground;
-		cl.waterlevel = pmove.waterlevel;
-		check_standing_on_entity();
+		p = &predicted[predicted_last & UPDATE_MASK];
+		VectorCopy (p->state.velocity, cl.simvel);
+		VectorCopy (p->state.origin, cl.simorg);
+		cl.onground = p->state.onground;
+		cl.waterlevel = p->waterlevel;
+		check_standing_on_entity(p->state.onground, p->groundent);
 	}
 
 	if (!cls.mvdplayback && cl_independentPhysics.value != 0) {
@@ -410,9 +676,13 @@ void CL_InitPrediction (void) {
 	Cvar_SetCurrentGroup(CVAR_GROUP_NETWORK);
 	Cvar_Register(&cl_nopred);
 	Cvar_Register(&cl_pushlatency);
+	Cvar_Register(&cl_predict_cache);
+	Cvar_Register(&cl_showpredict);
 
 	Cvar_ResetCurrentGroup();
 
+	Cmd_AddCommand ("pmovebench", CL_PMoveBench_f);
+
 #ifdef JSS_CAM	
 	Cvar_SetCurrentGroup(CVAR_GROUP_SPECTATOR);
 	Cvar_Register (&cam_thirdperson);
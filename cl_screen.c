@@ -41,9 +41,9 @@ $Id: cl_screen.c,v 1.156 2007-10-29 00:56:47 qqshka Exp $
 #include "sbar.h"
 #include "menu.h"
 #include "image.h"
+#include "movie.h"
 #ifdef _WIN32
-#include "movie.h"	//joe: capturing to avi
-#include "movie_avi.h"	//
+#include "movie_avi.h"	//joe: capturing to avi
 #endif
 #include "Ctrl.h"
 #include "qtv.h"
@@ -797,7 +797,7 @@ void SCR_DrawGameClock (void) {
 		return;
 
 	if (scr_gameclock.value == 2 || scr_gameclock.value == 4)
-		timelimit = 60 * Q_atof(Info_ValueForKey(cl.serverinfo, "timelimit")) + 1;
+		timelimit = 60 * Q_atof(Info_Get(&cl._serverinfo_ctx_, "timelimit")) + 1;
 	else
 		timelimit = 0;
 
@@ -1414,7 +1414,7 @@ void SCR_SetupCI (void) {
 		if (state->messagenum != cl.parsecount || j == cl.playernum || j == tracknum || info->spectator)
 			continue;
 
-		if (!*(s = Info_ValueForKey (info->userinfo, "chat")))
+		if (!*(s = Info_Get(&info->_userinfo_ctx_, "chat")))
 			continue; // user not chatting, so ignore
 
 		id = &ci_clients[ci_count];
@@ -3296,6 +3296,8 @@ void SCR_UpdateScreenPostPlayerView (void)
 
 	SCR_RenderFrameEnd();
 
+	CL_InputPoll ();
+
 	GL_EndRendering ();
 }
 
@@ -3724,8 +3726,134 @@ void SCR_AutoScreenshot(char *matchname)
 }
 
 // Capturing to avi.
+// Frames streamed to demo_capture_pipe are read back through two pixel buffer objects,
+// frame N is read into one while frame N-1 is mapped from the other, so the CPU never
+// waits for the GPU to finish the frame it just drew.
+static GLuint movie_pbo[2];
+static int movie_pbo_frames;
+static int movie_pbo_width, movie_pbo_height;
+
+// OpenGL rows are bottom-up, the encoder wants them top-down.
+static void SCR_MovieFlipCopy(byte *out, const byte *in, int width, int height)
+{
+	int row = width * 3;
+	int y;
+
+	for (y = 0; y < height; y++)
+		memcpy(out + (height - 1 - y) * row, in + y * row, row);
+}
+
+static void SCR_MovieFlipInPlace(byte *buffer, int width, int height)
+{
+	int row = width * 3;
+	byte *top, *bottom, temp;
+	int x, y;
+
+	for (y = 0; y < height / 2; y++) {
+		top = buffer + y * row;
+		bottom = buffer + (height - 1 - y) * row;
+		for (x = 0; x < row; x++) {
+			temp = top[x];
+			top[x] = bottom[x];
+			bottom[x] = temp;
+		}
+	}
+}
+
+static void SCR_MovieSubmitPBO(GLuint pbo, double readback)
+{
+	byte *buffer = Movie_PipeVideoBuffer(movie_pbo_width, movie_pbo_height);
+	double start = Sys_DoubleTime();
+	int size = movie_pbo_width * movie_pbo_height * 3;
+	byte *pixels;
+
+	if (!buffer)
+		return;
+
+	qglBindBuffer(GL_PIXEL_PACK_BUFFER_ARB, pbo);
+	if ((pixels = (byte *) qglMapBuffer(GL_PIXEL_PACK_BUFFER_ARB, GL_READ_ONLY_ARB))) {
+		SCR_MovieFlipCopy(buffer, pixels, movie_pbo_width, movie_pbo_height);
+		qglUnmapBuffer(GL_PIXEL_PACK_BUFFER_ARB);
+	}
+	else {
+		memset(buffer, 0, size);
+	}
+	qglBindBuffer(GL_PIXEL_PACK_BUFFER_ARB, 0);
+
+	applyHWGamma(buffer, size);
+	Movie_PipeSubmitVideo(readback + Sys_DoubleTime() - start);
+}
+
+static void SCR_MoviePipeFrame(void)
+{
+	int size = glwidth * glheight * 3;
+	double start, readback;
+	byte *buffer;
+	int i;
+
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+	if (!gl_support_pbo) {
+		if (!(buffer = Movie_PipeVideoBuffer(glwidth, glheight)))
+			return;
+
+		start = Sys_DoubleTime();
+		glReadPixels(glx, gly, glwidth, glheight, GL_RGB, GL_UNSIGNED_BYTE, buffer);
+		SCR_MovieFlipInPlace(buffer, glwidth, glheight);
+		applyHWGamma(buffer, size);
+		Movie_PipeSubmitVideo(Sys_DoubleTime() - start);
+		return;
+	}
+
+	if (!movie_pbo[0]) {
+		qglGenBuffers(2, movie_pbo);
+		for (i = 0; i < 2; i++) {
+			qglBindBuffer(GL_PIXEL_PACK_BUFFER_ARB, movie_pbo[i]);
+			qglBufferData(GL_PIXEL_PACK_BUFFER_ARB, size, NULL, GL_STREAM_READ_ARB);
+		}
+		movie_pbo_width = glwidth;
+		movie_pbo_height = glheight;
+		movie_pbo_frames = 0;
+	}
+	else if (glwidth != movie_pbo_width || glheight != movie_pbo_height) {
+		// let the pipe notice and stop the capture
+		Movie_PipeVideoBuffer(glwidth, glheight);
+		return;
+	}
+
+	start = Sys_DoubleTime();
+	qglBindBuffer(GL_PIXEL_PACK_BUFFER_ARB, movie_pbo[movie_pbo_frames & 1]);
+	glReadPixels(glx, gly, glwidth, glheight, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+	qglBindBuffer(GL_PIXEL_PACK_BUFFER_ARB, 0);
+	readback = Sys_DoubleTime() - start;
+
+	// the other buffer now holds the previous frame
+	if (++movie_pbo_frames > 1)
+		SCR_MovieSubmitPBO(movie_pbo[movie_pbo_frames & 1], readback);
+}
+
+// Called when the capture stops, hands over the frame still sitting in a PBO.
+void SCR_MovieReadbackFinish(void)
+{
+	if (!movie_pbo[0])
+		return;
+
+	if (movie_pbo_frames > 0)
+		SCR_MovieSubmitPBO(movie_pbo[(movie_pbo_frames - 1) & 1], 0);
+
+	qglDeleteBuffers(2, movie_pbo);
+	movie_pbo[0] = movie_pbo[1] = 0;
+	movie_pbo_frames = 0;
+}
+
 void SCR_Movieshot(char *name)
 {
+	if (Movie_IsCapturingPipe())
+	{
+		SCR_MoviePipeFrame();
+		return;
+	}
+
 #ifdef _WIN32
 	if (Movie_IsCapturingAVI())
 	{
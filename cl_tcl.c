@@ -119,6 +119,7 @@ static int TCL_Alias (ClientData data, Tcl_Interp* interp, int objc, Tcl_Obj *co
 	for (a = cmd_alias_hash[h] ; a ; a=a->hash_next) {
 		if (!strcasecmp(s, a->name)) {
 			Q_free (a->value);
+			Cmd_AliasChanged (a);
 			a->flags = 0;
 			break;
 		}
@@ -126,7 +127,7 @@ static int TCL_Alias (ClientData data, Tcl_Interp* interp, int objc, Tcl_Obj *co
 
 	// New alias
 	if (!a) {
-		a = (cmd_alias_t *) Q_malloc (sizeof(cmd_alias_t));
+		a = (cmd_alias_t *) Q_calloc (1, sizeof(cmd_alias_t));
 		a->next = cmd_alias;
 		cmd_alias = a;
 		a->hash_next = cmd_alias_hash[h];
@@ -1025,7 +1025,7 @@ void V_RenderView (void) {
 	r_refdef2.time = cl.time;
 
 	// restrictions
-	r_refdef2.allow_cheats = (Info_ValueForKey(cl.serverinfo, "*cheats")[0] && com_serveractive)
+	r_refdef2.allow_cheats = (Info_Get(&cl._serverinfo_ctx_, "*cheats")[0] && com_serveractive)
 		|| cls.demoplayback;
 	if (cls.demoplayback || cl.spectator)
 	{
@@ -1035,10 +1035,10 @@ void V_RenderView (void) {
 	}
 	else 
 	{
-		r_refdef2.allow_lumas = !strcmp(Info_ValueForKey(cl.serverinfo, "24bit_fbs"), "0") ? false : true;
-		r_refdef2.max_fbskins = *(p = Info_ValueForKey(cl.serverinfo, "fbskins")) ? bound(0, Q_atof(p), 1) :
+		r_refdef2.allow_lumas = !strcmp(Info_Get(&cl._serverinfo_ctx_, "24bit_fbs"), "0") ? false : true;
+		r_refdef2.max_fbskins = *(p = Info_Get(&cl._serverinfo_ctx_, "fbskins")) ? bound(0, Q_atof(p), 1) :
 			cl.teamfortress ? 0 : 1;
-		r_refdef2.max_watervis = *(p = Info_ValueForKey(cl.serverinfo, "watervis")) ? bound(0, Q_atof(p), 1) : 0;
+		r_refdef2.max_watervis = *(p = Info_Get(&cl._serverinfo_ctx_, "watervis")) ? bound(0, Q_atof(p), 1) : 0;
 	}
 
 //	r_refdef2.viewplayernum = Cam_PlayerNum();
@@ -135,6 +135,7 @@ typedef struct player_info_s
 	int		stats[MAX_CL_STATS];
 	byte	translations[VID_GRADES*256];
 	char	userinfo[MAX_INFO_STRING];
+	ctxinfo_t _userinfo_ctx_;       // hashed mirror of userinfo, look keys up here
 	char	team[MAX_INFO_STRING];
 	char	_team[MAX_INFO_STRING];
 
@@ -463,6 +464,7 @@ typedef struct {
 	int			servercount;		///< server identification for prespawns
 
 	char		serverinfo[MAX_SERVERINFO_STRING];
+	ctxinfo_t	_serverinfo_ctx_;	///< hashed mirror of serverinfo, look keys up here
 
 	int			protoversion;
 	// some important serverinfo keys are mirrored here:
@@ -710,6 +712,7 @@ void CL_Disconnect_f (void);
 void CL_Reconnect_f (void);
 qbool CL_ConnectedToProxy(void);
 void CL_MakeActive(void);
+void CL_InputPoll(void);
 
 extern char emodel_name[], pmodel_name[];
 
@@ -896,6 +899,9 @@ void CL_ParsePacketEntities (qbool delta);
 void CL_SetSolidEntities (void);
 void CL_ParsePlayerinfo (void);
 
+extern mvd_predict_t cl_mvdpredict[MAX_CLIENTS]; // MVD_PEXT1_PREDICTEDPLAYERS history of the mvd being played
+void CL_MVDPredictReset (void);
+
 
 void MVD_Interpolate(void);
 void CL_ClearPredict(void);
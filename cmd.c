@@ -39,6 +39,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 qbool CL_CheckServerCommand (void);
 
 static void Cmd_ExecuteStringEx (cbuf_t *context, char *text);
+static void Cmd_ExecuteTokenized (cbuf_t *context);
 static int gtf = 0; // global trigger flag
 
 cvar_t cl_warncmd = {"cl_warncmd", "1"};
@@ -182,6 +183,7 @@ void Cbuf_InsertTextEx (cbuf_t *cbuf, const char *text)
 	if (len <= cbuf->text_start) {
 		memcpy (cbuf->text_buf + (cbuf->text_start - len), text, len);
 		cbuf->text_start -= len;
+		cbuf->text_inserted += len;
 		return;
 	}
 
@@ -198,16 +200,89 @@ void Cbuf_InsertTextEx (cbuf_t *cbuf, const char *text)
 	memcpy (cbuf->text_buf + new_start, text, len);
 	cbuf->text_start = new_start;
 	cbuf->text_end = cbuf->text_start + new_bufsize;
+	cbuf->text_inserted += len;
 }
 
 #define MAX_RUNAWAYLOOP 1000
 
+// Returns the length of the first command in text, which ends at a newline or at a ';'
+// outside quotes and braces. Escaped newlines are turned into '\r', dropped by Cbuf_CopyLine.
+static int Cbuf_LineLength (char *text, int size)
+{
+	int i, quotes = 0;
+	qbool comment = false;
+
+	for (i = 0; i < size; i++)
+	{
+		if (cl_curlybraces.integer)
+		{
+			if (text[i] == '\\')
+			{
+				if (i + 1 < size && text[i+1] == '\n')
+				{ // escaped endline
+					text[i] = text[i+1] = '\r'; // '\r' removed later during copying
+					i++;
+					continue;
+				}
+				else if (i + 2 < size && text[i+1] == '\r' && text[i+2] == '\n')
+				{ // escaped dos endline
+					text[i] = text[i+2] = '\r';
+					i+=2;
+					continue;
+				}
+			}
+		}
+
+		if (text[i] == '\n')
+			break;
+
+		if (text[i] == '"' && quotes <= 0)
+		{
+			if (!quotes)
+				quotes = -1;
+			else
+				quotes = 0;
+		}
+		else if (quotes >= 0)
+		{
+			if (cl_curlybraces.integer)
+			{
+				if (text[i] == '{')
+					quotes++;
+				else if (text[i] == '}')
+					quotes--;
+			}
+		}
+
+		if (comment || quotes)
+			continue;
+
+		if (text[i] == '/' && i + 1 < size && text[i + 1] == '/')
+			comment = true;
+		else if (text[i] == ';' && !quotes)
+			break;
+	}
+
+	return i;
+}
+
+// Copy a command found by Cbuf_LineLength, skipping carriage return chars
+static void Cbuf_CopyLine (char *dest, int dest_size, const char *src, int len)
+{
+	int j = min (len, dest_size - 1);
+
+	for ( ; j; j--, src++)
+	{
+		if (*src != '\r')
+			*dest++ = *src;
+	}
+	*dest = 0;
+}
+
 void Cbuf_ExecuteEx (cbuf_t *cbuf)
 {
-	int i, j, cursize, nextsize;
-	char *text, line[1024], *src, *dest;
-	qbool comment;
-	int quotes;
+	int i, cursize, nextsize;
+	char *text, line[1024];
 
 	if (cbuf == &cbuf_safe)
 		gtf++;
@@ -220,59 +295,7 @@ void Cbuf_ExecuteEx (cbuf_t *cbuf)
 		text = (char *) cbuf->text_buf + cbuf->text_start;
 
 		cursize = cbuf->text_end - cbuf->text_start;
-		comment = false;
-		quotes = 0;
-
-		for (i = 0; i < cursize; i++)
-		{
-			if (cl_curlybraces.integer)
-			{
-				if (text[i] == '\\')
-				{
-					if (i + 1 < cursize && text[i+1] == '\n')
-					{ // escaped endline
-						text[i] = text[i+1] = '\r'; // '\r' removed later during copying
-						i++;
-						continue;
-					}
-					else if (i + 2 < cursize && text[i+1] == '\r' && text[i+2] == '\n')
-					{ // escaped dos endline
-						text[i] = text[i+2] = '\r';
-						i+=2;
-						continue;
-					}
-				}
-			}
-
-			if (text[i] == '\n')
-				break;
-
-			if (text[i] == '"' && quotes <= 0)
-			{
-				if (!quotes)
-					quotes = -1;
-				else
-					quotes = 0;
-			}
-			else if (quotes >= 0)
-			{
-				if (cl_curlybraces.integer)
-				{
-					if (text[i] == '{')
-						quotes++;
-					else if (text[i] == '}')
-						quotes--;
-				}
-			}
-
-			if (comment || quotes)
-				continue;
-
-			if (text[i] == '/' && i + 1 < cursize && text[i + 1] == '/')
-				comment = true;
-			else if (text[i] == ';' && !quotes)
-				break;
-		}
+		i = Cbuf_LineLength (text, cursize);
 
 		if ((cursize - i) < nextsize) // have we reached the next command?
 			nextsize = cursize - i;
@@ -283,16 +306,7 @@ void Cbuf_ExecuteEx (cbuf_t *cbuf)
 		if (cbuf_current == &cbuf_svc && i == cursize)
 			break;
 
-		// Copy text to line, skipping carriage return chars
-		src = text;
-		dest = line;
-		j = min (i, sizeof (line) - 1);
-		for ( ; j; j--, src++)
-		{
-			if (*src != '\r')
-				*dest++ = *src;
-		}
-		*dest = 0;
+		Cbuf_CopyLine (line, sizeof (line), text, i);
 
 		// delete the text from the command buffer and move remaining commands down  This is necessary
 		// because commands (exec, alias) can insert data at the beginning of the text buffer
@@ -731,7 +745,7 @@ static cmd_alias_t* Cmd_AliasCreate (char* name)
 
 	key = Com_HashKey(name) % ALIAS_HASHPOOL_SIZE;
 
-	a = (cmd_alias_t *) Q_malloc(sizeof(cmd_alias_t));
+	a = (cmd_alias_t *) Q_calloc(1, sizeof(cmd_alias_t));
 	a->next = cmd_alias;
 	cmd_alias = a;
 	a->hash_next = cmd_alias_hash[key];
@@ -767,12 +781,13 @@ void Cmd_Alias_f (void)
 	for (a = cmd_alias_hash[key]; a; a = a->hash_next) {
 		if (!strcasecmp(a->name, s)) {
 			Q_free(a->value);
+			Cmd_AliasChanged(a);
 			break;
 		}
 	}
 
 	if (!a)	{
-		a = (cmd_alias_t *) Q_malloc(sizeof(cmd_alias_t));
+		a = (cmd_alias_t *) Q_calloc(1, sizeof(cmd_alias_t));
 		a->next = cmd_alias;
 		cmd_alias = a;
 		a->hash_next = cmd_alias_hash[key];
@@ -835,6 +850,7 @@ qbool Cmd_DeleteAlias (char *name)
 				cmd_alias = a->next;
 
 			// free
+			Cmd_AliasChanged(a);
 			Q_free(a->value);
 			Q_free(a);
 			return true;
@@ -920,6 +936,7 @@ void Cmd_UnAliasAll_f (void)
 	} else {
 		for (a = cmd_alias; a ; a = next) {
 			next = a->next;
+			Cmd_AliasChanged(a);
 			Q_free(a->value);
 			Q_free(a);
 		}
@@ -1018,7 +1035,8 @@ static qbool Cmd_LegacyCommand (void)
 =============================================================================
 */
 
-#define CMD_HASHPOOL_SIZE 512
+#define CMD_HASHPOOL_SIZE 2048
+#define CMD_HASH_SLOT(hash) ((hash) & (CMD_HASHPOOL_SIZE - 1))
 cmd_function_t	*cmd_hash_array[CMD_HASHPOOL_SIZE];
 /*static*/ cmd_function_t	*cmd_functions;		// possible commands to execute
 
@@ -1156,6 +1174,7 @@ void Cmd_AddCommand (char *cmd_name, xcommand_t function)
 {
 	cmd_function_t *cmd;
 	int	key;
+	unsigned int hash;
 
 	/* commented out when vid_restart was added
 	if (host_initialized)	// because hunk allocation would get stomped
@@ -1168,11 +1187,12 @@ void Cmd_AddCommand (char *cmd_name, xcommand_t function)
 		return;
 	} */
 
-	key = Com_HashKey (cmd_name) % CMD_HASHPOOL_SIZE;
+	hash = Com_HashKey (cmd_name);
+	key = CMD_HASH_SLOT(hash);
 
 	// fail if the command already exists
 	for (cmd = cmd_hash_array[key]; cmd; cmd=cmd->hash_next) {
-		if (!strcasecmp (cmd_name, cmd->name)) {
+		if (cmd->hash == hash && !strcasecmp (cmd_name, cmd->name)) {
 			Com_Printf ("Cmd_AddCommand: %s already defined\n", cmd_name);
 			return;
 		}
@@ -1184,6 +1204,7 @@ void Cmd_AddCommand (char *cmd_name, xcommand_t function)
 	cmd->zmalloced = false;
 	cmd->next = cmd_functions;
 	cmd_functions = cmd;
+	cmd->hash = hash;
 	cmd->hash_next = cmd_hash_array[key];
 	cmd_hash_array[key] = cmd;
 }
@@ -1192,12 +1213,14 @@ qbool Cmd_AddRemCommand (char *cmd_name, xcommand_t function)
 {
 	cmd_function_t *cmd;
 	int	key;
+	unsigned int hash;
 
-	key = Com_HashKey (cmd_name) % CMD_HASHPOOL_SIZE;
+	hash = Com_HashKey (cmd_name);
+	key = CMD_HASH_SLOT(hash);
 
 	// fail if the command already exists
 	for (cmd = cmd_hash_array[key]; cmd; cmd=cmd->hash_next) {
-		if (!strcasecmp (cmd_name, cmd->name)) {
+		if (cmd->hash == hash && !strcasecmp (cmd_name, cmd->name)) {
 			Com_Printf ("Cmd_AddCommand: %s already defined\n", cmd_name);
 			return false;
 		}
@@ -1210,6 +1233,7 @@ qbool Cmd_AddRemCommand (char *cmd_name, xcommand_t function)
 	cmd->next = cmd_functions;
 	cmd->zmalloced = true;
 	cmd_functions = cmd;
+	cmd->hash = hash;
 	cmd->hash_next = cmd_hash_array[key];
 	cmd_hash_array[key] = cmd;
 
@@ -1219,7 +1243,7 @@ qbool Cmd_AddRemCommand (char *cmd_name, xcommand_t function)
 // removes command from the hash map of the commands
 cmd_function_t *Cmd_RemoveCommand_Hash(char *cmd_name)
 {
-	int key = Com_HashKey (cmd_name) % CMD_HASHPOOL_SIZE;
+	int key = CMD_HASH_SLOT(Com_HashKey (cmd_name));
 	cmd_function_t *cmd = cmd_hash_array[key];
 	cmd_function_t *prev = NULL;
 	cmd_function_t *retval = NULL;
@@ -1286,25 +1310,16 @@ void Cmd_RemoveCommand (char *cmd_name)
 
 qbool Cmd_Exists (char *cmd_name)
 {
-	int	key;
-	cmd_function_t	*cmd;
-
-	key = Com_HashKey (cmd_name) % CMD_HASHPOOL_SIZE;
-	for (cmd=cmd_hash_array[key]; cmd; cmd = cmd->hash_next) {
-		if (!strcasecmp (cmd_name, cmd->name))
-			return true;
-	}
-	return false;
+	return Cmd_FindCommand (cmd_name) != NULL;
 }
 
 cmd_function_t *Cmd_FindCommand (const char *cmd_name)
 {
-	int	key;
+	unsigned int hash = Com_HashKey (cmd_name);
 	cmd_function_t *cmd;
 
-	key = Com_HashKey (cmd_name) % CMD_HASHPOOL_SIZE;
-	for (cmd = cmd_hash_array[key]; cmd; cmd = cmd->hash_next) {
-		if (!strcasecmp (cmd_name, cmd->name))
+	for (cmd = cmd_hash_array[CMD_HASH_SLOT(hash)]; cmd; cmd = cmd->hash_next) {
+		if (cmd->hash == hash && !strcasecmp (cmd_name, cmd->name))
 			return cmd;
 	}
 	return NULL;
@@ -1481,7 +1496,8 @@ char *Cmd_MacroString (const char *s, int *macro_length)
 			if (cbuf_current == &cbuf_main && (macro->teamplay == MACRO_DISALLOWED))
 				cbuf_current = &cbuf_formatted_comms;
 			*macro_length = strlen (macro->name);
-			return macro->func();
+			// most macros share one buffer, give each expansion its own copy
+			return Frame_Strdup (macro->func());
 		}
 		macro++;
 	}
@@ -1700,29 +1716,333 @@ static qbool Cmd_IsCommandAllowedInTeamPlayMacros( const char *command )
 	return *s != NULL;
 }
 
-//A complete command line has been parsed, so try to execute it
-static void Cmd_ExecuteStringEx (cbuf_t *context, char *text)
+/*
+=============================================================================
+					COMPILED ALIASES
+=============================================================================
+*/
+
+// An alias body is split into lines the way Cbuf_ExecuteEx would split it once it's
+// inserted into a buffer. Lines without $macros are tokenized up front as well, since
+// expanding them changes nothing. The result stays attached to the alias until its
+// value changes, see Cmd_AliasChanged.
+
+#define MAX_ALIAS_DEPTH		16
+
+typedef struct cmd_aliasline_s {
+	char	*text;
+	qbool	expand;				// has $, expanded and tokenized each time it runs
+	int		argc;
+	int		argv_ofs[MAX_ARGS];
+	int		argv_len;
+	char	*argv_buf;
+	char	*args;
+} cmd_aliasline_t;
+
+typedef struct cmd_aliasprog_s {
+	int				refcount;	// the alias and each run in progress
+	int				curlybraces;	// cl_curlybraces the lines were split and tokenized with
+	int				numlines;
+	cmd_aliasline_t	*lines;
+} cmd_aliasprog_t;
+
+static int cmd_aliasdepth;
+static qbool cmd_aliascompile = true;
+
+static cmd_aliasprog_t *Cmd_CompileAlias (const char *value)
+{
+	static tokenizecontext_t ctx;
+	cmd_aliasprog_t *prog;
+	cmd_aliasline_t *line;
+	char *copy, *text, buf[1024];
+	int i, len, size;
+
+	prog = (cmd_aliasprog_t *) Q_calloc (1, sizeof (cmd_aliasprog_t));
+	prog->refcount = 1;
+	prog->curlybraces = cl_curlybraces.integer;
+
+	text = copy = Q_strdup (value);
+	size = strlen (copy);
+
+	while (size > 0) {
+		len = Cbuf_LineLength (text, size);
+		Cbuf_CopyLine (buf, sizeof (buf), text, len);
+
+		text += len + 1;
+		size -= len + 1;
+
+		if (!strchr (buf, '$')) {
+			Cmd_TokenizeStringEx (&ctx, buf);
+			if (!ctx.cmd_argc)
+				continue;
+		}
+
+		prog->lines = (cmd_aliasline_t *) Q_realloc (prog->lines, (prog->numlines + 1) * sizeof (cmd_aliasline_t));
+		line = &prog->lines[prog->numlines++];
+		memset (line, 0, sizeof (*line));
+		line->text = Q_strdup (buf);
+
+		if (strchr (buf, '$')) {
+			line->expand = true;
+			continue;
+		}
+
+		line->argc = ctx.cmd_argc;
+		for (i = 0; i < ctx.cmd_argc; i++) {
+			line->argv_ofs[i] = ctx.cmd_argv[i] - ctx.argv_buf;
+			line->argv_len = line->argv_ofs[i] + strlen (ctx.cmd_argv[i]) + 1;
+		}
+		line->argv_buf = (char *) Q_malloc (line->argv_len);
+		memcpy (line->argv_buf, ctx.argv_buf, line->argv_len);
+		line->args = Q_strdup (ctx.cmd_args);
+	}
+
+	Q_free (copy);
+	return prog;
+}
+
+static void Cmd_ReleaseAliasProg (cmd_aliasprog_t *prog)
+{
+	int i;
+
+	if (!prog || --prog->refcount > 0)
+		return;
+
+	for (i = 0; i < prog->numlines; i++) {
+		Q_free (prog->lines[i].text);
+		Q_free (prog->lines[i].argv_buf);
+		Q_free (prog->lines[i].args);
+	}
+	Q_free (prog->lines);
+	Q_free (prog);
+}
+
+// Must be called whenever the value of an alias is replaced or edited.
+void Cmd_AliasChanged (cmd_alias_t *a)
+{
+	Cmd_ReleaseAliasProg (a->prog);
+	a->prog = NULL;
+}
+
+// Puts the lines from first on back into the buffer, behind whatever the last line queued
+// at the front (exec, a deep alias...) and ahead of what was already there.
+static void Cmd_RequeueAliasLines (cbuf_t *cbuf, cmd_aliasprog_t *prog, int first, int queued, int oldsize)
+{
+	char *rest, *front = NULL;
+	int i, len = 1;
+
+	for (i = first; i < prog->numlines; i++)
+		len += strlen (prog->lines[i].text) + 1;
+
+	rest = (char *) Q_malloc (len);
+	rest[0] = 0;
+	for (i = first; i < prog->numlines; i++) {
+		strlcat (rest, prog->lines[i].text, len);
+		strlcat (rest, "\n", len);
+	}
+
+	// if the buffer was also partly executed in the meantime there's no telling what's new, put the rest first
+	if (queued > 0 && cbuf->text_end - cbuf->text_start >= oldsize + queued) {
+		front = (char *) Q_malloc (queued + 1);
+		memcpy (front, cbuf->text_buf + cbuf->text_start, queued);
+		front[queued] = 0;
+		cbuf->text_start += queued;
+	}
+
+	Cbuf_InsertTextEx (cbuf, rest);
+	if (front) {
+		Cbuf_InsertTextEx (cbuf, front);
+		cbuf->text_inserted -= queued;	// only moved, callers further up shouldn't count it twice
+	}
+
+	Q_free (front);
+	Q_free (rest);
+}
+
+static void Cmd_ExecuteAlias (cbuf_t *context, cmd_alias_t *a)
+{
+	tokenizecontext_t *ctx = &cmd_tokenizecontext;
+	cmd_aliasprog_t *prog;
+	cmd_aliasline_t *line;
+	cbuf_t *oldcontext;
+	int i, j, oldsize, inserted;
+
+	if (a->prog && a->prog->curlybraces != cl_curlybraces.integer)
+		Cmd_AliasChanged (a);
+	if (!a->prog)
+		a->prog = Cmd_CompileAlias (a->value);
+
+	// each run counts against the buffer's runaway budget like an alias inserted into it does,
+	// so a recursive alias is caught just as early when it doesn't grow the buffer
+	if (++context->runAwayLoop > MAX_RUNAWAYLOOP)
+		return;
+
+	// the alias may be redefined by its own lines
+	prog = a->prog;
+	prog->refcount++;
+	cmd_aliasdepth++;
+
+	for (i = 0; i < prog->numlines; i++) {
+		// a nested run went over the budget, Cbuf_ExecuteEx clears the buffer once we are back
+		if (context->runAwayLoop > MAX_RUNAWAYLOOP)
+			break;
+
+		line = &prog->lines[i];
+		oldsize = context->text_end - context->text_start;
+		inserted = context->text_inserted;
+
+		if (line->expand) {
+			Cmd_ExecuteStringEx (context, line->text);
+		} else {
+			ctx->cmd_argc = line->argc;
+			memcpy (ctx->argv_buf, line->argv_buf, line->argv_len);
+			for (j = 0; j < line->argc; j++)
+				ctx->cmd_argv[j] = ctx->argv_buf + line->argv_ofs[j];
+			strlcpy (ctx->cmd_args, line->args, sizeof (ctx->cmd_args));
+
+			oldcontext = cbuf_current;
+			cbuf_current = context;
+			Cmd_ExecuteTokenized (context);
+			cbuf_current = oldcontext;
+		}
+
+		// anything the line queued or a wait has to be honoured before the rest of the alias
+		if (i + 1 < prog->numlines && (context->wait || context->text_inserted != inserted)) {
+			Cmd_RequeueAliasLines (context, prog, i + 1, context->text_inserted - inserted, oldsize);
+			break;
+		}
+	}
+
+	cmd_aliasdepth--;
+	Cmd_ReleaseAliasProg (prog);
+}
+
+// Runs an alias count times from a private buffer, with and without compiled aliases.
+static void Cmd_AliasBench_f (void)
+{
+	static char text[1 << 14];
+	char name[MAX_ALIAS_NAME];
+	double start, times[2];
+	int i, pass, count;
+	cbuf_t cbuf;
+
+	if (Cmd_Argc() < 2) {
+		Com_Printf ("Usage: %s <alias> [count]\n", Cmd_Argv(0));
+		return;
+	}
+
+	if (!Cmd_FindAlias (Cmd_Argv(1))) {
+		Com_Printf ("%s: no such alias \"%s\"\n", Cmd_Argv(0), Cmd_Argv(1));
+		return;
+	}
+
+	strlcpy (name, Cmd_Argv(1), sizeof (name));
+	count = (Cmd_Argc() > 2) ? max (1, Q_atoi (Cmd_Argv(2))) : 1000;
+
+	for (pass = 0; pass < 2; pass++) {
+		cmd_aliascompile = !pass;
+		start = Sys_DoubleTime ();
+		for (i = 0; i < count; i++) {
+			memset (&cbuf, 0, sizeof (cbuf));
+			cbuf.text_buf = text;
+			cbuf.maxsize = sizeof (text);
+			cbuf.text_start = cbuf.text_end = (cbuf.maxsize >> 1);
+
+			Cbuf_AddTextEx (&cbuf, name);
+			Cbuf_AddTextEx (&cbuf, "\n");
+			Cbuf_ExecuteEx (&cbuf);
+		}
+		times[pass] = Sys_DoubleTime () - start;
+	}
+	cmd_aliascompile = true;
+
+	Com_Printf ("%s x%d: compiled %.3f ms, interpreted %.3f ms\n", name, count, times[0] * 1000.0, times[1] * 1000.0);
+}
+
+static double Cmd_LookupBenchNames (char **names, int numnames, int count, qbool cvars)
+{
+	double start = Sys_DoubleTime ();
+	int i, j, found = 0;
+
+	for (i = 0; i < count; i++) {
+		for (j = 0; j < numnames; j++) {
+			if (cvars ? (Cvar_Find (names[j]) != NULL) : (Cmd_FindCommand (names[j]) != NULL))
+				found++;
+		}
+	}
+
+	// keep the lookups from being optimised away
+	if (found < 0)
+		Com_Printf ("%d\n", found);
+
+	return Sys_DoubleTime () - start;
+}
+
+// times Cvar_Find and Cmd_FindCommand over every registered name, and over the same names with a suffix so every lookup misses
+static void Cmd_LookupBench_f (void)
+{
+	char **names, **misses;
+	int i, count, numcvars = 0, numcmds = 0, maxchain = 0, chain;
+	double hit, miss;
+	cmd_function_t *cmd;
+	cvar_t *var;
+
+	count = (Cmd_Argc() > 1) ? max (1, Q_atoi (Cmd_Argv(1))) : 100;
+
+	for (var = Cvar_Next (NULL); var; var = Cvar_Next (var))
+		numcvars++;
+	for (cmd = cmd_functions; cmd; cmd = cmd->next)
+		numcmds++;
+
+	names = (char **) Q_malloc ((numcvars + numcmds) * sizeof (char *));
+	misses = (char **) Q_malloc ((numcvars + numcmds) * sizeof (char *));
+
+	for (i = 0, var = Cvar_Next (NULL); var; var = Cvar_Next (var), i++) {
+		names[i] = var->name;
+		misses[i] = Q_strdup (va ("%s_", var->name));
+	}
+	for (cmd = cmd_functions; cmd; cmd = cmd->next, i++) {
+		names[i] = cmd->name;
+		misses[i] = Q_strdup (va ("%s_", cmd->name));
+	}
+
+	hit = Cmd_LookupBenchNames (names, numcvars, count, true);
+	miss = Cmd_LookupBenchNames (misses, numcvars, count, true);
+	Com_Printf ("cvars    %5d: hit %.1f ns, miss %.1f ns per lookup\n", numcvars,
+		hit * 1e9 / max (1, numcvars * count), miss * 1e9 / max (1, numcvars * count));
+
+	hit = Cmd_LookupBenchNames (names + numcvars, numcmds, count, false);
+	miss = Cmd_LookupBenchNames (misses + numcvars, numcmds, count, false);
+	for (i = 0; i < CMD_HASHPOOL_SIZE; i++) {
+		for (chain = 0, cmd = cmd_hash_array[i]; cmd; cmd = cmd->hash_next)
+			chain++;
+		maxchain = max (maxchain, chain);
+	}
+	Com_Printf ("commands %5d: hit %.1f ns, miss %.1f ns per lookup, longest chain %d\n", numcmds,
+		hit * 1e9 / max (1, numcmds * count), miss * 1e9 / max (1, numcmds * count), maxchain);
+
+	for (i = 0; i < numcvars + numcmds; i++)
+		Q_free (misses[i]);
+	Q_free (misses);
+	Q_free (names);
+}
+
+//A complete command line has been tokenized, so try to execute it
+static void Cmd_ExecuteTokenized (cbuf_t *context)
 {
 	cvar_t *v;
 	cmd_function_t *cmd;
 	cmd_alias_t *a;
 	static char buf[1024];
-	cbuf_t *inserttarget, *oldcontext;
+	cbuf_t *inserttarget;
 	char *p, *n, *s;
-	char text_exp[1024];
-
-	oldcontext = cbuf_current;
-	cbuf_current = context;
-
-	Cmd_ExpandString (text, text_exp);
-	Cmd_TokenizeString (text_exp);
 
 	if (!Cmd_Argc())
-		goto done; // no tokens
+		return; // no tokens
 
 	if (cbuf_current == &cbuf_svc) {
 		if (CL_CheckServerCommand())
-			goto done;
+			return;
 	}
 
 	// check functions
@@ -1730,12 +2050,12 @@ static void Cmd_ExecuteStringEx (cbuf_t *context, char *text)
 		if (gtf || cbuf_current == &cbuf_safe) {
 			if (!Cmd_IsCommandAllowedInMessageTrigger(Cmd_Argv(0))) {
 				Com_Printf ("\"%s\" cannot be used in message triggers\n", Cmd_Argv(0));
-				goto done;
+				return;
 			}
 		} else if (cbuf_current == &cbuf_formatted_comms) {
 			if (!Cmd_IsCommandAllowedInTeamPlayMacros(Cmd_Argv(0))) {
 				Com_Printf ("\"%s\" cannot be used in combination with teamplay $macros\n", Cmd_Argv(0));
-				goto done;
+				return;
 			}
 		}
 
@@ -1743,7 +2063,7 @@ static void Cmd_ExecuteStringEx (cbuf_t *context, char *text)
 			cmd->function();
 		else
 			Cmd_ForwardToServer ();
-		goto done;
+		return;
 	}
 
 	// some bright guy decided to use "skill" as a mod command in Custom TF, sigh
@@ -1754,10 +2074,10 @@ static void Cmd_ExecuteStringEx (cbuf_t *context, char *text)
 	if ((v = Cvar_Find(Cmd_Argv(0)))) {
 		if (cbuf_current == &cbuf_formatted_comms) {
 			Com_Printf ("\"%s\" cannot be used in combination with teamplay $macros\n", Cmd_Argv(0));
-			goto done;
+			return;
 		}
 		if (Cvar_Command())
-			goto done;
+			return;
 	}
 
 	// check aliases
@@ -1769,11 +2089,11 @@ checkaliases:
 		if (a->flags & ALIAS_TCL)
 		{
 			TCL_ExecuteAlias (a);
-			goto done;
+			return;
 		}
 #endif
 
-		if (a->value[0]=='\0') goto done; // alias is empty.
+		if (a->value[0]=='\0') return; // alias is empty.
 
 		if(a->flags & ALIAS_HAS_PARAMETERS) { // %parameters are given in alias definition
 			s=a->value;
@@ -1823,6 +2143,15 @@ checkaliases:
 		} else
 		{
 			inserttarget = cbuf_current ? cbuf_current : &cbuf_main;
+
+			// the alias text would be executed straight away from the front of this buffer,
+			// so run its compiled lines instead of going through the buffer
+			if (inserttarget == context && p == a->value && Cmd_Argc() == 1 && host_initialized
+				&& cmd_aliasdepth < MAX_ALIAS_DEPTH && cmd_aliascompile) {
+				Cmd_ExecuteAlias (context, a);
+				return;
+			}
+
 			Cbuf_InsertTextEx (inserttarget, "\n");
 
 			// if the alias value is a command or cvar and
@@ -1835,15 +2164,15 @@ checkaliases:
 			}
 			Cbuf_InsertTextEx (inserttarget, p);
 		}
-		goto done;
+		return;
 	}
 
 	if (Cmd_LegacyCommand())
-		goto done;
+		return;
 
 	if (!host_initialized && Cmd_Argc() > 1) {
 		if (Cvar_CreateTempVar())
-			goto done;
+			return;
 	}
 
 	if (cbuf_current != &cbuf_svc)
@@ -1851,8 +2180,21 @@ checkaliases:
 		if (cl_warncmd.integer || developer.integer)
 			Com_Printf ("Unknown command \"%s\"\n", Cmd_Argv(0));
 	}
+}
+
+//A complete command line has been parsed, so try to execute it
+static void Cmd_ExecuteStringEx (cbuf_t *context, char *text)
+{
+	cbuf_t *oldcontext;
+	char text_exp[1024];
+
+	oldcontext = cbuf_current;
+	cbuf_current = context;
+
+	Cmd_ExpandString (text, text_exp);
+	Cmd_TokenizeString (text_exp);
+	Cmd_ExecuteTokenized (context);
 
-done:
 	cbuf_current = oldcontext;
 }
 
@@ -2219,6 +2561,7 @@ void Cmd_Alias_In_f (void)
 	}
 
 	Q_free(alias->value);
+	Cmd_AliasChanged(alias);
 	alias->value = Q_strdup(buf);
 	if (strchr(buf, '%'))
 		alias->flags |= ALIAS_HAS_PARAMETERS;
@@ -2254,6 +2597,8 @@ void Cmd_Alias_Out_f (void)
 			Com_Printf ("alias_out: not found\n");
 		return;
 	}
+
+	Cmd_AliasChanged(alias);
 }
 
 void Cmd_Cvar_In_f (void)
@@ -2357,6 +2702,8 @@ void Cmd_Init (void)
 	Cmd_AddCommand ("alias", Cmd_Alias_f);
 	Cmd_AddCommand ("tempalias", Cmd_Alias_f);
 	Cmd_AddCommand ("viewalias", Cmd_Viewalias_f);
+	Cmd_AddCommand ("aliasbench", Cmd_AliasBench_f);
+	Cmd_AddCommand ("lookupbench", Cmd_LookupBench_f);
 	Cmd_AddCommand ("unaliasall", Cmd_UnAliasAll_f);
 	Cmd_AddCommand ("unalias", Cmd_UnAlias_f);
 	Cmd_AddCommand ("unalias_re", Cmd_UnAlias_re_f);
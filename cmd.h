@@ -40,6 +40,7 @@ typedef struct cbuf_s {
 	qbool	wait;
 	int     waitCount;
 	int		runAwayLoop;
+	int		text_inserted;	// bytes ever inserted at the front, lets compiled aliases see what a command queued
 } cbuf_t;
 
 extern cbuf_t cbuf_main;
@@ -86,6 +87,7 @@ typedef struct cmd_function_s {
 	char					*name;
 	xcommand_t				function;
 	qbool                   zmalloced;
+	unsigned int            hash;       // Com_HashKey(name)
 } cmd_function_t;
 
 void Cmd_Init (void);
@@ -202,11 +204,13 @@ typedef struct cmd_alias_s {
 	char				name[MAX_ALIAS_NAME];
 	char				*value;
 	int					flags;
+	struct cmd_aliasprog_s	*prog;			// value split and tokenized, built on first use
 } cmd_alias_t;
 
 qbool Cmd_DeleteAlias (char *name);	// return true if successful
 cmd_alias_t *Cmd_FindAlias (const char *name); // returns NULL on failure
 char *Cmd_AliasString (char *name); // returns NULL on failure
+void Cmd_AliasChanged (cmd_alias_t *a); // drops the compiled form, call before replacing a->value
 
 void DeleteServerAliases (void);
 
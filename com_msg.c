@@ -254,6 +254,130 @@ void MSG_WriteDeltaUsercmd (sizebuf_t *buf, struct usercmd_s *from, struct userc
 	MSG_WriteByte (buf, cmd->msec);
 }
 
+/*
+==============================================================================
+	MVD_PEXT1_PREDICTEDPLAYERS
+
+Player origins are quantised to 1/8 units and angles to 1/65536 turns, exactly
+like MSG_WriteCoord and MSG_WriteAngle16 do, and only the difference to a
+prediction is written: origins are extrapolated from the last two writes,
+angles are expected to stay where they were. Differences are zigzag varints,
+which keeps small ones in a single byte, and a clear DF_ORIGIN/DF_ANGLES bit
+means the value is the prediction itself. Writer and reader must see the same
+sequence of writes for each player, DF_PREDICTRESET starts over.
+==============================================================================
+*/
+
+static int MSG_PredictCoord (float f)
+{
+	return (short) (f >= 0 ? f * 8 + 0.5f : f * 8 - 0.5f);
+}
+
+static int MSG_PredictAngle (float f)
+{
+	return (short) (Q_rint(f * 65536.0 / 360.0) & 65535);
+}
+
+static void MSG_Predict (const mvd_predict_t *p, int origin[3], int angles[3])
+{
+	int i;
+
+	for (i = 0; i < 3; i++)
+	{
+		if (p->history >= 2)
+			origin[i] = 2 * p->origin[0][i] - p->origin[1][i];
+		else
+			origin[i] = p->origin[0][i];
+		angles[i] = p->angles[i];
+	}
+}
+
+static void MSG_PredictUpdate (mvd_predict_t *p, const int origin[3], const int angles[3])
+{
+	VectorCopy (p->origin[0], p->origin[1]);
+	VectorCopy (origin, p->origin[0]);
+	VectorCopy (angles, p->angles);
+	p->history = min (p->history + 1, 2);
+}
+
+void MSG_PredictReset (mvd_predict_t *p)
+{
+	memset (p, 0, sizeof (*p));
+}
+
+// What 'p' remembers, 'back' 0 is the last origin and 1 the one before.
+void MSG_PredictHistory (const mvd_predict_t *p, int back, vec3_t origin, vec3_t angles)
+{
+	int i;
+
+	back = bound (0, back, 1);
+	for (i = 0; i < 3; i++)
+	{
+		origin[i] = p->origin[back][i] / 8.0f;
+		angles[i] = (short) p->angles[i] * (360.0 / 65536);
+	}
+}
+
+// Returns the DF_ORIGIN and DF_ANGLES bits of the components which are not what 'p' predicts.
+int MSG_PredictFlags (const mvd_predict_t *p, const vec3_t origin, const vec3_t angles)
+{
+	int i, flags = 0, porigin[3], pangles[3];
+
+	MSG_Predict (p, porigin, pangles);
+
+	for (i = 0; i < 3; i++)
+	{
+		if (MSG_PredictCoord (origin[i]) != porigin[i])
+			flags |= DF_ORIGIN << i;
+		if ((short) (MSG_PredictAngle (angles[i]) - pangles[i]))
+			flags |= DF_ANGLES << i;
+	}
+
+	return flags;
+}
+
+void MSG_WriteSignedVarint (sizebuf_t *sb, int c)
+{
+	unsigned int u = (c < 0) ? ~((unsigned int) c << 1) : (unsigned int) c << 1;
+
+	for ( ; u >= 0x80; u >>= 7)
+		MSG_WriteByte (sb, (u & 0x7f) | 0x80);
+	MSG_WriteByte (sb, u);
+}
+
+// Writes the origin and angles components flagged in 'flags', anything else is taken as predicted.
+void MSG_WritePredicted (sizebuf_t *sb, mvd_predict_t *p, int flags, const vec3_t origin, const vec3_t angles)
+{
+	int i, porigin[3], pangles[3], qorigin[3], qangles[3];
+
+	if (flags & DF_PREDICTRESET)
+		MSG_PredictReset (p);
+
+	MSG_Predict (p, porigin, pangles);
+
+	for (i = 0; i < 3; i++)
+	{
+		qorigin[i] = porigin[i];
+		if (flags & (DF_ORIGIN << i))
+		{
+			qorigin[i] = MSG_PredictCoord (origin[i]);
+			MSG_WriteSignedVarint (sb, qorigin[i] - porigin[i]);
+		}
+	}
+
+	for (i = 0; i < 3; i++)
+	{
+		qangles[i] = pangles[i];
+		if (flags & (DF_ANGLES << i))
+		{
+			qangles[i] = MSG_PredictAngle (angles[i]);
+			MSG_WriteSignedVarint (sb, (short) (qangles[i] - pangles[i]));
+		}
+	}
+
+	MSG_PredictUpdate (p, qorigin, qangles);
+}
+
 //Writes part of a packetentities message.
 //Can delta from either a baseline or a previous packet_entity
 void MSG_WriteDeltaEntity (entity_state_t *from, entity_state_t *to, sizebuf_t *msg, qbool force, unsigned int fte_extensions, unsigned int mvdsv_extensions)
@@ -690,6 +814,50 @@ void MSG_ReadDeltaUsercmd (usercmd_t *from, usercmd_t *move, int protoversion)
 	}
 }
 
+int MSG_ReadSignedVarint (void)
+{
+	unsigned int u = 0;
+	int c, shift;
+
+	for (shift = 0; shift < 32; shift += 7)
+	{
+		if ((c = MSG_ReadByte ()) == -1)
+			break;
+		u |= (unsigned int) (c & 0x7f) << shift;
+		if (!(c & 0x80))
+			break;
+	}
+
+	return (u & 1) ? (int) ~(u >> 1) : (int) (u >> 1);
+}
+
+// Counterpart of MSG_WritePredicted.
+void MSG_ReadPredicted (mvd_predict_t *p, int flags, vec3_t origin, vec3_t angles)
+{
+	int i, qorigin[3], qangles[3];
+
+	if (flags & DF_PREDICTRESET)
+		MSG_PredictReset (p);
+
+	MSG_Predict (p, qorigin, qangles);
+
+	for (i = 0; i < 3; i++)
+	{
+		if (flags & (DF_ORIGIN << i))
+			qorigin[i] += MSG_ReadSignedVarint ();
+		origin[i] = qorigin[i] / 8.0f;
+	}
+
+	for (i = 0; i < 3; i++)
+	{
+		if (flags & (DF_ANGLES << i))
+			qangles[i] = (short) (qangles[i] + MSG_ReadSignedVarint ());
+		angles[i] = qangles[i] * (360.0 / 65536);
+	}
+
+	MSG_PredictUpdate (p, qorigin, qangles);
+}
+
 void MSG_ReadData (void *data, int len)
 {
 	int	i;
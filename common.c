@@ -1055,6 +1055,8 @@ qbool Info_SetStar (ctxinfo_t *ctx, const char *name, const char *value)
 	if (strlen(name) >= MAX_KEY_STRING || strlen(value) >= MAX_KEY_STRING)
 		return false; // too long name/value, its wrong
 
+	ctx->serialized_valid = false;
+
 	key = Info_HashKey(name) % INFO_HASHPOOL_SIZE;
 
 	// if already exists, reuse it
@@ -1171,6 +1173,8 @@ qbool Info_Remove (ctxinfo_t *ctx, const char *name)
 	if (!a)
 		return false;	// not found
 
+	ctx->serialized_valid = false;
+
 	prev = NULL;
 	for (a = ctx->info_list; a; a = a->next)
 	{
@@ -1215,6 +1219,10 @@ void Info_RemoveAll (ctxinfo_t *ctx)
 
 	// clear hash
 	memset (ctx->info_hash, 0, sizeof(ctx->info_hash));
+
+	Q_free (ctx->serialized);
+	ctx->serialized_len = 0;
+	ctx->serialized_valid = false;
 }
 
 qbool Info_Convert(ctxinfo_t *ctx, char *str)
@@ -1259,6 +1267,15 @@ qbool Info_ReverseConvert(ctxinfo_t *ctx, char *str, int size)
 	if (!str || size < 1)
 		return false;
 
+	Info_Serialized(ctx, NULL);
+
+	if (ctx->serialized_len < size)
+	{
+		memcpy(str, ctx->serialized, ctx->serialized_len + 1);
+		return true;
+	}
+
+	// does not fit, fill in as much as we can like we always did
 	str[0] = 0;
 
 	for (a = ctx->info_list; a; a = a->next)
@@ -1282,6 +1299,118 @@ qbool Info_ReverseConvert(ctxinfo_t *ctx, char *str, int size)
 	return true;
 }
 
+const char *Info_Serialized(ctxinfo_t *ctx, int *len)
+{
+	info_t *a;
+	char *o;
+	int size;
+
+	if (!ctx)
+	{
+		if (len)
+			*len = 0;
+		return "";
+	}
+
+	if (!ctx->serialized_valid)
+	{
+		size = 0;
+		for (a = ctx->info_list; a; a = a->next)
+		{
+			if (a->value[0])
+				size += 2 + strlen(a->name) + strlen(a->value);
+		}
+
+		ctx->serialized = (char *) Q_realloc(ctx->serialized, size + 1);
+		o = ctx->serialized;
+
+		for (a = ctx->info_list; a; a = a->next)
+		{
+			if (a->value[0])
+				o += sprintf(o, "\\%s\\%s", a->name, a->value);
+		}
+		*o = 0;
+
+		ctx->serialized_len = size;
+		ctx->serialized_valid = true;
+	}
+
+	if (len)
+		*len = ctx->serialized_len;
+
+	return ctx->serialized;
+}
+
+void Info_Mirror(ctxinfo_t *ctx, const char *str)
+{
+	const char *start, *name, *value;
+	int name_len, value_len, key;
+	info_t *a;
+
+	if (!ctx)
+		return;
+
+	Info_RemoveAll(ctx);
+
+	if (!str)
+		str = "";
+	start = str;
+
+	// same walk as Info_ValueForKey()
+	if (*str == '\\')
+		str++;
+
+	while (*str)
+	{
+		name = str;
+		while (*str && *str != '\\')
+			str++;
+		if (!*str)
+			break; // key without a value
+		name_len = str++ - name;
+
+		value = str;
+		while (*str && *str != '\\')
+			str++;
+		value_len = str - value;
+
+		if (*str)
+			str++;
+
+		if (!name_len)
+			continue;
+
+		// the first occurrence of a key is the one Info_ValueForKey() would find
+		a = (info_t *) Q_malloc (sizeof(info_t));
+		a->name = (char *) Q_malloc (name_len + 1);
+		memcpy(a->name, name, name_len);
+		a->name[name_len] = 0;
+
+		if (_Info_Get(ctx, a->name))
+		{
+			Q_free (a->name);
+			Q_free (a);
+			continue;
+		}
+
+		a->value = (char *) Q_malloc (value_len + 1);
+		memcpy(a->value, value, value_len);
+		a->value[value_len] = 0;
+
+		key = Info_HashKey(a->name) % INFO_HASHPOOL_SIZE;
+		a->next = ctx->info_list;
+		ctx->info_list = a;
+		a->hash_next = ctx->info_hash[key];
+		ctx->info_hash[key] = a;
+		ctx->cur++;
+	}
+
+	// the source string is already the serialized form
+	ctx->serialized = Q_strdup(start);
+	ctx->serialized_len = strlen(start);
+	ctx->serialized_valid = true;
+}
+
 qbool Info_CopyStar(ctxinfo_t *ctx_from, ctxinfo_t *ctx_to)
 {
 	info_t *a;
@@ -256,6 +256,10 @@ typedef struct ctxinfo_s {
 	int		cur; // current infos
 	int		max; // max    infos
 
+	char	*serialized;		// cached "\\key\\value" form, rebuilt on demand after a change
+	int		serialized_len;
+	qbool	serialized_valid;
+
 } ctxinfo_t;
 
 // return value for given key
@@ -274,6 +278,11 @@ qbool			Info_Convert(ctxinfo_t *ctx, char *str);
 qbool			Info_ReverseConvert(ctxinfo_t *ctx, char *str, int size);
 // copy star keys from ont ctx to other
 qbool			Info_CopyStar(ctxinfo_t *ctx_from, ctxinfo_t *ctx_to);
+// return the cached info string, rebuilding it only if something changed since the last call
+const char		*Info_Serialized(ctxinfo_t *ctx, int *len);
+// replace ctx contents with the pairs of a legacy info string, verbatim and without filtering,
+// so Info_Get() answers like Info_ValueForKey() on that string (first key wins)
+void			Info_Mirror(ctxinfo_t *ctx, const char *str);
 // just print all key value pairs
 void			Info_PrintList(ctxinfo_t *ctx);
 
@@ -363,6 +372,20 @@ void MSG_WriteAngle16 (sizebuf_t *sb, float f);
 void MSG_WriteDeltaUsercmd (sizebuf_t *sb, struct usercmd_s *from, struct usercmd_s *cmd);
 void MSG_WriteDeltaEntity  (entity_state_t *from, entity_state_t *to, sizebuf_t *msg, qbool force, unsigned int fte_extensions, unsigned int mvdsv_extensions);
 
+// MVD_PEXT1_PREDICTEDPLAYERS, what the writer and reader of a player's origin and angles remember
+typedef struct mvd_predict_s
+{
+	int		origin[2][3];	// last two origins, in 1/8 units
+	int		angles[3];		// last angles, in 1/65536 turns
+	int		history;		// origins known, up to 2
+} mvd_predict_t;
+
+void MSG_PredictReset (mvd_predict_t *p);
+void MSG_PredictHistory (const mvd_predict_t *p, int back, vec3_t origin, vec3_t angles);
+int MSG_PredictFlags (const mvd_predict_t *p, const vec3_t origin, const vec3_t angles);
+void MSG_WriteSignedVarint (sizebuf_t *sb, int c);
+void MSG_WritePredicted (sizebuf_t *sb, mvd_predict_t *p, int flags, const vec3_t origin, const vec3_t angles);
+
 extern	int	msg_readcount;
 extern	qbool	msg_badread; // set if a read goes beyond end of message
 
@@ -381,6 +404,8 @@ float MSG_ReadFloatCoord (void);
 float MSG_ReadAngle (void);
 float MSG_ReadAngle16 (void);
 void MSG_ReadDeltaUsercmd (struct usercmd_s *from, struct usercmd_s *cmd, int protoversion);
+int MSG_ReadSignedVarint (void);
+void MSG_ReadPredicted (mvd_predict_t *p, int flags, vec3_t origin, vec3_t angles);
 
 void MSG_ReadData (void *data, int len);
 void MSG_ReadSkip(int bytes);
@@ -420,6 +445,7 @@ void Con_Init (void);
 void SV_Init (void);
 void SV_Shutdown (char *finalmsg);
 void SV_Frame (double time);
+void SV_DiskIO_Frame (double frametime);
 
 void SV_Error (char *error, ...);
 
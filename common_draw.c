@@ -436,17 +436,17 @@ void SCR_DrawClients(void)
 		snprintf (buf, sizeof (buf), "%-*.*s ", 16-uid_w, 16-uid_w, cl.players[i].name);
 		strlcat (line, buf, sizeof (line));
 
-		snprintf(buf, sizeof (buf), "%-4.4s ", Info_ValueForKey(cl.players[i].userinfo, "team"));
+		snprintf(buf, sizeof (buf), "%-4.4s ", Info_Get(&cl.players[i]._userinfo_ctx_, "team"));
 		strlcat (line, buf, sizeof (line));
 
 		if (cl.players[i].spectator)
 			strlcpy (buf, "<spec>   ", sizeof (buf));
 		else
-			snprintf (buf, sizeof (buf), "%-8.8s ", Info_ValueForKey(cl.players[i].userinfo, "skin"));
+			snprintf (buf, sizeof (buf), "%-8.8s ", Info_Get(&cl.players[i]._userinfo_ctx_, "skin"));
 
 		strlcat (line, buf, sizeof (line));
 
-		snprintf (buf, sizeof (buf), "%4d", min(9999, atoi(Info_ValueForKey(cl.players[i].userinfo, "rate"))));
+		snprintf (buf, sizeof (buf), "%4d", min(9999, atoi(Info_Get(&cl.players[i]._userinfo_ctx_, "rate"))));
 		strlcat (line, buf, sizeof (line));
 
 		Draw_String (x, y, line);
@@ -801,7 +801,7 @@ char* SCR_GetGameTime(int t)
 	static char str[9];
 	float timelimit;
 
-	timelimit = (t == TIMETYPE_GAMECLOCKINV) ? 60 * Q_atof(Info_ValueForKey(cl.serverinfo, "timelimit")) + 1: 0;
+	timelimit = (t == TIMETYPE_GAMECLOCKINV) ? 60 * Q_atof(Info_Get(&cl._serverinfo_ctx_, "timelimit")) + 1: 0;
 
 	if (cl.countdown || cl.standby)
 		strlcpy (str, SecondsToMinutesString(timelimit), sizeof(str));
@@ -47,11 +47,15 @@ cvar_t	cvar_viewdefault = {"cvar_viewdefault", "1"};
 cvar_t	cvar_viewhelp    = {"cvar_viewhelp",    "1"};
 cvar_t  cvar_viewlatched = {"cvar_viewlatched", "1"};
 
-#define VAR_HASHPOOL_SIZE 1024
+#define VAR_HASHPOOL_SIZE 4096
 
 static void Cvar_AddCvarToGroup(cvar_t *var);
 #endif
 
+// pool sizes are powers of two so the slot is just the low bits of the full hash,
+// the full hash is kept in each cvar so chain walks rarely need a strcasecmp
+#define VAR_HASH_SLOT(hash) ((hash) & (VAR_HASHPOOL_SIZE - 1))
+
 static cvar_t *cvar_hash[VAR_HASHPOOL_SIZE];
 cvar_t *cvar_vars;
 static char	*cvar_null_string = "";
@@ -68,10 +72,10 @@ cvar_t *Cvar_Next (cvar_t *var)
 cvar_t *Cvar_Find (const char *var_name)
 {
 	cvar_t *var;
-	int key = Com_HashKey (var_name) % VAR_HASHPOOL_SIZE;
+	unsigned int hash = Com_HashKey (var_name);
 
-	for (var = cvar_hash[key]; var; var = var->hash_next) {
-		if (!strcasecmp(var_name, var->name)) {
+	for (var = cvar_hash[VAR_HASH_SLOT(hash)]; var; var = var->hash_next) {
+		if (var->hash == hash && !strcasecmp(var_name, var->name)) {
 			return var;
 		}
 	}
@@ -322,7 +326,8 @@ void Cvar_Register (cvar_t *var)
 	}
 
 	// link the variable in
-	key = Com_HashKey (var->name);
+	var->hash = Com_HashKey (var->name);
+	key = VAR_HASH_SLOT(var->hash);
 	var->hash_next = cvar_hash[key];
 	cvar_hash[key] = var;
 	var->next = cvar_vars;
@@ -391,7 +396,8 @@ void Cvar_Register (cvar_t *var)
 	var->modified = true;
 
 	// link the variable in
-	key = Com_HashKey (var->name) % VAR_HASHPOOL_SIZE;
+	var->hash = Com_HashKey (var->name);
+	key = VAR_HASH_SLOT(var->hash);
 	var->hash_next = cvar_hash[key];
 	cvar_hash[key] = var;
 	var->next = cvar_vars;
@@ -630,7 +636,8 @@ cvar_t *Cvar_Create(const char *name, const char *string, int cvarflags)
 	v->next = cvar_vars;
 	cvar_vars = v;
 
-	key = Com_HashKey(name) % VAR_HASHPOOL_SIZE;
+	v->hash = Com_HashKey(name);
+	key = VAR_HASH_SLOT(v->hash);
 	v->hash_next = cvar_hash[key];
 	cvar_hash[key] = v;
 
@@ -659,10 +666,11 @@ cvar_t *Cvar_Create(const char *name, const char *string, int cvarflags)
 qbool Cvar_Delete(const char *name)
 {
 	cvar_t *var, *prev = NULL;
-	int key = Com_HashKey(name) % VAR_HASHPOOL_SIZE;
+	unsigned int hash = Com_HashKey(name);
+	int key = VAR_HASH_SLOT(hash);
 
 	for (var = cvar_hash[key]; var; var = var->hash_next) {
-		if (!strcasecmp(var->name, name)) {
+		if (var->hash == hash && !strcasecmp(var->name, name)) {
 			// unlink from hash
 			if (prev) {
 				prev->hash_next = var->hash_next;
@@ -68,6 +68,7 @@ typedef struct cvar_s {
 	struct cvar_s       *next_in_group;
 #endif
 
+	unsigned int  hash;         // Com_HashKey(name), set when the var is linked in
 	struct cvar_s *hash_next;
 	struct cvar_s *next;
 } cvar_t;
@@ -499,7 +499,7 @@ static void Stats_ParsePrintLine(char *s, cfrags_format *cff)
 		if (!player1->name[0] || player1->spectator)
 			continue;
 
-		name1 = Info_ValueForKey(player1->userinfo, "name");
+		name1 = Info_Get(&player1->_userinfo_ctx_, "name");
 		p1len = min(strlen(name1), 31);
 		
 		if (!strncmp(start, name1, p1len)) 
@@ -548,7 +548,7 @@ static void Stats_ParsePrintLine(char *s, cfrags_format *cff)
 							if (!player2->name[0] || player2->spectator)
 								continue;
 							
-							name2 = Info_ValueForKey(player2->userinfo, "name");
+							name2 = Info_Get(&player2->_userinfo_ctx_, "name");
 							p2len = min(strlen(name2), 31);
 						
 							if (!strncmp(start, name2, p2len)) 
@@ -1371,43 +1371,75 @@ int FS_GZipUnpack (char *source_path,		// The path to the compressed source file
 }
 
 //
-// Unpack a .gz file to a temp file.
+// Inflates a gzip file straight into a memory file, takes over the source file.
+// Demos compressed while they are recorded are flushed now and then, so a file
+// that is cut short or still being written is read up to where it ends.
+// Concatenated gzip members are read one after another like gzip does.
 //
-int FS_GZipUnpackToTemp (char *source_path,		// The compressed source file.
-						  char *unpack_path,		// A buffer that will contain the path to the unpacked file.
-						  int unpack_path_size,		// The size of the buffer.
-						  char *append_extension)	// The extension if any that should be appended to the filename.
+vfsfile_t *FS_GZipUnpackToMemory (vfsfile_t *source)
 {
-	int retval;
-	// Get a unique temp filename.
-	if (COM_GetUniqueTempFilename (NULL, unpack_path, unpack_path_size, true) < 0)
+	unsigned char in[CHUNK];
+	byte *out = NULL;
+	size_t out_size = 0, out_allocated = 0;
+	z_stream strm;
+	vfserrno_t err;
+	int ret;
+
+	memset (&strm, 0, sizeof (strm));
+
+	// 32 + window bits expects a gzip header.
+	if (inflateInit2 (&strm, 32 + MAX_WBITS) != Z_OK)
 	{
-		return 0;
+		VFS_CLOSE (source);
+		return NULL;
 	}
 
-	// Delete the existing temp file (it is created when the filename is received above).
-	retval = unlink (unpack_path);
-	if (retval == -1 && qerrno != ENOENT)
+	while (true)
 	{
-		unpack_path[0] = 0;
-		return 0;
-	}
+		if (!strm.avail_in)
+		{
+			if ((int) (strm.avail_in = VFS_READ (source, in, sizeof (in), &err)) <= 0)
+			{
+				strm.avail_in = 0;
+				break; // end of the file, complete or not
+			}
+			strm.next_in = in;
+		}
 
-	// Append the extension if any.
-	if (append_extension != NULL) {
-		char tmp_path[MAX_OSPATH];
-		snprintf(&tmp_path[0], sizeof(tmp_path), "%s%s", unpack_path, append_extension);
-		strlcpy (unpack_path, tmp_path, unpack_path_size);
+		if (out_allocated - out_size < CHUNK)
+		{
+			out_allocated = max (2 * out_allocated, 4 * CHUNK);
+			out = (byte *) Q_realloc (out, out_allocated);
+		}
+
+		strm.next_out = out + out_size;
+		strm.avail_out = out_allocated - out_size;
+		ret = inflate (&strm, Z_NO_FLUSH);
+		out_size = strm.next_out - out;
+
+		if (ret == Z_STREAM_END)
+		{
+			// another member may follow
+			inflateReset (&strm);
+		}
+		else if (ret != Z_OK && ret != Z_BUF_ERROR)
+		{
+			break;
+		}
 	}
 
-	// Unpack the file.
-	if (!FS_GZipUnpack (source_path, unpack_path, true))
+	inflateEnd (&strm);
+	VFS_CLOSE (source);
+
+	// whatever came out before a broken part is still usable
+	if (!out_size)
 	{
-		unpack_path[0] = 0;
-		return 0;
+		Com_Printf ("Couldn't decompress gz file\n");
+		Q_free (out);
+		return NULL;
 	}
 
-	return 1;
+	return FSMMAP_OpenVFS (out, out_size);
 }
 
 //
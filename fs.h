@@ -123,10 +123,7 @@ int FS_GZipUnpack (char *source_path,		// The path to the compressed source file
 					char *destination_path, // The destination file path.
 					qbool overwrite);		// Overwrite the destination file if it exists?
 
-int FS_GZipUnpackToTemp (char *source_path,		// The compressed source file.
-						  char *unpack_path,		// A buffer that will contain the path to the unpacked file.
-						  int unpack_path_size,		// The size of the buffer.	
-						  char *append_extension);	// The extension if any that should be appended to the filename.
+vfsfile_t *FS_GZipUnpackToMemory (vfsfile_t *source);
 
 int FS_ZlibInflate(FILE *source, FILE *dest);
 
@@ -1951,7 +1951,7 @@ void Draw_FadeScreen (float alpha)
 // Call before beginning any disc IO.
 void Draw_BeginDisc (void)
 {
-	if (!draw_disc)
+	if (!draw_disc || Framebuffer_OffscreenActive())
 		return;
 
 	// Intel cards, most notably Intel 915GM/910GML has problems with
@@ -16,11 +16,12 @@ You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-#if defined(FRAMEBUFFERS)
-
 // Loads and does all the framebuffer stuff
 #include "quakedef.h"
-#include "gl_framebuffer.h"
+#include "gl_model.h"
+#include "gl_local.h"
+
+#if defined(FRAMEBUFFERS)
 
 cvar_t	framebuffer		= {"framebuffer", "0"};
 /*
@@ -314,3 +315,63 @@ void Framebuffer_Draw (fb_t *fbs)
 }
 #endif // FRAMEBUFFERS
 
+//
+// Offscreen target for headless capture. The framebuffer is bound once and stays bound,
+// nothing else in the renderer binds framebuffers, so every draw and glReadPixels uses it.
+// Objects belong to the GL context, a vid_restart creates a new one through VID_Init.
+//
+static GLuint offscreen_fb, offscreen_color, offscreen_depth;
+
+qbool Framebuffer_OffscreenInit (int width, int height)
+{
+	qbool packed = CheckExtension("GL_EXT_packed_depth_stencil");
+	GLenum status;
+
+	offscreen_fb = offscreen_color = offscreen_depth = 0;
+
+	if (!gl_support_fbo)
+	{
+		return false;
+	}
+
+	qglGenFramebuffers(1, &offscreen_fb);
+	qglGenRenderbuffers(1, &offscreen_color);
+	qglGenRenderbuffers(1, &offscreen_depth);
+
+	qglBindFramebuffer(GL_FRAMEBUFFER_EXT, offscreen_fb);
+
+	qglBindRenderbuffer(GL_RENDERBUFFER_EXT, offscreen_color);
+	qglRenderbufferStorage(GL_RENDERBUFFER_EXT, GL_RGBA8, width, height);
+	qglFramebufferRenderbuffer(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_RENDERBUFFER_EXT, offscreen_color);
+
+	// Shadows and some HUD elements use the stencil buffer.
+	qglBindRenderbuffer(GL_RENDERBUFFER_EXT, offscreen_depth);
+	qglRenderbufferStorage(GL_RENDERBUFFER_EXT, packed ? GL_DEPTH24_STENCIL8_EXT : GL_DEPTH_COMPONENT24, width, height);
+	qglFramebufferRenderbuffer(GL_FRAMEBUFFER_EXT, GL_DEPTH_ATTACHMENT_EXT, GL_RENDERBUFFER_EXT, offscreen_depth);
+	if (packed)
+	{
+		qglFramebufferRenderbuffer(GL_FRAMEBUFFER_EXT, GL_STENCIL_ATTACHMENT_EXT, GL_RENDERBUFFER_EXT, offscreen_depth);
+	}
+	qglBindRenderbuffer(GL_RENDERBUFFER_EXT, 0);
+
+	status = qglCheckFramebufferStatus(GL_FRAMEBUFFER_EXT);
+	if (status != GL_FRAMEBUFFER_COMPLETE_EXT)
+	{
+		Com_Printf("Offscreen framebuffer %dx%d is not supported (0x%x)\n", width, height, status);
+		qglBindFramebuffer(GL_FRAMEBUFFER_EXT, 0);
+		qglDeleteRenderbuffers(1, &offscreen_depth);
+		qglDeleteRenderbuffers(1, &offscreen_color);
+		qglDeleteFramebuffers(1, &offscreen_fb);
+		offscreen_fb = offscreen_color = offscreen_depth = 0;
+		return false;
+	}
+
+	glViewport(0, 0, width, height);
+	Com_Printf("Rendering offscreen at %dx%d\n", width, height);
+	return true;
+}
+
+qbool Framebuffer_OffscreenActive (void)
+{
+	return offscreen_fb != 0;
+}
@@ -78,4 +78,17 @@ extern fb_t	main_fb; // The main framebuffer that can be used generally to draw
 extern qbool use_framebuffer;
 
 #endif // FRAMEBUFFERS
+
+//
+// Redirects all rendering into an offscreen framebuffer object of the given size,
+// used when capturing demos headless (-capturedemo) with a hidden window.
+// Returns false if the driver can't provide one, headless capture can't run without it.
+//
+qbool Framebuffer_OffscreenInit (int width, int height);
+
+//
+// True if rendering goes to the offscreen target instead of the window.
+//
+qbool Framebuffer_OffscreenActive (void);
+
 #endif // __GL_FRAMEBUFFER_H__
@@ -47,9 +47,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #endif // __APPLE__
 
 #include "gl_texture.h"
-#ifdef FRAMEBUFFERS
 #include "gl_framebuffer.h"
-#endif
 
 #ifndef APIENTRY
 #define APIENTRY
@@ -80,6 +78,7 @@ extern	int glx, gly, glwidth, glheight;
 #define BACKFACE_EPSILON	0.01
 
 void R_TimeRefresh_f (void);
+void R_SetFrustum (void);
 texture_t *R_TextureAnimation (texture_t *base);
 
 //====================================================
@@ -111,7 +110,6 @@ extern	entity_t	r_worldentity;
 extern	qbool	r_cache_thrash;		// compatability
 extern	vec3_t		modelorg, r_entorigin;
 extern	entity_t	*currententity;
-extern	int			r_visframecount;
 extern	int			r_framecount;
 extern	mplane_t	frustum[4];
 extern	int			c_brush_polys, c_alias_polys;
@@ -161,6 +159,7 @@ extern	cvar_t	r_mirroralpha;
 extern	cvar_t	r_wateralpha;
 extern	cvar_t	r_dynamic;
 extern	cvar_t	r_novis;
+extern	cvar_t	r_pvscache;
 extern	cvar_t	r_netgraph;
 extern	cvar_t	r_netstats;
 extern	cvar_t	r_fullbrightSkins;
@@ -268,6 +267,8 @@ void R_RotateForEntity (entity_t *e);
 void R_PolyBlend (void);
 void R_BrightenScreen (void);
 void R_DrawEntitiesOnList (visentlist_t *vislist);
+void R_AliasSetupLighting (entity_t *ent);
+void R_TimeAlias_f (void);
 
 void GL_PolygonOffset (float factor, float units);
 
@@ -290,6 +291,8 @@ void GL_MakeAliasModelDisplayLists (model_t *m, aliashdr_t *hdr);
 void EmitDetailPolys (void);
 void R_DrawBrushModel (entity_t *e);
 void R_DrawWorld (void);
+void R_TimeWorld_f (void);
+void R_FlushPVSCache (void);
 void R_DrawWaterSurfaces (void);
 void R_DrawAlphaChain (void);
 void GL_BuildLightmaps (void);
@@ -336,6 +339,12 @@ void R_InitOtherTextures(void);
 #define GL_NUM_COMPRESSED_TEXTURE_FORMATS_ARB	0x86A2
 #define GL_COMPRESSED_TEXTURE_FORMATS_ARB		0x86A3
 
+//s3tc texture compression
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT			0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT		0x83F3
+#endif
+
 //sRGB gamma correction
 #define GL_SRGB8 0x8C41
 #define GL_SRGB8_ALPHA8 0x8C43
@@ -348,9 +357,42 @@ void R_InitOtherTextures(void);
 
 typedef void (APIENTRY *lpMTexFUNC) (GLenum, GLfloat, GLfloat);
 typedef void (APIENTRY *lpSelTexFUNC) (GLenum);
+typedef void (APIENTRY *lpCompressedTexImage2DFUNC) (GLenum, GLint, GLenum, GLsizei, GLsizei, GLint, GLsizei, const GLvoid *);
+typedef void (APIENTRY *lpGenBuffersFUNC) (GLsizei, GLuint *);
+typedef void (APIENTRY *lpDeleteBuffersFUNC) (GLsizei, const GLuint *);
+typedef void (APIENTRY *lpBindBufferFUNC) (GLenum, GLuint);
+typedef void (APIENTRY *lpBufferDataFUNC) (GLenum, GLsizeiptrARB, const GLvoid *, GLenum);
+typedef GLvoid * (APIENTRY *lpMapBufferFUNC) (GLenum, GLenum);
+typedef GLboolean (APIENTRY *lpUnmapBufferFUNC) (GLenum);
+typedef void (APIENTRY *lpGenFramebuffersFUNC) (GLsizei, GLuint *);
+typedef void (APIENTRY *lpDeleteFramebuffersFUNC) (GLsizei, const GLuint *);
+typedef void (APIENTRY *lpBindFramebufferFUNC) (GLenum, GLuint);
+typedef GLenum (APIENTRY *lpCheckFramebufferStatusFUNC) (GLenum);
+typedef void (APIENTRY *lpFramebufferRenderbufferFUNC) (GLenum, GLenum, GLenum, GLuint);
+typedef void (APIENTRY *lpGenRenderbuffersFUNC) (GLsizei, GLuint *);
+typedef void (APIENTRY *lpDeleteRenderbuffersFUNC) (GLsizei, const GLuint *);
+typedef void (APIENTRY *lpBindRenderbufferFUNC) (GLenum, GLuint);
+typedef void (APIENTRY *lpRenderbufferStorageFUNC) (GLenum, GLenum, GLsizei, GLsizei);
 
 extern lpMTexFUNC qglMultiTexCoord2f;
 extern lpSelTexFUNC qglActiveTexture;
+extern lpSelTexFUNC qglClientActiveTexture;
+extern lpCompressedTexImage2DFUNC qglCompressedTexImage2D;
+extern lpGenBuffersFUNC qglGenBuffers;
+extern lpDeleteBuffersFUNC qglDeleteBuffers;
+extern lpBindBufferFUNC qglBindBuffer;
+extern lpBufferDataFUNC qglBufferData;
+extern lpMapBufferFUNC qglMapBuffer;
+extern lpUnmapBufferFUNC qglUnmapBuffer;
+extern lpGenFramebuffersFUNC qglGenFramebuffers;
+extern lpDeleteFramebuffersFUNC qglDeleteFramebuffers;
+extern lpBindFramebufferFUNC qglBindFramebuffer;
+extern lpCheckFramebufferStatusFUNC qglCheckFramebufferStatus;
+extern lpFramebufferRenderbufferFUNC qglFramebufferRenderbuffer;
+extern lpGenRenderbuffersFUNC qglGenRenderbuffers;
+extern lpDeleteRenderbuffersFUNC qglDeleteRenderbuffers;
+extern lpBindRenderbufferFUNC qglBindRenderbuffer;
+extern lpRenderbufferStorageFUNC qglRenderbufferStorage;
 
 extern float gldepthmin, gldepthmax;
 extern byte color_white[4], color_black[4];
@@ -358,6 +400,9 @@ extern qbool gl_mtexable;
 extern int gl_textureunits;
 extern qbool gl_combine, gl_add_ext;
 extern qbool gl_support_arb_texture_non_power_of_two;
+extern qbool gl_support_s3tc;
+extern qbool gl_support_pbo;
+extern qbool gl_support_fbo;
 
 qbool CheckExtension (const char *extension);
 void Check_Gamma (unsigned char *pal);
@@ -299,6 +299,7 @@ void Mod_LoadAlias3Model (model_t *mod, void *buffer, int filesize)
 	char tenebraeskinname[128];
 	extern char loadname[];
 	int					start, end, total;
+	void *cache;
 	int numsurfs;
 	int numskins;
 	int surfn;
@@ -491,10 +492,9 @@ void Mod_LoadAlias3Model (model_t *mod, void *buffer, int filesize)
 	end = Hunk_LowMark ();
 	total = end - start;
 	
-	Cache_Alloc (&mod->cache, total, loadname);
-	if (!mod->cache.data)
+	if (!(cache = Cache_Alloc (&mod->cache, total, loadname, CACHE_MODEL)))
 		return;
-	memcpy (mod->cache.data, pheader, total);
+	memcpy (cache, pheader, total);
 
 	// try load simple textures
 	memset(mod->simpletexture, 0, sizeof(mod->simpletexture));
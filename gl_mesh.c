@@ -278,6 +278,107 @@ void BuildTris (void)
 }
 
 
+/*
+================
+GL_MakeAliasModelArrays
+
+Unpacks the command list into float poses and a triangle list for vertex arrays.
+Strips and fans share their vertexes, except where a vertex on the seam is used by
+a back facing triangle and so gets a different s coordinate.
+================
+*/
+static void GL_MakeAliasModelArrays (void)
+{
+	static int	arrayvert[MAXALIASVERTS * 2];	// command list vertex + back seam -> array vertex
+	static int	arraysrc[MAXALIASVERTS * 2];	// array vertex -> model vertex
+	int			i, j, k, n, count, first, tri, numarrayverts, numindexes;
+	qbool		fan;
+	int			*order, *arrayorder;
+	unsigned short *indexes;
+	float		s, t, *texcoords, *poses;
+	byte		*normals;
+	trivertx_t	*tv;
+
+	for (i = 0; i < paliashdr->numverts * 2; i++)
+		arrayvert[i] = -1;
+
+	arrayorder = (int *) Hunk_Alloc (numorder * sizeof(int));
+	texcoords = (float *) Hunk_Alloc (numorder * 2 * sizeof(float));
+	indexes = (unsigned short *) Hunk_Alloc (paliashdr->numtris * 3 * sizeof(unsigned short));
+
+	numarrayverts = numindexes = 0;
+	for (order = commands, j = 0; (count = *order++); )
+	{
+		if ((fan = (count < 0)))
+			count = -count;
+		first = j;
+
+		for (k = 0; k < count; k++, j++, order += 2)
+		{
+			s = ((float *) order)[0];
+			t = ((float *) order)[1];
+
+			for (n = vertexorder[j]; n < paliashdr->numverts * 2; n += paliashdr->numverts)
+			{
+				if (arrayvert[n] < 0)
+				{
+					arrayvert[n] = numarrayverts;
+					arraysrc[numarrayverts] = vertexorder[j];
+					texcoords[numarrayverts * 2] = s;
+					texcoords[numarrayverts * 2 + 1] = t;
+					numarrayverts++;
+					break;
+				}
+				if (texcoords[arrayvert[n] * 2] == s && texcoords[arrayvert[n] * 2 + 1] == t)
+					break;
+			}
+			// a vertex only ever has two s coordinates, front and back of the seam
+			if (n >= paliashdr->numverts * 2)
+				n -= paliashdr->numverts;
+			arrayorder[j] = arrayvert[n];
+		}
+
+		// keep the winding GL would use for the strip or fan
+		for (tri = 0; tri < count - 2 && numindexes + 3 <= paliashdr->numtris * 3; tri++)
+		{
+			if (fan)
+			{
+				indexes[numindexes++] = arrayorder[first];
+				indexes[numindexes++] = arrayorder[first + tri + 1];
+				indexes[numindexes++] = arrayorder[first + tri + 2];
+			}
+			else
+			{
+				indexes[numindexes++] = arrayorder[first + tri + (tri & 1)];
+				indexes[numindexes++] = arrayorder[first + tri + !(tri & 1)];
+				indexes[numindexes++] = arrayorder[first + tri + 2];
+			}
+		}
+	}
+
+	poses = (float *) Hunk_Alloc (paliashdr->numposes * numarrayverts * 3 * sizeof(float));
+	normals = (byte *) Hunk_Alloc (paliashdr->numposes * numarrayverts);
+	for (i = 0; i < paliashdr->numposes; i++)
+	{
+		for (k = 0; k < numarrayverts; k++)
+		{
+			tv = &poseverts[i][arraysrc[k]];
+			poses[(i * numarrayverts + k) * 3] = tv->v[0];
+			poses[(i * numarrayverts + k) * 3 + 1] = tv->v[1];
+			poses[(i * numarrayverts + k) * 3 + 2] = tv->v[2];
+			normals[i * numarrayverts + k] = tv->lightnormalindex;
+		}
+	}
+
+	paliashdr->numarrayverts = numarrayverts;
+	paliashdr->arrayposes = (byte *) poses - (byte *) paliashdr;
+	paliashdr->arraynormals = normals - (byte *) paliashdr;
+	paliashdr->arraytexcoords = (byte *) texcoords - (byte *) paliashdr;
+	paliashdr->arrayorder = (byte *) arrayorder - (byte *) paliashdr;
+	paliashdr->numindexes = numindexes;
+	paliashdr->indexes = (byte *) indexes - (byte *) paliashdr;
+}
+
 /*
 ================
 GL_MakeAliasModelDisplayLists
@@ -312,5 +413,7 @@ void GL_MakeAliasModelDisplayLists (model_t *m, aliashdr_t *hdr)
 		for (j=0 ; j<numorder ; j++)
 	//TODO: corrupted files may cause a crash here, sanity checks?
 			*verts++ = poseverts[i][vertexorder[j]];
+
+	GL_MakeAliasModelArrays ();
 }
 
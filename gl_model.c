@@ -65,9 +65,9 @@ void *Mod_Extradata (model_t *mod) {
 
 	Mod_LoadModel (mod, true);
 
-	if (!mod->cache.data)
+	if (!(r = Cache_Check (&mod->cache)))
 		Sys_Error ("Mod_Extradata: caching failed");
-	return mod->cache.data;
+	return r;
 }
 
 mleaf_t *Mod_PointInLeaf (vec3_t p, model_t *model) {
@@ -1653,6 +1653,141 @@ void *Mod_BSPX_FindLump(char *lumpname, int *plumpsize)
 
 //============================================================
 
+/*
+=================
+Mod_BuildRenderTree
+
+Repacks the world node tree into flat arrays (see mrendertree_t), so R_MarkLeaves
+and R_RecursiveWorldNode walk a few dense arrays instead of chasing mnode_t pointers.
+=================
+*/
+static int Mod_RenderTreeAddNode (mrendertree_t *tree, mnode_t *node, int parent, int *nextnode)
+{
+	int i, index;
+
+	if (node->contents < 0) {
+		index = tree->numnodes + ((mleaf_t *) node - loadmodel->leafs);
+		tree->parent[index] = parent;
+		return index;
+	}
+
+	index = (*nextnode)++;
+
+	for (i = 0; i < 3; i++) {
+		tree->mins[i][index] = node->minmaxs[i];
+		tree->maxs[i][index] = node->minmaxs[3 + i];
+	}
+	tree->contents[index] = node->contents;
+	tree->parent[index] = parent;
+	tree->planes[index] = node->plane;
+	tree->firstsurface[index] = node->firstsurface;
+	tree->numsurfaces[index] = node->numsurfaces;
+
+	// front child directly follows its parent in memory
+	tree->children[0][index] = Mod_RenderTreeAddNode (tree, node->children[0], index, nextnode);
+	tree->children[1][index] = Mod_RenderTreeAddNode (tree, node->children[1], index, nextnode);
+
+	return index;
+}
+
+static void Mod_BuildRenderTree (void)
+{
+	mrendertree_t *tree;
+	mleaf_t *leaf;
+	int i, j, total, nextnode = 0;
+
+	tree = (mrendertree_t *) Hunk_AllocName (sizeof(*tree), loadname);
+	tree->numnodes = loadmodel->numnodes;
+	tree->numleafs = loadmodel->numleafs;
+	total = tree->numnodes + tree->numleafs;
+
+	for (i = 0; i < 3; i++) {
+		tree->mins[i] = (float *) Hunk_AllocName (total * sizeof(float), loadname);
+		tree->maxs[i] = (float *) Hunk_AllocName (total * sizeof(float), loadname);
+	}
+	tree->contents = (int *) Hunk_AllocName (total * sizeof(int), loadname);
+	tree->visleafs = (int *) Hunk_AllocName (total * sizeof(int), loadname);
+	tree->parent = (int *) Hunk_AllocName (total * sizeof(int), loadname);
+
+	tree->planes = (mplane_t **) Hunk_AllocName (tree->numnodes * sizeof(mplane_t *), loadname);
+	tree->children[0] = (int *) Hunk_AllocName (tree->numnodes * sizeof(int), loadname);
+	tree->children[1] = (int *) Hunk_AllocName (tree->numnodes * sizeof(int), loadname);
+	tree->firstsurface = (int *) Hunk_AllocName (tree->numnodes * sizeof(int), loadname);
+	tree->numsurfaces = (int *) Hunk_AllocName (tree->numnodes * sizeof(int), loadname);
+	tree->curvis = (unsigned *) Hunk_AllocName (((tree->numleafs + 31) >> 5) * sizeof(unsigned), loadname);
+
+	for (i = 0; i < total; i++)
+		tree->parent[i] = -1;
+
+	for (i = 0, leaf = loadmodel->leafs; i < tree->numleafs; i++, leaf++) {
+		for (j = 0; j < 3; j++) {
+			tree->mins[j][tree->numnodes + i] = leaf->minmaxs[j];
+			tree->maxs[j][tree->numnodes + i] = leaf->minmaxs[3 + j];
+		}
+		tree->contents[tree->numnodes + i] = leaf->contents;
+	}
+
+	if (tree->numnodes)
+		Mod_RenderTreeAddNode (tree, loadmodel->nodes, -1, &nextnode);
+
+	loadmodel->rendertree = tree;
+}
+
+static int Mod_SurfaceGroupCompare (const void *a, const void *b)
+{
+	const msurface_t *s1 = *(const msurface_t **) a;
+	const msurface_t *s2 = *(const msurface_t **) b;
+
+	if (s1->texinfo->texture != s2->texinfo->texture)
+		return (s1->texinfo->texture < s2->texinfo->texture) ? -1 : 1;
+	if (s1->lightmaptexturenum != s2->lightmaptexturenum)
+		return s1->lightmaptexturenum - s2->lightmaptexturenum;
+
+	return (s1 < s2) ? -1 : (s1 > s2);
+}
+
+/*
+=================
+Mod_BuildSurfaceGroups
+
+Sorts the opaque world surfaces by texture and lightmap into static ranges,
+R_ChainWorldSurfaces links the visible ones from there in lightmap order.
+Must run after lightmaps are allocated, so it's called from GL_BuildLightmaps.
+=================
+*/
+void Mod_BuildSurfaceGroups (model_t *model)
+{
+	msurface_t *surf;
+	msurfacegroup_t *group = NULL;
+	int i, count = 0;
+
+	if (!model->groupsurfaces)
+		return;
+
+	for (i = 0, surf = model->surfaces + model->firstmodelsurface; i < model->nummodelsurfaces; i++, surf++) {
+		if (surf->flags & (SURF_DRAWSKY | SURF_DRAWTURB | SURF_DRAWALPHA))
+			continue;
+		model->groupsurfaces[count++] = surf;
+	}
+
+	qsort (model->groupsurfaces, count, sizeof(msurface_t *), Mod_SurfaceGroupCompare);
+
+	model->numsurfacegroups = 0;
+	for (i = 0; i < count; i++) {
+		surf = model->groupsurfaces[i];
+
+		if (!group || group->texture != surf->texinfo->texture || group->lightmaptexturenum != surf->lightmaptexturenum) {
+			group = &model->surfacegroups[model->numsurfacegroups++];
+			group->texture = surf->texinfo->texture;
+			group->lightmaptexturenum = surf->lightmaptexturenum;
+			group->firstsurface = i;
+			group->numsurfaces = 0;
+		}
+
+		group->numsurfaces++;
+	}
+}
+
 void Mod_LoadBrushModel (model_t *mod, void *buffer, int filesize) {
 	int i;
 	dheader_t *header;
@@ -1717,6 +1852,17 @@ void Mod_LoadBrushModel (model_t *mod, void *buffer, int filesize) {
 	}
 	Mod_LoadSubmodels (&header->lumps[LUMP_MODELS]);
 
+	Mod_BuildRenderTree ();
+
+	// filled in by Mod_BuildSurfaceGroups once lightmaps are allocated
+	mod->numsurfacegroups = 0;
+	mod->surfacegroups = NULL;
+	mod->groupsurfaces = NULL;
+	if (mod->numsubmodels) {
+		mod->surfacegroups = (msurfacegroup_t *) Hunk_AllocName (mod->submodels[0].numfaces * sizeof(msurfacegroup_t), loadname);
+		mod->groupsurfaces = (msurface_t **) Hunk_AllocName (mod->submodels[0].numfaces * sizeof(msurface_t *), loadname);
+	}
+
 	mod->numframes = 2;		// regular and alternate animation
 
 	// set up the submodels (FIXME: this is confusing)
@@ -2067,6 +2213,7 @@ void Mod_LoadAliasModel (model_t *mod, void *buffer, int filesize) {
 	daliasframetype_t *pframetype;
 	daliasskintype_t *pskintype;
 	aliasframetype_t frametype;
+	void *cache;
 
 	//VULT MODELS
 	Mod_AddModelFlags(mod);
@@ -2189,10 +2336,9 @@ void Mod_LoadAliasModel (model_t *mod, void *buffer, int filesize) {
 	end = Hunk_LowMark ();
 	total = end - start;
 
-	Cache_Alloc (&mod->cache, total, loadname);
-	if (!mod->cache.data)
+	if (!(cache = Cache_Alloc (&mod->cache, total, loadname, CACHE_MODEL)))
 		return;
-	memcpy (mod->cache.data, pheader, total);
+	memcpy (cache, pheader, total);
 
 	// try load simple textures
 	memset(mod->simpletexture, 0, sizeof(mod->simpletexture));
@@ -2319,7 +2465,7 @@ void Mod_LoadSpriteModel (model_t *mod, void *buffer) {
 	dspriteframetype_t *pframetype;
 
 	msprite2_t *psprite2;
-
+	void *cache;
 
 	// remember point
 	start = Hunk_LowMark ();
@@ -2421,14 +2567,13 @@ void Mod_LoadSpriteModel (model_t *mod, void *buffer) {
 
 	// move the complete, relocatable model to the cache
 
-	Cache_Alloc (&mod->cache, size, loadname);
-	if (!mod->cache.data) {
+	if (!(cache = Cache_Alloc (&mod->cache, size, loadname, CACHE_MODEL))) {
 		Q_free(psprite2);
 		Hunk_FreeToLowMark (start);
 		return;
 	}
 
-	memcpy (mod->cache.data, psprite2, size);
+	memcpy (cache, psprite2, size);
 
 	Q_free(psprite2);
 	Hunk_FreeToLowMark (start);
@@ -125,6 +125,7 @@ typedef struct msurface_s {
 	int					dlightbits;
 
 	int					lightmaptexturenum;
+	int					drawframe;					// passed world culling this frame, see R_ChainWorldSurfaces
 	byte				styles[MAXLIGHTMAPS];
 	int					cached_light[MAXLIGHTMAPS];	// values currently used in lightmap
 	qbool				cached_dlight;				// true if dynamic light in cache
@@ -165,6 +166,37 @@ typedef struct mleaf_s {
 	int					nummarksurfaces;
 } mleaf_t;
 
+// Flat copy of the world node tree, walked by R_RecursiveWorldNode instead of the mnode_t pointers.
+// Nodes come first in depth first order, then all leafs in their original order
+// so PVS bits map directly: leaf n lives at index numnodes + n.
+typedef struct mrendertree_s {
+	int					numnodes;
+	int					numleafs;
+
+	// indexed by node or leaf
+	float				*mins[3];					// bounding boxes split by axis
+	float				*maxs[3];
+	int					*contents;
+	int					*visleafs;					// leafs in the current PVS at or below this one
+	int					*parent;					// -1 for the head node
+
+	// indexed by node
+	mplane_t			**planes;
+	int					*children[2];
+	int					*firstsurface;
+	int					*numsurfaces;
+
+	unsigned			*curvis;					// PVS bits the visleafs counts were built from
+} mrendertree_t;
+
+// Consecutive world surfaces sharing texture and lightmap in model_t->groupsurfaces.
+typedef struct msurfacegroup_s {
+	texture_t			*texture;
+	int					lightmaptexturenum;
+	int					firstsurface;
+	int					numsurfaces;
+} msurfacegroup_t;
+
 
 /*
 ==============================================================================
@@ -291,6 +323,15 @@ typedef struct aliashdr_s {
 	int					poseverts;
 	int					posedata;	// numposes*poseverts trivert_t
 	int					commands;	// gl command list with embedded s/t
+
+	// the command list unpacked into an indexed triangle list, see GL_MakeAliasModelArrays
+	int					numarrayverts;
+	int					arrayposes;		// numposes*numarrayverts*3 floats
+	int					arraynormals;	// numposes*numarrayverts normal indexes
+	int					arraytexcoords;	// numarrayverts*2 floats
+	int					arrayorder;		// poseverts ints, the array vertex of each command list vertex
+	int					numindexes;
+	int					indexes;		// numindexes unsigned shorts
 	int					gl_texturenum[MAX_SKINS][4];
 	int					fb_texturenum[MAX_SKINS][4];
 	maliasframedesc_t	frames[1];	// variable sized
@@ -434,6 +475,12 @@ typedef struct model_s {
 	byte				*visdata;
 	byte				*lightdata;
 
+	mrendertree_t		*rendertree;				// see Mod_BuildRenderTree
+
+	int					numsurfacegroups;			// see Mod_BuildSurfaceGroups
+	msurfacegroup_t		*surfacegroups;
+	msurface_t			**groupsurfaces;
+
 	int					bspversion;
 	qbool				isworldmodel;
 
@@ -452,6 +499,7 @@ void	Mod_TouchModel (char *name);
 void	Mod_TouchModels (void); // for vid_restart
 
 mleaf_t *Mod_PointInLeaf (float *p, model_t *model);
+void	Mod_BuildSurfaceGroups (model_t *model);
 byte	*Mod_LeafPVS (mleaf_t *leaf, model_t *model);
 
 qbool	Img_HasFullbrights (byte *pixels, int size);
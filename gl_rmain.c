@@ -36,6 +36,7 @@ void OnChange_gl_clearColor(cvar_t *v, char *s, qbool *cancel);
 void SCR_OnChangeMVHudPos(cvar_t *var, char *newval, qbool *cancel);
 void OnChange_r_drawflat(cvar_t *v, char *skyname, qbool *cancel);
 void OnChange_r_skyname(cvar_t *v, char *s, qbool *cancel);
+void OnChange_r_pvscache(cvar_t *var, char *value, qbool *cancel);
 void R_MarkLeaves(void);
 void R_InitBubble(void);
 
@@ -96,7 +97,6 @@ qbool     r_cache_thrash;                     // compatability
 qbool     full_light;
 int       lastposenum;
 int       shelltexture = 0;
-int       r_visframecount;                    // bumped when going to a new PVS
 int       r_framecount;                       // used for dlight push checking
 int       c_brush_polys;
 int       c_alias_polys;
@@ -130,6 +130,7 @@ cvar_t r_shadows                           = {"r_shadows", "0"};
 cvar_t r_wateralpha                        = {"gl_turbalpha", "1"};
 cvar_t r_dynamic                           = {"r_dynamic", "1"};
 cvar_t r_novis                             = {"r_novis", "0"};
+cvar_t r_pvscache                          = {"r_pvscache", "1024", 0, OnChange_r_pvscache};
 cvar_t r_netgraph                          = {"r_netgraph", "0"};
 cvar_t r_netstats                          = {"r_netstats", "0"};
 cvar_t r_fullbrightSkins                   = {"r_fullbrightSkins", "1", 0, Rulesets_OnChange_r_fullbrightSkins};
@@ -512,15 +513,116 @@ void GL_DrawAliasOutlineFrame (aliashdr_t *paliashdr, int pose1, int pose2)
 	GL_PolygonOffset(0, 0);
 }
 
+// Blended positions and lit colours of the array vertexes of the alias model being drawn.
+static float r_aliasverts[MAXALIASVERTS * 2][3];
+static float r_aliascolors[MAXALIASVERTS * 2][4];
+static float r_aliaslerpfracs[MAXALIASVERTS * 2];
+
+// Blends two float poses into r_aliasverts and records the fraction used for each vertex in
+// r_aliaslerpfracs, so R_AliasLightVerts blends the normals the same way. With limitlerp (the
+// view model) a vertex that moved r_lerpdistance or more between the poses, in unscaled model
+// units, snaps to the new pose, otherwise every coordinate is blended in one flat loop.
+static void R_AliasLerpVerts(aliashdr_t *paliashdr, int pose1, int pose2, qbool limitlerp)
+{
+	int i, numverts = paliashdr->numarrayverts;
+	float *v1 = (float *) ((byte *) paliashdr + paliashdr->arrayposes) + pose1 * numverts * 3;
+	float *v2 = (float *) ((byte *) paliashdr + paliashdr->arrayposes) + pose2 * numverts * 3;
+	float *out = r_aliasverts[0], lerpfrac = r_framelerp, maxdist = r_lerpdistance * r_lerpdistance;
+	float dx, dy, dz;
+
+	if (!limitlerp) {
+		for (i = 0; i < numverts * 3; i++)
+			out[i] = v1[i] + lerpfrac * (v2[i] - v1[i]);
+		for (i = 0; i < numverts; i++)
+			r_aliaslerpfracs[i] = lerpfrac;
+		return;
+	}
+
+	for (i = 0; i < numverts; i++, v1 += 3, v2 += 3, out += 3) {
+		dx = v1[0] - v2[0];
+		dy = v1[1] - v2[1];
+		dz = v1[2] - v2[2];
+		lerpfrac = (dx * dx + dy * dy + dz * dz < maxdist) ? r_framelerp : 1;
+		r_aliaslerpfracs[i] = lerpfrac;
+		out[0] = v1[0] + lerpfrac * (v2[0] - v1[0]);
+		out[1] = v1[1] + lerpfrac * (v2[1] - v1[1]);
+		out[2] = v1[2] + lerpfrac * (v2[2] - v1[2]);
+	}
+}
+
+// Fills r_aliascolors from the normals of both poses, using the lighting set up by R_AliasSetupLighting.
+static void R_AliasLightVerts(aliashdr_t *paliashdr, int pose1, int pose2)
+{
+	int i, numverts = paliashdr->numarrayverts;
+	byte *n1 = (byte *) paliashdr + paliashdr->arraynormals + pose1 * numverts;
+	byte *n2 = (byte *) paliashdr + paliashdr->arraynormals + pose2 * numverts;
+	qbool vertexlight = amf_lighting_vertex.value && !full_light;
+	qbool colourlight = amf_lighting_colour.value && !full_light;
+	float l, *color, rgb[3];
+
+	for (i = 0; i < 3; i++)
+		rgb[i] = (r_modelcolor[0] < 0) ? 1 : r_modelcolor[i];
+
+	for (i = 0, color = r_aliascolors[0]; i < numverts; i++, color += 4) {
+		// VULT VERTEX LIGHTING
+		if (vertexlight) {
+			l = VLight_LerpLight(n1[i], n2[i], r_aliaslerpfracs[i], apitch, ayaw);
+		} else {
+			l = FloatInterpolate(shadedots[n1[i]], r_aliaslerpfracs[i], shadedots[n2[i]]) / 127.0;
+			l = (l * shadelight + ambientlight) / 256.0;
+		}
+		l = min(l, 1);
+
+		//VULT COLOURED MODEL LIGHTS
+		if (colourlight) {
+			color[0] = rgb[0] * (lightcolor[0] / 256 + l);
+			color[1] = rgb[1] * (lightcolor[1] / 256 + l);
+			color[2] = rgb[2] * (lightcolor[2] / 256 + l);
+		} else {
+			color[0] = rgb[0] * l;
+			color[1] = rgb[1] * l;
+			color[2] = rgb[2] * l;
+		}
+		color[3] = r_modelalpha;
+	}
+}
+
+static void R_DrawAliasArrays(aliashdr_t *paliashdr, qbool mtex, qbool colors)
+{
+	float *texcoords = (float *) ((byte *) paliashdr + paliashdr->arraytexcoords);
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(3, GL_FLOAT, 0, r_aliasverts);
+	if (colors) {
+		glEnableClientState(GL_COLOR_ARRAY);
+		glColorPointer(4, GL_FLOAT, 0, r_aliascolors);
+	}
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glTexCoordPointer(2, GL_FLOAT, 0, texcoords);
+	if (mtex) {
+		qglClientActiveTexture(GL_TEXTURE1);
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		glTexCoordPointer(2, GL_FLOAT, 0, texcoords);
+	}
+
+	glDrawElements(GL_TRIANGLES, paliashdr->numindexes, GL_UNSIGNED_SHORT, (byte *) paliashdr + paliashdr->indexes);
+
+	if (mtex) {
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		qglClientActiveTexture(GL_TEXTURE0);
+	}
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	if (colors)
+		glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+}
+
 void GL_DrawAliasFrame(aliashdr_t *paliashdr, int pose1, int pose2, qbool mtex, qbool scrolldir)
 {
-	int *order, count;
-	vec3_t interpolated_verts;
-	float l, lerpfrac;
+	int *order, *arrayorder, count;
+	float lerpfrac;
 	trivertx_t *verts1, *verts2;
-	//VULT COLOURED MODEL LIGHTS
-	int i;
-	vec3_t lc;
+	qbool colors;
 
 	lerpfrac = r_framelerp;
 	lastposenum = (lerpfrac >= 0.5) ? pose2 : pose1;	
@@ -612,76 +714,48 @@ void GL_DrawAliasFrame(aliashdr_t *paliashdr, int pose1, int pose2, qbool mtex,
 			glColor4ub(custom_model->color_cvar.color[0], custom_model->color_cvar.color[1], custom_model->color_cvar.color[2], r_modelalpha * 255);
 		}
 
-		for ( ;; )
-		{
-			count = *order++;
-			if (!count)
-				break;
+		// coloured lighting overrides the custom model colour
+		colors = !custom_model || (amf_lighting_colour.value && !full_light);
 
-			if (count < 0)
+		R_AliasLerpVerts(paliashdr, pose1, pose2, (currententity->renderfx & RF_LIMITLERP));
+		if (colors)
+			R_AliasLightVerts(paliashdr, pose1, pose2);
+
+		if (mtex && !qglClientActiveTexture)
+		{
+			// no way to give the second unit its own texture coordinate array
+			arrayorder = (int *) ((byte *) paliashdr + paliashdr->arrayorder);
+			for ( ;; )
 			{
-				count = -count;
-				glBegin(GL_TRIANGLE_FAN);
-			}
-			else
-				glBegin(GL_TRIANGLE_STRIP);
+				count = *order++;
+				if (!count)
+					break;
 
-			do {
-				// texture coordinates come from the draw list
-				if (mtex)
+				if (count < 0)
 				{
-					qglMultiTexCoord2f (GL_TEXTURE0, ((float *) order)[0], ((float *) order)[1]);
-					qglMultiTexCoord2f (GL_TEXTURE1, ((float *) order)[0], ((float *) order)[1]);
+					count = -count;
+					glBegin(GL_TRIANGLE_FAN);
 				}
 				else
-					glTexCoord2f (((float *) order)[0], ((float *) order)[1]);
-
-				order += 2;
-
-				if ((currententity->renderfx & RF_LIMITLERP))
-					lerpfrac = VectorL2Compare(verts1->v, verts2->v, r_lerpdistance) ? r_framelerp : 1;
-
-				// VULT VERTEX LIGHTING
-				if (amf_lighting_vertex.value && !full_light)
-				{
-					l = VLight_LerpLight(verts1->lightnormalindex, verts2->lightnormalindex, lerpfrac, apitch, ayaw);
-				}
-				else
-				{
-					l = FloatInterpolate(shadedots[verts1->lightnormalindex], lerpfrac, shadedots[verts2->lightnormalindex]) / 127.0;
-					l = (l * shadelight + ambientlight) / 256.0;
-				}
-				l = min(l , 1);
-				//VULT COLOURED MODEL LIGHTS
-				if (amf_lighting_colour.value && !full_light)
-				{
-					for (i=0;i<3;i++)
-						lc[i] = lightcolor[i] / 256 + l;
-
-					//Com_Printf("rgb light : %f %f %f\n", lc[0], lc[1], lc[2]);
-					if (r_modelcolor[0] < 0)
-						glColor4f(lc[0], lc[1], lc[2], r_modelalpha); // normal color
-					else
-						glColor4f(r_modelcolor[0] * lc[0], r_modelcolor[1] * lc[1], r_modelcolor[2] * lc[2], r_modelalpha); // forced
-				}
-				else if (custom_model == NULL)
-				{
-					if (r_modelcolor[0] < 0) {
-						glColor4f(l, l, l, r_modelalpha); // normal color
-					} else {
-						glColor4f(r_modelcolor[0] * l, r_modelcolor[1] * l, r_modelcolor[2] * l, r_modelalpha); // forced
-					}
-				}
-
-				VectorInterpolate(verts1->v, lerpfrac, verts2->v, interpolated_verts);
-				glVertex3fv(interpolated_verts);
+					glBegin(GL_TRIANGLE_STRIP);
 
+				do {
+					qglMultiTexCoord2f (GL_TEXTURE0, ((float *) order)[0], ((float *) order)[1]);
+					qglMultiTexCoord2f (GL_TEXTURE1, ((float *) order)[0], ((float *) order)[1]);
+					order += 2;
 
-				verts1++;
-				verts2++;
-			} while (--count);
+					if (colors)
+						glColor4fv(r_aliascolors[*arrayorder]);
+					glVertex3fv(r_aliasverts[*arrayorder]);
+					arrayorder++;
+				} while (--count);
 
-			glEnd();
+				glEnd();
+			}
+		}
+		else
+		{
+			R_DrawAliasArrays(paliashdr, mtex, colors);
 		}
 
 		if (r_modelalpha < 1)
@@ -694,24 +768,31 @@ void GL_DrawAliasFrame(aliashdr_t *paliashdr, int pose1, int pose2, qbool mtex,
 	}
 }
 
-void R_SetupAliasFrame(maliasframedesc_t *oldframe, maliasframedesc_t *frame, aliashdr_t *paliashdr, qbool mtex, qbool scrolldir, qbool outline)
+static void R_AliasFramePoses(maliasframedesc_t *oldframe, maliasframedesc_t *frame, int *oldpose, int *pose)
 {
-	int oldpose, pose, numposes;
+	int numposes;
 	float interval;
 
-	oldpose = oldframe->firstpose;
+	*oldpose = oldframe->firstpose;
 	numposes = oldframe->numposes;
 	if (numposes > 1) {
 		interval = oldframe->interval;
-		oldpose += (int) (r_refdef2.time / interval) % numposes;
+		*oldpose += (int) (r_refdef2.time / interval) % numposes;
 	}
 
-	pose = frame->firstpose;
+	*pose = frame->firstpose;
 	numposes = frame->numposes;
 	if (numposes > 1) {
 		interval = frame->interval;
-		pose += (int) (r_refdef2.time / interval) % numposes;
+		*pose += (int) (r_refdef2.time / interval) % numposes;
 	}
+}
+
+void R_SetupAliasFrame(maliasframedesc_t *oldframe, maliasframedesc_t *frame, aliashdr_t *paliashdr, qbool mtex, qbool scrolldir, qbool outline)
+{
+	int oldpose, pose;
+
+	R_AliasFramePoses(oldframe, frame, &oldpose, &pose);
 
 	GL_DrawAliasFrame (paliashdr, oldpose, pose, mtex, scrolldir);
 
@@ -719,6 +800,55 @@ void R_SetupAliasFrame(maliasframedesc_t *oldframe, maliasframedesc_t *frame, al
 		GL_DrawAliasOutlineFrame (paliashdr, oldpose, pose) ;
 }
 
+// Times pose blending and vertex lighting of every alias model in the scene, nothing is drawn.
+void R_TimeAlias_f(void)
+{
+	visentlist_t *lists[3] = { &cl_firstpassents, &cl_visents, &cl_alphaents };
+	int i, j, k, frames, oldpose, pose, models = 0, verts = 0;
+	aliashdr_t *paliashdr;
+	entity_t *ent;
+	entity_t *oldentity = currententity;
+	double start, time = 0;
+
+	if (cls.state != ca_active)
+		return;
+
+	frames = (Cmd_Argc() > 1) ? max(1, Q_atoi(Cmd_Argv(1))) : 100;
+
+	for (i = 0; i < frames; i++) {
+		for (j = 0; j < 3; j++) {
+			for (k = 0, ent = lists[j]->list; k < lists[j]->count; k++, ent++) {
+				if (ent->model->type != mod_alias)
+					continue;
+
+				paliashdr = (aliashdr_t *) Mod_Extradata(ent->model);
+				if (ent->frame < 0 || ent->frame >= paliashdr->numframes || ent->oldframe < 0 || ent->oldframe >= paliashdr->numframes)
+					continue;
+
+				// light the entity like R_DrawAliasModel does, only the vertex work is timed
+				currententity = ent;
+				R_AliasSetupLighting(ent);
+				shadedots = r_avertexnormal_dots[((int) (ent->angles[1] * (SHADEDOT_QUANT / 360.0))) & (SHADEDOT_QUANT - 1)];
+
+				start = Sys_DoubleTime();
+				r_framelerp = (!r_lerpframes.value || ent->framelerp < 0 || ent->oldframe == ent->frame) ? 1.0 : min(ent->framelerp, 1);
+				R_AliasFramePoses(&paliashdr->frames[ent->oldframe], &paliashdr->frames[ent->frame], &oldpose, &pose);
+				R_AliasLerpVerts(paliashdr, oldpose, pose, (ent->renderfx & RF_LIMITLERP));
+				R_AliasLightVerts(paliashdr, oldpose, pose);
+				time += Sys_DoubleTime() - start;
+
+				if (!i) {
+					models++;
+					verts += paliashdr->numarrayverts;
+				}
+			}
+		}
+	}
+	currententity = oldentity;
+
+	Com_Printf("%d alias models, %d vertexes: %.3f ms per frame\n", models, verts, time * 1000.0 / frames);
+}
+
 void GL_DrawAliasShadow(aliashdr_t *paliashdr, int posenum)
 {
 	int *order, count;
@@ -1429,6 +1559,55 @@ static qbool R_DrawTrySimpleItem(void)
 	return true;
 }
 
+// Frustum sphere test for a whole entity list, done up front on flat arrays so the loop over
+// the planes stays tight and branch free. Only entities whose model radius bounds everything drawn for them
+// are tested, R_DrawAliasModel and R_DrawBrushModel still do the exact test on whatever passes.
+static float *r_entcull_origin[3], *r_entcull_radius;
+static byte *r_entculled;
+static int r_entcull_max;
+
+static void R_CullEntityList(visentlist_t *vislist)
+{
+	int i, j, count = vislist->count;
+	float nx, ny, nz, dist;
+	entity_t *ent;
+	model_t *model;
+
+	if (count > r_entcull_max) {
+		r_entcull_max = max(count, vislist->max);
+		for (i = 0; i < 3; i++)
+			r_entcull_origin[i] = (float *) Q_realloc(r_entcull_origin[i], r_entcull_max * sizeof(float));
+		r_entcull_radius = (float *) Q_realloc(r_entcull_radius, r_entcull_max * sizeof(float));
+		r_entculled = (byte *) Q_realloc(r_entculled, r_entcull_max);
+	}
+
+	for (i = 0, ent = vislist->list; i < count; i++, ent++) {
+		model = ent->model;
+		r_entcull_origin[0][i] = ent->origin[0];
+		r_entcull_origin[1][i] = ent->origin[1];
+		r_entcull_origin[2][i] = ent->origin[2];
+		r_entculled[i] = 0;
+
+		// the view model and eyes are drawn away from their origin, coronas are spawned from
+		// R_DrawAliasModel even when the model itself is culled
+		if (model->type == mod_brush
+			|| (model->type == mod_alias && !(ent->renderfx & RF_WEAPONMODEL)
+				&& model->modhint != MOD_EYES && !amf_coronas.value))
+			r_entcull_radius[i] = model->radius;
+		else
+			r_entcull_radius[i] = 999999;	// never outside
+	}
+
+	for (j = 0; j < 4; j++) {
+		nx = frustum[j].normal[0];
+		ny = frustum[j].normal[1];
+		nz = frustum[j].normal[2];
+		dist = frustum[j].dist;
+		for (i = 0; i < count; i++)
+			r_entculled[i] |= (r_entcull_origin[0][i] * nx + r_entcull_origin[1][i] * ny + r_entcull_origin[2][i] * nz - dist <= -r_entcull_radius[i]);
+	}
+}
+
 void R_DrawEntitiesOnList(visentlist_t *vislist)
 {
 	int i;
@@ -1436,6 +1615,8 @@ void R_DrawEntitiesOnList(visentlist_t *vislist)
 	if (!r_drawentities.value || !vislist->count)
 		return;
 
+	R_CullEntityList(vislist);
+
 	if (vislist->alpha)
 		glEnable (GL_ALPHA_TEST);
 
@@ -1498,6 +1679,9 @@ void R_DrawEntitiesOnList(visentlist_t *vislist)
 					}
 				}
 
+				if (r_entculled[i])
+					break;
+
 				R_DrawAliasModel (currententity);
 
 				break;
@@ -1505,6 +1689,8 @@ void R_DrawEntitiesOnList(visentlist_t *vislist)
 				R_DrawAlias3Model (currententity);
 				break;
 			case mod_brush:
+				if (r_entculled[i])
+					break;
 
 				// Get rid of Z-fighting for textures by offsetting the
 				// drawing of entity models compared to normal polygons.
@@ -1930,6 +2116,8 @@ void R_Init(void)
 
 	Cmd_AddCommand ("loadsky", R_LoadSky_f);
 	Cmd_AddCommand ("timerefresh", R_TimeRefresh_f);
+	Cmd_AddCommand ("timeworld", R_TimeWorld_f);
+	Cmd_AddCommand ("timealias", R_TimeAlias_f);
 #ifndef CLIENTONLY
 	Cmd_AddCommand ("pointfile", R_ReadPointFile_f);
 #endif
@@ -2003,6 +2191,7 @@ void R_Init(void)
 	Cvar_Register (&r_watercolor);
 
 	Cvar_Register (&r_novis);
+	Cvar_Register (&r_pvscache);
 	Cvar_Register (&r_wateralpha);
 	Cvar_Register (&gl_caustics);
 	if (!COM_CheckParm ("-nomtex")) {
@@ -2475,6 +2664,10 @@ void R_RenderView(void)
 
 	// render normal view
 	R_RenderScene ();
+
+	// the world and entities are the bulk of the frame, don't hold input back behind them
+	CL_InputPoll ();
+
 	R_RenderDlights ();
 	R_DrawParticles ();
 
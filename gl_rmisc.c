@@ -289,6 +289,7 @@ void R_NewMap (qbool vid_restart) {
 			cl.worldmodel->leafs[i].efrags = NULL;
 			 	
 		r_viewleaf = NULL;
+		R_FlushPVSCache ();
 		R_ClearParticles ();
 	}
 	else {
@@ -1244,7 +1244,7 @@ void OnChange_r_drawflat (cvar_t *var, char *value, qbool *cancel) {
 	qbool progress = false;
 
 
-	p = Info_ValueForKey (cl.serverinfo, "status");
+	p = Info_Get(&cl._serverinfo_ctx_, "status");
 	progress = (strstr (p, "left")) ? true : false;
 
 	if (cls.state >= ca_connected && progress && !r_refdef2.allow_cheats && !cl.spectator) {
@@ -1397,22 +1397,55 @@ void R_DrawBrushModel (entity_t *e) {
 }
 
 
-void R_RecursiveWorldNode (mnode_t *node, int clipflags) {
-	int c, side, clipped, underwater;
+// BOX_ON_PLANE_SIDE for a node or leaf of the render tree, bounds are stored by axis.
+static int R_TreeBoxOnPlaneSide (mrendertree_t *tree, int index, mplane_t *p)
+{
+	float dist1, dist2;
+	int i, sides = 0;
+
+	if (p->type < 3) {
+		if (p->dist <= tree->mins[p->type][index])
+			return 1;
+		if (p->dist >= tree->maxs[p->type][index])
+			return 2;
+		return 3;
+	}
+
+	dist1 = dist2 = 0;
+	for (i = 0; i < 3; i++) {
+		if (p->normal[i] >= 0) {
+			dist1 += p->normal[i] * tree->maxs[i][index];
+			dist2 += p->normal[i] * tree->mins[i][index];
+		} else {
+			dist1 += p->normal[i] * tree->mins[i][index];
+			dist2 += p->normal[i] * tree->maxs[i][index];
+		}
+	}
+
+	if (dist1 >= p->dist)
+		sides = 1;
+	if (dist2 < p->dist)
+		sides |= 2;
+
+	return sides;
+}
+
+static void R_RecursiveWorldNode (mrendertree_t *tree, int index, int clipflags) {
+	int c, side, clipped;
 	mplane_t *plane, *clipplane;
 	msurface_t *surf, **mark;
 	mleaf_t *pleaf;
 	float dot;
 
-	if (node->contents == CONTENTS_SOLID)
+	if (tree->contents[index] == CONTENTS_SOLID)
 		return;		// solid
-	if (node->visframe != r_visframecount)
+	if (!tree->visleafs[index])
 		return;
 	for (c = 0, clipplane = frustum; c < 4; c++, clipplane++) {
 		if (!(clipflags & (1 << c)))
 			continue;	// don't need to clip against it
 
-		clipped = BOX_ON_PLANE_SIDE (node->minmaxs, node->minmaxs + 3, clipplane);
+		clipped = R_TreeBoxOnPlaneSide (tree, index, clipplane);
 		if (clipped == 2)
 			return;
 		else if (clipped == 1)
@@ -1420,8 +1453,8 @@ void R_RecursiveWorldNode (mnode_t *node, int clipflags) {
 	}
 
 	// if a leaf node, draw stuff
-	if (node->contents < 0)	{
-		pleaf = (mleaf_t *) node;
+	if (index >= tree->numnodes)	{
+		pleaf = cl.worldmodel->leafs + (index - tree->numnodes);
 
 		mark = pleaf->firstmarksurface;
 		c = pleaf->nummarksurfaces;
@@ -1443,24 +1476,19 @@ void R_RecursiveWorldNode (mnode_t *node, int clipflags) {
 	// node is just a decision point, so go down the apropriate sides
 
 	// find which side of the node we are on
-	plane = node->plane;
+	plane = tree->planes[index];
 
 	dot = PlaneDiff(modelorg, plane);
 	side = (dot >= 0) ? 0 : 1;
 
 	// recurse down the children, front side first
-	R_RecursiveWorldNode (node->children[side], clipflags);
+	R_RecursiveWorldNode (tree, tree->children[side][index], clipflags);
 
 	// draw stuff
-	c = node->numsurfaces;
+	c = tree->numsurfaces[index];
 
 	if (c)	{
-		surf = cl.worldmodel->surfaces + node->firstsurface;
-
-		if (dot < -BACKFACE_EPSILON)
-			side = SURF_PLANEBACK;
-		else if (dot > BACKFACE_EPSILON)
-			side = 0;
+		surf = cl.worldmodel->surfaces + tree->firstsurface[index];
 
 		for ( ; c; c--, surf++) {
 			if (surf->visframe != r_framecount)
@@ -1469,7 +1497,7 @@ void R_RecursiveWorldNode (mnode_t *node, int clipflags) {
 			if ((dot < 0) ^ !!(surf->flags & SURF_PLANEBACK))
 				continue;		// wrong side
 
-			// add surf to the right chain
+			// add surf to the right chain, opaque surfaces are chained by R_ChainWorldSurfaces
 			if (surf->flags & SURF_DRAWSKY) {
 				CHAIN_SURF_F2B(surf, skychain_tail);
 			} else if (surf->flags & SURF_DRAWTURB) {
@@ -1478,13 +1506,34 @@ void R_RecursiveWorldNode (mnode_t *node, int clipflags) {
 				
 				CHAIN_SURF_B2F(surf, alphachain);
 			} else {
-				underwater = (surf->flags & SURF_UNDERWATER) ? 1 : 0;
-				CHAIN_SURF_F2B(surf, surf->texinfo->texture->texturechain_tail[underwater]);
+				surf->drawframe = r_framecount;
 			}
 		}
 	}
 	// recurse down the back side
-	R_RecursiveWorldNode (node->children[!side], clipflags);
+	R_RecursiveWorldNode (tree, tree->children[!side][index], clipflags);
+}
+
+// Links the opaque surfaces which passed R_RecursiveWorldNode into texture chains,
+// walking the static texture/lightmap groups so each chain is sorted by lightmap.
+static void R_ChainWorldSurfaces (model_t *model)
+{
+	msurfacegroup_t *group;
+	msurface_t *surf, **groupsurf;
+	int i, c, underwater;
+
+	for (i = 0, group = model->surfacegroups; i < model->numsurfacegroups; i++, group++) {
+		groupsurf = model->groupsurfaces + group->firstsurface;
+
+		for (c = group->numsurfaces; c; c--, groupsurf++) {
+			surf = *groupsurf;
+			if (surf->drawframe != r_framecount)
+				continue;
+
+			underwater = (surf->flags & SURF_UNDERWATER) ? 1 : 0;
+			CHAIN_SURF_F2B(surf, group->texture->texturechain_tail[underwater]);
+		}
+	}
 }
 
 void R_DrawWorld (void)
@@ -1504,7 +1553,8 @@ void R_DrawWorld (void)
 	currenttexture = -1;
 
 	//set up texture chains for the world
-	R_RecursiveWorldNode (cl.worldmodel->nodes, 15);
+	R_RecursiveWorldNode (cl.worldmodel->rendertree, 0, 15);
+	R_ChainWorldSurfaces (cl.worldmodel);
 	
 	//draw the world sky
 	R_DrawSky ();
@@ -1541,54 +1591,189 @@ void R_DrawWorld (void)
 	R_DrawAlphaChain ();
 }
 
-void R_MarkLeaves (void) {
-	byte *vis;
-	mnode_t *node;
+// Decompressed PVS rows of recently visited leafs, so moving back and forth through a doorway
+// doesn't decompress the same rows again. Rows are padded to whole words, r_pvscache is in KB.
+#define PVSCACHE_MAX_SLOTS	4096
+
+typedef struct pvscache_s {
+	int			leafnum;
+	int			lastused;
+} pvscache_t;
+
+static pvscache_t	*pvscache;
+static int			*pvscache_leafslot;			// slot holding each leaf's row, -1 if not cached
+static byte			*pvscache_rows;
+static int			pvscache_numslots, pvscache_numleafs, pvscache_rowsize, pvscache_sequence;
+
+void R_FlushPVSCache (void) {
+	Q_free (pvscache);
+	Q_free (pvscache_leafslot);
+	Q_free (pvscache_rows);
+	pvscache_numslots = pvscache_numleafs = pvscache_rowsize = pvscache_sequence = 0;
+}
+
+void OnChange_r_pvscache (cvar_t *var, char *value, qbool *cancel) {
+	R_FlushPVSCache ();
+}
+
+static void R_AllocPVSCache (model_t *model) {
 	int i;
-	byte solid[MAX_MAP_LEAFS/8];
+
+	pvscache_numleafs = model->numleafs;
+	pvscache_rowsize = ((model->numleafs + 31) >> 5) * sizeof(unsigned);
+	pvscache_numslots = bound (1, (int) (r_pvscache.value * 1024) / pvscache_rowsize, PVSCACHE_MAX_SLOTS);
+
+	pvscache = (pvscache_t *) Q_calloc (pvscache_numslots, sizeof(pvscache_t));
+	pvscache_leafslot = (int *) Q_malloc (pvscache_numleafs * sizeof(int));
+	pvscache_rows = (byte *) Q_malloc (pvscache_numslots * pvscache_rowsize);
+
+	for (i = 0; i < pvscache_numslots; i++)
+		pvscache[i].leafnum = -1;
+	for (i = 0; i < pvscache_numleafs; i++)
+		pvscache_leafslot[i] = -1;
+}
+
+static unsigned *R_CachedLeafPVS (mleaf_t *leaf, model_t *model) {
+	int i, slot, leafnum = leaf - model->leafs, rowbytes = (model->numleafs + 7) >> 3;
+	byte *row;
+
+	if (!pvscache || pvscache_numleafs != model->numleafs) {
+		R_FlushPVSCache ();
+		R_AllocPVSCache (model);
+	}
+
+	if ((slot = pvscache_leafslot[leafnum]) < 0) {
+		// replace the least recently used row
+		for (i = 1, slot = 0; i < pvscache_numslots; i++) {
+			if (pvscache[i].lastused < pvscache[slot].lastused)
+				slot = i;
+		}
+		if (pvscache[slot].leafnum >= 0)
+			pvscache_leafslot[pvscache[slot].leafnum] = -1;
+		pvscache[slot].leafnum = leafnum;
+		pvscache_leafslot[leafnum] = slot;
+
+		row = pvscache_rows + slot * pvscache_rowsize;
+		memcpy (row, Mod_LeafPVS (leaf, model), rowbytes);
+		memset (row + rowbytes, 0, pvscache_rowsize - rowbytes);
+	}
+
+	pvscache[slot].lastused = ++pvscache_sequence;
+	return (unsigned *) (pvscache_rows + slot * pvscache_rowsize);
+}
+
+// Only leafs entering or leaving the PVS are touched: each one adjusts the visible leaf
+// counts on its way up to the head node, so R_RecursiveWorldNode skips nodes counting zero.
+void R_MarkLeaves (void) {
+	mrendertree_t *tree = cl.worldmodel->rendertree;
+	unsigned vis[MAX_MAP_LEAFS / 32 + 1], *src;
+	byte *newbits, *oldbits, changed;
+	int i, j, b, count, leafnum, index, delta;
 
 	if (!r_novis.value && r_oldviewleaf == r_viewleaf
 		&& r_oldviewleaf2 == r_viewleaf2)	// watervis hack
 		return;
 
-	r_visframecount++;
 	r_oldviewleaf = r_viewleaf;
 
+	count = (tree->numleafs + 31) >> 5;
+
 	if (r_novis.value) {
-		vis = solid;
-		memset (solid, 0xff, (cl.worldmodel->numleafs + 7) >> 3);
+		memset (vis, 0xff, count * sizeof(unsigned));
 	} else {
-		vis = Mod_LeafPVS (r_viewleaf, cl.worldmodel);
+		memcpy (vis, R_CachedLeafPVS (r_viewleaf, cl.worldmodel), count * sizeof(unsigned));
 
+		// merge visibility data for two leafs
 		if (r_viewleaf2) {
-			int			i, count;
-			unsigned	*src, *dest;
-
-			// merge visibility data for two leafs
-			count = (cl.worldmodel->numleafs + 7) >> 3;
-			memcpy (solid, vis, count);
-			src = (unsigned *) Mod_LeafPVS (r_viewleaf2, cl.worldmodel);
-			dest = (unsigned *) solid;
-			count = (count + 3) >> 2;
+			src = R_CachedLeafPVS (r_viewleaf2, cl.worldmodel);
 			for (i = 0; i < count; i++)
-				*dest++ |= *src++;
-			vis = solid;
+				vis[i] |= src[i];
 		}
 	}
-		
-	for (i = 0; i < cl.worldmodel->numleafs; i++)	{
-		if (vis[i >> 3] & (1 << (i & 7))) {
-			node = (mnode_t *)&cl.worldmodel->leafs[i + 1];
-			do {
-				if (node->visframe == r_visframecount)
-					break;
-				node->visframe = r_visframecount;
-				node = node->parent;
-			} while (node);
+
+	for (i = 0; i < count; i++) {
+		if (vis[i] == tree->curvis[i])
+			continue;
+
+		// PVS bits are stored bytewise, walk the bytes so this works on any endianness
+		newbits = (byte *) &vis[i];
+		oldbits = (byte *) &tree->curvis[i];
+		for (j = 0; j < 4; j++) {
+			if (!(changed = newbits[j] ^ oldbits[j]))
+				continue;
+
+			for (b = 0; b < 8; b++) {
+				if (!(changed & (1 << b)))
+					continue;
+
+				// bit n is leaf n + 1, leaf 0 is the shared solid leaf
+				leafnum = ((i << 2) + j) * 8 + b + 1;
+				if (leafnum >= tree->numleafs)
+					continue;
+
+				delta = (newbits[j] & (1 << b)) ? 1 : -1;
+				for (index = tree->numnodes + leafnum; index >= 0; index = tree->parent[index])
+					tree->visleafs[index] += delta;
+			}
 		}
+		tree->curvis[i] = vis[i];
 	}
 }
 
+// Forgets the marked PVS and the cached rows, so the next R_MarkLeaves decompresses
+// the row and visits every visible leaf like it does on a map's first frame.
+static void R_UnmarkLeaves (void) {
+	mrendertree_t *tree = cl.worldmodel->rendertree;
+
+	memset (tree->visleafs, 0, (tree->numnodes + tree->numleafs) * sizeof(int));
+	memset (tree->curvis, 0, ((tree->numleafs + 31) >> 5) * sizeof(unsigned));
+	R_FlushPVSCache ();
+	r_oldviewleaf = NULL;
+}
+
+// Times PVS marking, world traversal and chain building without drawing anything.
+void R_TimeWorld_f (void) {
+	int i, visents, alphaents, firstpassents;
+	double start, time;
+	vec3_t viewangles;
+
+	if (cls.state != ca_active || !cl.worldmodel)
+		return;
+
+	// traversal stores static entities, don't leave them behind in the lists
+	visents = cl_visents.count;
+	alphaents = cl_alphaents.count;
+	firstpassents = cl_firstpassents.count;
+	VectorCopy (r_refdef.viewangles, viewangles);
+	VectorCopy (r_refdef.vieworg, r_origin);
+	VectorCopy (r_refdef.vieworg, modelorg);
+
+	start = Sys_DoubleTime ();
+	for (i = 0; i < 128; i++) {
+		r_framecount++;
+		r_refdef.viewangles[1] = i * (360.0 / 128.0);
+		AngleVectors (r_refdef.viewangles, vpn, vright, vup);
+		R_SetFrustum ();
+
+		R_UnmarkLeaves ();		// mark the whole PVS again, not just what changed
+		R_MarkLeaves ();
+
+		R_ClearTextureChains (cl.worldmodel);
+		R_RecursiveWorldNode (cl.worldmodel->rendertree, 0, 15);
+		R_ChainWorldSurfaces (cl.worldmodel);
+	}
+	time = Sys_DoubleTime () - start;
+
+	VectorCopy (viewangles, r_refdef.viewangles);
+	R_ClearTextureChains (cl.worldmodel);
+	cl_visents.count = visents;
+	cl_alphaents.count = alphaents;
+	cl_firstpassents.count = firstpassents;
+
+	Com_Printf ("%s: %d nodes, %d surface groups, %.3f ms per frame\n", cl.worldmodel->name,
+		cl.worldmodel->rendertree->numnodes, cl.worldmodel->numsurfacegroups, time * 1000.0 / 128);
+}
+
 
 // returns a texture number and the position inside it
 int AllocBlock (int w, int h, int *x, int *y) {
@@ -1757,6 +1942,9 @@ void GL_BuildLightmaps (void) {
 		}
 	}
 
+	if (cl.worldmodel)
+		Mod_BuildSurfaceGroups (cl.worldmodel);
+
  	if (gl_mtexable)
  		GL_EnableMultitexture();
 
@@ -0,0 +1,416 @@
+/*
+Copyright (C) 2026 ezQuake team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// gl_texcache.c -- on disk cache of decoded, resampled and mipmapped external textures.
+//
+// Entries are keyed by the contents of the source image file together with every
+// setting that affects the uploaded pixels (gl_max_size, gl_picmip, gl_lightmode...),
+// so a hit skips image decoding, resampling and mip generation entirely.
+// The container is a fixed size header followed by the mip levels, offsets are
+// relative to the end of the header so the file can be used directly once mapped.
+
+#include "quakedef.h"
+#include "image.h"
+#include "gl_model.h"
+#include "gl_local.h"
+#include "vfs.h"
+#ifdef _WIN32
+#include <sys/utime.h>
+#else
+#include <utime.h>
+#endif
+#include <sys/stat.h>
+
+#define TEXCACHE_MAGIC		"EZTC"
+#define TEXCACHE_VERSION	1
+#define TEXCACHE_ALIGN(x)	(((x) + 15) & ~15)
+
+extern float vid_gamma;
+
+cvar_t gl_texturecache			= {"gl_texturecache", "0"};
+cvar_t gl_texturecache_compress	= {"gl_texturecache_compress", "0"};
+cvar_t gl_texturecache_size		= {"gl_texturecache_size", "256"};	// megabytes
+
+static qbool TexCache_Dir (char *dir, int dir_size)
+{
+	int len;
+
+	if (com_homedir[0])
+		len = snprintf(dir, dir_size, "%s/texcache", com_homedir);
+	else
+		len = snprintf(dir, dir_size, "%s/ezquake/texcache", com_basedir);
+
+	return (len > 0 && len < dir_size);
+}
+
+static qbool TexCache_Path (const texcache_key_t *key, char *path, int path_size)
+{
+	static const char hexdigits[] = "0123456789abcdef";
+	unsigned char digest[16];
+	char dir[MAX_OSPATH], hex[33];
+	int i, len;
+
+	Com_BlockFullChecksum((void *) key, sizeof(*key), digest);
+	for (i = 0; i < 16; i++)
+	{
+		hex[i * 2] = hexdigits[digest[i] >> 4];
+		hex[i * 2 + 1] = hexdigits[digest[i] & 15];
+	}
+	hex[32] = 0;
+
+	if (!TexCache_Dir(dir, sizeof(dir)))
+		return false;
+
+	len = snprintf(path, path_size, "%s/%s.tc", dir, hex);
+	return (len > 0 && len < path_size);
+}
+
+// Marks the entry as just used, trimming removes the least recently used files first.
+static void TexCache_Touch (const char *path)
+{
+	utime(path, NULL);
+}
+
+typedef struct texcache_file_s {
+	char		name[64];
+	int			size;
+	time_t		mtime;
+} texcache_file_t;
+
+typedef struct texcache_filelist_s {
+	char				*dir;
+	texcache_file_t		*files;
+	int					numfiles, maxfiles;
+	double				total;
+} texcache_filelist_t;
+
+static int TexCache_TrimListFile (char *name, int size, void *parm)
+{
+	texcache_filelist_t *list = (texcache_filelist_t *) parm;
+	char path[MAX_OSPATH];
+	struct stat st;
+	int len = strlen(name);
+
+	// Sys_EnumerateFiles marks directories with a trailing slash.
+	if (!len || name[len - 1] == '/' || len >= (int) sizeof(list->files[0].name))
+		return true;
+
+	if (snprintf(path, sizeof(path), "%s/%s", list->dir, name) >= (int) sizeof(path) || stat(path, &st))
+		return true;
+
+	if (list->numfiles == list->maxfiles)
+	{
+		list->maxfiles = max(64, list->maxfiles * 2);
+		list->files = (texcache_file_t *) Q_realloc(list->files, list->maxfiles * sizeof(*list->files));
+	}
+
+	strlcpy(list->files[list->numfiles].name, name, sizeof(list->files[0].name));
+	list->files[list->numfiles].size = (int) st.st_size;
+	list->files[list->numfiles].mtime = st.st_mtime;
+	list->numfiles++;
+	list->total += st.st_size;
+
+	return true;
+}
+
+static int TexCache_TrimCompare (const void *a, const void *b)
+{
+	time_t ta = ((const texcache_file_t *) a)->mtime;
+	time_t tb = ((const texcache_file_t *) b)->mtime;
+
+	return (ta < tb) ? -1 : (ta > tb);
+}
+
+//
+// Removes the least recently used entries until the cache is well below gl_texturecache_size.
+// The size on disk is only counted once, after that stored entries are added up.
+// The directory is walked without Sys_listdir so caches with thousands of entries are fully seen.
+//
+static void TexCache_Trim (int added)
+{
+	static double cachesize = -1;
+	double limit = bound(1, gl_texturecache_size.value, 2047) * 1024 * 1024;
+	char dir[MAX_OSPATH], path[MAX_OSPATH];
+	texcache_filelist_t list;
+	int i;
+
+	if (cachesize >= 0 && (cachesize += added) <= limit)
+		return;
+
+	if (!TexCache_Dir(dir, sizeof(dir)))
+		return;
+
+	memset(&list, 0, sizeof(list));
+	list.dir = dir;
+	Sys_EnumerateFiles(dir, "*.tc", TexCache_TrimListFile, &list);
+	cachesize = list.total;
+
+	if (cachesize > limit)
+	{
+		qsort(list.files, list.numfiles, sizeof(*list.files), TexCache_TrimCompare);
+
+		for (i = 0; i < list.numfiles && cachesize > limit / 4 * 3; i++)
+		{
+			if (snprintf(path, sizeof(path), "%s/%s", dir, list.files[i].name) >= (int) sizeof(path))
+				continue;
+
+			if (Sys_remove(path) == 0)
+				cachesize -= list.files[i].size;
+		}
+	}
+
+	Q_free(list.files);
+}
+
+static qbool TexCache_Load (texcache_entry_t *entry)
+{
+	texcache_header_t *header = &entry->header;
+	char path[MAX_OSPATH];
+	FILE *f;
+	int i, len;
+
+	if (!TexCache_Path(&header->key, path, sizeof(path)))
+		return false;
+
+	if (!(f = fopen(path, "rb")))
+		return false;
+
+	len = FS_FileLength(f) - (int) sizeof(*header);
+	if (len <= 0 || fread(header, sizeof(*header), 1, f) != 1)
+	{
+		fclose(f);
+		return false;
+	}
+
+	entry->data = (byte *) Q_malloc(len);
+	entry->datasize = len;
+	if (fread(entry->data, len, 1, f) != 1)
+	{
+		fclose(f);
+		return false;
+	}
+	fclose(f);
+
+	if (strncmp(header->magic, TEXCACHE_MAGIC, 4) || header->version != TEXCACHE_VERSION)
+		return false;
+
+	// Compressed entries can't be used if the driver doesn't know about s3tc or sRGB is on.
+	if (header->format != TEXCACHE_FMT_RGBA && (!gl_support_s3tc || gl_gammacorrection.integer))
+		return false;
+
+	if (header->numlevels < 1 || header->numlevels > TEXCACHE_MAX_LEVELS)
+		return false;
+
+	// The upload reads exactly width * height worth of pixels per level, the sizes must agree.
+	for (i = 0; i < header->numlevels; i++)
+	{
+		texcache_level_t *level = &header->levels[i];
+		int expected;
+
+		if (level->width <= 0 || level->height <= 0 || level->width > 16384 || level->height > 16384)
+			return false;
+
+		if (header->format == TEXCACHE_FMT_RGBA)
+			expected = level->width * level->height * 4;
+		else if (header->format == TEXCACHE_FMT_DXT1 || header->format == TEXCACHE_FMT_DXT5)
+			expected = Image_DXTSize(level->width, level->height, header->format == TEXCACHE_FMT_DXT5);
+		else
+			return false;
+
+		if (level->size != expected || level->offset < 0 || level->offset > len || level->size > len - level->offset)
+			return false;
+	}
+
+	TexCache_Touch(path);
+	return true;
+}
+
+//
+// Builds the key for the image file and checks the cache for it.
+// On a miss the file is replaced with an in memory copy so it isn't read twice.
+//
+qbool TexCache_Probe (vfsfile_t **f, int mode, int matchwidth, int matchheight, texcache_entry_t *entry)
+{
+	texcache_key_t key, *k = &entry->header.key;
+	vfsfile_t *mem;
+	qbool copyprotected;
+	byte *buf;
+	int len;
+
+	if ((len = VFS_GETLEN(*f)) <= 0)
+		return false;
+
+	buf = (byte *) Q_malloc(len);
+	if (VFS_READ(*f, buf, len, NULL) != len)
+	{
+		// Can't rewind everything (tcp), leave it to the image loader to fail.
+		Q_free(buf);
+		return false;
+	}
+
+	copyprotected = (*f)->copyprotected;
+	VFS_CLOSE(*f);
+	mem = FSMMAP_OpenVFS(buf, len);
+	mem->copyprotected = copyprotected;
+	*f = mem;
+
+	memset(&key, 0, sizeof(key));
+	key.checksum = Com_BlockChecksum(buf, len);
+	key.filelen = len;
+	key.mode = mode;
+	key.matchwidth = matchwidth;
+	key.matchheight = matchheight;
+	key.max_size = gl_max_size.integer;
+	key.max_size_default = gl_max_size_default;
+	key.picmip = gl_picmip.integer;
+	key.npot = gl_support_arb_texture_non_power_of_two;
+	key.lightmode = lightmode;
+	key.luma_level = gl_wicked_luma_level.integer;
+	key.lerpimages = gl_lerpimages.integer;
+	key.gamma = vid_gamma;
+
+	TexCache_Free(entry);
+	*k = key;
+	entry->keyed = true;
+
+	if (TexCache_Load(entry) && !memcmp(&entry->header.key, &key, sizeof(key)))
+	{
+		entry->loaded = true;
+		return true;
+	}
+
+	// Start over, the captured levels will fill it in.
+	Q_free(entry->data);
+	entry->datasize = 0;
+	memset(&entry->header, 0, sizeof(entry->header));
+	entry->header.key = key;
+	return false;
+}
+
+void TexCache_AddLevel (texcache_entry_t *entry, int width, int height, const byte *pixels)
+{
+	texcache_header_t *header = &entry->header;
+	texcache_level_t *level;
+	int size = width * height * 4;
+
+	if (!entry->keyed || entry->loaded || header->numlevels >= TEXCACHE_MAX_LEVELS)
+		return;
+
+	level = &header->levels[header->numlevels++];
+	level->width = width;
+	level->height = height;
+	level->offset = entry->datasize;
+	level->size = size;
+
+	entry->data = (byte *) Q_realloc(entry->data, TEXCACHE_ALIGN(entry->datasize + size));
+	memcpy(entry->data + level->offset, pixels, size);
+	entry->datasize = TEXCACHE_ALIGN(entry->datasize + size);
+}
+
+// Recompress captured RGBA levels to DXT1/DXT5 on the CPU.
+static void TexCache_Compress (texcache_entry_t *entry)
+{
+	texcache_header_t *header = &entry->header;
+	qbool alpha = (header->texmode & TEX_ALPHA) ? true : false;
+	texcache_level_t *level;
+	byte *out;
+	int i, size, outsize = 0;
+
+	for (i = 0; i < header->numlevels; i++)
+		outsize += TEXCACHE_ALIGN(Image_DXTSize(header->levels[i].width, header->levels[i].height, alpha));
+
+	out = (byte *) Q_malloc(outsize);
+
+	for (i = 0, outsize = 0; i < header->numlevels; i++)
+	{
+		level = &header->levels[i];
+		size = Image_DXTSize(level->width, level->height, alpha);
+		Image_CompressDXT(entry->data + level->offset, level->width, level->height, out + outsize, alpha);
+		level->offset = outsize;
+		level->size = size;
+		outsize += TEXCACHE_ALIGN(size);
+	}
+
+	Q_free(entry->data);
+	entry->data = out;
+	entry->datasize = outsize;
+	header->format = alpha ? TEXCACHE_FMT_DXT5 : TEXCACHE_FMT_DXT1;
+}
+
+void TexCache_Store (texcache_entry_t *entry)
+{
+	texcache_header_t *header = &entry->header;
+	char path[MAX_OSPATH];
+	FILE *f;
+
+	if (!entry->keyed || entry->loaded || !header->numlevels)
+		return;
+
+	memcpy(header->magic, TEXCACHE_MAGIC, 4);
+	header->version = TEXCACHE_VERSION;
+	header->format = TEXCACHE_FMT_RGBA;
+
+	if (gl_texturecache_compress.integer && gl_support_s3tc && !gl_gammacorrection.integer)
+		TexCache_Compress(entry);
+
+	if (!TexCache_Path(&header->key, path, sizeof(path)))
+		return;
+
+	if (!(f = fopen(path, "wb")))
+	{
+		FS_CreatePath(path);
+		if (!(f = fopen(path, "wb")))
+		{
+			Com_DPrintf("TexCache_Store: couldn't write %s\n", path);
+			return;
+		}
+	}
+
+	// A short entry would be rejected on load anyway, don't leave it taking up space.
+	if (fwrite(header, sizeof(*header), 1, f) != 1 || fwrite(entry->data, entry->datasize, 1, f) != 1)
+	{
+		fclose(f);
+		Sys_remove(path);
+		Com_DPrintf("TexCache_Store: couldn't write %s\n", path);
+		return;
+	}
+
+	if (fclose(f))
+	{
+		Sys_remove(path);
+		Com_DPrintf("TexCache_Store: couldn't write %s\n", path);
+		return;
+	}
+
+	TexCache_Trim((int) sizeof(*header) + entry->datasize);
+}
+
+void TexCache_Free (texcache_entry_t *entry)
+{
+	Q_free(entry->data);
+	memset(entry, 0, sizeof(*entry));
+}
+
+void TexCache_Init (void)
+{
+	Cvar_SetCurrentGroup(CVAR_GROUP_TEXTURES);
+	Cvar_Register(&gl_texturecache);
+	Cvar_Register(&gl_texturecache_compress);
+	Cvar_Register(&gl_texturecache_size);
+	Cvar_ResetCurrentGroup();
+}
@@ -75,6 +75,9 @@ typedef struct {
 
 static gltexture_t	gltextures[MAX_GLTEXTURES];
 static int			numgltextures = 0;
+
+static texcache_entry_t	*texcache_request = NULL;	// texture cache lookup for the image being loaded
+static texcache_entry_t	*texcache_capture = NULL;	// uploaded mip levels are recorded here
 	   int			texture_extension_number = 1; // non static, sad but used in gl_framebufer.c too
 
 void OnChange_gl_max_size (cvar_t *var, char *string, qbool *cancel) 
@@ -315,6 +318,41 @@ static void brighten32 (byte *data, int size)
 	}
 }
 
+static int GL_InternalFormat (int mode)
+{
+	if (gl_gammacorrection.integer)
+		return (mode & TEX_ALPHA) ? GL_SRGB8_ALPHA8 : GL_SRGB8;
+	else if (mode & TEX_NOCOMPRESS)
+		return (mode & TEX_ALPHA) ? 4 : 3;
+
+	return (mode & TEX_ALPHA) ? gl_alpha_format : gl_solid_format;
+}
+
+static void GL_SetTextureFilters (int mode)
+{
+	if (mode & TEX_MIPMAP)
+	{
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, gl_filter_min);
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, gl_filter_max);
+
+		if (anisotropy_ext)
+			glTexParameterf (GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropy_tap);
+	}
+	else
+	{
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, gl_filter_max_2d);
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, gl_filter_max_2d);
+	}
+}
+
+static void GL_UploadLevel (int miplevel, int internal_format, int width, int height, unsigned *data)
+{
+	glTexImage2D (GL_TEXTURE_2D, miplevel, internal_format, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+
+	if (texcache_capture)
+		TexCache_AddLevel (texcache_capture, width, height, (byte *) data);
+}
+
 //
 // Uploads a 32-bit texture to OpenGL. Makes sure it's the correct size and creates mipmaps if requested.
 //
@@ -373,22 +411,11 @@ static void GL_Upload32 (unsigned *data, int width, int height, int mode)
 	if (mode & TEX_BRIGHTEN)
 		brighten32 ((byte *)newdata, width * height * 4);
 
-	if(gl_gammacorrection.integer)
-	{
-		internal_format = (mode & TEX_ALPHA) ? GL_SRGB8_ALPHA8 : GL_SRGB8;
-	}
-	else if(mode & TEX_NOCOMPRESS)
-	{
-		internal_format = (mode & TEX_ALPHA) ? 4 : 3;
-	}
-	else
-	{
-		internal_format = (mode & TEX_ALPHA) ? gl_alpha_format : gl_solid_format;
-	}
+	internal_format = GL_InternalFormat(mode);
 
 	// Upload the main texture to OpenGL.
 	miplevel = 0;
-	glTexImage2D (GL_TEXTURE_2D, 0, internal_format, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, newdata);
+	GL_UploadLevel (miplevel, internal_format, width, height, newdata);
 
 	if (mode & TEX_MIPMAP)
 	{
@@ -397,21 +424,12 @@ static void GL_Upload32 (unsigned *data, int width, int height, int mode)
 		{
 			Image_MipReduce ((byte *) newdata, (byte *) newdata, &width, &height, 4);
 			miplevel++;
-			glTexImage2D (GL_TEXTURE_2D, miplevel, internal_format, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, newdata);
+			GL_UploadLevel (miplevel, internal_format, width, height, newdata);
 		}
-
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, gl_filter_min);
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, gl_filter_max);
-
-		if (anisotropy_ext)
-			glTexParameterf (GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropy_tap);
-	} 
-	else
-	{
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, gl_filter_max_2d);
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, gl_filter_max_2d);
 	}
 
+	GL_SetTextureFilters (mode);
+
 	Q_free(newdata);
 }
 
@@ -476,32 +494,22 @@ static void GL_Upload8 (byte *data, int width, int height, int mode)
 	GL_Upload32 (trans, width, height, mode & ~TEX_BRIGHTEN);
 }
 
-int GL_LoadTexture (char *identifier, int width, int height, byte *data, int mode, int bpp) 
+//
+// Finds the texture slot for the identifier, or allocates a new one.
+// Returns NULL if exactly the same texture is already loaded, texnum is set then.
+//
+static gltexture_t *GL_AllocTextureSlot (char *identifier, int width, int height, int scaled_width, int scaled_height,
+										 unsigned short crc, int mode, int bpp, int *texnum)
 {
-	int	i, scaled_width, scaled_height;
-	unsigned short crc = 0;
+	int	i;
 	qbool load_over_existing = false;
 	gltexture_t *glt = NULL;
 
-	if (lightmode != 2)
-		mode &= ~TEX_BRIGHTEN;
-
-	ScaleDimensions(width, height, &scaled_width, &scaled_height, mode);
-
-	if (developer.integer >= 3)
-	{
-		Com_DPrintf("Texture: %s %dx%d -> %dx%d %s\n",
-				identifier, width, height, scaled_width, scaled_height,
-				((scaled_width & (scaled_width-1)) || (scaled_height & (scaled_height-1))) ? "non power of two" : "");
-	}
-
 	// If we were given an identifier for the texture, search through
 	// the list of loaded texture and see if we find a match, if so
 	// return the texnum for the already loaded texture.
 	if (identifier[0]) 
 	{
-		crc = CRC_Block (data, width * height * bpp);
-
 		for (i = 0, glt = gltextures; i < numgltextures; i++, glt++) 
 		{
 			if (!strncmp (identifier, glt->identifier, sizeof(glt->identifier) - 1)) 
@@ -513,8 +521,8 @@ int GL_LoadTexture (char *identifier, int width, int height, byte *data, int mod
 					crc == glt->crc && glt->bpp == bpp &&
 					(mode & ~(TEX_COMPLAIN | TEX_NOSCALE)) == (glt->texmode & ~(TEX_COMPLAIN | TEX_NOSCALE)))
 				{
-					GL_Bind(gltextures[i].texnum);
-					return gltextures[i].texnum;
+					*texnum = gltextures[i].texnum;
+					return NULL;
 				} 
 				else 
 				{
@@ -559,6 +567,46 @@ int GL_LoadTexture (char *identifier, int width, int height, byte *data, int mod
 	if (bpp == 4 && fs_netpath[0])
 		glt->pathname = Q_strdup(fs_netpath);
 
+	return glt;
+}
+
+int GL_LoadTexture (char *identifier, int width, int height, byte *data, int mode, int bpp) 
+{
+	int	scaled_width, scaled_height, texnum;
+	unsigned short crc = 0;
+	gltexture_t *glt;
+
+	if (lightmode != 2)
+		mode &= ~TEX_BRIGHTEN;
+
+	ScaleDimensions(width, height, &scaled_width, &scaled_height, mode);
+
+	if (developer.integer >= 3)
+	{
+		Com_DPrintf("Texture: %s %dx%d -> %dx%d %s\n",
+				identifier, width, height, scaled_width, scaled_height,
+				((scaled_width & (scaled_width-1)) || (scaled_height & (scaled_height-1))) ? "non power of two" : "");
+	}
+
+	if (identifier[0])
+		crc = CRC_Block (data, width * height * bpp);
+
+	if (!(glt = GL_AllocTextureSlot (identifier, width, height, scaled_width, scaled_height, crc, mode, bpp, &texnum)))
+	{
+		GL_Bind(texnum);
+		return texnum;
+	}
+
+	if (texcache_capture)
+	{
+		texcache_capture->header.width = width;
+		texcache_capture->header.height = height;
+		texcache_capture->header.scaled_width = scaled_width;
+		texcache_capture->header.scaled_height = scaled_height;
+		texcache_capture->header.texmode = mode;
+		texcache_capture->header.crc = crc;
+	}
+
 	// Tell OpenGL the texnum of the texture before uploading it.
 	GL_Bind(glt->texnum);
 
@@ -576,6 +624,47 @@ int GL_LoadTexture (char *identifier, int width, int height, byte *data, int mod
 	return glt->texnum;
 }
 
+//
+// Uploads the mip levels stored in the texture cache, no decoding or resampling needed.
+//
+static int GL_LoadCachedTexture (char *identifier, texcache_entry_t *entry)
+{
+	texcache_header_t *header = &entry->header;
+	texcache_level_t *level;
+	gltexture_t *glt;
+	int i, texnum, internal_format;
+
+	if (!(glt = GL_AllocTextureSlot (identifier, header->width, header->height, header->scaled_width, header->scaled_height,
+									 header->crc, header->texmode, 4, &texnum)))
+	{
+		GL_Bind(texnum);
+		return texnum;
+	}
+
+	GL_Bind(glt->texnum);
+
+	switch (header->format)
+	{
+		case TEXCACHE_FMT_DXT1: internal_format = GL_COMPRESSED_RGB_S3TC_DXT1_EXT; break;
+		case TEXCACHE_FMT_DXT5: internal_format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
+		default: internal_format = GL_InternalFormat(header->texmode); break;
+	}
+
+	for (i = 0; i < header->numlevels; i++)
+	{
+		level = &header->levels[i];
+
+		if (header->format == TEXCACHE_FMT_RGBA)
+			glTexImage2D (GL_TEXTURE_2D, i, internal_format, level->width, level->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, entry->data + level->offset);
+		else
+			qglCompressedTexImage2D (GL_TEXTURE_2D, i, internal_format, level->width, level->height, 0, level->size, entry->data + level->offset);
+	}
+
+	GL_SetTextureFilters (header->texmode);
+
+	return glt->texnum;
+}
+
 int GL_LoadPicTexture (const char *name, mpic_t *pic, byte *data) 
 {
 	int glwidth, glheight, i;
@@ -647,6 +736,13 @@ static gltexture_t *current_texture = NULL;
 	}
 
 
+// Image file is swapped for an in memory copy on a cache miss.
+#define CHECK_TEXTURE_CACHED												\
+	if (texcache_request && TexCache_Probe(&f, mode, matchwidth, matchheight, texcache_request)) {	\
+		VFS_CLOSE(f);														\
+		return NULL;														\
+	}
+
 static qbool CheckTextureLoaded(int mode) 
 {
 	int scaled_width, scaled_height;
@@ -709,6 +805,7 @@ byte *GL_LoadImagePixels (const char *filename, int matchwidth, int matchheight,
 		if ((f = FS_OpenVFS(name, "rb", FS_ANY))) 
 		{
        		CHECK_TEXTURE_ALREADY_LOADED;
+			CHECK_TEXTURE_CACHED;
        		if( !data && !strcasecmp(link + len - 3, "tga") )
 			{
 				data = Image_LoadTGA (f, name, matchwidth, matchheight, real_width, real_height);
@@ -775,6 +872,7 @@ byte *GL_LoadImagePixels (const char *filename, int matchwidth, int matchheight,
 
 	if (best && f) {
 		CHECK_TEXTURE_ALREADY_LOADED;
+		CHECK_TEXTURE_CACHED;
 		snprintf (name, sizeof (name), "%s.%s", basename, best->extension);
 		if ((data = best->function (f, name, matchwidth, matchheight, real_width, real_height))) {
 			return data;
@@ -835,6 +933,7 @@ int GL_LoadTextureImage (char *filename, char *identifier, int matchwidth, int m
 	byte *data;
 	int image_width = -1, image_height = -1;
 	gltexture_t *gltexture;
+	texcache_entry_t entry;
 
 	if (no24bit)
 		return 0;
@@ -844,16 +943,29 @@ int GL_LoadTextureImage (char *filename, char *identifier, int matchwidth, int m
 
 	gltexture = current_texture = GL_FindTexture(identifier);
 
-	if (!(data = GL_LoadImagePixels (filename, matchwidth, matchheight, mode, &image_width, &image_height))) 
+	memset(&entry, 0, sizeof(entry));
+	texcache_request = gl_texturecache.integer ? &entry : NULL;
+	data = GL_LoadImagePixels (filename, matchwidth, matchheight, mode, &image_width, &image_height);
+	texcache_request = NULL;
+
+	if (entry.loaded)
+	{
+		texnum = GL_LoadCachedTexture(identifier, &entry);
+	}
+	else if (!data) 
 	{
 		texnum =  (gltexture && !current_texture) ? gltexture->texnum : 0;
 	} 
 	else 
 	{
+		texcache_capture = entry.keyed ? &entry : NULL;
 		texnum = GL_LoadTexturePixels(data, identifier, image_width, image_height, mode);
+		texcache_capture = NULL;
+		TexCache_Store(&entry);
 		Q_free(data);	// Data was Q_malloc'ed by GL_LoadImagePixels.
 	}
 
+	TexCache_Free(&entry);
 	current_texture = NULL;
 	return texnum;
 }
@@ -1047,6 +1159,8 @@ void GL_Texture_Init(void)
     Cvar_Register(&gl_no24bit);
 	Cvar_Register(&gl_wicked_luma_level);
 
+	TexCache_Init();
+
 	glGetIntegerv(GL_MAX_TEXTURE_SIZE, (GLint *)&gl_max_size_default);
 	Cvar_SetDefault(&gl_max_size, gl_max_size_default);
 
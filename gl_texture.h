@@ -60,9 +60,62 @@ int GL_LoadCharsetImage (char *, char *, int);
 void GL_Texture_Init(void);
 
 
+// Texture cache, keeps final mip chains of external textures on disk (gl_texcache.c)
+
+#define TEXCACHE_MAX_LEVELS	16
+
+typedef enum {
+	TEXCACHE_FMT_RGBA,
+	TEXCACHE_FMT_DXT1,
+	TEXCACHE_FMT_DXT5
+} texcache_format_t;
+
+typedef struct texcache_key_s {
+	unsigned	checksum;		// checksum of the source image file
+	int			filelen;
+	int			mode, matchwidth, matchheight;
+	int			max_size, max_size_default, picmip, npot;
+	int			lightmode, luma_level, lerpimages;
+	float		gamma;
+} texcache_key_t;
+
+typedef struct texcache_level_s {
+	int			width, height;
+	int			offset, size;	// offset is relative to the end of the header
+} texcache_level_t;
+
+typedef struct texcache_header_s {
+	char				magic[4];
+	int					version;
+	texcache_key_t		key;
+	int					width, height, scaled_width, scaled_height;
+	int					texmode;
+	unsigned			crc;
+	int					format;
+	int					numlevels;
+	texcache_level_t	levels[TEXCACHE_MAX_LEVELS];
+} texcache_header_t;
+
+typedef struct texcache_entry_s {
+	texcache_header_t	header;
+	qbool				keyed;		// key is valid, so entry may be stored
+	qbool				loaded;		// entry was read from disk and can be uploaded as is
+	byte				*data;		// level data, follows the header
+	int					datasize;
+} texcache_entry_t;
+
+void TexCache_Init(void);
+qbool TexCache_Probe(vfsfile_t **f, int mode, int matchwidth, int matchheight, texcache_entry_t *entry);
+void TexCache_AddLevel(texcache_entry_t *entry, int width, int height, const byte *pixels);
+void TexCache_Store(texcache_entry_t *entry);
+void TexCache_Free(texcache_entry_t *entry);
+
+extern cvar_t gl_texturecache;
+
+
 extern int gl_lightmap_format, gl_solid_format, gl_alpha_format;
 
-extern cvar_t gl_max_size, gl_scaleModelTextures, gl_scaleTurbTextures, gl_miptexLevel;
+extern cvar_t gl_max_size, gl_picmip, gl_lerpimages, gl_scaleModelTextures, gl_scaleTurbTextures, gl_miptexLevel;
 extern cvar_t gl_externalTextures_world, gl_externalTextures_bmodels;
 extern cvar_t gl_no24bit;
 extern cvar_t gl_wicked_luma_level;
@@ -50,6 +50,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "qsound.h"
 #include "keys.h"
 #include "config_manager.h"
+#include "movie.h"
 #include "EX_qtvlist.h"
 
 double		curtime;
@@ -460,12 +461,20 @@ void Host_ClearMemory (void)
 
 void Host_Frame (double time)
 {
+	// transient strings from the previous frame are done with
+	Frame_Reset ();
+
 	if (setjmp (host_abort))
 		return;			// something bad happened, or the server disconnected
 
 	curtime += time;
 
 	CL_Frame (time);	// will also call SV_Frame
+
+#ifndef CLIENTONLY
+	// SV_Frame doesn't run every frame, or at all once the server is gone
+	SV_DiskIO_Frame (0);
+#endif
 }
 
 char *Host_PrintBars(char *s, int len)
@@ -697,7 +706,11 @@ void Host_Init (int argc, char **argv, int default_memsize)
 	{
 		char cmd[1024] = {0};
 
-		if (COM_CheckArgsForPlayableFiles(cmd, sizeof(cmd)))
+		if (Movie_IsHeadless())
+		{
+			Movie_HeadlessStart();
+		}
+		else if (COM_CheckArgsForPlayableFiles(cmd, sizeof(cmd)))
 		{
 			Cbuf_AddText(cmd);
 		}
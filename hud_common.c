@@ -224,7 +224,7 @@ int TP_IsAmmoLow(int weapon)
 
 int TP_TeamFortressEngineerSpanner(void)
 {
-	char *player_skin=Info_ValueForKey(cl.players[cl.playernum].userinfo,"skin");
+	char *player_skin=Info_Get(&cl.players[cl.playernum]._userinfo_ctx_,"skin");
 	char *model_name=cl.model_precache[cl.viewent.current.modelindex]->name;
 	if (cl.teamfortress && player_skin
 			&& (strcasecmp(player_skin, "tf_eng") == 0)
@@ -4057,22 +4057,21 @@ void SCR_HUD_DrawTeamFrags(hud_t *hud)
 	}
 }
 
+// returns frame memory
 char *Get_MP3_HUD_style(float style, char *st)
 {
-	static char HUD_style[32];
 	if(style == 1.0)
 	{
-		strlcpy(HUD_style, va("%s:", st), sizeof(HUD_style));
+		return Frame_Printf("%s:", st);
 	}
 	else if(style == 2.0)
 	{
-		strlcpy(HUD_style, va("\x10%s\x11", st), sizeof(HUD_style));
+		return Frame_Printf("\x10%s\x11", st);
 	}
 	else
 	{
-		strlcpy(HUD_style, "", sizeof(HUD_style));
+		return "";
 	}
-	return HUD_style;
 }
 
 // Draws MP3 Title.
@@ -4173,7 +4172,6 @@ void SCR_HUD_DrawMP3_Time(hud_t *hud)
 	int remain = 0;
 	int total = 0;
 	static char time_string[MP3_MAXSONGTITLE];
-	static char elapsed_string[MP3_MAXSONGTITLE];
 	double t; // current time
 	static double lastframetime; // last refresh
 
@@ -4204,8 +4202,7 @@ void SCR_HUD_DrawMP3_Time(hud_t *hud)
 			{
 				case 1 :
 					remain = total - elapsed;
-					strlcpy (elapsed_string, SecondsToMinutesString (remain), sizeof (elapsed_string));
-					snprintf (time_string, sizeof (time_string), "\x10-%s/%s\x11", elapsed_string, SecondsToMinutesString (total));
+					snprintf (time_string, sizeof (time_string), "\x10-%s/%s\x11", SecondsToMinutesString (remain), SecondsToMinutesString (total));
 					break;
 				case 2 :
 					remain = total - elapsed;
@@ -4216,12 +4213,10 @@ void SCR_HUD_DrawMP3_Time(hud_t *hud)
 					break;
 				case 4 :
 					remain = total - elapsed;
-					strlcpy (elapsed_string, SecondsToMinutesString (remain), sizeof (elapsed_string));
-					snprintf (time_string, sizeof (time_string), "%s/%s", elapsed_string, SecondsToMinutesString (total));
+					snprintf (time_string, sizeof (time_string), "%s/%s", SecondsToMinutesString (remain), SecondsToMinutesString (total));
 					break;
 				case 5 :
-					strlcpy (elapsed_string, SecondsToMinutesString (elapsed), sizeof (elapsed_string));
-					snprintf (time_string, sizeof (time_string), "-%s/%s", elapsed_string, SecondsToMinutesString (total));
+					snprintf (time_string, sizeof (time_string), "-%s/%s", SecondsToMinutesString (elapsed), SecondsToMinutesString (total));
 					break;
 				case 6 :
 					remain = total - elapsed;
@@ -4232,8 +4227,7 @@ void SCR_HUD_DrawMP3_Time(hud_t *hud)
 					break;
 				case 0 :
 				default :
-					strlcpy (elapsed_string, SecondsToMinutesString (elapsed), sizeof (elapsed_string));
-					snprintf (time_string, sizeof (time_string), "\x10%s/%s\x11", elapsed_string, SecondsToMinutesString (total));
+					snprintf (time_string, sizeof (time_string), "\x10%s/%s\x11", SecondsToMinutesString (elapsed), SecondsToMinutesString (total));
 					break;
 			}
 		}
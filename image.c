@@ -501,6 +501,174 @@ void Image_MipReduce (const byte *in, byte *out, int *width, int *height, int bp
 	}
 }
 
+/************************************ DXT ************************************/
+
+// S3TC block compression done on the CPU, so results can be stored in the
+// texture cache and uploaded as is, no matter what the driver would do with them.
+
+#define DXT_PACK565(r, g, b)	((((r) >> 3) << 11) | (((g) >> 2) << 5) | ((b) >> 3))
+
+static void Image_DXTUnpack565 (unsigned short c, byte *out)
+{
+	out[0] = ((c >> 11) & 31) * 255 / 31;
+	out[1] = ((c >> 5) & 63) * 255 / 63;
+	out[2] = (c & 31) * 255 / 31;
+}
+
+// Fetch 4x4 block of RGBA pixels, edge pixels are repeated for textures smaller than 4x4.
+static void Image_DXTFetchBlock (const byte *in, int width, int height, int bx, int by, byte *block)
+{
+	int x, y, sx, sy;
+
+	for (y = 0; y < 4; y++)
+	{
+		sy = min(by + y, height - 1);
+		for (x = 0; x < 4; x++)
+		{
+			sx = min(bx + x, width - 1);
+			memcpy(block + (y * 4 + x) * 4, in + (sy * width + sx) * 4, 4);
+		}
+	}
+}
+
+static void Image_DXTColorBlock (const byte *block, byte *out)
+{
+	byte mincol[3] = {255, 255, 255}, maxcol[3] = {0, 0, 0}, palette[4][3];
+	unsigned short c0, c1;
+	unsigned int indices = 0;
+	int i, j, inset, best, dist, bestdist;
+
+	for (i = 0; i < 16; i++)
+	{
+		for (j = 0; j < 3; j++)
+		{
+			mincol[j] = min(mincol[j], block[i * 4 + j]);
+			maxcol[j] = max(maxcol[j], block[i * 4 + j]);
+		}
+	}
+
+	// Move the end points slightly inside the bounding box, reduces the error for the middle colors.
+	for (j = 0; j < 3; j++)
+	{
+		inset = (maxcol[j] - mincol[j]) >> 4;
+		mincol[j] = min(mincol[j] + inset, 255);
+		maxcol[j] = max(maxcol[j] - inset, 0);
+	}
+
+	c0 = DXT_PACK565(maxcol[0], maxcol[1], maxcol[2]);
+	c1 = DXT_PACK565(mincol[0], mincol[1], mincol[2]);
+
+	if (c0 != c1)
+	{
+		Image_DXTUnpack565(c0, palette[0]);
+		Image_DXTUnpack565(c1, palette[1]);
+		for (j = 0; j < 3; j++)
+		{
+			palette[2][j] = (2 * palette[0][j] + palette[1][j]) / 3;
+			palette[3][j] = (palette[0][j] + 2 * palette[1][j]) / 3;
+		}
+
+		for (i = 15; i >= 0; i--)
+		{
+			best = 0;
+			bestdist = INT_MAX;
+			for (j = 0; j < 4; j++)
+			{
+				dist = (block[i * 4] - palette[j][0]) * (block[i * 4] - palette[j][0])
+					+ (block[i * 4 + 1] - palette[j][1]) * (block[i * 4 + 1] - palette[j][1])
+					+ (block[i * 4 + 2] - palette[j][2]) * (block[i * 4 + 2] - palette[j][2]);
+				if (dist < bestdist)
+				{
+					bestdist = dist;
+					best = j;
+				}
+			}
+			indices = (indices << 2) | best;
+		}
+	}
+
+	// c0 >= c1 always since the end points are per channel max/min, so the block stays in 4 color mode.
+	out[0] = c0 & 0xFF;
+	out[1] = c0 >> 8;
+	out[2] = c1 & 0xFF;
+	out[3] = c1 >> 8;
+	out[4] = indices & 0xFF;
+	out[5] = (indices >> 8) & 0xFF;
+	out[6] = (indices >> 16) & 0xFF;
+	out[7] = (indices >> 24) & 0xFF;
+}
+
+static void Image_DXTAlphaBlock (const byte *block, byte *out)
+{
+	byte a0 = 0, a1 = 255, palette[8];
+	unsigned long long indices = 0;
+	int i, j, best, dist, bestdist;
+
+	for (i = 0; i < 16; i++)
+	{
+		a0 = max(a0, block[i * 4 + 3]);
+		a1 = min(a1, block[i * 4 + 3]);
+	}
+
+	if (a0 != a1)
+	{
+		palette[0] = a0;
+		palette[1] = a1;
+		for (j = 1; j < 7; j++)
+			palette[j + 1] = ((7 - j) * a0 + j * a1) / 7;
+
+		for (i = 15; i >= 0; i--)
+		{
+			best = 0;
+			bestdist = INT_MAX;
+			for (j = 0; j < 8; j++)
+			{
+				dist = abs(block[i * 4 + 3] - palette[j]);
+				if (dist < bestdist)
+				{
+					bestdist = dist;
+					best = j;
+				}
+			}
+			indices = (indices << 3) | best;
+		}
+	}
+
+	out[0] = a0;
+	out[1] = a1;
+	for (i = 0; i < 6; i++)
+		out[2 + i] = (indices >> (8 * i)) & 0xFF;
+}
+
+int Image_DXTSize (int width, int height, qbool alpha)
+{
+	return ((width + 3) / 4) * ((height + 3) / 4) * (alpha ? 16 : 8);
+}
+
+// Compress RGBA image to DXT5 if alpha is set, DXT1 otherwise, out must be at least Image_DXTSize() bytes.
+void Image_CompressDXT (const byte *in, int width, int height, byte *out, qbool alpha)
+{
+	byte block[16 * 4];
+	int x, y;
+
+	for (y = 0; y < height; y += 4)
+	{
+		for (x = 0; x < width; x += 4)
+		{
+			Image_DXTFetchBlock(in, width, height, x, y, block);
+
+			if (alpha)
+			{
+				Image_DXTAlphaBlock(block, out);
+				out += 8;
+			}
+
+			Image_DXTColorBlock(block, out);
+			out += 8;
+		}
+	}
+}
+
 /************************************ PNG ************************************/
 #ifdef WITH_PNG
 
@@ -32,6 +32,8 @@ void Image_Init(void);
 void Image_Resample (void *indata, int inwidth, int inheight,
 					 void *outdata, int outwidth, int outheight, int bpp, int quality);
 void Image_MipReduce (const byte *in, byte *out, int *width, int *height, int bpp);
+int Image_DXTSize (int width, int height, qbool alpha);
+void Image_CompressDXT (const byte *in, int width, int height, byte *out, qbool alpha);
 
 typedef struct
 {
@@ -24,6 +24,7 @@ void IN_Shutdown (void);
 void IN_Commands (void); // oportunity for devices to stick commands on the script buffer
 void IN_Move (usercmd_t *cmd); // add additional movement on top of the keyboard move cmd
 void IN_ClearProtectedKeys (void); // reset player movement
+void IN_PollMouse (void); // pick up mouse movement in the middle of a frame
 
 //
 // cl_input.c
@@ -43,6 +44,7 @@ extern kbutton_t in_speed;
 void CL_InitInput (void);
 void CL_SendClientCommand(qbool reliable, char *format, ...);
 void CL_SendCmd (void);
+void CL_InputSampled (void);
 void CL_BaseMove (usercmd_t *cmd);
 float CL_KeyState (kbutton_t *key, qbool lookbutton);
 qbool Key_TryMovementProtected(const char *cmd, qbool down, int key);
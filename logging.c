@@ -446,7 +446,7 @@ void Log_AutoLogging_Upload(const char *filename)
 		MT_Challenge_IsOn(),
 		MT_Challenge_GetHash(),
 		filename,
-		Info_ValueForKey(cl.serverinfo, "hostname"),
+		Info_Get(&cl._serverinfo_ctx_, "hostname"),
 		cl.players[cl.playernum].name,
 		MT_Challenge_GetToken(),
 		match_auto_logurl.string,
@@ -110,7 +110,7 @@ static char *MT_EnemyName(void) {
 
 	for (i = 0; i < MAX_CLIENTS; i++) {
 		if (cl.players[i].name[0] && !cl.players[i].spectator) {
-			name = Info_ValueForKey(cl.players[i].userinfo, "name");
+			name = Info_Get(&cl.players[i]._userinfo_ctx_, "name");
 			if (strcmp(name, myname)) {
 				strlcpy(enemyname, name, sizeof (enemyname));
 				return enemyname;
@@ -232,7 +232,7 @@ static int MT_GetTeamNames(char teams[][MAX_INFO_STRING], int max) {
 static char *MT_Serverinfo_Race(void) {
 	static char buf[MAX_OSPATH];
 
-	strlcpy(buf, Info_ValueForKey(cl.serverinfo, "race"), sizeof(buf));
+	strlcpy(buf, Info_Get(&cl._serverinfo_ctx_, "race"), sizeof(buf));
 	return buf;
 }
 
@@ -418,10 +418,10 @@ static matchinfo_t *MT_GetMatchInfo(void) {
 
 	matchinfo.numplayers = MT_CountPlayers();
 
-	matchinfo.timelimit = Q_atoi(Info_ValueForKey(cl.serverinfo, "timelimit"));
-	matchinfo.fraglimit = Q_atoi(Info_ValueForKey(cl.serverinfo, "fraglimit"));
-	matchinfo.teamplay = Q_atoi(Info_ValueForKey(cl.serverinfo, "teamplay"));
-	matchinfo.maxclients = Q_atoi(Info_ValueForKey(cl.serverinfo, "maxclients"));
+	matchinfo.timelimit = Q_atoi(Info_Get(&cl._serverinfo_ctx_, "timelimit"));
+	matchinfo.fraglimit = Q_atoi(Info_Get(&cl._serverinfo_ctx_, "fraglimit"));
+	matchinfo.teamplay = Q_atoi(Info_Get(&cl._serverinfo_ctx_, "teamplay"));
+	matchinfo.maxclients = Q_atoi(Info_Get(&cl._serverinfo_ctx_, "maxclients"));
 	matchinfo.deathmatch = cl.deathmatch;
 
 	strlcpy(matchinfo.mapname, MT_MapName(), sizeof(matchinfo.mapname));
@@ -606,7 +606,7 @@ char *MT_MatchName(void) {
 
 char *MT_ShortStatus(void)
 {
-	int maxclients = Q_atoi(Info_ValueForKey(cl.serverinfo, "maxclients"));
+	int maxclients = Q_atoi(Info_Get(&cl._serverinfo_ctx_, "maxclients"));
 	char *mapname = TP_MapName();
 
 	return va("%d/%d - %s", TP_CountPlayers(), maxclients, mapname);
@@ -698,7 +698,7 @@ static const char *MT_Challenge_GenerateHash(void)
 {
 	static unsigned char hash[DIGEST_SIZE];
 	SHA1_CTX context;
-	char* hostname = Info_ValueForKey(cl.serverinfo, "hostname");
+	char* hostname = Info_Get(&cl._serverinfo_ctx_, "hostname");
 	double curtime = Sys_DoubleTime();
 
 	SHA1Init(&context);
@@ -752,7 +752,7 @@ void MT_Challenge_Destroy(challenge_data_t *challenge)
 challenge_data_t *MT_Challenge_Init(challenge_status_e status)
 {
 	return MT_Challenge_Create(status, MT_CountPlayers(), match_ladder_id.string, match_auto_logupload_token.string,
-			MT_PlayerName(), MT_EnemyName(), Info_ValueForKey(cl.serverinfo, "hostname"), host_mapname.string,
+			MT_PlayerName(), MT_EnemyName(), Info_Get(&cl._serverinfo_ctx_, "hostname"), host_mapname.string,
 			match_challenge_url.string, MT_Challenge_GenerateHash());
 }
 
@@ -23,6 +23,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "quakedef.h"
 #include "utils.h"
 #include "qsound.h"
+#include "movie.h"
 #ifdef _WIN32
 #include "movie_avi.h"	//joe: capturing to avi
 #include <windows.h>
@@ -65,6 +66,7 @@ cvar_t          movie_fps                = {"demo_capture_fps", "30.0"};
 static cvar_t   movie_dir                = {"demo_capture_dir",  "capture", 0, OnChange_movie_dir};
 cvar_t          movie_steadycam          = {"demo_capture_steadycam", "0"};
 static cvar_t   movie_background_threads = {"demo_capture_background_threads", "0"};
+static cvar_t   movie_pipe               = {"demo_capture_pipe", ""};
 
 extern cvar_t scr_sshot_type;
 
@@ -84,6 +86,46 @@ static char image_ext[4];
 	struct tm movie_start_date;
 #endif
 
+// Headless mode: ezquake -capturedemo <demo> [-capturetime <seconds>] renders the demo
+// into a hidden window as fast as possible, captures it and quits when done.
+qbool Movie_IsHeadless(void)
+{
+	static int headless = -1;
+
+	if (headless < 0) {
+		int i = COM_CheckParm("-capturedemo");
+
+		headless = (i && i + 1 < COM_Argc()) ? 1 : 0;
+	}
+
+	return headless;
+}
+
+// Called instead of the usual startup place once the configs and command line have run.
+void Movie_HeadlessStart(void)
+{
+	double len = 999999;
+	int i;
+
+	// nothing waits for the screen and nothing of this run should end up in the user's config
+	Cvar_SetValueByName("vid_vsync", 0);
+	Cvar_SetValueByName("sys_inactivesleep", 0);
+	Cvar_SetValueByName("cfg_save_onquit", 0);
+
+	if ((i = COM_CheckParm("-capturetime")) && i + 1 < COM_Argc())
+		len = Q_atof(COM_Argv(i + 1));
+
+	Cbuf_AddText(va("playdemo \"%s\"\n", COM_Argv(COM_CheckParm("-capturedemo") + 1)));
+	Cbuf_Execute();
+	if (!cls.demoplayback)
+		Sys_Error("-capturedemo: couldn't play %s\n", COM_Argv(COM_CheckParm("-capturedemo") + 1));
+
+	Cbuf_AddText(va("demo_capture start %f\n", len));
+	Cbuf_Execute();
+	if (!Movie_IsCapturing())
+		Sys_Error("-capturedemo: couldn't start capturing\n");
+}
+
 qbool Movie_IsCapturing(void)
 {
 	return cls.demoplayback && !cls.timedemo && movie_is_capturing;
@@ -108,6 +150,7 @@ double Movie_InputFrametime(void)
 static void Movie_Start(double _time) 
 {
 	extern cvar_t scr_sshot_format;
+	extern int glwidth, glheight;
 
 	#ifndef _WIN32
 	time_t t;
@@ -145,7 +188,12 @@ static void Movie_Start(double _time)
 			strlcpy (image_ext, "tga", sizeof (image_ext));
 		}
 		movie_is_capturing = true;
-		WAVCaptureStart ();
+		if (movie_pipe.string[0] && !Movie_PipeStart(movie_pipe.string, movie_dir.string, glwidth, glheight, 1.0 / Movie_Frametime())) {
+			movie_is_capturing = false;
+			return;
+		}
+		if (!Movie_PipeAudioEnabled())
+			WAVCaptureStart ();
 	}
 	movie_real_start_time = Sys_DoubleTime ();
 }
@@ -165,8 +213,13 @@ void Movie_Stop (qbool restarting) {
 		Com_Printf("  Time: %5.1f seconds\n", Sys_DoubleTime() - movie_real_start_time);
 	}
 #endif
+	Movie_PipeStop ();
 	WAVCaptureStop ();
 	movie_is_capturing = restarting;
+
+	// the demo ended or the time ran out, the job is done
+	if (!restarting && Movie_IsHeadless())
+		Cbuf_AddText("quit\n");
 }
 
 void Movie_Demo_Capture_f(void) {
@@ -265,6 +318,7 @@ void Movie_Init(void) {
 	Cvar_Register(&movie_dir);
 	Cvar_Register(&movie_background_threads);
 	Cvar_Register(&movie_steadycam);
+	Cvar_Register(&movie_pipe);
 
 	Cvar_ResetCurrentGroup();
 
@@ -351,7 +405,13 @@ void Movie_FinishFrame(void)
 		con_suppress = false;
 	}
 
-	if (cls.realtime >= movie_start_time + movie_len) {
+	if (Movie_PipeFailed()) {
+		Com_Printf("demo_capture: video pipe closed, stopping capture\n");
+		Movie_Stop (false);
+		if (Movie_IsHeadless())
+			Sys_Error("-capturedemo: capture failed\n");
+	}
+	else if (cls.realtime >= movie_start_time + movie_len) {
 		Movie_Stop (false);
 	}
 }
@@ -486,7 +546,12 @@ void Movie_TransferSound(void* data, int snd_linear_count)
 			WAVCaptureFrame (samples_per_frame, (byte *)capture_audio_samples);
 		}
 #else
-		WAVCaptureFrame (samples_per_frame, (byte *)capture_audio_samples);
+		if (Movie_PipeAudioEnabled()) {
+			Movie_PipeAudio (samples_per_frame, (byte *)capture_audio_samples);
+		}
+		else {
+			WAVCaptureFrame (samples_per_frame, (byte *)capture_audio_samples);
+		}
 #endif
 		memcpy (capture_audio_samples, capture_audio_samples + (samples_per_frame << 1), (captured_audio_samples - samples_per_frame) * 2 * shw->numchannels);
 		captured_audio_samples -= samples_per_frame;
@@ -27,10 +27,25 @@ void Movie_StartFrame(void);
 void Movie_FinishFrame(void);
 qbool Movie_IsCapturing(void);
 qbool Movie_IsCapturingAVI(void);
+qbool Movie_IsHeadless(void);
+void Movie_HeadlessStart(void);
 void Movie_Stop(qbool restarting);
 double Movie_Frametime(void);
 double Movie_InputFrametime(void);
-qbool Movie_TransferSound(void* data, int snd_linear_count);
+void Movie_TransferSound(void* data, int snd_linear_count);
 void Movie_MixFrameSound(void (*mixFunction)(void));
 
+// movie_pipe.c
+qbool Movie_PipeStart(const char *command, const char *dir, int width, int height, double fps);
+void Movie_PipeStop(void);
+qbool Movie_IsCapturingPipe(void);
+qbool Movie_PipeFailed(void);
+qbool Movie_PipeAudioEnabled(void);
+byte *Movie_PipeVideoBuffer(int width, int height);
+void Movie_PipeSubmitVideo(double readback);
+void Movie_PipeAudio(int samples, const byte *data);
+
+// cl_screen.c
+void SCR_MovieReadbackFinish(void);
+
 #endif
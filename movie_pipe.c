@@ -0,0 +1,385 @@
+/*
+Copyright (C) 2026 ezQuake team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// movie_pipe.c -- streams captured demo frames and audio into an external encoder.
+//
+// Frames are written as raw top-down rgb24 to the standard input of the command
+// in demo_capture_pipe. If the command mentions %a, audio goes as raw s16le to a
+// FIFO at that path, otherwise it is still written to audio.wav as usual.
+// Writing happens on a background thread so the renderer only stalls when the
+// encoder falls more than a few packets behind.
+
+#include "quakedef.h"
+#include "qsound.h"
+#include "movie.h"
+#ifndef _WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <errno.h>
+#include <sys/stat.h>
+#endif
+
+#define MOVIE_PIPE_PACKETS				8
+#define MOVIE_PIPE_MAX_PENDING_AUDIO	(16 * 1024 * 1024)
+
+typedef enum {
+	PIPE_PACKET_VIDEO,
+	PIPE_PACKET_AUDIO,
+	PIPE_PACKET_STOP
+} pipe_packet_type_t;
+
+typedef struct pipe_packet_s {
+	pipe_packet_type_t	type;
+	byte				*data;
+	int					size;
+	int					allocated;
+} pipe_packet_t;
+
+typedef struct movie_pipe_s {
+	FILE			*video;
+	int				width, height;
+
+	char			fifo[MAX_OSPATH];	// audio FIFO, empty if audio goes to the wav file
+	int				audio_fd;
+	byte			*audio_pending;		// audio written before the encoder opened the FIFO
+	int				audio_pending_size;
+	qbool			audio_dropped;
+	qbool			resized;
+
+	SDL_Thread		*thread;
+	SDL_sem			*free;
+	SDL_sem			*filled;
+	pipe_packet_t	packets[MOVIE_PIPE_PACKETS];
+	int				head, tail;
+	volatile qbool	failed;
+
+	int				frames;
+	double			start;
+	double			wait;				// main thread blocked on the encoder
+	double			readback;			// reading and converting pixels
+#ifndef _WIN32
+	void			(*old_sigpipe)(int);
+	qbool			sigpipe_ignored;
+#endif
+} movie_pipe_t;
+
+static movie_pipe_t mp;
+
+#ifndef _WIN32
+static qbool Movie_PipeWriteAll (int fd, const byte *data, int size)
+{
+	int written;
+
+	while (size > 0) {
+		if ((written = write(fd, data, size)) < 0) {
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+		data += written;
+		size -= written;
+	}
+
+	return true;
+}
+#endif
+
+// Background thread only.
+static void Movie_PipeWriteAudio (const byte *data, int size)
+{
+#ifndef _WIN32
+	if (mp.audio_fd < 0) {
+		// The encoder opens its inputs one by one and may want to see video first,
+		// so don't block until it opens the FIFO, keep the audio until it does.
+		if ((mp.audio_fd = open(mp.fifo, O_WRONLY | O_NONBLOCK)) < 0) {
+			if (mp.audio_pending_size + size > MOVIE_PIPE_MAX_PENDING_AUDIO) {
+				mp.audio_dropped = true;
+				return;
+			}
+			mp.audio_pending = (byte *) Q_realloc(mp.audio_pending, mp.audio_pending_size + size);
+			memcpy(mp.audio_pending + mp.audio_pending_size, data, size);
+			mp.audio_pending_size += size;
+			return;
+		}
+
+		fcntl(mp.audio_fd, F_SETFL, fcntl(mp.audio_fd, F_GETFL) & ~O_NONBLOCK);
+
+		if (mp.audio_pending_size && !Movie_PipeWriteAll(mp.audio_fd, mp.audio_pending, mp.audio_pending_size))
+			mp.failed = true;
+		Q_free(mp.audio_pending);
+		mp.audio_pending_size = 0;
+	}
+
+	if (!Movie_PipeWriteAll(mp.audio_fd, data, size))
+		mp.failed = true;
+#endif
+}
+
+static int Movie_PipeThread (void *unused)
+{
+	pipe_packet_t *p;
+
+	while (true) {
+		SDL_SemWait(mp.filled);
+
+		p = &mp.packets[mp.tail];
+		if (p->type == PIPE_PACKET_STOP)
+			break;
+
+		// After a failure keep taking packets so the main thread never waits forever.
+		if (!mp.failed) {
+			if (p->type == PIPE_PACKET_VIDEO) {
+				if (fwrite(p->data, p->size, 1, mp.video) != 1)
+					mp.failed = true;
+			}
+			else {
+				Movie_PipeWriteAudio(p->data, p->size);
+			}
+		}
+
+		mp.tail = (mp.tail + 1) % MOVIE_PIPE_PACKETS;
+		SDL_SemPost(mp.free);
+	}
+
+	return 0;
+}
+
+static pipe_packet_t *Movie_PipeGetPacket (pipe_packet_type_t type, int size)
+{
+	double start = Sys_DoubleTime();
+	pipe_packet_t *p;
+
+	SDL_SemWait(mp.free);
+	mp.wait += Sys_DoubleTime() - start;
+
+	p = &mp.packets[mp.head];
+	if (size > p->allocated) {
+		p->data = (byte *) Q_realloc(p->data, size);
+		p->allocated = size;
+	}
+	p->type = type;
+	p->size = size;
+
+	return p;
+}
+
+static void Movie_PipePutPacket (void)
+{
+	mp.head = (mp.head + 1) % MOVIE_PIPE_PACKETS;
+	SDL_SemPost(mp.filled);
+}
+
+// Expands %w %h (frame size), %r (frame rate), %a (audio FIFO), %s (sample rate) and %c (channels).
+// Returns false if the result didn't fit.
+static qbool Movie_PipeCommand (const char *format, double fps, char *out, int out_size)
+{
+	char insert[MAX_OSPATH];
+
+	out[0] = 0;
+	for ( ; *format; format++) {
+		if (*format != '%' || !format[1]) {
+			insert[0] = *format;
+			insert[1] = 0;
+		}
+		else {
+			switch (*++format) {
+				case 'w': snprintf(insert, sizeof(insert), "%d", mp.width); break;
+				case 'h': snprintf(insert, sizeof(insert), "%d", mp.height); break;
+				case 'r': snprintf(insert, sizeof(insert), "%g", fps); break;
+				case 'a': strlcpy(insert, mp.fifo, sizeof(insert)); break;
+				case 's': snprintf(insert, sizeof(insert), "%d", shw->khz); break;
+				case 'c': snprintf(insert, sizeof(insert), "%d", shw->numchannels); break;
+				default: snprintf(insert, sizeof(insert), "%%%c", *format); break;
+			}
+		}
+		if (strlcat(out, insert, out_size) >= out_size) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+qbool Movie_PipeStart (const char *command, const char *dir, int width, int height, double fps)
+{
+	char cmdline[1024];
+
+	memset(&mp, 0, sizeof(mp));
+	mp.width = width;
+	mp.height = height;
+	mp.audio_fd = -1;
+
+	if (!shw && (strstr(command, "%a") || strstr(command, "%s") || strstr(command, "%c"))) {
+		Com_Printf("demo_capture: sound is disabled, can't capture audio\n");
+		return false;
+	}
+
+#ifndef _WIN32
+	if (strstr(command, "%a")) {
+		if (snprintf(mp.fifo, sizeof(mp.fifo), "%s/%s/audio-%d.fifo", com_basedir, dir, (int) getpid()) >= sizeof(mp.fifo)) {
+			Com_Printf("demo_capture: path of the audio FIFO is too long\n");
+			mp.fifo[0] = 0;
+			return false;
+		}
+		FS_CreatePath(mp.fifo);
+		unlink(mp.fifo);
+		if (mkfifo(mp.fifo, 0600)) {
+			Com_Printf("demo_capture: couldn't create %s\n", mp.fifo);
+			return false;
+		}
+	}
+
+	// A dying encoder must not take the client down with it.
+	mp.old_sigpipe = signal(SIGPIPE, SIG_IGN);
+	mp.sigpipe_ignored = true;
+#endif
+
+	if (!Movie_PipeCommand(command, fps, cmdline, sizeof(cmdline))) {
+		Com_Printf("demo_capture: encoder command is too long\n");
+		Movie_PipeStop();
+		return false;
+	}
+
+#ifdef _WIN32
+	mp.video = _popen(cmdline, "wb");
+#else
+	mp.video = popen(cmdline, "w");
+#endif
+	if (!mp.video) {
+		Com_Printf("demo_capture: couldn't run %s\n", cmdline);
+		Movie_PipeStop();
+		return false;
+	}
+
+	mp.free = SDL_CreateSemaphore(MOVIE_PIPE_PACKETS);
+	mp.filled = SDL_CreateSemaphore(0);
+	mp.thread = SDL_CreateThread(Movie_PipeThread, "movie_pipe", NULL);
+
+	mp.start = Sys_DoubleTime();
+	Com_Printf("demo_capture: streaming %dx%d at %g fps to %s\n", width, height, fps, cmdline);
+
+	return true;
+}
+
+void Movie_PipeStop (void)
+{
+	double elapsed;
+	int i;
+
+	if (mp.thread) {
+		// the last frame is still in flight on the GPU
+		SCR_MovieReadbackFinish();
+
+		Movie_PipeGetPacket(PIPE_PACKET_STOP, 0);
+		Movie_PipePutPacket();
+		SDL_WaitThread(mp.thread, NULL);
+		mp.thread = NULL;
+
+		elapsed = Sys_DoubleTime() - mp.start;
+		Com_Printf("demo_capture: %d frames in %.2f s, %.1f fps\n", mp.frames, elapsed, mp.frames / max(elapsed, 0.001));
+		if (mp.frames) {
+			Com_Printf("  %.2f ms/frame reading pixels, %.2f ms/frame waiting for the encoder\n",
+				mp.readback * 1000 / mp.frames, mp.wait * 1000 / mp.frames);
+		}
+		if (mp.resized)
+			Com_Printf("  the window was resized, capture stopped early\n");
+		else if (mp.failed)
+			Com_Printf("  the encoder stopped reading, output is incomplete\n");
+		if (mp.audio_dropped)
+			Com_Printf("  the encoder never opened %s, audio was dropped\n", mp.fifo);
+	}
+
+	if (mp.video) {
+#ifdef _WIN32
+		_pclose(mp.video);
+#else
+		pclose(mp.video);
+#endif
+		mp.video = NULL;
+	}
+
+#ifndef _WIN32
+	if (mp.audio_fd >= 0)
+		close(mp.audio_fd);
+	mp.audio_fd = -1;
+	if (mp.fifo[0])
+		unlink(mp.fifo);
+	if (mp.sigpipe_ignored)
+		signal(SIGPIPE, mp.old_sigpipe);
+#endif
+
+	if (mp.free)
+		SDL_DestroySemaphore(mp.free);
+	if (mp.filled)
+		SDL_DestroySemaphore(mp.filled);
+	for (i = 0; i < MOVIE_PIPE_PACKETS; i++)
+		Q_free(mp.packets[i].data);
+	Q_free(mp.audio_pending);
+
+	memset(&mp, 0, sizeof(mp));
+	mp.audio_fd = -1;
+}
+
+qbool Movie_IsCapturingPipe (void)
+{
+	return mp.thread && Movie_IsCapturing();
+}
+
+qbool Movie_PipeFailed (void)
+{
+	return mp.failed;
+}
+
+qbool Movie_PipeAudioEnabled (void)
+{
+	return mp.thread && mp.fifo[0];
+}
+
+// Returns a width * height * 3 buffer for the next frame, to be passed on with Movie_PipeSubmitVideo.
+// The encoder was told the frame size up front, so a resized window ends the capture.
+byte *Movie_PipeVideoBuffer (int width, int height)
+{
+	if (width != mp.width || height != mp.height) {
+		mp.resized = mp.failed = true;
+		return NULL;
+	}
+
+	return Movie_PipeGetPacket(PIPE_PACKET_VIDEO, mp.width * mp.height * 3)->data;
+}
+
+void Movie_PipeSubmitVideo (double readback)
+{
+	mp.readback += readback;
+	mp.frames++;
+	Movie_PipePutPacket();
+}
+
+void Movie_PipeAudio (int samples, const byte *data)
+{
+	pipe_packet_t *p = Movie_PipeGetPacket(PIPE_PACKET_AUDIO, samples * 4);
+	short *out = (short *) p->data;
+	const short *in = (const short *) data;
+	int i;
+
+	// 16 bit stereo, same as the wav file
+	for (i = 0; i < samples * 2; i++)
+		out[i] = LittleShort(in[i]);
+
+	Movie_PipePutPacket();
+}
@@ -100,7 +100,6 @@ void OnChange_MP3_player(cvar_t *var, char *value, qbool *cancel) {
 
 void MP3_SongInfo_f(void) {
 	char *status_string, *title, *s;
-	char elapsed_string[MP3_MAXSONGTITLE];
 	int status, elapsed, total;
 
 	if (!MP3_IsPlayerRunning()) {
@@ -126,8 +125,7 @@ void MP3_SongInfo_f(void) {
 		Com_Printf(va("%s %s\n", status_string, title));
 		return;
 	}
-	strlcpy(elapsed_string, SecondsToMinutesString(elapsed), sizeof(elapsed_string));
-	Com_Printf(va("%s %s \x10%s/%s\x11\n", status_string, title, elapsed_string, SecondsToMinutesString(total)));
+	Com_Printf(va("%s %s \x10%s/%s\x11\n", status_string, title, SecondsToMinutesString(elapsed), SecondsToMinutesString(total)));
 }
 
 char *MP3_Menu_SongtTitle(void) {
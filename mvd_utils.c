@@ -262,8 +262,8 @@ void MVD_Init_Info (int player_slot) {
 	else
 		mvd_cg_info.gametype=4;
 
-	strlcpy(mvd_cg_info.hostname,Info_ValueForKey(cl.serverinfo,"hostname"),sizeof(mvd_cg_info.hostname));
-	mvd_cg_info.deathmatch=atoi(Info_ValueForKey(cl.serverinfo,"deathmatch"));
+	strlcpy(mvd_cg_info.hostname,Info_Get(&cl._serverinfo_ctx_,"hostname"),sizeof(mvd_cg_info.hostname));
+	mvd_cg_info.deathmatch=atoi(Info_Get(&cl._serverinfo_ctx_,"deathmatch"));
 
 	mvd_cg_info.pcount = z;
 
@@ -818,7 +818,7 @@ static void PM_SpectatorMove(void)
 
 //Returns with origin, angles, and velocity modified in place.
 //Numtouch and touchindex[] will be set if any of the physents were contacted during the move.
-int PM_PlayerMove(void)
+static int PM_Move(void)
 {
 	int blocked = 0;
 
@@ -895,3 +895,14 @@ int PM_PlayerMove(void)
 
 	return blocked;
 }
+
+int PM_PlayerMove(void)
+{
+	int blocked;
+
+	PM_BeginBroadPhase();
+	blocked = PM_Move();
+	PM_EndBroadPhase();
+
+	return blocked;
+}
@@ -88,7 +88,11 @@ typedef struct {
 extern movevars_t movevars;
 extern playermove_t pmove;
 
+extern qbool pm_broadphase;
+
 int PM_PlayerMove (void);
+void PM_BeginBroadPhase (void);
+void PM_EndBroadPhase (void);
 
 int PM_PointContents (vec3_t point);
 int PM_PointContents_AllBSPs (vec3_t p);
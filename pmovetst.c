@@ -53,6 +53,133 @@ static qbool PM_CullTraceBox(vec3_t mins, vec3_t maxs, vec3_t offset, vec3_t emi
 		);
 }
 
+/*
+==================
+Broad phase
+
+PM_PlayerMove runs several traces against the same physents, so once per move
+the physent bounds, grown by the player hull, are binned into a coarse grid over
+the XY plane. Traces then only look at physents sharing a cell with them. They
+are still visited in their original order and go through the same exact tests,
+so results don't change. The world is always tested.
+==================
+*/
+#define PM_GRID_SIZE	8
+
+#if MAX_PHYSENTS > 64
+#error "physentmask_t needs a bit per physent"
+#endif
+typedef unsigned long long physentmask_t;	// one bit per physent
+
+typedef struct {
+	qbool			active;
+	vec3_t			absmins[MAX_PHYSENTS];	// player origins that can touch the physent
+	vec3_t			absmaxs[MAX_PHYSENTS];
+	float			gridmins[2];
+	float			cellscale[2];
+	physentmask_t	cells[PM_GRID_SIZE][PM_GRID_SIZE];
+} pm_broadphase_t;
+
+static pm_broadphase_t pm_bp;
+
+qbool pm_broadphase = true;
+
+static int PM_GridCell (float v, int axis)
+{
+	int cell = (int) floor((v - pm_bp.gridmins[axis]) * pm_bp.cellscale[axis]);
+
+	return bound(0, cell, PM_GRID_SIZE - 1);
+}
+
+void PM_BeginBroadPhase (void)
+{
+	int i, j, x, y, x0, x1, y0, y1;
+	physent_t *pe;
+	hull_t *hull;
+	float gridmaxs[2];
+
+	pm_bp.active = false;
+
+	if (!pm_broadphase || pmove.numphysent < 2)
+		return;
+
+	for (i = 1; i < pmove.numphysent; i++) {
+		pe = &pmove.physents[i];
+
+		for (j = 0; j < 3; j++) {
+			if (pe->model) {
+				hull = &pe->model->hulls[1];
+				pm_bp.absmins[i][j] = pe->origin[j] + pe->model->mins[j] - hull->clip_maxs[j];
+				pm_bp.absmaxs[i][j] = pe->origin[j] + pe->model->maxs[j] - hull->clip_mins[j];
+			}
+			else {
+				pm_bp.absmins[i][j] = pe->origin[j] + pe->mins[j] - player_maxs[j];
+				pm_bp.absmaxs[i][j] = pe->origin[j] + pe->maxs[j] - player_mins[j];
+			}
+		}
+
+		for (j = 0; j < 2; j++) {
+			if (i == 1 || pm_bp.absmins[i][j] < pm_bp.gridmins[j])
+				pm_bp.gridmins[j] = pm_bp.absmins[i][j];
+			if (i == 1 || pm_bp.absmaxs[i][j] > gridmaxs[j])
+				gridmaxs[j] = pm_bp.absmaxs[i][j];
+		}
+	}
+
+	for (j = 0; j < 2; j++)
+		pm_bp.cellscale[j] = PM_GRID_SIZE / max(gridmaxs[j] - pm_bp.gridmins[j], 1);
+
+	memset(pm_bp.cells, 0, sizeof(pm_bp.cells));
+	for (i = 1; i < pmove.numphysent; i++) {
+		x0 = PM_GridCell(pm_bp.absmins[i][0], 0);
+		x1 = PM_GridCell(pm_bp.absmaxs[i][0], 0);
+		y0 = PM_GridCell(pm_bp.absmins[i][1], 1);
+		y1 = PM_GridCell(pm_bp.absmaxs[i][1], 1);
+
+		for (x = x0; x <= x1; x++)
+			for (y = y0; y <= y1; y++)
+				pm_bp.cells[x][y] |= (physentmask_t) 1 << i;
+	}
+
+	pm_bp.active = true;
+}
+
+void PM_EndBroadPhase (void)
+{
+	pm_bp.active = false;
+}
+
+// Physents that may touch a player origin anywhere inside mins/maxs.
+static physentmask_t PM_BroadPhaseCandidates (vec3_t mins, vec3_t maxs)
+{
+	physentmask_t mask = 1, candidates = 0;	// world
+	int i, x, y, x0, x1, y0, y1;
+
+	if (!pm_bp.active)
+		return ~(physentmask_t) 0;
+
+	x0 = PM_GridCell(mins[0], 0);
+	x1 = PM_GridCell(maxs[0], 0);
+	y0 = PM_GridCell(mins[1], 1);
+	y1 = PM_GridCell(maxs[1], 1);
+
+	for (x = x0; x <= x1; x++)
+		for (y = y0; y <= y1; y++)
+			candidates |= pm_bp.cells[x][y];
+
+	for (i = 1; i < pmove.numphysent; i++) {
+		if (!(candidates & ((physentmask_t) 1 << i)))
+			continue;
+		if (mins[0] > pm_bp.absmaxs[i][0] || maxs[0] < pm_bp.absmins[i][0] ||
+			mins[1] > pm_bp.absmaxs[i][1] || maxs[1] < pm_bp.absmins[i][1] ||
+			mins[2] > pm_bp.absmaxs[i][2] || maxs[2] < pm_bp.absmins[i][2])
+			continue;
+		mask |= (physentmask_t) 1 << i;
+	}
+
+	return mask;
+}
+
 /*
 ==================
 PM_PointContents
@@ -111,8 +238,15 @@ qbool PM_TestPlayerPosition (vec3_t pos)
 	physent_t *pe;
 	vec3_t    mins, maxs, offset, test;
 	hull_t    *hull;
+	physentmask_t candidates;
+
+	PM_TraceBounds(pos, pos, mins, maxs);
+	candidates = PM_BroadPhaseCandidates(mins, maxs);
 
 	for (i = 0; i < pmove.numphysent; i++) {
+		if (!(candidates & ((physentmask_t) 1 << i)))
+			continue;
+
 		pe = &pmove.physents[i];
 		// get the clipping hull
 		if (pe->model) {
@@ -151,6 +285,7 @@ trace_t PM_PlayerTrace (vec3_t start, vec3_t end)
 	int       i;
 	physent_t *pe;
 	vec3_t    mins, maxs, tracemins, tracemaxs;
+	physentmask_t candidates;
 
 	// fill in a default trace
 	memset (&total, 0, sizeof(trace_t));
@@ -159,8 +294,12 @@ trace_t PM_PlayerTrace (vec3_t start, vec3_t end)
 	VectorCopy (end, total.endpos);
 
 	PM_TraceBounds(start, end, tracemins, tracemaxs);
+	candidates = PM_BroadPhaseCandidates(tracemins, tracemaxs);
 
 	for (i = 0; i < pmove.numphysent; i++) {
+		if (!(candidates & ((physentmask_t) 1 << i)))
+			continue;
+
 		pe = &pmove.physents[i];
 
 		// get the clipping hull
@@ -66,6 +66,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #define MVD_PEXT1_FLOATCOORDS       0x00000001 // FTE_PEXT_FLOATCOORDS but for entity/player coords only
 #define MVD_PEXT1_HIGHLAGTELEPORT   0x00000002 // Adjust movement direction for frames following teleport
+#define MVD_PEXT1_PREDICTEDPLAYERS  0x00010000 // MVD/QTV only: player origins and angles coded as residuals to a prediction, kept clear of bits used by other servers
 
 #endif
 
@@ -284,6 +285,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #define DF_GIB			(1 << 9)
 #define DF_WEAPONFRAME	(1 << 10)
 #define DF_MODEL		(1 << 11)
+#define DF_PREDICTRESET	(1 << 12)	// MVD_PEXT1_PREDICTEDPLAYERS: forget the history, origin and angles are predicted as 0
 
 
 //==============================================
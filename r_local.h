@@ -106,8 +106,6 @@ extern	float	screenAspect;
 extern	float	verticalFieldOfView;
 extern	float	xOrigin, yOrigin;
 
-extern	int		r_visframecount;
-
 //=============================================================================
 
 extern int	vstartscan;
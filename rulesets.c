@@ -424,7 +424,7 @@ void Rulesets_OnChange_r_fullbrightSkins(cvar_t *var, char *value, qbool *cancel
 {
 	char *fbs;
 	qbool fbskins_policy = (cls.demoplayback || cl.spectator) ? 1 :
-		*(fbs = Info_ValueForKey(cl.serverinfo, "fbskins")) ? bound(0, Q_atof(fbs), 1) :
+		*(fbs = Info_Get(&cl._serverinfo_ctx_, "fbskins")) ? bound(0, Q_atof(fbs), 1) :
 		cl.teamfortress ? 0 : 1;
 	float fbskins = bound(0.0, Q_atof (value), fbskins_policy);
 
@@ -443,7 +443,7 @@ void Rulesets_OnChange_allow_scripts (cvar_t *var, char *value, qbool *cancel)
 	qbool progress;
 	int val;
 
-	p = Info_ValueForKey(cl.serverinfo, "status");
+	p = Info_Get(&cl._serverinfo_ctx_, "status");
 	progress = (strstr (p, "left")) ? true : false;
 	val = Q_atoi(value);
 
@@ -254,7 +254,7 @@ typedef struct client_s
 
 	client_frame_t	frames[UPDATE_BACKUP];		// updates can be deltad from here
 
-	vfsfile_t		*download;			// file being downloaded
+	struct sv_download_s	*download;	// file being downloaded
 #ifdef PROTOCOL_VERSION_FTE
 #ifdef FTE_PEXT_CHUNKEDDOWNLOADS
 	int				download_chunks_perframe;
@@ -421,6 +421,26 @@ typedef struct mvdpendingdest_s
 	struct mvdpendingdest_s *nextdest;
 } mvdpendingdest_t;
 
+//
+// sv_diskio.c
+//
+
+typedef struct diskfile_s diskfile_t;
+typedef void (*diskio_done_t) (void *arg);
+
+diskfile_t *SV_DiskIO_Open (FILE *file);
+diskfile_t *SV_DiskIO_OpenGZip (FILE *file, int level);
+qbool SV_DiskIO_GZip (diskfile_t *df);
+void SV_DiskIO_Write (diskfile_t *df, const void *data, int size);
+void SV_DiskIO_Flush (diskfile_t *df);
+void SV_DiskIO_FlushLater (diskfile_t *df);
+void SV_DiskIO_Close (diskfile_t *df, diskio_done_t done, const void *arg, int argsize);
+qbool SV_DiskIO_Error (diskfile_t *df);
+unsigned long SV_DiskIO_Size (diskfile_t *df);
+void SV_DiskIO_Frame (double frametime);
+void SV_DiskIO_Sync (void);
+void SV_DiskIO_Init (void);
+
 typedef enum {DEST_NONE, DEST_FILE, DEST_BUFFEREDFILE, DEST_STREAM} desttype_t;
 
 #define MAX_PROXY_INBUFFER		4096 /* qqshka: too small??? */
@@ -432,7 +452,7 @@ typedef struct mvddest_s
 	desttype_t desttype;
 
 	int socket;
-	FILE *file;
+	diskfile_t *file;
 
 	char name[MAX_QPATH];
 	char path[MAX_QPATH];
@@ -485,6 +505,8 @@ typedef struct
 
 	demo_frame_t	frames[UPDATE_BACKUP]; // here we store all previous frames
 	demo_client_t	clients[MAX_CLIENTS]; // we store here what we wrote last time so we can delta
+	mvd_predict_t	predict[MAX_CLIENTS]; // MVD_PEXT1_PREDICTEDPLAYERS, what readers remember of player origins and angles
+	qbool			predictreset[MAX_CLIENTS]; // a dest joined, next write of the player starts over with DF_PREDICTRESET
 
 	// =====================================
 	char			mem_set_point; // fields below, like ->dest and ->pendingdest must not be memset to 0
@@ -516,17 +538,10 @@ typedef struct
 	int				latched_packets;
 } svstats_t;
 
-// MAX_CHALLENGES is made large to prevent a denial
-// of service attack that could cycle all of them
-// out before legitimate users connected
-#define	MAX_CHALLENGES	1024
-
-typedef struct
-{
-	netadr_t		adr;
-	int				challenge;
-	int				time;
-} challenge_t;
+// connection challenges are a keyed hash of the address and a time window,
+// so answering getchallenge keeps no state and can't be flooded out
+#define	CHALLENGE_SECRET_SIZE	16
+#define	CHALLENGE_WINDOW		30		// seconds, a challenge is good for one to two windows
 
 // TCPCONNECT -->
 typedef struct svtcpstream_s
@@ -584,7 +599,7 @@ typedef struct
 	sizebuf_t		log[2];
 	byte			log_buf[2][MAX_DATAGRAM];
 
-	challenge_t		challenges[MAX_CHALLENGES];	// to prevent invalid IPs from connecting
+	byte			challenge_secret[CHALLENGE_SECRET_SIZE];	// to prevent invalid IPs from connecting
 
 	packet_t		*free_packets;
 } server_static_t;
@@ -740,6 +755,74 @@ typedef struct
 } penfilter_t;
 //<-
 
+//
+// sv_ipfilter.c
+//
+
+typedef struct iptrie_edge_s
+{
+	byte					octet;
+	struct iptrie_node_s	*node;
+} iptrie_edge_t;
+
+typedef struct iptrie_node_s
+{
+	struct iptrie_node_s	*any;		// wildcard octet
+	iptrie_edge_t			*edges;		// sorted by octet
+	int						numedges;
+	int						count;		// filters ending here
+	int						refs;		// filters ending here or below
+} iptrie_node_t;
+
+typedef struct
+{
+	iptrie_node_t	*root;
+	int				count;
+} iptrie_t;
+
+typedef struct
+{
+	double		time;
+	unsigned	mask;
+	unsigned	compare;	// filter address, or the client ip for penalty filters
+	int			type;		// ipfiltertype_t or filtertype_t
+} iptimer_t;
+
+typedef struct
+{
+	iptimer_t	*timers;
+	int			count;
+	int			size;
+} iptimer_heap_t;
+
+void IPTrie_Insert (iptrie_t *trie, const byte *key, const byte *mask, int len);
+qbool IPTrie_Remove (iptrie_t *trie, const byte *key, const byte *mask, int len);
+qbool IPTrie_Match (const iptrie_t *trie, const byte *addr, int len);
+void IPTrie_Clear (iptrie_t *trie);
+
+void IPTimer_Push (iptimer_heap_t *heap, const iptimer_t *timer);
+qbool IPTimer_Pop (iptimer_heap_t *heap, double now, iptimer_t *timer);
+void IPTimer_Clear (iptimer_heap_t *heap);
+
+//
+// sv_download.c
+//
+
+#ifdef SERVERONLY
+#define CLIENT_DOWNLOAD_RELATIVE_BASE FS_GAME // FIXME: Should we use FS_BASE ???
+#else
+#define CLIENT_DOWNLOAD_RELATIVE_BASE FS_BASE
+#endif
+
+typedef struct sv_download_s sv_download_t;
+
+sv_download_t *SV_DownloadOpen (vfsfile_t *file, const char *name);
+int SV_DownloadSize (sv_download_t *dl);
+const byte *SV_DownloadData (sv_download_t *dl, int offset, int *len);
+void SV_DownloadClose (sv_download_t *dl);
+void SV_DownloadCacheFlush (void);
+void SV_DownloadInit (void);
+
 void SV_Frame (double time);
 void SV_FinalMessage (const char *message);
 void SV_DropClient (client_t *drop);
@@ -829,6 +912,7 @@ void SV_RunBots(void);
 typedef enum {RD_NONE, RD_CLIENT, RD_PACKET, RD_MOD} redirect_t;
 void SV_BeginRedirect (redirect_t rd);
 void SV_EndRedirect (void);
+void SV_CaptureRedirect (sizebuf_t *buf);
 qbool SV_AddToRedirect(char *msg);
 
 void SV_Multicast(vec3_t origin, int to);
@@ -892,7 +976,7 @@ void ClientReliableWrite_Coord(client_t *cl, float f);
 void ClientReliableWrite_Long(client_t *cl, int c);
 void ClientReliableWrite_Short(client_t *cl, int c);
 void ClientReliableWrite_String(client_t *cl, char *s);
-void ClientReliableWrite_SZ(client_t *cl, void *data, int len);
+void ClientReliableWrite_SZ(client_t *cl, const void *data, int len);
 void SV_ClearReliable (client_t *cl); // clear cl->netchan.message and backbuf
 
 //
@@ -976,6 +1060,7 @@ void	SV_MVDInfoRemove_f (void);
 void	SV_MVDInfo_f (void);
 void	SV_LastScores_f (void);
 char*   SV_MVDName2Txt (const char *name);
+void	SV_MVDStripExtension (char *name);
 
 //
 // sv_demo_qtv.c
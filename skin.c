@@ -108,7 +108,7 @@ char *Skin_FindName (player_info_t *sc) {
 		char *s = Skin_AsNameOrId(sc);
 
 		if (!s || !s[0])
-			s = Info_ValueForKey(sc->userinfo, "skin");
+			s = Info_Get(&sc->_userinfo_ctx_, "skin");
 
 		if (s && s[0])
 			strlcpy(name, s, sizeof(name));
@@ -328,7 +328,7 @@ byte *Skin_Cache (skin_t *skin, qbool no_baseskin)
 		}
 	}
 
-	if (!(out = pix = (byte *) Cache_Alloc (&skin->cache, max_w * max_h * bpp, skin->name)))
+	if (!(out = pix = (byte *) Cache_Alloc (&skin->cache, max_w * max_h * bpp, skin->name, CACHE_SKIN)))
 		Sys_Error ("Skin_Cache: couldn't allocate");
 
 	memset (out, 0, max_w * max_h * bpp);
@@ -405,7 +405,7 @@ void Skin_Skins_f (void) {
 	int i;
 
 	for (i = 0; i < numskins; i++) {
-		if (skins[i].cache.data)
+		if (Cache_Check (&skins[i].cache))
 			Cache_Free (&skins[i].cache);
 	}
 	numskins = 0;
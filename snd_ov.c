@@ -202,7 +202,7 @@ sfxcache_t *S_LoadSound(sfx_t *s)
 	len = (int) ((double) info.samples * (double) shw->khz / (double) info.rate);
 	len = len * info.width * info.channels;
 
-	if (!(sc = (sfxcache_t *) Cache_Alloc (&s->cache, len + sizeof(sfxcache_t), s->name)))
+	if (!(sc = (sfxcache_t *) Cache_Alloc (&s->cache, len + sizeof(sfxcache_t), s->name, CACHE_SOUND)))
 		return NULL;
 
 	/* Read the whole Ogg Vorbis file in */
@@ -92,7 +92,7 @@ void SV_Logfile (int sv_log, qbool newlog)
 	{
 		// turn off logging
 
-		fclose (logs[sv_log].sv_logfile);
+		SV_DiskIO_Close (logs[sv_log].sv_logfile, NULL, NULL, 0);
 		logs[sv_log].sv_logfile = NULL;
 
 		// in case of NON "newlog" we do some additional work and exit function
@@ -121,7 +121,7 @@ void SV_Logfile (int sv_log, qbool newlog)
 
 	Con_Printf ("Logging %s to %s\n", logs[sv_log].message_on, name);
 
-	if (!(logs[sv_log].sv_logfile = fopen (name, "a")))
+	if (!(logs[sv_log].sv_logfile = SV_DiskIO_Open (fopen (name, "a"))))
 	{
 		Con_Printf ("Failed.\n");
 		logs[sv_log].sv_logfile = NULL;
@@ -41,6 +41,10 @@ cvar_t  sv_demoIdlefps      = {"sv_demoIdlefps",    "10"};
 cvar_t  sv_demoPings        = {"sv_demopings",      "3"};
 cvar_t  sv_demoMaxSize      = {"sv_demoMaxSize",    "20480"};
 cvar_t  sv_demoExtraNames   = {"sv_demoExtraNames", "0"};
+cvar_t  sv_demoPredict      = {"sv_demoPredict",    "0"}; // record player origins and angles as MVD_PEXT1_PREDICTEDPLAYERS, older clients can't play it
+#ifdef WITH_ZLIB
+cvar_t  sv_demogzip         = {"sv_demogzip",       "0"}; // compression level of demos recorded as .mvd.gz, 0 = plain .mvd
+#endif
 
 cvar_t	sv_demoPrefix		= {"sv_demoPrefix",		""};
 cvar_t	sv_demoSuffix		= {"sv_demoSuffix",		""};
@@ -134,33 +138,65 @@ mvddest_t *DestByName (char *name)
 	return NULL;
 }
 
-void DestClose (mvddest_t *d, qbool destroyfiles)
+typedef struct
+{
+	char	name[MAX_QPATH];
+	char	path[MAX_QPATH];
+	qbool	destroyfiles;
+	qbool	finished;		// run sv_demotxt and sv_onrecordfinish
+} destclosed_t;
+
+// Called once the demo file is closed, which the disk writer thread may do a bit later.
+static void DestClosed (void *arg)
 {
+	destclosed_t *c = (destclosed_t *) arg;
 	char path[MAX_OSPATH];
 
-	if (d->cache)
-		Q_free(d->cache);
-	if (d->file)
-		fclose(d->file);
-	if (d->socket)
-		closesocket(d->socket);
-	if (d->qtvuserlist)
-		QTVsv_FreeUserList(d);
-
-	if (destroyfiles)
+	if (c->destroyfiles)
 	{
-		snprintf(path, MAX_OSPATH, "%s/%s/%s", fs_gamedir, d->path, d->name);
+		snprintf(path, MAX_OSPATH, "%s/%s/%s", fs_gamedir, c->path, c->name);
 		Sys_remove(path);
-		strlcpy(path + strlen(path) - 3, "txt", MAX_OSPATH - strlen(path) + 3);
+		SV_MVDStripExtension(path);
+		strlcat(path, ".txt", MAX_OSPATH);
 		Sys_remove(path);
 
 		// force cache rebuild.
 		FS_FlushFSHash();
 	}
 
+	if (c->finished)
+		Run_sv_demotxt_and_sv_onrecordfinish (c->name, c->path, c->destroyfiles);
+}
+
+static void DestCloseEx (mvddest_t *d, qbool destroyfiles, qbool finished)
+{
+	destclosed_t closed;
+
+	strlcpy(closed.name, d->name, sizeof(closed.name));
+	strlcpy(closed.path, d->path, sizeof(closed.path));
+	closed.destroyfiles = destroyfiles;
+	closed.finished = finished;
+
+	if (d->cache)
+		Q_free(d->cache);
+	if (d->socket)
+		closesocket(d->socket);
+	if (d->qtvuserlist)
+		QTVsv_FreeUserList(d);
+
+	if (d->file)
+		SV_DiskIO_Close(d->file, DestClosed, &closed, sizeof(closed));
+	else if (destroyfiles || finished)
+		DestClosed(&closed);
+
 	Q_free(d);
 }
 
+void DestClose (mvddest_t *d, qbool destroyfiles)
+{
+	DestCloseEx(d, destroyfiles, false);
+}
+
 //
 // compleate - just force flush for chached dests (dest->desttype == DEST_BUFFEREDFILE)
 //
@@ -191,22 +227,28 @@ void DestFlush (qbool compleate)
 		switch(d->desttype)
 		{
 		case DEST_FILE:
-			fflush (d->file);
+			SV_DiskIO_Flush(d->file);
+			if (SV_DiskIO_Error(d->file))
+			{
+				Sys_Printf("DestFlush: fwrite() error\n");
+				d->error = true;
+			}
 			break;
 
 		case DEST_BUFFEREDFILE:
 			if (d->cacheused + DEMO_FLUSH_CACHE_IF_LESS_THAN_THIS > d->maxcachesize || compleate)
 			{
-				len = fwrite(d->cache, 1, d->cacheused, d->file);
-				if (len != d->cacheused)
-				{
-					Sys_Printf("DestFlush: fwrite() error\n");
-					d->error = true;
-				}
-				fflush(d->file);
+				// queued for the disk writer thread
+				SV_DiskIO_Write(d->file, d->cache, d->cacheused);
+				SV_DiskIO_Flush(d->file);
 
 				d->cacheused = 0;
 			}
+			if (SV_DiskIO_Error(d->file))
+			{
+				Sys_Printf("DestFlush: fwrite() error\n");
+				d->error = true;
+			}
 			break;
 
 		case DEST_STREAM:
@@ -286,19 +328,10 @@ static int DestCloseAllFlush (qbool destroyfiles, qbool mvdonly)
 
 		if (!mvdonly || d->desttype != DEST_STREAM)
 		{
-			desttype_t dt = d->desttype;
-			char dest_name[sizeof(d->name)];
-			char dest_path[sizeof(d->path)];
-
-			strlcpy(dest_name, d->name, sizeof(dest_name));
-			strlcpy(dest_path, d->path, sizeof(dest_path));
-
 			*prev = d->nextdest;
-			DestClose(d, destroyfiles); // NOTE: this free dest struck, so we can't use 'd' below
+			// sv_demotxt and sv_onrecordfinish run once the file is closed, ignore stream or empty file name
+			DestCloseEx(d, destroyfiles, d->desttype != DEST_STREAM && d->name[0]); // NOTE: this free dest struck, so we can't use 'd' below
 			numclosed++;
-
-			if (dt != DEST_STREAM && dest_name[0]) // ignore stream or empty file name
-				Run_sv_demotxt_and_sv_onrecordfinish (dest_name, dest_path, destroyfiles);
 		}
 		else
 			prev = &d->nextdest;
@@ -311,8 +344,6 @@ static int DestCloseAllFlush (qbool destroyfiles, qbool mvdonly)
 
 int DemoWriteDest (void *data, int len, mvddest_t *d)
 {
-	int ret;
-
 	if (d->error)
 		return 0;
 
@@ -321,8 +352,8 @@ int DemoWriteDest (void *data, int len, mvddest_t *d)
 	switch(d->desttype)
 	{
 		case DEST_FILE:
-			ret = fwrite(data, 1, len, d->file);
-			if (ret != len)
+			SV_DiskIO_Write(d->file, data, len);
+			if (SV_DiskIO_Error(d->file))
 			{
 				Sys_Printf("DemoWriteDest: fwrite() error\n");
 				d->error = true;
@@ -640,13 +671,27 @@ static qbool SV_MVDWritePacketsEx (int num)
 			// now write it to buf
 			flags = cl->flags;
 
-			for (j = 0; j < 3; j++)
-				if (origin[j] != last_cl->origin[j])
-					flags |= DF_ORIGIN << j;
+			if (demo.recorder.mvdprotocolextensions1 & MVD_PEXT1_PREDICTEDPLAYERS)
+			{
+				if (demo.predictreset[i])
+				{
+					MSG_PredictReset (&demo.predict[i]);
+					demo.predictreset[i] = false;
+					flags |= DF_PREDICTRESET;
+				}
+
+				flags |= MSG_PredictFlags (&demo.predict[i], origin, angles);
+			}
+			else
+			{
+				for (j = 0; j < 3; j++)
+					if (origin[j] != last_cl->origin[j])
+						flags |= DF_ORIGIN << j;
 
-			for (j = 0; j < 3; j++)
-				if (angles[j] != last_cl->angles[j])
-					flags |= DF_ANGLES << j;
+				for (j = 0; j < 3; j++)
+					if (angles[j] != last_cl->angles[j])
+						flags |= DF_ANGLES << j;
+			}
 
 			if (cl->model != last_cl->model)
 				flags |= DF_MODEL;
@@ -663,13 +708,20 @@ static qbool SV_MVDWritePacketsEx (int num)
 
 			MSG_WriteByte (&msg, cl->frame);
 
-			for (j = 0 ; j < 3 ; j++)
-				if (flags & (DF_ORIGIN << j))
-					MSG_WriteCoord (&msg, origin[j]);
+			if (demo.recorder.mvdprotocolextensions1 & MVD_PEXT1_PREDICTEDPLAYERS)
+			{
+				MSG_WritePredicted (&msg, &demo.predict[i], flags, origin, angles);
+			}
+			else
+			{
+				for (j = 0 ; j < 3 ; j++)
+					if (flags & (DF_ORIGIN << j))
+						MSG_WriteCoord (&msg, origin[j]);
 
-			for (j = 0 ; j < 3 ; j++)
-				if (flags & (DF_ANGLES << j))
-					MSG_WriteAngle16 (&msg, angles[j]);
+				for (j = 0 ; j < 3 ; j++)
+					if (flags & (DF_ANGLES << j))
+						MSG_WriteAngle16 (&msg, angles[j]);
+			}
 
 			if (flags & DF_MODEL)
 				MSG_WriteByte (&msg, cl->model);
@@ -769,13 +821,22 @@ qbool SV_MVDWritePackets (int num)
 SV_InitRecord
 ====================
 */
-static mvddest_t *SV_InitRecordFile (char *name)
+static mvddest_t *SV_InitRecordFile (char *demoname)
 {
 	char *s;
 	mvddest_t *dst;
 	FILE *file;
 
 	char path[MAX_OSPATH];
+	char name[MAX_OSPATH + MAX_DEMO_NAME];
+	int gzip = 0;
+
+	strlcpy(name, demoname, sizeof(name));
+#ifdef WITH_ZLIB
+	// compressed by the disk writer thread as it is written, flushed so it can be read while recording
+	if ((gzip = bound(0, (int) sv_demogzip.value, 9)))
+		strlcat(name, ".gz", sizeof(name));
+#endif
 
 	Con_DPrintf("SV_InitRecordFile: Demo name: \"%s\"\n", name);
 	file = fopen (name, "wb");
@@ -790,16 +851,15 @@ static mvddest_t *SV_InitRecordFile (char *name)
 	if (!(int)sv_demoUseCache.value)
 	{
 		dst->desttype = DEST_FILE;
-		dst->file = file;
 		dst->maxcachesize = 0;
 	}
 	else
 	{
 		dst->desttype = DEST_BUFFEREDFILE;
-		dst->file = file;
 		dst->maxcachesize = 1024 * (int) sv_demoCacheSize.value;
 		dst->cache = (char *) Q_malloc (dst->maxcachesize);
 	}
+	dst->file = gzip ? SV_DiskIO_OpenGZip(file, gzip) : SV_DiskIO_Open(file);
 
 	s = name + strlen(name);
 	while (*s != '/') s--;
@@ -812,7 +872,8 @@ static mvddest_t *SV_InitRecordFile (char *name)
 	Cvar_SetROM(&serverdemo, dst->name);
 
 	strlcpy(path, name, MAX_OSPATH);
-	strlcpy(path + strlen(path) - 3, "txt", MAX_OSPATH - strlen(path) + 3);
+	SV_MVDStripExtension(path);
+	strlcat(path, ".txt", MAX_OSPATH);
 
 	if ((int)sv_demotxt.value)
 	{
@@ -826,10 +887,11 @@ static mvddest_t *SV_InitRecordFile (char *name)
 		}
 		else if ((f = fopen (path, "w+t")))
 		{
+			diskfile_t *df = SV_DiskIO_Open(f);
+
 			text = SV_PrintTeams();
-			fwrite(text, strlen(text), 1, f);
-			fflush(f);
-			fclose(f);
+			SV_DiskIO_Write(df, text, strlen(text));
+			SV_DiskIO_Close(df, NULL, NULL, 0);
 		}
 	}
 	else
@@ -1077,6 +1139,7 @@ void MVD_PlayerReset(int player)
 	}
 
 	memset(&(demo.clients[player]), 0, sizeof(demo.clients[0]));
+	demo.predictreset[player] = true; // somebody else in the slot, don't predict from where the last one was
 }
 
 qbool SV_MVD_Record (mvddest_t *dest, qbool mapchange)
@@ -1110,6 +1173,10 @@ qbool SV_MVD_Record (mvddest_t *dest, qbool mapchange)
 			SZ_InitEx(&demo.frames[i]._buf_, demo.frames[i]._buf__data, sizeof(demo.frames[0]._buf__data), true);
 		}
 
+		// players are only predicted at 1/8 unit precision, like MSG_WriteCoord does without sv_bigcoords
+		if (sv_demoPredict.value && msg_coordsize == 2)
+			demo.recorder.mvdprotocolextensions1 |= MVD_PEXT1_PREDICTEDPLAYERS;
+
 		// set up buffer for non releable data
 		SZ_InitEx(&demo.datagram, demo.datagram_data, sizeof(demo.datagram_data), true);
 	}
@@ -1199,6 +1266,14 @@ void SV_MVD_SendInitialGamestate(mvddest_t *dest)
 	}
 #endif
 
+#ifdef PROTOCOL_VERSION_MVD1
+	if (demo.recorder.mvdprotocolextensions1)
+	{
+		MSG_WriteLong(&buf, PROTOCOL_VERSION_MVD1);
+		MSG_WriteLong(&buf, demo.recorder.mvdprotocolextensions1);
+	}
+#endif
+
 	MSG_WriteLong (&buf, PROTOCOL_VERSION);
 	MSG_WriteLong (&buf, svs.spawncount);
 	MSG_WriteString (&buf, gamedir);
@@ -1434,11 +1509,16 @@ void SV_MVD_SendInitialGamestate(mvddest_t *dest)
 		SZ_Clear (&buf);
 	}
 
+	// the dest starts reading players here, everybody else starts over with it
+	for (i = 0; i < MAX_CLIENTS; i++)
+		demo.predictreset[i] = true;
+
 	// this set proper model origin and angles etc for players
 	for (i = 0; i < MAX_CLIENTS; i++)
 	{
 		vec3_t origin, angles;
 		int j, flags;
+		mvd_predict_t predict;
 
 		player = svs.clients + i;
 		ent = player->edict;
@@ -1472,19 +1552,29 @@ void SV_MVD_SendInitialGamestate(mvddest_t *dest)
 			angles[2] = 0;
 		}
 
+		if (demo.recorder.mvdprotocolextensions1 & MVD_PEXT1_PREDICTEDPLAYERS)
+			flags |= DF_PREDICTRESET;
+
 		MSG_WriteByte (&buf, svc_playerinfo);
 		MSG_WriteByte (&buf, i);
 		MSG_WriteShort (&buf, flags);
 
 		MSG_WriteByte (&buf, ent->v.frame);
 
-		for (j = 0 ; j < 3 ; j++)
-			if (flags & (DF_ORIGIN << j))
-				MSG_WriteCoord (&buf, origin[j]);
+		if (flags & DF_PREDICTRESET)
+		{
+			MSG_WritePredicted (&buf, &predict, flags, origin, angles);
+		}
+		else
+		{
+			for (j = 0 ; j < 3 ; j++)
+				if (flags & (DF_ORIGIN << j))
+					MSG_WriteCoord (&buf, origin[j]);
 
-		for (j = 0 ; j < 3 ; j++)
-			if (flags & (DF_ANGLES << j))
-				MSG_WriteAngle16 (&buf, angles[j]);
+			for (j = 0 ; j < 3 ; j++)
+				if (flags & (DF_ANGLES << j))
+					MSG_WriteAngle16 (&buf, angles[j]);
+		}
 
 		if (flags & DF_MODEL)
 			MSG_WriteByte (&buf, ent->v.modelindex);
@@ -1763,6 +1853,10 @@ static void MVD_Init (void)
 	Cvar_Register (&sv_ondemoremove);
 	Cvar_Register (&sv_demotxt);
 	Cvar_Register (&sv_demoExtraNames);
+	Cvar_Register (&sv_demoPredict);
+#ifdef WITH_ZLIB
+	Cvar_Register (&sv_demogzip);
+#endif
 	Cvar_Register (&sv_demoRegexp);
 	Cvar_Register (&sv_silentrecord);
 
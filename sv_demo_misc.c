@@ -180,33 +180,18 @@ qbool SV_DirSizeCheck (void)
 	return true;
 }
 
-void Run_sv_demotxt_and_sv_onrecordfinish (const char *dest_name, const char *dest_path, qbool destroyfiles)
+typedef struct
 {
-	char path[MAX_OSPATH];
-
-	snprintf(path, MAX_OSPATH, "%s/%s/%s", fs_gamedir, dest_path, dest_name);
-	strlcpy(path + strlen(path) - 3, "txt", MAX_OSPATH - strlen(path) + 3);
-
-	if ((int)sv_demotxt.value && !destroyfiles) // dont keep txt's for deleted demos
-	{
-		FILE *f;
-		char *text;
+	char	name[MAX_OSPATH];
+	char	path[MAX_OSPATH];
+} onrecordfinish_t;
 
-		if (sv_demotxt.value == 2)
-		{
-			if ((f = fopen (path, "a+t")))
-				fclose(f); // at least made empty file, but do not owerwite
-		}
-		else if ((f = fopen (path, "w+t")))
-		{
-			text = SV_PrintTeams();
-			fwrite(text, strlen(text), 1, f);
-			fflush(f);
-			fclose(f);
-		}
-	}
+static void Run_sv_onrecordfinish (void *arg)
+{
+	onrecordfinish_t *demo = (onrecordfinish_t *) arg;
+	char path[MAX_OSPATH];
 
-	if (sv_onrecordfinish.string[0] && !destroyfiles) // dont gzip deleted demos
+	if (sv_onrecordfinish.string[0])
 	{
 		extern redirect_t sv_redirected;
 		redirect_t old = sv_redirected;
@@ -215,15 +200,11 @@ void Run_sv_demotxt_and_sv_onrecordfinish (const char *dest_name, const char *de
 		if ((p = strstr(sv_onrecordfinish.string, " ")) != NULL)
 			*p = 0; // strip parameters
 	
-		strlcpy(path, dest_name, sizeof(path));
-#ifdef SERVERONLY
-		COM_StripExtension(path);
-#else
-		COM_StripExtension(path, path, sizeof(path));
-#endif
+		strlcpy(path, demo->name, sizeof(path));
+		SV_MVDStripExtension(path);
 
 		sv_redirected = RD_NONE; // onrecord script is called always from the console
-		Cmd_TokenizeString(va("script %s \"%s\" \"%s\" %s", sv_onrecordfinish.string, dest_path, path, p != NULL ? p+1 : ""));
+		Cmd_TokenizeString(va("script %s \"%s\" \"%s\" %s", sv_onrecordfinish.string, demo->path, path, p != NULL ? p+1 : ""));
 
 		if (p)
 			*p = ' '; // restore params
@@ -237,6 +218,49 @@ void Run_sv_demotxt_and_sv_onrecordfinish (const char *dest_name, const char *de
 	FS_FlushFSHash();
 }
 
+void Run_sv_demotxt_and_sv_onrecordfinish (const char *dest_name, const char *dest_path, qbool destroyfiles)
+{
+	char path[MAX_OSPATH];
+	onrecordfinish_t demo;
+
+	snprintf(path, MAX_OSPATH, "%s/%s/%s", fs_gamedir, dest_path, dest_name);
+	SV_MVDStripExtension(path);
+	strlcat(path, ".txt", MAX_OSPATH);
+
+	if (destroyfiles) // dont keep txt's or gzip deleted demos
+	{
+		FS_FlushFSHash();
+		return;
+	}
+
+	strlcpy(demo.name, dest_name, sizeof(demo.name));
+	strlcpy(demo.path, dest_path, sizeof(demo.path));
+
+	if ((int)sv_demotxt.value)
+	{
+		FILE *f;
+		char *text;
+
+		if (sv_demotxt.value == 2)
+		{
+			if ((f = fopen (path, "a+t")))
+				fclose(f); // at least made empty file, but do not owerwite
+		}
+		else if ((f = fopen (path, "w+t")))
+		{
+			diskfile_t *df = SV_DiskIO_Open(f);
+
+			// the script may want the txt, run it once that is written
+			text = SV_PrintTeams();
+			SV_DiskIO_Write(df, text, strlen(text));
+			SV_DiskIO_Close(df, Run_sv_onrecordfinish, &demo, sizeof(demo));
+			return;
+		}
+	}
+
+	Run_sv_onrecordfinish(&demo);
+}
+
 char *SV_PrintTeams (void)
 {
 	char			*teams[MAX_CLIENTS];
@@ -441,14 +465,16 @@ char *SV_MVDNum (int num)
 	// last recorded demo's names for command "cmd dl . .." (maximum 15 dots)
 	if (num & 0xFF000000)
 	{
-		char *name = demo.lastdemosname[(demo.lastdemospos - (num >> 24) + 1) & 0xF];
+		char name[MAX_OSPATH];
 		char *name2;
-		int c;
+
+		if (!demo.lastdemosname[(demo.lastdemospos - (num >> 24) + 1) & 0xF])
+			return NULL;
+		strlcpy(name, demo.lastdemosname[(demo.lastdemospos - (num >> 24) + 1) & 0xF], sizeof(name));
+		SV_MVDStripExtension(name); // sv_demoRegexp matches the extension
 
 		if (!(name2 = quote(name)))
 			return NULL;
-		if ((c = strlen(name2)) > 5)
-			name2[c - 5] = '\0'; // crop quoted extension '\.mvd'
 
 		dir = Sys_listdir(va("%s/%s", fs_gamedir, sv_demoDir.string),
 						  va("^%s%s", name2, sv_demoRegexp.string), SORT_NO);
@@ -494,6 +520,17 @@ char *SV_MVDNum (int num)
 	return list->name[0] ? list->name : NULL;
 }
 
+// Cuts .mvd, or .mvd.gz of a compressed demo, off a demo name.
+void SV_MVDStripExtension (char *name)
+{
+	int len = strlen(name);
+
+	if (len > 3 && !strcasecmp(name + len - 3, ".gz"))
+		name[len -= 3] = '\0';
+	if (len > 4 && !strcasecmp(name + len - 4, ".mvd"))
+		name[len - 4] = '\0';
+}
+
 #define OVECCOUNT 3
 char *SV_MVDName2Txt (const char *name)
 {
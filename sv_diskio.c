@@ -0,0 +1,542 @@
+/*
+Copyright (C) 2026 ezQuake team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+// sv_diskio.c -- writes demo and log files on a background thread.
+//
+// A write, flush or close only puts a request in a bounded queue, the writer
+// thread does the actual fwrite/fflush/fclose. Writes to a file are gathered on
+// the server thread and queued in batches. Work that has to follow a close,
+// like running sv_onrecordfinish, is handed back to the server thread from
+// SV_DiskIO_Frame once the file is closed. Files that get many small writes,
+// like logs, can ask for their flush to wait until SV_DiskIO_Frame too, so a
+// frame's worth of lines costs one write and one flush. The server thread only
+// waits when the disk falls the whole queue behind, sv_diskio shows whether that
+// ever happened.
+//
+// Files opened with SV_DiskIO_OpenGZip are gzip compressed by the writer thread
+// too. A flush ends the deflate block so everything written up to there can be
+// read back even while the file is still open.
+
+#include "qwsvdef.h"
+#include <SDL.h>
+#ifdef WITH_ZLIB
+#include <zlib.h>
+#endif
+
+#define DISKIO_SLOTS		256
+#define DISKIO_BATCH		(64 * 1024)		// gathered writes are queued once they are this big
+#define DISKIO_GZIP_FLUSH	1.0				// seconds between flushes of compressed files
+
+typedef enum {
+	DISKIO_WRITE,
+	DISKIO_FLUSH,
+	DISKIO_CLOSE
+} diskio_op_t;
+
+struct diskfile_s
+{
+	FILE				*file;
+	volatile qbool		error;				// set by the writer
+#ifdef WITH_ZLIB
+	z_stream			*gzip;				// writer thread only
+	byte				*gzip_out;
+#endif
+
+	// server thread only
+	byte				*pending;			// writes not queued yet
+	int					pending_size;
+	int					pending_allocated;
+	qbool				dirty;				// written since the last flush
+	qbool				flushlater;			// in the list flushed by SV_DiskIO_Frame
+	struct diskfile_s	*nextflush;
+	double				flushtime;
+	unsigned long		size;				// before compression
+
+	int					closed;				// request number of the close
+	diskio_done_t		done;
+	void				*arg;
+	struct diskfile_s	*nextclosing;
+};
+
+typedef struct diskio_slot_s
+{
+	diskio_op_t			op;
+	diskfile_t			*df;
+	byte				*data;
+	int					size;
+	int					allocated;
+} diskio_slot_t;
+
+typedef struct diskio_s
+{
+	SDL_Thread			*thread;
+	SDL_sem				*free;
+	SDL_sem				*filled;
+	diskio_slot_t		slots[DISKIO_SLOTS];
+	int					head, tail;
+	int					queued;				// requests queued, server thread
+	SDL_atomic_t		finished;			// requests done, writer thread
+
+	diskfile_t			*closing, *closing_tail;
+	diskfile_t			*flushing;			// flushed at the end of the frame
+
+	// written by the server thread
+	int					ops, stalls, frames, peak;
+	double				bytes, server_time, server_max, frame_max;
+	double				frame_io;			// time spent queuing in the current frame
+
+	// written by the writer thread
+	volatile double		disk_time, disk_max, disk_bytes;
+} diskio_t;
+
+static diskio_t dio;
+
+cvar_t sv_diskio_delay = {"sv_diskio_delay", "0"};	// milliseconds added to every disk operation, for testing
+
+static void SV_DiskIO_WriteFile (diskfile_t *df, const byte *data, int size)
+{
+	if (!df->error && fwrite (data, 1, size, df->file) != size)
+		df->error = true;
+
+	dio.disk_bytes += size;
+}
+
+#ifdef WITH_ZLIB
+// Writer thread only, compresses and writes what deflate gives back.
+static void SV_DiskIO_Deflate (diskfile_t *df, byte *data, int size, int flush)
+{
+	z_stream *z = df->gzip;
+	int ret;
+
+	z->next_in = data;
+	z->avail_in = size;
+
+	do
+	{
+		z->next_out = df->gzip_out;
+		z->avail_out = DISKIO_BATCH;
+		ret = deflate (z, flush);
+		SV_DiskIO_WriteFile (df, df->gzip_out, DISKIO_BATCH - z->avail_out);
+	} while (ret == Z_OK && (z->avail_in || !z->avail_out));
+
+	if (ret == Z_STREAM_ERROR)
+		df->error = true;
+}
+#endif
+
+static void SV_DiskIO_Run (diskio_slot_t *slot)
+{
+	double start = Sys_DoubleTime (), time;
+	diskfile_t *df = slot->df;
+
+	if (sv_diskio_delay.value > 0)
+		Sys_MSleep ((int) sv_diskio_delay.value);
+
+	switch (slot->op)
+	{
+	case DISKIO_WRITE:
+#ifdef WITH_ZLIB
+		if (df->gzip)
+		{
+			SV_DiskIO_Deflate (df, slot->data, slot->size, Z_NO_FLUSH);
+			break;
+		}
+#endif
+		SV_DiskIO_WriteFile (df, slot->data, slot->size);
+		break;
+
+	case DISKIO_FLUSH:
+#ifdef WITH_ZLIB
+		if (df->gzip)
+			SV_DiskIO_Deflate (df, NULL, 0, Z_SYNC_FLUSH);
+#endif
+		if (!df->error && fflush (df->file))
+			df->error = true;
+		break;
+
+	case DISKIO_CLOSE:
+#ifdef WITH_ZLIB
+		if (df->gzip)
+		{
+			SV_DiskIO_Deflate (df, NULL, 0, Z_FINISH);
+			deflateEnd (df->gzip);
+			Q_free (df->gzip);
+			Q_free (df->gzip_out);
+		}
+#endif
+		fclose (df->file);
+		df->file = NULL;
+		break;
+	}
+
+	time = Sys_DoubleTime () - start;
+	dio.disk_time += time;
+	if (time > dio.disk_max)
+		dio.disk_max = time;
+}
+
+static int SV_DiskIO_Thread (void *unused)
+{
+	while (true)
+	{
+		SDL_SemWait (dio.filled);
+
+		SV_DiskIO_Run (&dio.slots[dio.tail]);
+		dio.tail = (dio.tail + 1) % DISKIO_SLOTS;
+		SDL_AtomicAdd (&dio.finished, 1);
+
+		SDL_SemPost (dio.free);
+	}
+
+	return 0;
+}
+
+static void SV_DiskIO_Start (void)
+{
+	static qbool started;
+
+	if (started)
+		return;
+	started = true;
+
+	dio.free = SDL_CreateSemaphore (DISKIO_SLOTS);
+	dio.filled = SDL_CreateSemaphore (0);
+	if (dio.free && dio.filled)
+		dio.thread = SDL_CreateThread (SV_DiskIO_Thread, "sv_diskio", NULL);
+
+	if (!dio.thread)
+		Sys_Printf ("SV_DiskIO: couldn't start the writer thread, writing on the server thread\n");
+}
+
+// Hands a request to the writer, the data of a write is taken over from df->pending.
+static void SV_DiskIO_Queue (diskio_op_t op, diskfile_t *df)
+{
+	double start = Sys_DoubleTime (), time;
+	diskio_slot_t *slot;
+	byte *data;
+	int allocated;
+
+	if (dio.thread)
+		SDL_SemWait (dio.free);
+
+	slot = &dio.slots[dio.head];
+	slot->op = op;
+	slot->df = df;
+
+	if (op == DISKIO_WRITE)
+	{
+		// swap buffers instead of copying
+		data = slot->data;
+		allocated = slot->allocated;
+		slot->data = df->pending;
+		slot->size = df->pending_size;
+		slot->allocated = df->pending_allocated;
+		df->pending = data;
+		df->pending_size = 0;
+		df->pending_allocated = allocated;
+		dio.bytes += slot->size;
+	}
+
+	dio.queued++;
+	dio.ops++;
+
+	if (dio.thread)
+	{
+		dio.head = (dio.head + 1) % DISKIO_SLOTS;
+		dio.peak = max (dio.peak, dio.queued - SDL_AtomicGet (&dio.finished));
+		SDL_SemPost (dio.filled);
+	}
+	else
+	{
+		SV_DiskIO_Run (slot);
+		SDL_AtomicAdd (&dio.finished, 1);
+	}
+
+	time = Sys_DoubleTime () - start;
+	dio.frame_io += time;
+	if (time > 0.001)
+		dio.stalls++;
+}
+
+diskfile_t *SV_DiskIO_Open (FILE *file)
+{
+	diskfile_t *df;
+
+	if (!file)
+		return NULL;
+
+	SV_DiskIO_Start ();
+
+	df = (diskfile_t *) Q_malloc (sizeof (diskfile_t));
+	df->file = file;
+
+	// files opened for appending start out with what is there
+	if (!fseek (file, 0, SEEK_END))
+		df->size = ftell (file);
+
+	return df;
+}
+
+/*
+==================
+SV_DiskIO_OpenGZip
+
+Like SV_DiskIO_Open, but what is written ends up in the file gzip compressed with
+the given level. Without zlib the file is written as is, SV_DiskIO_GZip tells.
+==================
+*/
+diskfile_t *SV_DiskIO_OpenGZip (FILE *file, int level)
+{
+	diskfile_t *df = SV_DiskIO_Open (file);
+
+#ifdef WITH_ZLIB
+	if (!df)
+		return NULL;
+
+	df->gzip = (z_stream *) Q_malloc (sizeof (z_stream));
+	df->gzip_out = (byte *) Q_malloc (DISKIO_BATCH);
+	df->size = 0;
+
+	// 16 + window bits writes a gzip header and trailer around the deflate stream
+	if (deflateInit2 (df->gzip, bound (1, level, 9), Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+	{
+		Q_free (df->gzip);
+		Q_free (df->gzip_out);
+	}
+#endif
+
+	return df;
+}
+
+qbool SV_DiskIO_GZip (diskfile_t *df)
+{
+#ifdef WITH_ZLIB
+	return df->gzip != NULL;
+#else
+	return false;
+#endif
+}
+
+void SV_DiskIO_Write (diskfile_t *df, const void *data, int size)
+{
+	if (size <= 0)
+		return;
+
+	if (df->pending_size + size > df->pending_allocated)
+	{
+		df->pending_allocated = max (df->pending_size + size, min (DISKIO_BATCH, 2 * df->pending_allocated + 4096));
+		df->pending = (byte *) Q_realloc (df->pending, df->pending_allocated);
+	}
+
+	memcpy (df->pending + df->pending_size, data, size);
+	df->pending_size += size;
+	df->size += size;
+	df->dirty = true;
+
+	if (df->pending_size >= DISKIO_BATCH)
+		SV_DiskIO_Queue (DISKIO_WRITE, df);
+}
+
+void SV_DiskIO_Flush (diskfile_t *df)
+{
+	if (!df->dirty)
+		return;
+
+	// every flush costs a few bytes and restarts the compression, don't do it every frame
+	if (SV_DiskIO_GZip (df))
+	{
+		if (realtime - df->flushtime < DISKIO_GZIP_FLUSH && realtime >= df->flushtime)
+			return;
+		df->flushtime = realtime;
+	}
+
+	if (df->pending_size)
+		SV_DiskIO_Queue (DISKIO_WRITE, df);
+	SV_DiskIO_Queue (DISKIO_FLUSH, df);
+	df->dirty = false;
+}
+
+// Flushes at the end of the frame, however often it is called until then.
+void SV_DiskIO_FlushLater (diskfile_t *df)
+{
+	if (df->flushlater)
+		return;
+
+	df->flushlater = true;
+	df->nextflush = dio.flushing;
+	dio.flushing = df;
+}
+
+static void SV_DiskIO_FlushFrame (void)
+{
+	diskfile_t *df;
+
+	while ((df = dio.flushing))
+	{
+		dio.flushing = df->nextflush;
+		df->nextflush = NULL;
+		df->flushlater = false;
+		SV_DiskIO_Flush (df);
+	}
+}
+
+/*
+==================
+SV_DiskIO_Close
+
+Queues the close, 'done' gets a copy of 'arg' on the server thread once the file is closed.
+==================
+*/
+void SV_DiskIO_Close (diskfile_t *df, diskio_done_t done, const void *arg, int argsize)
+{
+	diskfile_t **link;
+
+	if (!df)
+		return;
+
+	if (df->flushlater)
+	{
+		for (link = &dio.flushing; *link != df; link = &(*link)->nextflush)
+			;
+		*link = df->nextflush;
+		df->flushlater = false;
+	}
+
+	if (df->pending_size)
+		SV_DiskIO_Queue (DISKIO_WRITE, df);
+	SV_DiskIO_Queue (DISKIO_CLOSE, df);
+
+	df->closed = dio.queued;
+	df->done = done;
+	if (arg && argsize > 0)
+	{
+		df->arg = Q_malloc (argsize);
+		memcpy (df->arg, arg, argsize);
+	}
+
+	if (dio.closing_tail)
+		dio.closing_tail->nextclosing = df;
+	else
+		dio.closing = df;
+	dio.closing_tail = df;
+
+	if (!dio.thread)
+		SV_DiskIO_Frame (0);
+}
+
+qbool SV_DiskIO_Error (diskfile_t *df)
+{
+	return df->error;
+}
+
+unsigned long SV_DiskIO_Size (diskfile_t *df)
+{
+	return df->size;
+}
+
+/*
+==================
+SV_DiskIO_Frame
+
+Queues the flushes asked for during the frame, finishes closed files and keeps
+frame statistics. frametime is how long the server frame took, 0 outside of one.
+==================
+*/
+void SV_DiskIO_Frame (double frametime)
+{
+	int i, finished;
+	diskfile_t *df;
+
+	SV_DiskIO_FlushFrame ();
+	finished = SDL_AtomicGet (&dio.finished);
+
+	while ((df = dio.closing) && finished - df->closed >= 0)
+	{
+		if (!(dio.closing = df->nextclosing))
+			dio.closing_tail = NULL;
+
+		if (df->done)
+			df->done (df->arg);
+
+		Q_free (df->arg);
+		Q_free (df->pending);
+		Q_free (df);
+	}
+
+	// nothing queued, give the memory of big writes back
+	if (finished == dio.queued)
+	{
+		for (i = 0; i < DISKIO_SLOTS; i++)
+		{
+			if (dio.slots[i].allocated > DISKIO_BATCH)
+			{
+				Q_free (dio.slots[i].data);
+				dio.slots[i].allocated = 0;
+			}
+		}
+	}
+
+	if (frametime > 0)
+	{
+		dio.frames++;
+		dio.frame_max = max (dio.frame_max, frametime);
+		dio.server_time += dio.frame_io;
+		dio.server_max = max (dio.server_max, dio.frame_io);
+	}
+	dio.frame_io = 0;
+}
+
+// Waits for everything queued to be on disk, for shutting down. Finishing a close
+// may queue more, sv_onrecordfinish writes a txt file and closes it again.
+void SV_DiskIO_Sync (void)
+{
+	SV_DiskIO_FlushFrame ();
+
+	while (SDL_AtomicGet (&dio.finished) != dio.queued || dio.closing)
+	{
+		if (SDL_AtomicGet (&dio.finished) != dio.queued)
+			Sys_MSleep (1);
+		SV_DiskIO_Frame (0);
+	}
+}
+
+static void SV_DiskIO_f (void)
+{
+	if (Cmd_Argc () > 1 && !strcmp (Cmd_Argv (1), "reset"))
+	{
+		dio.ops = dio.stalls = dio.frames = dio.peak = 0;
+		dio.bytes = dio.server_time = dio.server_max = dio.frame_max = 0;
+		dio.disk_time = dio.disk_max = dio.disk_bytes = 0;
+		return;
+	}
+
+	Con_Printf ("disk writer: %s, %d requests, %.2f MB, %d/%d queued at most\n",
+		dio.thread ? "background thread" : "server thread", dio.ops, dio.bytes / (1024 * 1024), dio.peak, DISKIO_SLOTS);
+	Con_Printf ("disk calls:     %9.2f ms, longest %7.2f ms, %.2f MB written\n",
+		dio.disk_time * 1000, dio.disk_max * 1000, dio.disk_bytes / (1024 * 1024));
+	Con_Printf ("server thread:  %9.2f ms, longest %7.2f ms per frame, %d waits over 1 ms\n",
+		dio.server_time * 1000, dio.server_max * 1000, dio.stalls);
+	Con_Printf ("server frames:  %9d, longest %7.2f ms\n", dio.frames, dio.frame_max * 1000);
+}
+
+void SV_DiskIO_Init (void)
+{
+	Cvar_Register (&sv_diskio_delay);
+	Cmd_AddCommand ("sv_diskio", SV_DiskIO_f);
+}
@@ -0,0 +1,426 @@
+/*
+Copyright (C) 2026 ezQuake team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+// sv_download.c -- files being downloaded by clients.
+//
+// When a map changes everybody who lacks it asks for the same files at once.
+// Instead of every downloader reading its own copy, a file is read into memory
+// once and all downloaders are served from that copy by offset, straight into
+// their message buffers. The copy is filled a chunk at a time as the foremost
+// downloader gets to it, so a large file never stalls a server frame. Files
+// nobody downloads any more are kept while they fit in sv_download_cache
+// megabytes and dropped on map change, files larger than that are read per
+// downloader as before.
+
+#include "qwsvdef.h"
+
+typedef struct dlcache_entry_s
+{
+	char					name[MAX_OSPATH];
+	byte					*data;
+	int						size;
+	time_t					mtime;		// of the file on disk, 0 if it came from a pak
+	int						filled;		// bytes read into data so far
+	vfsfile_t				*file;		// to read the rest from, closed once filled
+	int						refs;
+	qbool					stale;		// dropped from the cache, freed with the last downloader
+	double					lastused;
+	struct dlcache_entry_s	*next;
+} dlcache_entry_t;
+
+struct sv_download_s
+{
+	dlcache_entry_t	*entry;			// shared copy, or
+	vfsfile_t		*file;			// read for this downloader only
+	byte			*buffer;
+	int				buffer_size;
+	int				size;
+};
+
+#define DLCACHE_CHUNK	(64 * 1024)	// read ahead of the foremost downloader at once
+
+cvar_t sv_download_cache = {"sv_download_cache", "64"};	// megabytes of files kept in memory for downloads
+
+static dlcache_entry_t *dlcache;
+static int dlcache_size;
+static int dlcache_limit = -1;		// overrides sv_download_cache while benchmarking
+
+static int SV_DownloadCacheLimit (void)
+{
+	if (dlcache_limit >= 0)
+		return dlcache_limit;
+
+	return (int) bound (0, sv_download_cache.value, 1024) * 1024 * 1024;
+}
+
+// Takes the file out of the cache, downloaders who have it keep it until they are done.
+static void SV_DownloadCacheUnlink (dlcache_entry_t *entry)
+{
+	dlcache_entry_t **link;
+
+	for (link = &dlcache; *link; link = &(*link)->next)
+	{
+		if (*link == entry)
+		{
+			*link = entry->next;
+			break;
+		}
+	}
+
+	entry->next = NULL;
+	entry->stale = true;
+	dlcache_size -= entry->size;
+}
+
+static void SV_DownloadCacheFree (dlcache_entry_t *entry)
+{
+	if (!entry->stale)
+		SV_DownloadCacheUnlink (entry);
+
+	if (entry->file)
+		VFS_CLOSE (entry->file);
+	Q_free (entry->data);
+	Q_free (entry);
+}
+
+// Frees files nobody downloads, least recently used first, until 'size' more bytes fit.
+static qbool SV_DownloadCacheMakeRoom (int size, int limit)
+{
+	dlcache_entry_t *entry, *oldest;
+
+	while (size > limit - dlcache_size)
+	{
+		oldest = NULL;
+		for (entry = dlcache; entry; entry = entry->next)
+		{
+			if (!entry->refs && (!oldest || entry->lastused < oldest->lastused))
+				oldest = entry;
+		}
+
+		if (!oldest)
+			return false;
+		SV_DownloadCacheFree (oldest);
+	}
+
+	return true;
+}
+
+// A new entry takes over the file to fill itself from.
+static dlcache_entry_t *SV_DownloadCacheFind (vfsfile_t *file, const char *name, int size, time_t mtime)
+{
+	int limit = SV_DownloadCacheLimit ();
+	dlcache_entry_t *entry;
+
+	if (!limit)
+		return NULL;
+
+	for (entry = dlcache; entry; entry = entry->next)
+	{
+		if (!strcmp (entry->name, name))
+		{
+			if (entry->size == size && entry->mtime == mtime)
+				return entry;
+
+			// changed on disk, let current downloaders finish with the old copy
+			if (entry->refs)
+				SV_DownloadCacheUnlink (entry);
+			else
+				SV_DownloadCacheFree (entry);
+			break;
+		}
+	}
+
+	if (size > limit || !SV_DownloadCacheMakeRoom (size, limit))
+		return NULL;
+
+	if (VFS_SEEK (file, 0, SEEK_SET))
+		return NULL;
+
+	entry = (dlcache_entry_t *) Q_malloc (sizeof (dlcache_entry_t));
+	entry->data = (byte *) Q_malloc (max (size, 1));
+	entry->size = size;
+	entry->mtime = mtime;
+	entry->file = size ? file : NULL;
+	strlcpy (entry->name, name, sizeof (entry->name));
+
+	entry->next = dlcache;
+	dlcache = entry;
+	dlcache_size += size;
+
+	return entry;
+}
+
+// Reads at least up to 'end', a whole chunk at a time.
+static qbool SV_DownloadCacheFill (dlcache_entry_t *entry, int end)
+{
+	int r;
+
+	end = min (entry->size, max (end, entry->filled + DLCACHE_CHUNK));
+
+	while (entry->filled < end)
+	{
+		if (!entry->file || (r = VFS_READ (entry->file, entry->data + entry->filled, end - entry->filled, NULL)) <= 0)
+		{
+			// nobody can be served from it any more, later downloaders read their own copy
+			if (entry->file)
+				VFS_CLOSE (entry->file);
+			entry->file = NULL;
+			if (!entry->stale)
+				SV_DownloadCacheUnlink (entry);
+			return false;
+		}
+		entry->filled += r;
+	}
+
+	if (entry->filled == entry->size && entry->file)
+	{
+		VFS_CLOSE (entry->file);
+		entry->file = NULL;
+	}
+
+	return true;
+}
+
+/*
+==================
+SV_DownloadOpen
+
+Takes over an opened file, it is closed or kept for this download as needed.
+==================
+*/
+sv_download_t *SV_DownloadOpen (vfsfile_t *file, const char *name)
+{
+	sv_download_t *dl = (sv_download_t *) Q_malloc (sizeof (sv_download_t));
+
+	dl->size = VFS_GETLEN (file);
+
+	if ((dl->entry = SV_DownloadCacheFind (file, name, dl->size, VFSOS_FileTime (file))))
+	{
+		dl->entry->refs++;
+		dl->entry->lastused = realtime;
+		if (dl->entry->file != file)
+			VFS_CLOSE (file);
+	}
+	else
+	{
+		VFS_SEEK (file, 0, SEEK_SET);
+		dl->file = file;
+	}
+
+	return dl;
+}
+
+int SV_DownloadSize (sv_download_t *dl)
+{
+	return dl->size;
+}
+
+/*
+==================
+SV_DownloadData
+
+Returns up to *len bytes at offset and sets *len to how many there are.
+Cached files hand out their shared copy, nothing is read or copied.
+==================
+*/
+const byte *SV_DownloadData (sv_download_t *dl, int offset, int *len)
+{
+	if (offset < 0 || offset >= dl->size)
+	{
+		*len = 0;
+		return NULL;
+	}
+
+	*len = bound (0, *len, dl->size - offset);
+	if (!*len)
+		return NULL;
+
+	if (dl->entry)
+	{
+		if (offset + *len > dl->entry->filled && !SV_DownloadCacheFill (dl->entry, offset + *len))
+		{
+			*len = 0;
+			return NULL;
+		}
+
+		dl->entry->lastused = realtime;
+		return dl->entry->data + offset;
+	}
+
+	if (*len > dl->buffer_size)
+	{
+		dl->buffer = (byte *) Q_realloc (dl->buffer, *len);
+		dl->buffer_size = *len;
+	}
+
+	if (VFS_SEEK (dl->file, offset, SEEK_SET) || (*len = VFS_READ (dl->file, dl->buffer, *len, NULL)) <= 0)
+	{
+		*len = 0;
+		return NULL;
+	}
+
+	return dl->buffer;
+}
+
+void SV_DownloadClose (sv_download_t *dl)
+{
+	if (!dl)
+		return;
+
+	if (dl->entry)
+	{
+		dl->entry->refs--;
+		if (dl->entry->stale && !dl->entry->refs)
+			SV_DownloadCacheFree (dl->entry);
+	}
+
+	if (dl->file)
+		VFS_CLOSE (dl->file);
+
+	Q_free (dl->buffer);
+	Q_free (dl);
+}
+
+/*
+==================
+SV_DownloadCacheFlush
+
+Files may change with the map, forget everything but what is being downloaded right now.
+==================
+*/
+void SV_DownloadCacheFlush (void)
+{
+	dlcache_entry_t *entry, *next;
+
+	for (entry = dlcache; entry; entry = next)
+	{
+		next = entry->next;
+		if (entry->refs)
+			SV_DownloadCacheUnlink (entry);
+		else
+			SV_DownloadCacheFree (entry);
+	}
+}
+
+/*
+==================
+SV_DownloadBench_f
+
+Serves a file to a number of simulated downloaders at once, first each reading
+its own copy and then from the shared cache, and prints the aggregate throughput.
+The downloaders take turns sending FILE_TRANSFER_BUF_SIZE bytes into a message
+buffer, like clients with unlimited rate would.
+==================
+*/
+static void SV_DownloadBench_f (void)
+{
+	int clients = (Cmd_Argc() > 2) ? Q_atoi (Cmd_Argv(2)) : 20;
+	byte msg_buf[FILE_TRANSFER_BUF_SIZE + 16];
+	sv_download_t **dl;
+	sizebuf_t msg;
+	vfsfile_t *file;
+	const byte *data;
+	double start, elapsed;
+	int pass, i, len, active, size = 0, *offset;
+	qbool cached;
+
+	if (Cmd_Argc() < 2 || clients < 1)
+	{
+		Con_Printf ("usage: %s <file> [downloaders]\n", Cmd_Argv(0));
+		return;
+	}
+
+	if (!(file = FS_OpenVFS (Cmd_Argv(1), "rb", CLIENT_DOWNLOAD_RELATIVE_BASE)))
+	{
+		Con_Printf ("%s: couldn't open %s\n", Cmd_Argv(0), Cmd_Argv(1));
+		return;
+	}
+	VFS_CLOSE (file);
+
+	dl = (sv_download_t **) Q_malloc (clients * sizeof (sv_download_t *));
+	offset = (int *) Q_malloc (clients * sizeof (int));
+	SZ_Init (&msg, msg_buf, sizeof (msg_buf));
+
+	for (pass = 0; pass < 2; pass++)
+	{
+		// the first pass must not find the file in the cache, the second must not miss it
+		dlcache_limit = pass ? max (SV_DownloadCacheLimit (), 1024 * 1024 * 1024) : 0;
+
+		start = Sys_DoubleTime ();
+		for (i = 0; i < clients; i++)
+		{
+			if (!(file = FS_OpenVFS (Cmd_Argv(1), "rb", CLIENT_DOWNLOAD_RELATIVE_BASE)))
+				break;
+			dl[i] = SV_DownloadOpen (file, Cmd_Argv(1));
+			offset[i] = 0;
+		}
+		if (i < clients)
+		{
+			Con_Printf ("%s: couldn't open %s %d times\n", Cmd_Argv(0), Cmd_Argv(1), clients);
+			while (i--)
+				SV_DownloadClose (dl[i]);
+			break;
+		}
+		size = SV_DownloadSize (dl[0]);
+		cached = (dl[0]->entry != NULL);
+
+		do
+		{
+			for (i = active = 0; i < clients; i++)
+			{
+				if (offset[i] >= size)
+					continue;
+
+				len = FILE_TRANSFER_BUF_SIZE;
+				if (!(data = SV_DownloadData (dl[i], offset[i], &len)))
+				{
+					offset[i] = size;
+					continue;
+				}
+
+				SZ_Clear (&msg);
+				MSG_WriteShort (&msg, len);
+				SZ_Write (&msg, data, len);
+				offset[i] += len;
+				active++;
+			}
+		} while (active);
+
+		for (i = 0; i < clients; i++)
+			SV_DownloadClose (dl[i]);
+		elapsed = max (Sys_DoubleTime () - start, 0.000001);
+
+		Con_Printf ("%s: %d x %d bytes in %.3f s, %.1f MB/s%s\n", pass ? "shared" : "per client",
+			clients, size, elapsed, (double) clients * size / elapsed / (1024 * 1024),
+			pass && !cached ? " (too big for the cache)" : "");
+	}
+
+	dlcache_limit = -1;
+	SV_DownloadCacheMakeRoom (0, SV_DownloadCacheLimit ());
+
+	Q_free (offset);
+	Q_free (dl);
+}
+
+void SV_DownloadInit (void)
+{
+	Cvar_Register (&sv_download_cache);
+
+	Cmd_AddCommand ("sv_downloadbench", SV_DownloadBench_f);
+}
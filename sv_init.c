@@ -254,6 +254,7 @@ void SV_SpawnServer(char *mapname, qbool devmap, char* entityfile, qbool loading
 	PR_UnLoadProgs();
 
 	svs.spawncount++; // any partially connected client will be restarted
+	SV_DownloadCacheFlush(); // the new map may come with new versions of files
 
 #ifndef SERVERONLY
 	com_serveractive = false;
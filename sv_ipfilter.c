@@ -0,0 +1,256 @@
+/*
+Copyright (C) 2026 ezQuake team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+// sv_ipfilter.c -- lookup structures behind the ip filter and penalty lists.
+//
+// Filters are per octet: every octet of the address either has to match exactly
+// or is a wildcard ("addip 192.168" bans 192.168.*.*). The trie branches on one
+// octet per level and keeps a separate wildcard branch, so a lookup follows at most
+// two branches per level instead of testing every filter. Keys are a byte string
+// of any length, IPv6 addresses only need a 16 byte key once netadr_t carries them.
+//
+// Timed filters are expired through a min-heap ordered by expiry time, so the
+// server frame only looks at the earliest entry instead of sweeping the lists.
+
+#include "qwsvdef.h"
+
+static iptrie_node_t *IPTrie_NewNode (void)
+{
+	return (iptrie_node_t *) Q_malloc (sizeof (iptrie_node_t));
+}
+
+static void IPTrie_FreeNode (iptrie_node_t *node)
+{
+	int i;
+
+	if (!node)
+		return;
+
+	IPTrie_FreeNode (node->any);
+	for (i = 0; i < node->numedges; i++)
+		IPTrie_FreeNode (node->edges[i].node);
+
+	Q_free (node->edges);
+	Q_free (node);
+}
+
+// Binary search, returns the position the octet is at or should be inserted at.
+static int IPTrie_FindEdge (const iptrie_node_t *node, byte octet)
+{
+	int lo = 0, hi = node->numedges;
+
+	while (lo < hi)
+	{
+		int mid = (lo + hi) / 2;
+
+		if (node->edges[mid].octet < octet)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+static iptrie_node_t **IPTrie_Child (iptrie_node_t *node, byte octet, byte mask, qbool create)
+{
+	int i;
+
+	if (!mask)
+	{
+		if (!node->any && create)
+			node->any = IPTrie_NewNode ();
+		return &node->any;
+	}
+
+	i = IPTrie_FindEdge (node, octet);
+	if (i < node->numedges && node->edges[i].octet == octet)
+		return &node->edges[i].node;
+
+	if (!create)
+		return NULL;
+
+	node->edges = (iptrie_edge_t *) Q_realloc (node->edges, (node->numedges + 1) * sizeof (iptrie_edge_t));
+	memmove (node->edges + i + 1, node->edges + i, (node->numedges - i) * sizeof (iptrie_edge_t));
+	node->numedges++;
+	node->edges[i].octet = octet;
+	node->edges[i].node = IPTrie_NewNode ();
+
+	return &node->edges[i].node;
+}
+
+void IPTrie_Insert (iptrie_t *trie, const byte *key, const byte *mask, int len)
+{
+	iptrie_node_t *node;
+	int i;
+
+	if (!trie->root)
+		trie->root = IPTrie_NewNode ();
+
+	node = trie->root;
+	node->refs++;
+	for (i = 0; i < len; i++)
+	{
+		node = *IPTrie_Child (node, key[i] & mask[i], mask[i], true);
+		node->refs++;
+	}
+
+	node->count++;
+	trie->count++;
+}
+
+static qbool IPTrie_RemoveNode (iptrie_node_t *node, const byte *key, const byte *mask, int depth, int len)
+{
+	iptrie_node_t **child;
+
+	if (depth == len)
+	{
+		if (node->count <= 0)
+			return false;
+		node->count--;
+		node->refs--;
+		return true;
+	}
+
+	child = IPTrie_Child (node, key[depth] & mask[depth], mask[depth], false);
+	if (!child || !*child || !IPTrie_RemoveNode (*child, key, mask, depth + 1, len))
+		return false;
+
+	node->refs--;
+
+	// prune the branch once nothing is left below it
+	if (!(*child)->refs)
+	{
+		IPTrie_FreeNode (*child);
+		if (mask[depth])
+		{
+			int i = IPTrie_FindEdge (node, key[depth] & mask[depth]);
+
+			memmove (node->edges + i, node->edges + i + 1, (node->numedges - i - 1) * sizeof (iptrie_edge_t));
+			node->numedges--;
+		}
+		else
+		{
+			node->any = NULL;
+		}
+	}
+
+	return true;
+}
+
+// Removes one filter added with the same key and mask, returns false if there was none.
+qbool IPTrie_Remove (iptrie_t *trie, const byte *key, const byte *mask, int len)
+{
+	if (!trie->root || !IPTrie_RemoveNode (trie->root, key, mask, 0, len))
+		return false;
+
+	trie->count--;
+	return true;
+}
+
+static qbool IPTrie_MatchNode (const iptrie_node_t *node, const byte *addr, int depth, int len)
+{
+	int i;
+
+	if (!node)
+		return false;
+
+	if (depth == len)
+		return node->count > 0;
+
+	if (IPTrie_MatchNode (node->any, addr, depth + 1, len))
+		return true;
+
+	i = IPTrie_FindEdge (node, addr[depth]);
+	return i < node->numedges && node->edges[i].octet == addr[depth] && IPTrie_MatchNode (node->edges[i].node, addr, depth + 1, len);
+}
+
+// True if any filter in the trie matches the address.
+qbool IPTrie_Match (const iptrie_t *trie, const byte *addr, int len)
+{
+	return trie->count && IPTrie_MatchNode (trie->root, addr, 0, len);
+}
+
+void IPTrie_Clear (iptrie_t *trie)
+{
+	IPTrie_FreeNode (trie->root);
+	trie->root = NULL;
+	trie->count = 0;
+}
+
+//============================================================================
+
+#define IPTIMER_PARENT(i)	(((i) - 1) / 2)
+
+static void IPTimer_Swap (iptimer_heap_t *heap, int a, int b)
+{
+	iptimer_t temp = heap->timers[a];
+
+	heap->timers[a] = heap->timers[b];
+	heap->timers[b] = temp;
+}
+
+void IPTimer_Push (iptimer_heap_t *heap, const iptimer_t *timer)
+{
+	int i;
+
+	if (heap->count == heap->size)
+	{
+		heap->size = max (64, heap->size * 2);
+		heap->timers = (iptimer_t *) Q_realloc (heap->timers, heap->size * sizeof (iptimer_t));
+	}
+
+	i = heap->count++;
+	heap->timers[i] = *timer;
+
+	while (i > 0 && heap->timers[i].time < heap->timers[IPTIMER_PARENT(i)].time)
+	{
+		IPTimer_Swap (heap, i, IPTIMER_PARENT(i));
+		i = IPTIMER_PARENT(i);
+	}
+}
+
+// Takes the earliest timer off the heap if it is due at 'now'.
+qbool IPTimer_Pop (iptimer_heap_t *heap, double now, iptimer_t *timer)
+{
+	int i, child;
+
+	if (!heap->count || heap->timers[0].time > now)
+		return false;
+
+	*timer = heap->timers[0];
+	heap->timers[0] = heap->timers[--heap->count];
+
+	for (i = 0; (child = 2 * i + 1) < heap->count; i = child)
+	{
+		if (child + 1 < heap->count && heap->timers[child + 1].time < heap->timers[child].time)
+			child++;
+		if (heap->timers[i].time <= heap->timers[child].time)
+			break;
+		IPTimer_Swap (heap, i, child);
+	}
+
+	return true;
+}
+
+void IPTimer_Clear (iptimer_heap_t *heap)
+{
+	Q_free (heap->timers);
+	heap->count = heap->size = 0;
+}
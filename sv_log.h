@@ -25,7 +25,7 @@ enum {	MIN_LOG = 0, CONSOLE_LOG = 0, ERROR_LOG,  RCON_LOG,
 		TELNET_LOG,  FRAG_LOG,        PLAYER_LOG, MOD_FRAG_LOG, MAX_LOG};
 
 typedef struct log_s {
-	FILE		*sv_logfile;
+	diskfile_t	*sv_logfile;
 	char		*command;
 	char		*file_name;
 	char		*message_off;
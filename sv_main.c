@@ -79,6 +79,10 @@ cvar_t	sv_crypt_rcon = {"sv_crypt_rcon", "1"}; // use SHA1 for encryption of rco
 // Time in seconds during which in rcon command this encryption is valid (change only with master_rcon_password).
 cvar_t	sv_timestamplen = {"sv_timestamplen", "60"};
 cvar_t	sv_rconlim = {"sv_rconlim", "10"};	// rcon bandwith limit: requests per second
+cvar_t	sv_oob_rate = {"sv_oob_rate", "10"};	// connectionless packets per second from one address
+cvar_t	sv_oob_burst = {"sv_oob_burst", "30"};	// connectionless packets one address may send at once
+cvar_t	sv_oob_sharedrate = {"sv_oob_sharedrate", "1000"};	// per second for all addresses that collide with another one
+cvar_t	sv_status_cachetime = {"sv_status_cachetime", "1"};	// seconds a status reply is sent again while nothing changed
 
 //bliP: telnet log level
 void OnChange_telnetloglevel_var (cvar_t *var, char *string, qbool *cancel);
@@ -226,13 +230,16 @@ void SV_Shutdown (char *finalmsg)
 	{
 		if (logs[i].sv_logfile)
 		{
-			fclose (logs[i].sv_logfile);
+			SV_DiskIO_Close (logs[i].sv_logfile, NULL, NULL, 0);
 			logs[i].sv_logfile = NULL;
 		}
 	}
 	if (sv.mvdrecording)
 		SV_MVDStop_f();
 
+	// finish writing and closing files, sv_onrecordfinish included
+	SV_DiskIO_Sync ();
+
 #ifndef SERVER_ONLY
 	NET_CloseServer ();
 #endif
@@ -382,7 +389,7 @@ void SV_DropClient (client_t *drop)
 
 	if (drop->download)
 	{
-		VFS_CLOSE(drop->download);
+		SV_DownloadClose(drop->download);
 		drop->download = NULL;
 	}
 	if (drop->upload)
@@ -456,6 +463,8 @@ int SV_CalcPing (client_t *cl)
 	return ping*1000;
 }
 
+static unsigned int status_players_changed;	// invalidates cached status replies
+
 /*
 ===================
 SV_FullClientUpdate
@@ -468,6 +477,8 @@ void SV_FullClientUpdate (client_t *client, sizebuf_t *buf)
 	char info[MAX_EXT_INFO_STRING];
 	int i;
 
+	status_players_changed++;
+
 	i = client - svs.clients;
 
 	//Sys_Printf("SV_FullClientUpdate:  Updated frags for client %d\n", i);
@@ -576,17 +587,12 @@ This message can be up to around 5k with worst case string lengths.
 #define STATUS_SHOWTEAMS                16
 #define STATUS_SHOWQTV                  32
 
-static void SVC_Status (void)
+static void SVC_StatusPrint (int opt)
 {
-	int top, bottom, ping, i, opt = 0;
+	int top, bottom, ping, i;
 	char *name, *frags;
 	client_t *cl;
 
-
-	if (Cmd_Argc() > 1)
-		opt = Q_atoi(Cmd_Argv(1));
-
-	SV_BeginRedirect (RD_PACKET);
 	if (opt == STATUS_OLDSTYLE || (opt & STATUS_SERVERINFO))
 		Con_Printf ("%s\n", svs.info);
 	if (opt == STATUS_OLDSTYLE || (opt & (STATUS_PLAYERS | STATUS_SPECTATORS)))
@@ -630,7 +636,91 @@ static void SVC_Status (void)
 
 	if (opt & STATUS_SHOWQTV)
 		QTV_Streams_List ();
-	SV_EndRedirect ();
+}
+
+/*
+Status replies are cached per option set, anyone can ask for them with a spoofed
+address and building them is the most expensive thing a connectionless packet
+can make us do. A reply is built again when serverinfo or the player list
+changes, and at least every sv_status_cachetime seconds for pings and times.
+*/
+#define STATUS_CACHE_OPTS               64
+
+typedef struct status_cache_s
+{
+	sizebuf_t       buf;
+	byte            data[OUTPUTBUF_SIZE * 2];
+	unsigned int    signature;
+	double          time;
+	qbool           valid;
+} status_cache_t;
+
+static status_cache_t *status_cache[STATUS_CACHE_OPTS];
+static int status_rebuilds;
+
+static unsigned int SV_StatusSignature (void)
+{
+	unsigned int hash = status_players_changed * 2654435761u;
+	char *s;
+	int i;
+
+	for (s = svs.info; *s; s++)
+		hash = hash * 31 + (byte) *s;
+
+	for (i = 0; i < MAX_CLIENTS; i++)
+		hash = hash * 31 + (svs.clients[i].state >= cs_preconnected ? svs.clients[i].old_frags : 0x80000000);
+
+	return hash;
+}
+
+static void SVC_Status (void)
+{
+	status_cache_t *cache;
+	unsigned int signature;
+	int opt = 0, len;
+	byte *p;
+
+	if (Cmd_Argc() > 1)
+		opt = Q_atoi(Cmd_Argv(1));
+
+	if (sv_status_cachetime.value <= 0 || opt < 0 || opt >= STATUS_CACHE_OPTS)
+	{
+		SV_BeginRedirect (RD_PACKET);
+		SVC_StatusPrint (opt);
+		SV_EndRedirect ();
+		return;
+	}
+
+	if (!status_cache[opt])
+	{
+		status_cache[opt] = (status_cache_t *) Q_malloc (sizeof (status_cache_t));
+		SZ_Init (&status_cache[opt]->buf, status_cache[opt]->data, sizeof (status_cache[opt]->data));
+	}
+	cache = status_cache[opt];
+	signature = SV_StatusSignature ();
+
+	if (!cache->valid || cache->signature != signature
+		|| realtime - cache->time >= sv_status_cachetime.value || realtime < cache->time)
+	{
+		SZ_Clear (&cache->buf);
+		SV_CaptureRedirect (&cache->buf);
+		SV_BeginRedirect (RD_PACKET);
+		SVC_StatusPrint (opt);
+		SV_EndRedirect ();
+		SV_CaptureRedirect (NULL);
+
+		cache->valid = !cache->buf.overflowed;
+		cache->signature = signature;
+		cache->time = realtime;
+		status_rebuilds++;
+		return;
+	}
+
+	for (p = cache->data; p + 2 <= cache->data + cache->buf.cursize; p += 2 + len)
+	{
+		len = p[0] | (p[1] << 8);
+		NET_SendPacket (NS_SERVER, len, p + 2, net_from);
+	}
 }
 
 /*
@@ -764,38 +854,64 @@ flood the server with invalid connection IPs.  With a
 challenge, they must give a valid IP address.
 =================
 */
-static void SVC_GetChallenge (void)
-{
-	int oldestTime, oldest, i;
-	char buf[256], *over;
-
+/*
+=================
+SV_Challenge
 
-	oldest = 0;
-	oldestTime = 0x7fffffff;
+HMAC-MD4 of the address and time window, keyed with a secret made at startup.
+=================
+*/
+static int SV_Challenge (netadr_t adr, int window)
+{
+	byte inner[64 + 8], outer[64 + 16], digest[16];
+	int i, challenge;
 
-	// see if we already have a challenge for this ip
-	for (i = 0 ; i < MAX_CHALLENGES ; i++)
+	memset (inner, 0, 64);
+	memcpy (inner, svs.challenge_secret, CHALLENGE_SECRET_SIZE);
+	memcpy (outer, inner, 64);
+	for (i = 0; i < 64; i++)
 	{
-		if (NET_CompareBaseAdr (net_from, svs.challenges[i].adr))
-			break;
-		if (svs.challenges[i].time < oldestTime)
-		{
-			oldestTime = svs.challenges[i].time;
-			oldest = i;
-		}
+		inner[i] ^= 0x36;
+		outer[i] ^= 0x5c;
 	}
 
-	if (i == MAX_CHALLENGES)
+	memcpy (inner + 64, adr.ip, 4);
+	window = LittleLong (window);
+	memcpy (inner + 68, &window, 4);
+	Com_BlockFullChecksum (inner, sizeof (inner), outer + 64);
+	Com_BlockFullChecksum (outer, sizeof (outer), digest);
+
+	memcpy (&challenge, digest, 4);
+	return LittleLong (challenge) & 0x7fffffff;
+}
+
+static void SV_InitChallenges (void)
+{
+	FILE *f;
+	double time;
+	int i;
+
+	if ((f = fopen ("/dev/urandom", "rb")))
 	{
-		// overwrite the oldest
-		svs.challenges[oldest].challenge = (rand() << 16) ^ rand();
-		svs.challenges[oldest].adr = net_from;
-		svs.challenges[oldest].time = realtime;
-		i = oldest;
+		i = fread (svs.challenge_secret, 1, CHALLENGE_SECRET_SIZE, f);
+		fclose (f);
+		if (i == CHALLENGE_SECRET_SIZE)
+			return;
 	}
 
-	// send it back
-	snprintf(buf, sizeof(buf), "%c%i", S2C_CHALLENGE, svs.challenges[i].challenge);
+	// no system source, the best we have is what rand() and the clock give
+	time = Sys_DoubleTime ();
+	for (i = 0; i < CHALLENGE_SECRET_SIZE; i++)
+		svs.challenge_secret[i] = (rand () >> 4) ^ ((byte *) &time)[i % sizeof (time)];
+	Com_BlockFullChecksum (svs.challenge_secret, CHALLENGE_SECRET_SIZE, svs.challenge_secret);
+}
+
+static void SVC_GetChallenge (void)
+{
+	char buf[256], *over;
+
+	// send it back, nothing is stored until the client connects with it
+	snprintf(buf, sizeof(buf), "%c%i", S2C_CHALLENGE, SV_Challenge (net_from, (int)(realtime / CHALLENGE_WINDOW)));
 	over = buf + strlen(buf) + 1;
 
 #ifdef PROTOCOL_VERSION_FTE
@@ -889,29 +1005,23 @@ void FixMaxClientsCvars(void)
 
 //==============================================
 
+static qbool SV_ChallengeValid (int challenge)
+{
+	int window = (int)(realtime / CHALLENGE_WINDOW);
+
+	// the previous window too, the challenge may have been asked for just before it ended
+	return challenge == SV_Challenge (net_from, window) || challenge == SV_Challenge (net_from, window - 1);
+}
+
 // see if the challenge is valid
 qbool CheckChallange( int challenge )
 {
-	int i;
-
 	if (net_from.type == NA_LOOPBACK)
 		return true; // local client do not need challenge
 
-	for (i = 0; i < MAX_CHALLENGES; i++)
-	{
-		if (NET_CompareBaseAdr (net_from, svs.challenges[i].adr))
-		{
-			if (challenge == svs.challenges[i].challenge)
-				break;		// good
-
-			Netchan_OutOfBandPrint (NS_SERVER, net_from, "%c\nBad challenge.\n", A2C_PRINT);
-			return false;
-		}
-	}
-
-	if (i == MAX_CHALLENGES)
+	if (!SV_ChallengeValid (challenge))
 	{
-		Netchan_OutOfBandPrint (NS_SERVER, net_from, "%c\nNo challenge for address.\n", A2C_PRINT);
+		Netchan_OutOfBandPrint (NS_SERVER, net_from, "%c\nBad challenge.\n", A2C_PRINT);
 		return false;
 	}
 
@@ -1825,6 +1935,89 @@ connectionless packets.
 =================
 */
 
+/*
+Per address token buckets for connectionless packets, in a fixed size table
+indexed by a hash of the address. An address gets sv_oob_burst packets at once
+and sv_oob_rate more every second, so a spoofed flood can't turn the server into
+an amplifier against one victim. A slot is handed to another address only once
+it has filled up again. Until then packets from colliding addresses are charged
+to one shared budget instead, so a flood from random sources can neither keep
+resetting somebody else's bucket nor drain it.
+
+A connect that carries a valid challenge has proven its address and is never
+limited. A getchallenge that lands on somebody else's slot is always answered:
+the reply is small, and a reflection victim gets enough packets to own its slot.
+Together these let a real client connect through a spoofed flood.
+*/
+#define OOB_BUCKET_BITS		12
+
+typedef struct oob_bucket_s
+{
+	unsigned int	ip;
+	float			tokens;
+	double			time;
+} oob_bucket_t;
+
+static oob_bucket_t oob_buckets[1 << OOB_BUCKET_BITS];
+static oob_bucket_t oob_shared;
+static int oob_limited;
+
+// Takes a token from the bucket, or returns true if it is empty.
+static qbool SV_OOBTakeToken (oob_bucket_t *bucket, float rate, float burst)
+{
+	double tokens;
+
+	tokens = bucket->tokens + (realtime - bucket->time) * rate;
+	if (tokens > burst || realtime < bucket->time)
+		tokens = burst;
+	bucket->time = realtime;
+
+	if (tokens < 1)
+	{
+		bucket->tokens = tokens;
+		oob_limited++;
+		return true;
+	}
+
+	bucket->tokens = tokens - 1;
+	return false;
+}
+
+// Expects the packet to be tokenized already.
+static qbool SV_OOBRateLimited (void)
+{
+	float burst = max (1, sv_oob_burst.value);
+	oob_bucket_t *bucket;
+	unsigned int ip;
+	double tokens;
+
+	if (sv_oob_rate.value <= 0 || net_from.type != NA_IP)
+		return false;
+
+	if (!strcmp (Cmd_Argv(0), "connect") && SV_ChallengeValid (Q_atoi (Cmd_Argv(3))))
+		return false;
+
+	memcpy (&ip, net_from.ip, 4);
+	bucket = &oob_buckets[(ip * 2654435761u) >> (32 - OOB_BUCKET_BITS)];
+
+	if (bucket->ip != ip)
+	{
+		tokens = bucket->tokens + (realtime - bucket->time) * sv_oob_rate.value;
+		if (tokens >= burst || realtime < bucket->time)
+		{
+			bucket->ip = ip;
+		}
+		else
+		{
+			if (!strcmp (Cmd_Argv(0), "getchallenge"))
+				return false;
+			return SV_OOBTakeToken (&oob_shared, max (0, sv_oob_sharedrate.value), max (1, sv_oob_sharedrate.value));
+		}
+	}
+
+	return SV_OOBTakeToken (bucket, sv_oob_rate.value, burst);
+}
+
 static void SV_ConnectionlessPacket (void)
 {
 	char	*s;
@@ -1837,6 +2030,9 @@ static void SV_ConnectionlessPacket (void)
 
 	Cmd_TokenizeString (s);
 
+	if (SV_OOBRateLimited ())
+		return;
+
 	c = Cmd_Argv(0);
 
 	if (!strcmp(c, "ping") || ( c[0] == A2A_PING && (c[1] == 0 || c[1] == '\n')) )
@@ -1929,6 +2125,10 @@ penfilter_t	penfilters[MAX_PENFILTERS];
 int		numpenfilters;
 //<-
 
+static iptrie_t			ipban_trie;			// ipft_ban entries of ipfilters[], checked for every packet
+static iptimer_heap_t	ipfilter_timers;	// expiry of timed ipfilters[], wall clock
+static iptimer_heap_t	penfilter_timers;	// expiry of penfilters[], realtime
+
 cvar_t	filterban = {"filterban", "1"};
 
 /*
@@ -1978,6 +2178,37 @@ qbool StringToFilter (char *s, ipfilter_t *f)
 	return true;
 }
 
+/*
+=================
+SV_IndexIPFilter
+
+Keeps the ban trie and the expiry heap in step with ipfilters[],
+call it with add false before an entry is overwritten or removed.
+=================
+*/
+static void SV_IndexIPFilter (const ipfilter_t *f, qbool add)
+{
+	iptimer_t timer;
+
+	if (f->type == ipft_ban)
+	{
+		if (add)
+			IPTrie_Insert (&ipban_trie, (const byte *) &f->compare, (const byte *) &f->mask, 4);
+		else
+			IPTrie_Remove (&ipban_trie, (const byte *) &f->compare, (const byte *) &f->mask, 4);
+	}
+
+	// stale timers are skipped when they come due, see SV_CleanBansIPList
+	if (add && f->time)
+	{
+		timer.time = f->time;
+		timer.mask = f->mask;
+		timer.compare = f->compare;
+		timer.type = f->type;
+		IPTimer_Push (&ipfilter_timers, &timer);
+	}
+}
+
 /*
 =================
 SV_AddIPVIP_f
@@ -2154,8 +2385,13 @@ static void SV_AddIP_f (void)
 		}
 		numipfilters++;
 	}
+	else
+	{
+		SV_IndexIPFilter (&ipfilters[i], false);
+	}
 
 	ipfilters[i] = f;
+	SV_IndexIPFilter (&ipfilters[i], true);
 }
 
 /*
@@ -2178,6 +2414,7 @@ static void SV_RemoveIP_f (void)
 		if (ipfilters[i].mask == f.mask
 		        && ipfilters[i].compare == f.compare)
 		{
+			SV_IndexIPFilter (&ipfilters[i], false);
 			for (j=i+1 ; j<numipfilters ; j++)
 				ipfilters[j-1] = ipfilters[j];
 			numipfilters--;
@@ -2291,16 +2528,302 @@ SV_FilterPacket
 */
 qbool SV_FilterPacket (void)
 {
-	int		i;
-	unsigned	in;
+	if (IPTrie_Match (&ipban_trie, net_from.ip, 4))
+		return (int)filterban.value;
 
-	in = *(unsigned *)net_from.ip;
+	return !(int)filterban.value;
+}
 
-	for (i=0 ; i<numipfilters ; i++)
-		if ( ipfilters[i].type == ipft_ban && (in & ipfilters[i].mask) == ipfilters[i].compare )
-			return (int)filterban.value;
+/*
+=================
+SV_FilterBench_f
 
-	return !(int)filterban.value;
+Floods SV_ConnectionlessPacket with pings from random addresses against a list of
+random bans, comparing the trie with the linear scan it replaced. Sources are
+in 127/8 so the replies never leave the machine. The real ban list is untouched.
+=================
+*/
+static void SV_FilterBench_f (void)
+{
+	int numfilters = (Cmd_Argc() > 1) ? Q_atoi (Cmd_Argv(1)) : 4096;
+	int numpackets = (Cmd_Argc() > 2) ? Q_atoi (Cmd_Argv(2)) : 100000;
+	iptrie_t saved_trie = ipban_trie, bench_trie = { 0 };
+	netadr_t saved_from = net_from;
+	int saved_readcount = msg_readcount;
+	int saved_size = net_message.cursize;
+	byte *saved_data;
+	ipfilter_t *filters;
+	unsigned *addrs;
+	int i, j, linear_hits = 0, trie_hits = 0, banned = 0;
+	double start, linear_time, trie_time, flood_time;
+
+	if (numfilters < 1 || numpackets < 1)
+	{
+		Con_Printf ("usage: %s [filters] [packets]\n", Cmd_Argv(0));
+		return;
+	}
+
+	filters = (ipfilter_t *) Q_malloc (numfilters * sizeof (ipfilter_t));
+	addrs = (unsigned *) Q_malloc (numpackets * sizeof (unsigned));
+
+	for (i = 0; i < numfilters; i++)
+	{
+		byte b[4] = { 127, 0, 0, 0 }, m[4] = { 255, 0, 0, 0 };
+		int octets = 2 + rand () % 3;
+
+		// like addip: 2 to 4 octets given, the rest match anything
+		for (j = 1; j < octets; j++)
+		{
+			b[j] = 1 + rand () % 255;
+			m[j] = 255;
+		}
+		filters[i].compare = *(unsigned *)b;
+		filters[i].mask = *(unsigned *)m;
+		IPTrie_Insert (&bench_trie, b, m, 4);
+	}
+
+	for (i = 0; i < numpackets; i++)
+	{
+		byte b[4] = { 127, rand () & 255, rand () & 255, rand () & 255 };
+
+		addrs[i] = *(unsigned *)b;
+	}
+
+	start = Sys_DoubleTime ();
+	for (i = 0; i < numpackets; i++)
+	{
+		for (j = 0; j < numfilters; j++)
+			if ((addrs[i] & filters[j].mask) == filters[j].compare)
+				break;
+		linear_hits += (j < numfilters);
+	}
+	linear_time = Sys_DoubleTime () - start;
+
+	start = Sys_DoubleTime ();
+	for (i = 0; i < numpackets; i++)
+		trie_hits += IPTrie_Match (&bench_trie, (byte *) &addrs[i], 4);
+	trie_time = Sys_DoubleTime () - start;
+
+	// we may be running from an rcon packet, keep it intact
+	saved_data = (byte *) Q_malloc (saved_size + 1);
+	memcpy (saved_data, net_message.data, saved_size);
+
+	ipban_trie = bench_trie;
+	start = Sys_DoubleTime ();
+	for (i = 0; i < numpackets; i++)
+	{
+		memset (&net_from, 0, sizeof (net_from));
+		net_from.type = NA_IP;
+		net_from.port = BigShort (9);	// discard
+		*(unsigned *)net_from.ip = addrs[i];
+
+		SZ_Clear (&net_message);
+		MSG_WriteLong (&net_message, -1);
+		MSG_WriteString (&net_message, "ping");
+
+		// same path as SV_ReadPackets
+		if (SV_FilterPacket ())
+		{
+			SV_SendBan ();
+			banned++;
+			continue;
+		}
+		SV_ConnectionlessPacket ();
+	}
+	flood_time = Sys_DoubleTime () - start;
+	bench_trie = ipban_trie;
+	ipban_trie = saved_trie;
+
+	net_from = saved_from;
+	SZ_Clear (&net_message);
+	SZ_Write (&net_message, saved_data, saved_size);
+	msg_readcount = saved_readcount;
+	Q_free (saved_data);
+
+	Con_Printf ("%d filters, %d packets, %d matched\n", numfilters, numpackets, trie_hits);
+	Con_Printf ("linear scan: %8.1f ns/packet\n", linear_time * 1e9 / numpackets);
+	Con_Printf ("trie:        %8.1f ns/packet\n", trie_time * 1e9 / numpackets);
+	Con_Printf ("flood:       %8.1f ns/packet, %.0f packets/s, %d banned\n",
+		flood_time * 1e9 / numpackets, numpackets / max (flood_time, 0.000001), banned);
+	if (linear_hits != trie_hits)
+		Con_Printf ("MISMATCH: linear scan matched %d\n", linear_hits);
+
+	IPTrie_Clear (&bench_trie);
+	Q_free (addrs);
+	Q_free (filters);
+}
+
+/*
+=================
+SV_FloodTest_f
+
+Spends the first half of the test measuring server frames as they are, then
+feeds spoofed connectionless packets into every frame at the given rate and
+measures again. One packet in eight comes from the same address to show the
+per address limit, the rest from random addresses in 127/8, so the replies
+never leave the machine. Twice a second during the flood a client at
+127.0.0.3 asks for a challenge and tries to connect with it, to show that real
+clients still get in. The connect only goes through the rate limit, it isn't
+run.
+=================
+*/
+static struct
+{
+	double		rate;
+	double		start, end, last;
+	double		owed;
+	int			packets, limited, rebuilds;
+	int			frames[2];
+	double		time[2], max[2];
+	double		nextclient;
+	int			clienttries, challenges, connects;
+} floodtest;
+
+static void SV_FloodTestReport (void)
+{
+	int i;
+
+	Con_Printf ("flood test: %d spoofed packets, %.0f packets/s\n",
+		floodtest.packets, floodtest.packets / max (floodtest.end - (floodtest.start + floodtest.end) / 2, 0.001));
+	for (i = 0; i < 2; i++)
+	{
+		Con_Printf ("%s %6.3f ms/frame avg, %6.3f ms max, %d frames\n", i ? "flooded:" : "idle:   ",
+			floodtest.time[i] * 1000 / max (floodtest.frames[i], 1), floodtest.max[i] * 1000, floodtest.frames[i]);
+	}
+	Con_Printf ("%d packets rate limited, %d status replies built\n",
+		oob_limited - floodtest.limited, status_rebuilds - floodtest.rebuilds);
+	Con_Printf ("client: %d of %d challenges answered, %d connects let through\n",
+		floodtest.challenges, floodtest.clienttries, floodtest.connects);
+
+	floodtest.rate = 0;
+}
+
+static void SV_FloodTest_f (void)
+{
+	double rate = (Cmd_Argc() > 1) ? Q_atof (Cmd_Argv(1)) : 100000;
+	double seconds = (Cmd_Argc() > 2) ? Q_atof (Cmd_Argv(2)) : 10;
+
+	if (floodtest.rate)
+	{
+		Con_Printf ("flood test stopped\n");
+		floodtest.end = realtime;
+		SV_FloodTestReport ();
+		return;
+	}
+
+	if (rate <= 0 || seconds <= 0)
+	{
+		Con_Printf ("usage: %s [packets per second] [seconds]\n", Cmd_Argv(0));
+		return;
+	}
+
+	if (sv.state != ss_active)
+	{
+		Con_Printf ("%s: no map running\n", Cmd_Argv(0));
+		return;
+	}
+
+	memset (&floodtest, 0, sizeof (floodtest));
+	floodtest.rate = rate;
+	floodtest.start = floodtest.last = realtime;
+	floodtest.end = realtime + seconds;
+	floodtest.limited = oob_limited;
+	floodtest.rebuilds = status_rebuilds;
+	Con_Printf ("flood test: %g packets/s for %g seconds, the first half without packets\n", rate, seconds);
+}
+
+// Called from SV_ReadPackets once the real packets are handled.
+static void SV_FloodTestPackets (void)
+{
+	static char *requests[] = { "status 23", "status 31", "getchallenge", "ping" };
+	netadr_t victim = { NA_IP, { 127, 0, 0, 2 } };
+	int i, count;
+
+	if (!floodtest.rate || realtime < (floodtest.start + floodtest.end) / 2)
+	{
+		floodtest.last = realtime;
+		return;
+	}
+
+	floodtest.owed += (realtime - floodtest.last) * floodtest.rate;
+	floodtest.last = realtime;
+	count = (int) floodtest.owed;
+	floodtest.owed -= count;
+
+	for (i = 0; i < count; i++)
+	{
+		if (i % 8)
+		{
+			memset (&net_from, 0, sizeof (net_from));
+			net_from.type = NA_IP;
+			net_from.ip[0] = 127;
+			net_from.ip[1] = rand () & 255;
+			net_from.ip[2] = rand () & 255;
+			net_from.ip[3] = rand () & 255;
+		}
+		else
+		{
+			net_from = victim;
+		}
+		net_from.port = BigShort (9);	// discard
+
+		SZ_Clear (&net_message);
+		MSG_WriteLong (&net_message, -1);
+		MSG_WriteString (&net_message, requests[i % (sizeof (requests) / sizeof (requests[0]))]);
+
+		if (SV_FilterPacket ())
+		{
+			SV_SendBan ();
+			continue;
+		}
+		SV_ConnectionlessPacket ();
+	}
+
+	floodtest.packets += count;
+
+	if (realtime >= floodtest.nextclient)
+	{
+		netadr_t client = { NA_IP, { 127, 0, 0, 3 } };
+		int limited;
+
+		floodtest.nextclient = realtime + 0.5;
+		floodtest.clienttries++;
+
+		net_from = client;
+		net_from.port = BigShort (9);
+
+		SZ_Clear (&net_message);
+		MSG_WriteLong (&net_message, -1);
+		MSG_WriteString (&net_message, "getchallenge");
+		limited = oob_limited;
+		SV_ConnectionlessPacket ();
+		if (oob_limited != limited)
+			return;
+		floodtest.challenges++;
+
+		// the client sends back what the reply held
+		Cmd_TokenizeString (va ("connect %i %i %i \"\\name\\floodtest\"", PROTOCOL_VERSION, 1,
+			SV_Challenge (net_from, (int)(realtime / CHALLENGE_WINDOW))));
+		if (!SV_OOBRateLimited ())
+			floodtest.connects++;
+	}
+}
+
+// Called from SV_Frame with the time the frame took.
+static void SV_FloodTestFrame (double frametime)
+{
+	int flooded;
+
+	if (!floodtest.rate)
+		return;
+
+	flooded = (realtime >= (floodtest.start + floodtest.end) / 2);
+	floodtest.frames[flooded]++;
+	floodtest.time[flooded] += frametime;
+	floodtest.max[flooded] = max (floodtest.max[flooded], frametime);
+
+	if (realtime >= floodtest.end)
+		SV_FloodTestReport ();
 }
 
 // { server internal BAN support
@@ -2385,6 +2908,8 @@ qbool SV_CanAddBan (ipfilter_t *f)
 
 void SV_RemoveBansIPFilter (int i)
 {
+	SV_IndexIPFilter (&ipfilters[i], false);
+
 	for (; i + 1 < numipfilters; i++)
 		ipfilters[i] = ipfilters[i + 1];
 
@@ -2394,19 +2919,24 @@ void SV_RemoveBansIPFilter (int i)
 void SV_CleanBansIPList (void)
 {
 	time_t	long_time = time(NULL);
+	iptimer_t timer;
 	int     i;
 
 	if (sv.state != ss_active)
 		return;
 
-	for (i = 0; i < numipfilters;)
+	while (IPTimer_Pop (&ipfilter_timers, long_time, &timer))
 	{
-		if (ipfilters[i].time && ipfilters[i].time <= long_time)
+		// the filter may have been removed or re-added with another time since
+		for (i = 0; i < numipfilters; i++)
 		{
-			SV_RemoveBansIPFilter (i);
+			if (ipfilters[i].time == timer.time && ipfilters[i].mask == timer.mask
+				&& ipfilters[i].compare == timer.compare && ipfilters[i].type == timer.type)
+			{
+				SV_RemoveBansIPFilter (i);
+				break;
+			}
 		}
-		else
-			i++;
 	}
 }
 
@@ -2790,19 +3320,24 @@ void SV_RemoveIPFilter (int i)
 
 static void SV_CleanIPList (void)
 {
+	iptimer_t timer;
 	int     i;
 
 	if (sv.state != ss_active)
 		return;
 
-	for (i = 0; i < numpenfilters;)
+	while (IPTimer_Pop (&penfilter_timers, realtime, &timer))
 	{
-		if (penfilters[i].time && (penfilters[i].time <= realtime))
+		// restored filters are removed right away, their timers are just dropped
+		for (i = 0; i < numpenfilters; i++)
 		{
-			SV_RemoveIPFilter (i);
+			if (penfilters[i].time == timer.time && penfilters[i].type == timer.type
+				&& *(unsigned *)penfilters[i].ip == timer.compare)
+			{
+				SV_RemoveIPFilter (i);
+				break;
+			}
 		}
-		else
-			i++;
 	}
 }
 
@@ -2827,6 +3362,7 @@ static void SV_IPCopy (byte *dest, byte *src)
 
 void SV_SavePenaltyFilter (client_t *cl, filtertype_t type, double pentime)
 {
+	iptimer_t timer;
 	int i;
 
 	if (pentime < realtime)   // no point
@@ -2847,6 +3383,12 @@ void SV_SavePenaltyFilter (client_t *cl, filtertype_t type, double pentime)
 	penfilters[numpenfilters].time = pentime;
 	penfilters[numpenfilters].type = type;
 	numpenfilters++;
+
+	timer.time = pentime;
+	timer.mask = 0xffffffff;
+	timer.compare = *(unsigned *)cl->realip.ip;
+	timer.type = type;
+	IPTimer_Push (&penfilter_timers, &timer);
 }
 
 double SV_RestorePenaltyFilter (client_t *cl, filtertype_t type)
@@ -2971,6 +3513,8 @@ static void SV_ReadPackets (void)
 			SV_ExecuteClientMessage (cl);
 		}
 	}
+
+	SV_FloodTestPackets ();
 }
 
 
@@ -3203,6 +3747,9 @@ void SV_Frame (double time1)
 	SV_MVDStream_Poll();
 
 #ifdef SERVERONLY
+	// the client does this from Host_Frame
+	Frame_Reset ();
+
 	// check for commands typed to the host
 	SV_GetConsoleCommands ();
 
@@ -3246,6 +3793,8 @@ void SV_Frame (double time1)
 	// collect timing statistics
 	end = Sys_DoubleTime ();
 	svs.stats.active += end-start;
+	SV_FloodTestFrame (end - start);
+	SV_DiskIO_Frame (end - start);
 	if (++svs.stats.count == STATFRAMES)
 	{
 		svs.stats.latched_active = svs.stats.active;
@@ -3309,6 +3858,10 @@ void SV_InitLocal (void)
 	Cvar_Register (&sv_crypt_rcon);
 	Cvar_Register (&sv_timestamplen);
 	Cvar_Register (&sv_rconlim);
+	Cvar_Register (&sv_oob_rate);
+	Cvar_Register (&sv_oob_burst);
+	Cvar_Register (&sv_oob_sharedrate);
+	Cvar_Register (&sv_status_cachetime);
 
 	Cvar_Register (&telnet_log_level);
 
@@ -3438,6 +3991,8 @@ void SV_InitLocal (void)
 	Cmd_AddCommand ("removeip", SV_RemoveIP_f);
 	Cmd_AddCommand ("listip", SV_ListIP_f);
 	Cmd_AddCommand ("writeip", SV_WriteIP_f);
+	Cmd_AddCommand ("sv_filterbench", SV_FilterBench_f);
+	Cmd_AddCommand ("sv_floodtest", SV_FloodTest_f);
 	Cmd_AddCommand ("vip_addip", SV_AddIPVIP_f);
 	Cmd_AddCommand ("vip_removeip", SV_RemoveIPVIP_f);
 	Cmd_AddCommand ("vip_listip", SV_ListIPVIP_f);
@@ -3447,6 +4002,9 @@ void SV_InitLocal (void)
 	for (i=0 ; i<MAX_MODELS ; i++)
 		snprintf (localmodels[i], MODEL_NAME_LEN, "*%i", i);
 
+	SV_InitChallenges ();
+	SV_DiskIO_Init ();
+
 #ifdef FTE_PEXT_ACCURATETIMINGS
 	svs.fteprotocolextensions |= FTE_PEXT_ACCURATETIMINGS;
 #endif
@@ -3961,7 +4519,12 @@ void SV_Write_Log(int sv_log, int level, char *msg)
 		               logs[sv_log].file_name, NET_UDPSVPort());
 	}
 
-	if (fprintf(logs[sv_log].sv_logfile, "%s", log_msg) < 0)
+	// the disk writer thread reports errors on a later write,
+	// the lines of a frame go to disk together once it is over
+	SV_DiskIO_Write(logs[sv_log].sv_logfile, log_msg, strlen(log_msg));
+	SV_DiskIO_FlushLater(logs[sv_log].sv_logfile);
+
+	if (SV_DiskIO_Error(logs[sv_log].sv_logfile))
 	{
 		//bliP: Sys_Error to Con_DPrintf ->
 		//VVD: Con_DPrintf to Sys_Printf ->
@@ -3971,9 +4534,8 @@ void SV_Write_Log(int sv_log, int level, char *msg)
 	}
 	else
 	{
-		fflush(logs[sv_log].sv_logfile);
 		if ((int)sv_maxlogsize.value &&
-		        (FS_FileLength(logs[sv_log].sv_logfile) > (int)sv_maxlogsize.value))
+		        (SV_DiskIO_Size(logs[sv_log].sv_logfile) > (int)sv_maxlogsize.value))
 		{
 			SV_Logfile(sv_log, true);
 		}
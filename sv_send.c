@@ -39,6 +39,7 @@ char	outputbuf[OUTPUTBUF_SIZE];
 
 redirect_t	sv_redirected;
 static int	sv_redirectbufcount;
+static sizebuf_t	*sv_redirectcapture;
 
 qbool SV_SkipCommsBotMessage(client_t* client);
 extern cvar_t sv_phs, sv_reliable_sound;
@@ -62,6 +63,20 @@ void SV_FlushRedirect (void)
 		memcpy (send1 + 5, outputbuf, strlen(outputbuf) + 1);
 
 		NET_SendPacket (NS_SERVER, strlen(send1) + 1, send1, net_from);
+
+		if (sv_redirectcapture)
+		{
+			int len = strlen(send1) + 1;
+
+			// keep the packets as sent, each prefixed with its length
+			if (sv_redirectcapture->cursize + len + 2 > sv_redirectcapture->maxsize)
+				sv_redirectcapture->overflowed = true;
+			else
+			{
+				MSG_WriteShort (sv_redirectcapture, len);
+				SZ_Write (sv_redirectcapture, send1, len);
+			}
+		}
 	}
 	else if (sv_redirected == RD_CLIENT && sv_redirectbufcount < MAX_REDIRECTMESSAGES)
 	{
@@ -116,6 +131,19 @@ void SV_EndRedirect (void)
 	sv_redirected = RD_NONE;
 }
 
+/*
+==================
+SV_CaptureRedirect
+
+  Also store RD_PACKET output in buf so it can be
+  sent again without building it, NULL stops
+==================
+*/
+void SV_CaptureRedirect (sizebuf_t *buf)
+{
+	sv_redirectcapture = buf;
+}
+
 qbool SV_AddToRedirect(char *msg)
 {
 	if (!sv_redirected)
@@ -329,7 +357,6 @@ void SV_DoBroadcastPrintf (int level, int flags, char *string)
 			if ((fraglog = parse_mod_string(string2)))
 			{
 				SV_Write_Log(MOD_FRAG_LOG, 1, fraglog);
-				Q_free(fraglog);
 			}
 			string2[0] = 0;
 		}
@@ -1005,7 +1005,7 @@ void SV_CompleteDownoload(void)
 	if (!sv_client->download)
 		return;
 
-	VFS_CLOSE(sv_client->download);
+	SV_DownloadClose(sv_client->download);
 	sv_client->download = NULL;
 	sv_client->file_percent = 0; //bliP: file percent
 	// qqshka: set normal rate
@@ -1042,7 +1042,7 @@ Cmd_NextDownload_f
 void SV_NextChunkedDownload(int chunknum, int percent, int chunked_download_number)
 {
 #define CHUNKSIZE 1024
-	char buffer[CHUNKSIZE];
+	const byte *chunk;
 	int i;
 
 	sv_client->file_percent = bound(0, percent, 100); //bliP: file percent
@@ -1061,16 +1061,18 @@ void SV_NextChunkedDownload(int chunknum, int percent, int chunked_download_numb
 			return;
 	}
 
-	if (!sv_client->download_chunks_perframe) // ignore "rate" if not first packet per frame
+	if (!sv_client->download_chunks_perframe)
+	{
 		if (sv_client->datagram.cursize + CHUNKSIZE+5+50 > sv_client->datagram.maxsize)
 			return;	//choked!
+	}
+	else if (!Netchan_CanPacket(&sv_client->netchan))
+		return; // further chunks go out of band, keep them within the download rate
 
-	if (VFS_SEEK(sv_client->download, chunknum*CHUNKSIZE, SEEK_SET))
-		return; // FIXME: ERROR of some kind
-
-	i = VFS_READ(sv_client->download, buffer, CHUNKSIZE, NULL);
+	i = CHUNKSIZE;
+	chunk = SV_DownloadData(sv_client->download, chunknum*CHUNKSIZE, &i);
 
-	if (i > 0)
+	if (chunk)
 	{
 		byte data[1+ (sizeof("\\chunk")-1) + 4 + 1 + 4 + CHUNKSIZE]; // byte + (sizeof("\\chunk")-1) + long + byte + long + CHUNKSIZE
 		sizebuf_t *msg, msg_oob;
@@ -1088,15 +1090,21 @@ void SV_NextChunkedDownload(int chunknum, int percent, int chunked_download_numb
 		else
 			msg = &sv_client->datagram;
 
-		if (i != CHUNKSIZE)
-			memset(buffer+i, 0, CHUNKSIZE-i);
-
 		MSG_WriteByte(msg, svc_download);
 		MSG_WriteLong(msg, chunknum);
-		SZ_Write(msg, buffer, CHUNKSIZE);
+		SZ_Write(msg, chunk, i);
+		if (i != CHUNKSIZE)
+			memset(SZ_GetSpace(msg, CHUNKSIZE-i), 0, CHUNKSIZE-i);
 
 		if (sv_client->download_chunks_perframe)
+		{
 			Netchan_OutOfBand (NS_SERVER, sv_client->netchan.remote_address, msg->cursize, msg->data);
+
+			// the netchan doesn't see these, charge them to the client's rate ourselves
+			if (sv_client->netchan.cleartime < curtime)
+				sv_client->netchan.cleartime = curtime;
+			sv_client->netchan.cleartime += msg->cursize * sv_client->netchan.rate;
+		}
 	}
 	else {
 		; // FIXME: EOF/READ ERROR
@@ -1109,7 +1117,7 @@ void SV_NextChunkedDownload(int chunknum, int percent, int chunked_download_numb
 
 static void Cmd_NextDownload_f (void)
 {
-	byte    buffer[FILE_TRANSFER_BUF_SIZE];
+	const byte *data;
 	int     r, tmp;
 	int     percent;
 	int     size;
@@ -1145,7 +1153,8 @@ static void Cmd_NextDownload_f (void)
 		r = tmp;
 
 	Con_DPrintf("Downloading: %d", r);
-	r = VFS_READ(sv_client->download, buffer, r, NULL);
+	if (!(data = SV_DownloadData(sv_client->download, sv_client->downloadcount, &r)))
+		r = 0;
 	Con_DPrintf(" => %d, total: %d => %d", r, sv_client->downloadsize, sv_client->downloadcount);
 	ClientReliableWrite_Begin (sv_client, svc_download, 6 + r);
 	ClientReliableWrite_Short (sv_client, r);
@@ -1159,7 +1168,7 @@ static void Cmd_NextDownload_f (void)
 		percent = 100;
 	Con_DPrintf("; %d\n", percent);
 	ClientReliableWrite_Byte (sv_client, percent);
-	ClientReliableWrite_SZ (sv_client, buffer, r);
+	ClientReliableWrite_SZ (sv_client, data, r);
 	sv_client->file_percent = percent; //bliP: file percent
 
 	if (sv_client->downloadcount == sv_client->downloadsize)
@@ -1315,8 +1324,9 @@ Cmd_Download_f
 //void SV_ReplaceChar(char *s, char from, char to);
 static void Cmd_Download_f(void)
 {
-	char	*name, n[MAX_OSPATH], *val;
+	char	*name, n[MAX_OSPATH], *val, *opened;
 	char alternative_path[MAX_OSPATH];
+	vfsfile_t *file;
 	extern	cvar_t	allow_download;
 	extern	cvar_t	allow_download_skins;
 	extern	cvar_t	allow_download_models;
@@ -1380,7 +1390,7 @@ static void Cmd_Download_f(void)
 
 	if (sv_client->download)
 	{
-		VFS_CLOSE(sv_client->download);
+		SV_DownloadClose(sv_client->download);
 		sv_client->download = NULL;
 		// set normal rate
 		val = Info_Get (&sv_client->_userinfo_ctx_, "rate");
@@ -1441,37 +1451,45 @@ static void Cmd_Download_f(void)
 
 	sv_client->downloadcount = 0;
 
-#ifdef SERVERONLY
-#define CLIENT_DOWNLOAD_RELATIVE_BASE FS_GAME // FIXME: Should we use FS_BASE ???
-#else
-#define CLIENT_DOWNLOAD_RELATIVE_BASE FS_BASE
-#endif
-
-	sv_client->download = FS_OpenVFS(name, "rb", CLIENT_DOWNLOAD_RELATIVE_BASE);
-	if (!sv_client->download && alternative_path[0]) {
-		sv_client->download = FS_OpenVFS(alternative_path, "rb", CLIENT_DOWNLOAD_RELATIVE_BASE);
-	}
-	if (sv_client->download) {
-		sv_client->downloadsize = VFS_GETLEN(sv_client->download);
+	opened = name;
+	file = FS_OpenVFS(name, "rb", CLIENT_DOWNLOAD_RELATIVE_BASE);
+	if (!file && alternative_path[0]) {
+		file = FS_OpenVFS(alternative_path, "rb", CLIENT_DOWNLOAD_RELATIVE_BASE);
+		opened = alternative_path;
 	}
 
 	// if not techlogin, perform extra check to block .pak maps
 	if (!sv_client->special) {
 		// special check for maps that came from a pak file
-		if (sv_client->download && !strncmp(name, "maps/", 5) && VFS_COPYPROTECTED(sv_client->download) && !(int)allow_download_pakmaps.value)
+		if (file && !strncmp(name, "maps/", 5) && VFS_COPYPROTECTED(file) && !(int)allow_download_pakmaps.value)
 		{
-			VFS_CLOSE(sv_client->download);
-			sv_client->download = NULL;
+			VFS_CLOSE(file);
 			goto deny_download;
 		}
 	}
 
-	if (!sv_client->download)
+	// demos recorded with sv_demogzip are only there compressed, have the client ask for that instead
+	if (!file && !strncmp(Cmd_Argv(1), "demos/", 6) && (i = strlen(name)) > 4 && !strcasecmp(name + i - 4, ".mvd")
+		&& (file = FS_OpenVFS(va("%s.gz", name), "rb", CLIENT_DOWNLOAD_RELATIVE_BASE)))
+	{
+		VFS_CLOSE(file);
+		snprintf(n, sizeof(n), "download %s.gz\n", Cmd_Argv(1));
+
+		ClientReliableWrite_Begin (sv_client, svc_stufftext, strlen(n) + 2);
+		ClientReliableWrite_String (sv_client, n);
+		return;
+	}
+
+	if (!file)
 	{
 		Sys_Printf ("Couldn't download %s to %s\n", name, sv_client->name);
 		goto deny_download;
 	}
 
+	// clients asking for the same file share one copy of it
+	sv_client->download = SV_DownloadOpen(file, opened);
+	sv_client->downloadsize = SV_DownloadSize(sv_client->download);
+
 	// set donwload rate
 	val = Info_Get (&sv_client->_userinfo_ctx_, "drate");
 	sv_client->netchan.rate = 1. / SV_BoundRate(true, Q_atoi(*val ? val : "99999"));
@@ -1645,7 +1663,7 @@ static void Cmd_StopDownload_f(void)
 		return;
 
 	sv_client->downloadcount = sv_client->downloadsize;
-	VFS_CLOSE(sv_client->download);
+	SV_DownloadClose(sv_client->download);
 	sv_client->download = NULL;
 	sv_client->file_percent = 0; //bliP: file percent
 	// qqshka: set normal rate
@@ -4026,6 +4044,7 @@ void SV_UserInit (void)
 	Cvar_Register (&sv_kickuserinfospamtime);
 	Cvar_Register (&sv_kickuserinfospamcount);
 	Cvar_Register (&sv_maxuploadsize);
+	SV_DownloadInit ();
 #ifdef FTE_PEXT_CHUNKEDDOWNLOADS
 	Cvar_Register (&sv_downloadchunksperframe);
 #endif
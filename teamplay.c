@@ -629,7 +629,7 @@ static char *Skin_To_TFSkin (char *myskin) // These four TF classes don't have t
 
 char *Macro_TF_Skin (void)
 {
-	return Skin_To_TFSkin(Info_ValueForKey(cl.players[cl.playernum].userinfo, "skin"));
+	return Skin_To_TFSkin(Info_Get(&cl.players[cl.playernum]._userinfo_ctx_, "skin"));
 }
 
 char *Macro_LastDrop (void)
@@ -941,7 +941,7 @@ void TP_PrintHiddenMessage(char *buf, int nodisplay)
 	if (cls.demoplayback)
 		return;
 
-	name = Info_ValueForKey (cl.players[cl.playernum].userinfo, "name");
+	name = Info_Get(&cl.players[cl.playernum]._userinfo_ctx_, "name");
 	if (strlen(name) >= 32)
 		name[31] = 0;
 
@@ -1306,7 +1306,7 @@ static void TP_SetDefaultMacroCharFormat(qbool extended, char character, int* fi
 //Parses %a-like expressions
 char *TP_ParseMacroString (char *s)
 {
-	static char	buf[MAX_MACRO_STRING];
+	char	*buf;
 	int i = 0;
 	int pN, pn;
 	char *macro_string;
@@ -1320,6 +1320,7 @@ char *TP_ParseMacroString (char *s)
 	if (!cl_parseSay.value)
 		return s;
 
+	buf = (char *) Frame_Alloc (MAX_MACRO_STRING);
 	suppress = false;
 	pn = pN = 0;
 
@@ -1540,21 +1541,21 @@ char *TP_ParseMacroString (char *s)
 		buf[i] = 0;
 	}
 
+	Frame_Trim(buf, strlen(buf) + 1);
 
 	return buf;
 }
 
-//Doesn't check for overflows, so strlen(s) should be < MAX_MACRO_STRING
+//Returns frame memory, the result is never longer than s
 char *TP_ParseFunChars (const char *s, qbool chat)
 {
-	static char	 buf[MAX_MACRO_STRING];
-	char		*out = buf;
+	char		*buf, *out;
 	int			 c;
 
-	if (!cl_parseFunChars.value) {
-		strlcpy(buf, s, sizeof(buf));
-		return buf;
-	}
+	if (!cl_parseFunChars.value)
+		return Frame_Strdup(s);
+
+	out = buf = (char *) Frame_Alloc(strlen(s) + 1);
 
 	while (*s) {
 		if (*s == '$' && s[1] == 'x') {
@@ -1825,18 +1826,146 @@ void TP_EnemyColor_f(void)
 static locdata_t *locdata = NULL;
 static int loc_count = 0;
 
+// k-d tree over the loc points for TP_LocationName, kept as a balanced tree in a flat
+// array: the node of a range is its median and its children are the halves either side
+typedef struct locnode_s {
+	locdata_t *loc;
+	int order;			// position in locdata, ties go to the earliest loc like a linear scan would
+	int axis;
+} locnode_t;
+
+static locnode_t *loc_tree = NULL;
+static int loc_tree_size = 0;
+static qbool loc_tree_dirty = true;
+static int loc_tree_sortaxis;
+
+static int TP_LocNodeCompare(const void *a, const void *b)
+{
+	const locnode_t *n1 = (const locnode_t *) a, *n2 = (const locnode_t *) b;
+	float d = n1->loc->coord[loc_tree_sortaxis] - n2->loc->coord[loc_tree_sortaxis];
+
+	return d < 0 ? -1 : (d > 0 ? 1 : n1->order - n2->order);
+}
+
+static void TP_BuildLocTreeRange(int lo, int hi)
+{
+	vec3_t mins, maxs;
+	int i, mid, axis;
+
+	if (lo > hi)
+		return;
+
+	// split along the widest extent of the range
+	VectorCopy(loc_tree[lo].loc->coord, mins);
+	VectorCopy(loc_tree[lo].loc->coord, maxs);
+	for (i = lo + 1; i <= hi; i++) {
+		for (axis = 0; axis < 3; axis++) {
+			mins[axis] = min(mins[axis], loc_tree[i].loc->coord[axis]);
+			maxs[axis] = max(maxs[axis], loc_tree[i].loc->coord[axis]);
+		}
+	}
+	axis = 0;
+	for (i = 1; i < 3; i++) {
+		if (maxs[i] - mins[i] > maxs[axis] - mins[axis])
+			axis = i;
+	}
+
+	loc_tree_sortaxis = axis;
+	qsort(loc_tree + lo, hi - lo + 1, sizeof(loc_tree[0]), TP_LocNodeCompare);
+
+	mid = (lo + hi) / 2;
+	loc_tree[mid].axis = axis;
+	TP_BuildLocTreeRange(lo, mid - 1);
+	TP_BuildLocTreeRange(mid + 1, hi);
+}
+
+static void TP_BuildLocTree(void)
+{
+	locdata_t *node;
+	int i;
+
+	Q_free(loc_tree);
+	loc_tree_size = 0;
+	loc_tree_dirty = false;
+
+	if (!loc_count)
+		return;
+
+	loc_tree = (locnode_t *) Q_malloc(loc_count * sizeof(loc_tree[0]));
+	for (i = 0, node = locdata; node && i < loc_count; node = node->next, i++) {
+		loc_tree[i].loc = node;
+		loc_tree[i].order = i;
+	}
+	loc_tree_size = i;
+
+	TP_BuildLocTreeRange(0, loc_tree_size - 1);
+}
+
+static void TP_NearestLocRange(vec3_t location, int lo, int hi, locnode_t **best, float *mindist)
+{
+	locnode_t *node;
+	vec3_t vec;
+	float dist, planedist;
+	int mid;
+
+	while (lo <= hi) {
+		mid = (lo + hi) / 2;
+		node = &loc_tree[mid];
+
+		VectorSubtract(location, node->loc->coord, vec);
+		dist = vec[0] * vec[0] + vec[1] * vec[1] + vec[2] * vec[2];
+		if (!*best || dist < *mindist || (dist == *mindist && node->order < (*best)->order)) {
+			*best = node;
+			*mindist = dist;
+		}
+
+		// descend into the near half, the far half only if the splitting plane is within reach
+		planedist = vec[node->axis];
+		if (planedist < 0) {
+			TP_NearestLocRange(location, lo, mid - 1, best, mindist);
+			lo = mid + 1;
+		} else {
+			TP_NearestLocRange(location, mid + 1, hi, best, mindist);
+			hi = mid - 1;
+		}
+
+		if (planedist * planedist > *mindist)
+			return;
+	}
+}
+
+static locdata_t *TP_NearestLoc(vec3_t location)
+{
+	locnode_t *best = NULL;
+	float mindist = 0;
+
+	if (loc_tree_dirty)
+		TP_BuildLocTree();
+
+	TP_NearestLocRange(location, 0, loc_tree_size - 1, &best, &mindist);
+
+	return best ? best->loc : NULL;
+}
+
+static void TP_FreeLocNode(locdata_t *node)
+{
+	Q_free(node->name);
+	Q_free(node->expanded);
+	Q_free(node);
+}
+
 static void TP_ClearLocs(void)
 {
 	locdata_t *node, *temp;
 
 	for (node = locdata; node; node = temp) {
-		Q_free(node->name);
 		temp = node->next;
-		Q_free(node);
+		TP_FreeLocNode(node);
 	}
 
 	locdata = NULL;
 	loc_count = 0;
+	loc_tree_dirty = true;
 }
 
 void TP_ClearLocs_f (void)
@@ -1858,10 +1987,11 @@ static void TP_AddLocNode(vec3_t coord, char *name)
 {
 	locdata_t *newnode, *node;
 
-	newnode = (locdata_t *) Q_malloc(sizeof(locdata_t));
+	newnode = (locdata_t *) Q_calloc(1, sizeof(locdata_t));
 	newnode->name = Q_strdup(name);
 	newnode->next = NULL;
 	memcpy(newnode->coord, coord, sizeof(vec3_t));
+	loc_tree_dirty = true;
 
 	if (!locdata) {
 		locdata = newnode;
@@ -2170,20 +2300,19 @@ void TP_RemoveClosestLoc (vec3_t location)
 		Q_free(best->name);
 		best->name = (char *)Q_calloc(strlen(best->next->name) + 1, sizeof(char));
 		strcpy(best->name, best->next->name);
+		Q_free(best->expanded);
 
 		// Save the pointer to the next node.
 		temp = best->next->next;
 
 		// Free the current next node.
-		Q_free(best->next->name);
-		Q_free(best->next);
+		TP_FreeLocNode(best->next);
 
 		// Set the pointer to the next node.
 		best->next = temp;
 	} else {
 		// Free the current node.
-		Q_free(best->name);
-		Q_free(best);
+		TP_FreeLocNode(best);
 		best = NULL;
 
 		// Make sure the previous node doesn't point to garbage.
@@ -2194,6 +2323,7 @@ void TP_RemoveClosestLoc (vec3_t location)
 
 	// Decrease the loc count.
 	loc_count--;
+	loc_tree_dirty = true;
 
 	// If this was the last loc, remove the entire node list.
 	if(loc_count <= 0) {
@@ -2215,75 +2345,97 @@ void TP_RemoveLoc_f (void)
 	}
 }
 
+// $loc_name_ macros in loc names
+cvar_t	loc_name_ssg = {"loc_name_ssg", "ssg"};
+cvar_t	loc_name_ng = {"loc_name_ng", "ng"};
+cvar_t	loc_name_sng = {"loc_name_sng", "sng"};
+cvar_t	loc_name_gl = {"loc_name_gl", "gl"};
+cvar_t	loc_name_rl = {"loc_name_rl", "rl"};
+cvar_t	loc_name_lg = {"loc_name_lg", "lg"};
+cvar_t	loc_name_separator = {"loc_name_separator", "-"};
+cvar_t	loc_name_ga = {"loc_name_ga", "ga"};
+cvar_t	loc_name_ya = {"loc_name_ya", "ya"};
+cvar_t	loc_name_ra = {"loc_name_ra", "ra"};
+cvar_t	loc_name_quad = {"loc_name_quad", "quad"};
+cvar_t	loc_name_pent = {"loc_name_pent", "pent"};
+cvar_t	loc_name_ring = {"loc_name_ring", "ring"};
+cvar_t	loc_name_suit = {"loc_name_suit", "suit"};
+cvar_t	loc_name_mh = {"loc_name_mh", "mega"};
+
 typedef struct locmacro_s
 {
 	char *macro;
-	char *val;
+	cvar_t *cvar;
 } locmacro_t;
 
 static locmacro_t locmacros[] = {
-                                    {"ssg", "ssg"},
-                                    {"ng", "ng"},
-                                    {"sng", "sng"},
-                                    {"gl", "gl"},
-                                    {"rl", "rl"},
-                                    {"lg", "lg"},
-                                    {"separator", "-"},
-                                    {"ga", "ga"},
-                                    {"ya", "ya"},
-                                    {"ra", "ra"},
-                                    {"quad", "quad"},
-                                    {"pent", "pent"},
-                                    {"ring", "ring"},
-                                    {"suit", "suit"},
-                                    {"mh", "mega"},
+                                    {"ssg", &loc_name_ssg},
+                                    {"ng", &loc_name_ng},
+                                    {"sng", &loc_name_sng},
+                                    {"gl", &loc_name_gl},
+                                    {"rl", &loc_name_rl},
+                                    {"lg", &loc_name_lg},
+                                    {"separator", &loc_name_separator},
+                                    {"ga", &loc_name_ga},
+                                    {"ya", &loc_name_ya},
+                                    {"ra", &loc_name_ra},
+                                    {"quad", &loc_name_quad},
+                                    {"pent", &loc_name_pent},
+                                    {"ring", &loc_name_ring},
+                                    {"suit", &loc_name_suit},
+                                    {"mh", &loc_name_mh},
                                 };
 
 #define NUM_LOCMACROS	(sizeof(locmacros) / sizeof(locmacros[0]))
 
-char *TP_LocationName(vec3_t location)
-{
-	char *in, *out, *value;
-	int i;
-	float dist, mindist;
-	vec3_t vec;
-	static locdata_t *node, *best;
-	cvar_t *cvar;
-	static qbool recursive;
-	static char	buf[1024], newbuf[MAX_LOC_NAME];
+// values the $loc_name_ macros had when the expanded loc names were last built
+static char *locmacro_values[NUM_LOCMACROS];
+static int locmacro_generation = 1;
 
-	if (!locdata || cls.state != ca_active)
-		return tp_name_someplace.string;
+static char *TP_LocMacroValue(int i)
+{
+	return locmacros[i].cvar->string;
+}
 
-	if (recursive)
-		return "";
+// returns true if any of the macros in the mask got a new value since last time
+static qbool TP_LocMacrosChanged(int macros)
+{
+	qbool changed = false;
+	char *value;
+	int i;
 
-	best = NULL;
-	mindist = 0;
+	for (i = 0; i < NUM_LOCMACROS; i++) {
+		if (!(macros & (1 << i)))
+			continue;
 
-	for (node = locdata; node; node = node->next) {
-		VectorSubtract(location, node->coord, vec);
-		dist = vec[0] * vec[0] + vec[1] * vec[1] + vec[2] * vec[2];
-		if (!best || dist < mindist) {
-			best = node;
-			mindist = dist;
+		value = TP_LocMacroValue(i);
+		if (!locmacro_values[i] || strcmp(locmacro_values[i], value)) {
+			Q_free(locmacro_values[i]);
+			locmacro_values[i] = Q_strdup(value);
+			changed = true;
 		}
 	}
 
+	return changed;
+}
+
+// substitutes $loc_name_ macros in name, returns the bitmask of macros used
+static int TP_ExpandLocMacros(char *name, char *newbuf, int size)
+{
+	char *in, *out, *value;
+	int i, macros = 0;
 
 	newbuf[0] = 0;
 	out = newbuf;
-	in = best->name;
-	while (*in && out - newbuf < sizeof(newbuf) - 1) {
+	in = name;
+	while (*in && out - newbuf < size - 1) {
 		if (!strncasecmp(in, "$loc_name_", 10)) {
 			in += 10;
 			for (i = 0; i < NUM_LOCMACROS; i++) {
 				if (!strncasecmp(in, locmacros[i].macro, strlen(locmacros[i].macro))) {
-					if ((cvar = Cvar_Find(va("loc_name_%s", locmacros[i].macro))))
-						value = cvar->string;
-					else
-						value = locmacros[i].val;
-					if (out - newbuf >= sizeof(newbuf) - strlen(value) - 1)
+					macros |= 1 << i;
+					value = TP_LocMacroValue(i);
+					if (out - newbuf + (int) strlen(value) >= size - 1)
 						goto done_locmacros;
 					strcpy(out, value);
 					out += strlen(value);
@@ -2292,7 +2444,7 @@ char *TP_LocationName(vec3_t location)
 				}
 			}
 			if (i == NUM_LOCMACROS) {
-				if (out - newbuf >= sizeof(newbuf) - 10 - 1)
+				if (out - newbuf + 10 >= size - 1)
 					goto done_locmacros;
 				strcpy(out, "$loc_name_");
 				out += 10;
@@ -2305,9 +2457,47 @@ char *TP_LocationName(vec3_t location)
 done_locmacros:
 	*out = 0;
 
+	return macros;
+}
+
+char *TP_LocationName(vec3_t location)
+{
+	locdata_t *best;
+	static qbool recursive;
+	static char	buf[1024], newbuf[MAX_LOC_NAME];
+
+	if (!locdata || cls.state != ca_active)
+		return tp_name_someplace.string;
+
+	if (recursive)
+		return "";
+
+	if (!(best = TP_NearestLoc(location)))
+		return tp_name_someplace.string;
+
+	if (best->expanded && best->macros && TP_LocMacrosChanged(best->macros))
+		locmacro_generation++;
+
+	if (!best->expanded || (best->macros && best->generation != locmacro_generation)) {
+		best->macros = TP_ExpandLocMacros(best->name, newbuf, sizeof(newbuf));
+		if (TP_LocMacrosChanged(best->macros))
+			locmacro_generation++;
+
+		Q_free(best->expanded);
+		best->expanded = Q_strdup(newbuf);
+		best->generation = locmacro_generation;
+		best->plain = !strchr(best->expanded, '$');
+	}
+
+	// nothing for Cmd_ExpandString to do
+	if (best->plain) {
+		strlcpy(buf, best->expanded, sizeof(buf));
+		return buf;
+	}
+
 	buf[0] = 0;
 	recursive = true;
-	Cmd_ExpandString(newbuf, buf);
+	Cmd_ExpandString(best->expanded, buf);
 	recursive = false;
 
 	return buf;
@@ -2319,7 +2509,7 @@ char *TP_PlayerName (void)
 {
 	static char myname[MAX_INFO_STRING];
 
-	strlcpy (myname, Info_ValueForKey(cl.players[cl.playernum].userinfo, "name"), MAX_INFO_STRING);
+	strlcpy (myname, Info_Get(&cl.players[cl.playernum]._userinfo_ctx_, "name"), MAX_INFO_STRING);
 	return myname;
 }
 
@@ -2465,7 +2655,7 @@ int TP_CategorizeMessage (const char *s, int *offset)
 	for (i = 0, player = cl.players; i < MAX_CLIENTS; i++, player++)	{
 		if (!player->name[0])
 			continue;
-		name = Info_ValueForKey (player->userinfo, "name");
+		name = Info_Get(&player->_userinfo_ctx_, "name");
 		len = strlen(name);
 		len = min (len, 31);
 		// check messagemode1
@@ -3293,7 +3483,7 @@ void TP_FindPoint (void)
             }
 
 			if (!eyes)
-				name = va("%s%s%s", name, name[0] ? " " : "", Skin_To_TFSkin(Info_ValueForKey(bestinfo->userinfo, "skin")));
+				name = va("%s%s%s", name, name[0] ? " " : "", Skin_To_TFSkin(Info_Get(&bestinfo->_userinfo_ctx_, "skin")));
 		} else {
 			teammate = (cl.teamplay && !strcmp(bestinfo->team, TP_PlayerTeam()));
 
@@ -3568,6 +3758,8 @@ void TP_DumpMsgFilters(FILE *f)
 extern void TP_InitTriggers (void);
 void TP_Init (void)
 {
+	int i;
+
 	TP_InitTriggers();
 	TP_AddMacros();
 
@@ -3604,6 +3796,8 @@ void TP_Init (void)
 	Cvar_Register (&tp_name_nothing);
 	Cvar_Register (&tp_name_at);
 	Cvar_Register (&tp_name_someplace);
+	for (i = 0; i < NUM_LOCMACROS; i++)
+		Cvar_Register (locmacros[i].cvar);
 
 	Cvar_Register (&tp_name_rune1);
 	Cvar_Register (&tp_name_rune2);
@@ -130,6 +130,10 @@ void TP_Init (void);
 typedef struct locdata_s {
 	vec3_t coord;
 	char *name;
+	char *expanded;		// name with $loc_name_ macros substituted, rebuilt when they change
+	int macros;			// bitmask of the $loc_name_ macros used in name
+	int generation;		// locmacro generation expanded was built for
+	qbool plain;		// expanded has nothing left for Cmd_ExpandString
 	struct locdata_s *next;
 } locdata_t;
 
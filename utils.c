@@ -81,20 +81,18 @@ char *CreateSpaces(int amount) {
 	return spaces;
 }
 
+// both return frame memory
 char *SecondsToMinutesString(int print_time) {
-	static char time[128];
 	int tens_minutes, minutes, tens_seconds, seconds;
 
 	tens_minutes = fmod (print_time / 600, 6);
 	minutes = fmod (print_time / 60, 10);
 	tens_seconds = fmod (print_time / 10, 6);
 	seconds = fmod (print_time, 10);
-	snprintf (time, sizeof(time), "%i%i:%i%i", tens_minutes, minutes, tens_seconds, seconds);
-	return time;
+	return Frame_Printf ("%i%i:%i%i", tens_minutes, minutes, tens_seconds, seconds);
 }
 
 char *SecondsToHourString(int print_time) {
-	static char time[128];
 	int tens_hours, hours,tens_minutes, minutes, tens_seconds, seconds;
 
 	tens_hours = fmod (print_time / 36000, 10);
@@ -103,8 +101,7 @@ char *SecondsToHourString(int print_time) {
 	minutes = fmod (print_time / 60, 10);
 	tens_seconds = fmod (print_time / 10, 6);
 	seconds = fmod (print_time, 10);
-	snprintf (time, sizeof(time), "%i%i:%i%i:%i%i", tens_hours, hours, tens_minutes, minutes, tens_seconds, seconds);
-	return time;
+	return Frame_Printf ("%i%i:%i%i:%i%i", tens_hours, hours, tens_minutes, minutes, tens_seconds, seconds);
 }
 
 #define RGB_COLOR_RED					"255 0 0"
@@ -598,7 +595,7 @@ int Player_NametoSlot(char *name) {
 	int i;
 
 	for (i = 0; i < MAX_CLIENTS; i++) {
-		if (cl.players[i].name[0] && !strncmp(Info_ValueForKey(cl.players[i].userinfo, "name"), name, 31))
+		if (cl.players[i].name[0] && !strncmp(Info_Get(&cl.players[i]._userinfo_ctx_, "name"), name, 31))
 			return i;
 	}
 	return PLAYER_NAME_NOMATCH;
@@ -1148,19 +1145,19 @@ char *Utils_TF_ColorToTeam(int color) {
 
 	switch (color) {
 		case 13:
-			if (*(s = Info_ValueForKey(cl.serverinfo, "team1")) || *(s = Info_ValueForKey(cl.serverinfo, "t1")))
+			if (*(s = Info_Get(&cl._serverinfo_ctx_, "team1")) || *(s = Info_Get(&cl._serverinfo_ctx_, "t1")))
 				return s;
 			break;
 		case 4:
-			if (*(s = Info_ValueForKey(cl.serverinfo, "team2")) || *(s = Info_ValueForKey(cl.serverinfo, "t2")))
+			if (*(s = Info_Get(&cl._serverinfo_ctx_, "team2")) || *(s = Info_Get(&cl._serverinfo_ctx_, "t2")))
 				return s;
 			break;
 		case 12:
-			if (*(s = Info_ValueForKey(cl.serverinfo, "team3")) || *(s = Info_ValueForKey(cl.serverinfo, "t3")))
+			if (*(s = Info_Get(&cl._serverinfo_ctx_, "team3")) || *(s = Info_Get(&cl._serverinfo_ctx_, "t3")))
 				return s;
 			break;
 		case 11:
-			if (*(s = Info_ValueForKey(cl.serverinfo, "team4")) || *(s = Info_ValueForKey(cl.serverinfo, "t4")))
+			if (*(s = Info_Get(&cl._serverinfo_ctx_, "team4")) || *(s = Info_Get(&cl._serverinfo_ctx_, "t4")))
 				return s;
 			break;
 		default:
@@ -91,6 +91,7 @@ typedef struct {
 
 vfsfile_t *FS_OpenTemp(void);
 vfsfile_t *VFSOS_Open(char *osname, char *mode);
+time_t VFSOS_FileTime(vfsfile_t *file);
 
 extern searchpathfuncs_t osfilefuncs;
 
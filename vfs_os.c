@@ -23,6 +23,7 @@
 #include "common.h"
 #include "fs.h"
 #include "vfs.h"
+#include <sys/stat.h>
 
 //==================================
 // STDIO files (OS) - VFS Functions
@@ -149,6 +150,17 @@ vfsfile_t *VFSOS_Open(char *osname, char *mode)
 	return (vfsfile_t*)file;
 }
 
+// Modification time of a file opened from disk, 0 for anything else (pak entries, memory).
+time_t VFSOS_FileTime(vfsfile_t *file)
+{
+	struct stat st;
+
+	if (file->Close != VFSOS_Close || fstat(fileno(((vfsosfile_t *)file)->handle), &st))
+		return 0;
+
+	return st.st_mtime;
+}
+
 //==================================
 // STDIO files (OS) - Search functions
 //==================================
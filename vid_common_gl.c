@@ -37,6 +37,23 @@ qbool gl_mtexable = false;
 int gl_textureunits = 1;
 lpMTexFUNC qglMultiTexCoord2f = NULL;
 lpSelTexFUNC qglActiveTexture = NULL;
+lpSelTexFUNC qglClientActiveTexture = NULL;
+lpCompressedTexImage2DFUNC qglCompressedTexImage2D = NULL;
+lpGenBuffersFUNC qglGenBuffers = NULL;
+lpDeleteBuffersFUNC qglDeleteBuffers = NULL;
+lpBindBufferFUNC qglBindBuffer = NULL;
+lpBufferDataFUNC qglBufferData = NULL;
+lpMapBufferFUNC qglMapBuffer = NULL;
+lpUnmapBufferFUNC qglUnmapBuffer = NULL;
+lpGenFramebuffersFUNC qglGenFramebuffers = NULL;
+lpDeleteFramebuffersFUNC qglDeleteFramebuffers = NULL;
+lpBindFramebufferFUNC qglBindFramebuffer = NULL;
+lpCheckFramebufferStatusFUNC qglCheckFramebufferStatus = NULL;
+lpFramebufferRenderbufferFUNC qglFramebufferRenderbuffer = NULL;
+lpGenRenderbuffersFUNC qglGenRenderbuffers = NULL;
+lpDeleteRenderbuffersFUNC qglDeleteRenderbuffers = NULL;
+lpBindRenderbufferFUNC qglBindRenderbuffer = NULL;
+lpRenderbufferStorageFUNC qglRenderbufferStorage = NULL;
 
 qbool gl_combine = false;
 
@@ -60,6 +77,15 @@ cvar_t  gl_maxtmu2 = {"gl_maxtmu2", "0", CVAR_LATCH};
 
 // GL_ARB_texture_non_power_of_two
 qbool gl_support_arb_texture_non_power_of_two = false;
+
+// GL_EXT_texture_compression_s3tc, used for precompressed textures from the texture cache
+qbool gl_support_s3tc = false;
+
+// GL_ARB_pixel_buffer_object, for asynchronous readback when capturing demos
+qbool gl_support_pbo = false;
+
+// GL_EXT_framebuffer_object, for rendering offscreen when capturing demos headless
+qbool gl_support_fbo = false;
 cvar_t gl_ext_arb_texture_non_power_of_two = {"gl_ext_arb_texture_non_power_of_two", "1", CVAR_LATCH};
 
 /************************************* EXTENSIONS *************************************/
@@ -91,6 +117,7 @@ void CheckMultiTextureExtensions (void) {
 		qglActiveTexture = SDL_GL_GetProcAddress("glActiveTextureARB");
 		if (!qglMultiTexCoord2f || !qglActiveTexture)
 			return;
+		qglClientActiveTexture = SDL_GL_GetProcAddress("glClientActiveTextureARB");	// optional, for vertex arrays
 		Com_Printf_State(PRINT_OK, "Multitexture extensions found\n");
 		gl_mtexable = true;
 	}
@@ -133,6 +160,35 @@ void GL_CheckExtensions (void) {
 		Cvar_SetCurrentGroup(CVAR_GROUP_TEXTURES);
 		Cvar_Register (&gl_ext_texture_compression);
 		Cvar_ResetCurrentGroup();
+
+		if (CheckExtension("GL_EXT_texture_compression_s3tc")) {
+			qglCompressedTexImage2D = SDL_GL_GetProcAddress("glCompressedTexImage2DARB");
+			gl_support_s3tc = (qglCompressedTexImage2D != NULL);
+		}
+	}
+
+	if (CheckExtension("GL_ARB_pixel_buffer_object")) {
+		qglGenBuffers = SDL_GL_GetProcAddress("glGenBuffersARB");
+		qglDeleteBuffers = SDL_GL_GetProcAddress("glDeleteBuffersARB");
+		qglBindBuffer = SDL_GL_GetProcAddress("glBindBufferARB");
+		qglBufferData = SDL_GL_GetProcAddress("glBufferDataARB");
+		qglMapBuffer = SDL_GL_GetProcAddress("glMapBufferARB");
+		qglUnmapBuffer = SDL_GL_GetProcAddress("glUnmapBufferARB");
+		gl_support_pbo = (qglGenBuffers && qglDeleteBuffers && qglBindBuffer && qglBufferData && qglMapBuffer && qglUnmapBuffer);
+	}
+
+	if (CheckExtension("GL_EXT_framebuffer_object")) {
+		qglGenFramebuffers = SDL_GL_GetProcAddress("glGenFramebuffersEXT");
+		qglDeleteFramebuffers = SDL_GL_GetProcAddress("glDeleteFramebuffersEXT");
+		qglBindFramebuffer = SDL_GL_GetProcAddress("glBindFramebufferEXT");
+		qglCheckFramebufferStatus = SDL_GL_GetProcAddress("glCheckFramebufferStatusEXT");
+		qglFramebufferRenderbuffer = SDL_GL_GetProcAddress("glFramebufferRenderbufferEXT");
+		qglGenRenderbuffers = SDL_GL_GetProcAddress("glGenRenderbuffersEXT");
+		qglDeleteRenderbuffers = SDL_GL_GetProcAddress("glDeleteRenderbuffersEXT");
+		qglBindRenderbuffer = SDL_GL_GetProcAddress("glBindRenderbufferEXT");
+		qglRenderbufferStorage = SDL_GL_GetProcAddress("glRenderbufferStorageEXT");
+		gl_support_fbo = (qglGenFramebuffers && qglDeleteFramebuffers && qglBindFramebuffer && qglCheckFramebufferStatus
+			&& qglFramebufferRenderbuffer && qglGenRenderbuffers && qglDeleteRenderbuffers && qglBindRenderbuffer && qglRenderbufferStorage);
 	}
 
 	// GL_ARB_texture_non_power_of_two
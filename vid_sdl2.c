@@ -52,6 +52,7 @@ void Sys_ActiveAppChanged (void);
 #include "gl_model.h"
 #include "gl_local.h"
 #include "textencoding.h"
+#include "movie.h"
 
 #define	WINDOW_CLASS_NAME	"ezQuake"
 
@@ -268,7 +269,7 @@ void IN_Frame(void)
 
 	HandleEvents();
 
-	if (!ActiveApp || Minimized || IN_OSMouseCursorRequired()) {
+	if (!ActiveApp || Minimized || IN_OSMouseCursorRequired() || Movie_IsHeadless()) {
 		IN_DeactivateMouse();
 		return;
 	} else {
@@ -282,7 +283,30 @@ void IN_Frame(void)
 		SDL_GetRelativeMouseState(&mx, &my);
 #endif
 	}
-	
+
+	CL_InputSampled();
+}
+
+// Adds mouse movement that arrived since IN_Frame. Events are only pumped,
+// not handled, so this is safe to call while a frame is being drawn.
+void IN_PollMouse(void)
+{
+	int dx = 0, dy = 0;
+
+	if (!sdl_window || !mouse_active || !SDL_GetRelativeMouseMode())
+		return;
+
+#ifdef __APPLE__
+	OSX_Mouse_GetMouseMovement(&dx, &dy);
+#else
+	SDL_PumpEvents();
+	SDL_GetRelativeMouseState(&dx, &dy);
+#endif
+
+	mx += dx;
+	my += dy;
+
+	CL_InputSampled();
 }
 
 void Sys_SendKeyEvents(void)
@@ -1073,7 +1097,10 @@ static void VID_SDL_Init(void)
 #ifdef SDL_WINDOW_ALLOW_HIGHDPI
 	flags |= SDL_WINDOW_ALLOW_HIGHDPI;
 #endif
-	if (r_fullscreen.integer > 0) {
+	if (Movie_IsHeadless()) {
+		// never shown, the frames are rendered offscreen at exactly the window size
+		flags = SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN;
+	} else if (r_fullscreen.integer > 0) {
 		if (vid_usedesktopres.integer == 1) {
 			flags |= SDL_WINDOW_FULLSCREEN_DESKTOP;
 		}
@@ -1415,7 +1442,7 @@ static void VID_ParseCmdLine(void)
 {
 	int i, w = 0, h = 0, display = 0;
 
-	if (COM_CheckParm("-window") || COM_CheckParm("-startwindowed")) {
+	if (COM_CheckParm("-window") || COM_CheckParm("-startwindowed") || Movie_IsHeadless()) {
 		Cvar_LatchedSetValue(&r_fullscreen, 0);
 	}
 
@@ -1440,7 +1467,7 @@ static void VID_ParseCmdLine(void)
 	}
 
 	if (w && h) {
-		if (COM_CheckParm("-window")) {
+		if (COM_CheckParm("-window") || Movie_IsHeadless()) {
 			Cvar_LatchedSetValue(&vid_win_width,  w);
 			Cvar_LatchedSetValue(&vid_win_height, h);
 		} else {
@@ -1625,6 +1652,11 @@ void VID_Init(unsigned char *palette) {
 
 	GL_Init(); // Real OpenGL stuff, vid_common_gl.c
 
+	if (Movie_IsHeadless() && !Framebuffer_OffscreenInit(glConfig.vidWidth, glConfig.vidHeight)) {
+		// A hidden window has no reliable backbuffer to read from, the capture would be garbage.
+		Sys_Error("Headless capture needs framebuffer objects, couldn't create a %dx%d offscreen target\n", glConfig.vidWidth, glConfig.vidHeight);
+	}
+
 	vid_initialized = true;
 }
 
@@ -193,29 +193,29 @@ void CheckModels_f(void)
 		if (!cl.players[i].name[0]) //not in game
 			continue;
 		//check pmodel
-		mod = TP_GetModels(Info_ValueForKey(cl.players[i].userinfo, "pmodel"));
+		mod = TP_GetModels(Info_Get(&cl.players[i]._userinfo_ctx_, "pmodel"));
 		if (mod == NULL)
 		{
-			if (!Info_ValueForKey(cl.players[i].userinfo, "pmodel")[0])
-				Com_Printf("Warning: %s has hidden pmodel\n", Info_ValueForKey(cl.players[i].userinfo, "name"));
+			if (!Info_Get(&cl.players[i]._userinfo_ctx_, "pmodel")[0])
+				Com_Printf("Warning: %s has hidden pmodel\n", Info_Get(&cl.players[i]._userinfo_ctx_, "name"));
 			else
-				Com_Printf("Warning: %s has suspicious player model (Unknown Model: %s)\n", Info_ValueForKey(cl.players[i].userinfo, "name"), Info_ValueForKey(cl.players[i].userinfo, "pmodel"));
+				Com_Printf("Warning: %s has suspicious player model (Unknown Model: %s)\n", Info_Get(&cl.players[i]._userinfo_ctx_, "name"), Info_Get(&cl.players[i]._userinfo_ctx_, "pmodel"));
 		}
 		else if (mod->notify || !QW_strncmp(mod->number, "6967")) //report eyes as being unusual is used as player model
 		{
-			Com_Printf("Warning: %s has suspicious player model (%s)\n", Info_ValueForKey(cl.players[i].userinfo, "name"), mod->name);
+			Com_Printf("Warning: %s has suspicious player model (%s)\n", Info_Get(&cl.players[i]._userinfo_ctx_, "name"), mod->name);
 		}
-		mod = TP_GetModels(Info_ValueForKey(cl.players[i].userinfo, "emodel"));
+		mod = TP_GetModels(Info_Get(&cl.players[i]._userinfo_ctx_, "emodel"));
 		if (mod == NULL)
 		{
-			if (!Info_ValueForKey(cl.players[i].userinfo, "emodel")[0])
-				Com_Printf("Warning: %s has hidden emodel\n", Info_ValueForKey(cl.players[i].userinfo, "name"));
+			if (!Info_Get(&cl.players[i]._userinfo_ctx_, "emodel")[0])
+				Com_Printf("Warning: %s has hidden emodel\n", Info_Get(&cl.players[i]._userinfo_ctx_, "name"));
 			else
-				Com_Printf("Warning: %s has ILLEGAL eyes model (Unknown Model: %s)\n", Info_ValueForKey(cl.players[i].userinfo, "name"), Info_ValueForKey(cl.players[i].userinfo, "emodel"));
+				Com_Printf("Warning: %s has ILLEGAL eyes model (Unknown Model: %s)\n", Info_Get(&cl.players[i]._userinfo_ctx_, "name"), Info_Get(&cl.players[i]._userinfo_ctx_, "emodel"));
 		}
 		else if (mod->notify || QW_strncmp(mod->number, "6967")) //anything other 6967 is a hack
 		{
-			Com_Printf("Warning: %s has ILLEGAL eyes model (%s)\n", Info_ValueForKey(cl.players[i].userinfo, "name"), mod->name);
+			Com_Printf("Warning: %s has ILLEGAL eyes model (%s)\n", Info_Get(&cl.players[i]._userinfo_ctx_, "name"), mod->name);
 		}
 	}
 };
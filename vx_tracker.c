@@ -622,7 +622,7 @@ void VX_TrackerStreak (int player, int count)
 	if (cl.playernum == player || (player == Cam_TrackNum() && cl.spectator))
 		snprintf(outstring, sizeof(outstring), "&c940You are %s (%i kills)", streak->spreestring, count);
 	else
-		snprintf(outstring, sizeof(outstring), "&r%s &c940is %s (%i kills)", Info_ValueForKey(cl.players[player].userinfo, "name"), streak->spreestring, count);
+		snprintf(outstring, sizeof(outstring), "&r%s &c940is %s (%i kills)", Info_Get(&cl.players[player]._userinfo_ctx_, "name"), streak->spreestring, count);
 	VX_TrackerAddText(outstring, tt_streak);
 }
 
@@ -635,10 +635,10 @@ void VX_TrackerStreakEnd(int player, int killer, int count)
 
 	if (player == killer) // streak ends due to suicide
 	{
-		char* userinfo_gender = Info_ValueForKey(cl.players[player].userinfo, "gender");
+		char* userinfo_gender = Info_Get(&cl.players[player]._userinfo_ctx_, "gender");
 		char gender;
 		if (! *userinfo_gender)
-			userinfo_gender = Info_ValueForKey(cl.players[player].userinfo, "g");
+			userinfo_gender = Info_Get(&cl.players[player]._userinfo_ctx_, "g");
 
 		gender = userinfo_gender[0];
 		if (gender == '0' || gender == 'M')
@@ -651,22 +651,22 @@ void VX_TrackerStreakEnd(int player, int killer, int count)
 		if (cl.playernum == player || (player == Cam_TrackNum() && cl.spectator))
 			snprintf(outstring, sizeof(outstring), "&c940You were looking good until you killed yourself (%i kills)", count);
 		else if (gender == 'm')
-			snprintf(outstring, sizeof(outstring), "&r%s&c940 was looking good until he killed himself (%i kills)", Info_ValueForKey(cl.players[player].userinfo, "name"), count);
+			snprintf(outstring, sizeof(outstring), "&r%s&c940 was looking good until he killed himself (%i kills)", Info_Get(&cl.players[player]._userinfo_ctx_, "name"), count);
 		else if (gender == 'f')
-			snprintf(outstring, sizeof(outstring), "&r%s&c940 was looking good until she killed herself (%i kills)", Info_ValueForKey(cl.players[player].userinfo, "name"), count);
+			snprintf(outstring, sizeof(outstring), "&r%s&c940 was looking good until she killed herself (%i kills)", Info_Get(&cl.players[player]._userinfo_ctx_, "name"), count);
 		else if (gender == 'n')
-			snprintf(outstring, sizeof(outstring), "&r%s&c940 was looking good until it killed itself (%i kills)", Info_ValueForKey(cl.players[player].userinfo, "name"), count);
+			snprintf(outstring, sizeof(outstring), "&r%s&c940 was looking good until it killed itself (%i kills)", Info_Get(&cl.players[player]._userinfo_ctx_, "name"), count);
 		else
-			snprintf(outstring, sizeof(outstring), "&r%s&c940 was looking good, then committed suicide (%i kills)", Info_ValueForKey(cl.players[player].userinfo, "name"), count);
+			snprintf(outstring, sizeof(outstring), "&r%s&c940 was looking good, then committed suicide (%i kills)", Info_Get(&cl.players[player]._userinfo_ctx_, "name"), count);
 	}
 	else // non suicide
 	{
 		if (cl.playernum == player || (player == Cam_TrackNum() && cl.spectator))
-			snprintf(outstring, sizeof(outstring), "&c940Your streak was ended by &r%s&c940 (%i kills)", Info_ValueForKey(cl.players[killer].userinfo, "name"), count);
+			snprintf(outstring, sizeof(outstring), "&c940Your streak was ended by &r%s&c940 (%i kills)", Info_Get(&cl.players[killer]._userinfo_ctx_, "name"), count);
 		else if (cl.playernum == killer || (killer == Cam_TrackNum() && cl.spectator))
-			snprintf(outstring, sizeof(outstring), "&r%s&c940's streak was ended by you (%i kills)", Info_ValueForKey(cl.players[player].userinfo, "name"), count);
+			snprintf(outstring, sizeof(outstring), "&r%s&c940's streak was ended by you (%i kills)", Info_Get(&cl.players[player]._userinfo_ctx_, "name"), count);
 		else
-			snprintf(outstring, sizeof(outstring), "&r%s&c940's streak was ended by &r%s&c940 (%i kills)", Info_ValueForKey(cl.players[player].userinfo, "name"), Info_ValueForKey(cl.players[killer].userinfo, "name"), count);
+			snprintf(outstring, sizeof(outstring), "&r%s&c940's streak was ended by &r%s&c940 (%i kills)", Info_Get(&cl.players[player]._userinfo_ctx_, "name"), Info_Get(&cl.players[killer]._userinfo_ctx_, "name"), count);
 	}
 	VX_TrackerAddText(outstring, tt_streak);
 }
@@ -681,7 +681,7 @@ void VX_TrackerStreakEndOddTeamkilled(int player, int count)
 	if (cl.playernum == player || (player == Cam_TrackNum() && cl.spectator))
 		snprintf(outstring, sizeof(outstring), "&c940Your streak was ended by teammate (%i kills)", count);
 	else
-		snprintf(outstring, sizeof(outstring), "&r%s&c940's streak was ended by teammate (%i kills)", Info_ValueForKey(cl.players[player].userinfo, "name"), count);
+		snprintf(outstring, sizeof(outstring), "&r%s&c940's streak was ended by teammate (%i kills)", Info_Get(&cl.players[player]._userinfo_ctx_, "name"), count);
 
 	VX_TrackerAddText(outstring, tt_streak);
 }
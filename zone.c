@@ -26,9 +26,6 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "gl_model.h"
 #endif
 
-void Cache_FreeLow(int new_low_hunk);
-void Cache_FreeHigh(int new_high_hunk);
-
 //============================================================================
 
 #define HUNK_SENTINEL 0x1df001ed
@@ -184,8 +181,6 @@ void *Hunk_AllocName(int size, char *name)
 	h = (hunk_t *)(hunk_base + hunk_low_used);
 	hunk_low_used += size;
 
-	Cache_FreeLow(hunk_low_used);
-
 	memset(h, 0, size);
 
 	h->size = size;
@@ -275,7 +270,6 @@ void *Hunk_HighAllocName(int size, char *name)
 	}
 
 	hunk_high_used += size;
-	Cache_FreeHigh(hunk_high_used);
 
 	h = (hunk_t *)(hunk_base + hunk_size - hunk_high_used);
 
@@ -317,195 +311,407 @@ void *Hunk_TempAlloc(int size)
 /*
 ===============================================================================
 
-CACHE MEMORY
+FRAME MEMORY
 
 ===============================================================================
 */
 
-typedef struct cache_system_s {
-	int						size; // including this header
-	cache_user_t			*user;
-	char					name[16];
-	struct cache_system_s	*prev, *next;
-	struct cache_system_s	*lru_prev, *lru_next; // for LRU flushing
-} cache_system_t;
+#define FRAME_MEMORY_SIZE	(256 * 1024)
 
-cache_system_t *Cache_TryAlloc(int size, qbool nobottom);
+typedef struct frame_overflow_s {
+	struct frame_overflow_s	*next;
+} frame_overflow_t;
 
-cache_system_t cache_head;
+static byte *frame_base;
+static int frame_size, frame_used;
+static byte *frame_last;		// most recent allocation in the arena, the only one Frame_Trim shrinks
+static frame_overflow_t *frame_overflow;	// allocations that didn't fit, freed on reset
+static int frame_overflow_used;
+static int frame_peak, frame_lastpeak, frame_maxpeak, frame_overflows;
 
-/*
-===========
-Cache_Move
-===========
-*/
-void Cache_Move(cache_system_t *c)
+void *Frame_Alloc(int size)
 {
-	cache_system_t *new_block;
+	frame_overflow_t *o;
+	byte *buf;
 
-	// we are clearing up space at the bottom, so only allocate it late
-	new_block = Cache_TryAlloc(c->size, true);
-	if (new_block) {
-		memcpy(new_block + 1, c + 1, c->size - sizeof(cache_system_t));
-		new_block->user = c->user;
-		memcpy(new_block->name, c->name, sizeof(new_block->name));
-		Cache_Free(c->user);
-		new_block->user->data = (void *)(new_block + 1);
+	if (size < 0) {
+		Sys_Error("Frame_Alloc: bad size: %i", size);
+	}
+
+	size = (size + 15) & ~15;
+
+	if (!frame_base) {
+		frame_size = FRAME_MEMORY_SIZE;
+		frame_base = (byte *) Q_malloc(frame_size);
+	}
+
+	if (frame_used + size <= frame_size) {
+		buf = frame_base + frame_used;
+		frame_used += size;
+		frame_last = buf;
 	}
 	else {
-		Cache_Free(c->user); // tough luck...
+		// grows the arena on the next reset
+		o = (frame_overflow_t *) Q_malloc(sizeof(frame_overflow_t) + 16 + size);
+		o->next = frame_overflow;
+		frame_overflow = o;
+		frame_overflow_used += size;
+		buf = (byte *) o + 16;
+		frame_last = NULL;
 	}
-}
 
-/*
-============
-Cache_FreeLow
+	frame_peak = max(frame_peak, frame_used + frame_overflow_used);
 
-Throw things out until the hunk can be expanded to the given point
-============
-*/
-void Cache_FreeLow(int new_low_hunk)
+	memset(buf, 0, size);
+	return buf;
+}
+
+char *Frame_Strdup(const char *s)
 {
-	cache_system_t *c;
+	int len;
 
-	while (1) {
-		c = cache_head.next;
-		if (c == &cache_head) {
-			return; // nothing in cache at all
-		}
-		if ((byte *)c >= hunk_base + new_low_hunk) {
-			return; // there is space to grow the hunk
-		}
-		Cache_Move(c); // reclaim the space
+	if (!s) {
+		return NULL;
 	}
+
+	len = strlen(s) + 1;
+	return (char *) memcpy(Frame_Alloc(len), s, len);
 }
 
-/*
-============
-Cache_FreeHigh
+char *Frame_Printf(const char *fmt, ...)
+{
+	va_list argptr;
+	char *buf;
+	int len;
 
-Throw things out until the hunk can be expanded to the given point
-============
-*/
-void Cache_FreeHigh(int new_high_hunk)
+	va_start(argptr, fmt);
+	len = vsnprintf(NULL, 0, fmt, argptr);
+	va_end(argptr);
+
+	buf = (char *) Frame_Alloc(max(len, 0) + 1);
+
+	va_start(argptr, fmt);
+	vsnprintf(buf, max(len, 0) + 1, fmt, argptr);
+	va_end(argptr);
+
+	return buf;
+}
+
+// Gives back the end of buf, keeping size bytes of it. Only done if nothing has
+// been allocated since buf, otherwise the call is ignored.
+void Frame_Trim(void *buf, int size)
 {
-	cache_system_t *c, *prev;
+	int used;
 
-	prev = NULL;
-	while (1) {
-		c = cache_head.prev;
-		if (c == &cache_head) {
-			return; // nothing in cache at all
-		}
-		if ((byte *)c + c->size <= hunk_base + hunk_size - new_high_hunk) {
-			return; // there is space to grow the hunk
-		}
-		if (c == prev) {
-			Cache_Free(c->user); // didn't move out of the way
-		}
-		else {
-			Cache_Move(c); // try to move it
-			prev = c;
-		}
+	if (size < 0) {
+		Sys_Error("Frame_Trim: bad size: %i", size);
+	}
+
+	if (!buf || buf != frame_last) {
+		return;
+	}
+
+	used = (byte *) buf - frame_base;
+	size = (size + 15) & ~15;
+	if (used + size < frame_used) {
+		frame_used = used + size;
 	}
 }
 
-void Cache_UnlinkLRU(cache_system_t *cs)
+frame_mark_t Frame_LowMark(void)
 {
-	if (!cs->lru_next || !cs->lru_prev) {
-		Sys_Error("Cache_UnlinkLRU: NULL link");
+	frame_mark_t mark;
+
+	mark.used = frame_used;
+	mark.overflow = frame_overflow;
+	mark.overflow_used = frame_overflow_used;
+
+	return mark;
+}
+
+void Frame_FreeToLowMark(frame_mark_t mark)
+{
+	frame_overflow_t *o;
+
+	if (mark.used < 0 || mark.used > frame_used || mark.overflow_used > frame_overflow_used) {
+		Sys_Error("Frame_FreeToLowMark: bad mark %i", mark.used);
 	}
 
-	cs->lru_next->lru_prev = cs->lru_prev;
-	cs->lru_prev->lru_next = cs->lru_next;
+	// overflow blocks are pushed on the front, so the ones allocated after
+	// the mark are all in front of the block it recorded
+	while ((o = frame_overflow) && o != (frame_overflow_t *) mark.overflow) {
+		frame_overflow = o->next;
+		Q_free(o);
+	}
+
+	if (frame_overflow != (frame_overflow_t *) mark.overflow) {
+		Sys_Error("Frame_FreeToLowMark: stale mark");
+	}
 
-	cs->lru_prev = cs->lru_next = NULL;
+	frame_used = mark.used;
+	frame_overflow_used = mark.overflow_used;
+	frame_last = NULL;
 }
 
-void Cache_MakeLRU(cache_system_t *cs)
+void Frame_Reset(void)
 {
-	if (cs->lru_next || cs->lru_prev) {
-		Sys_Error("Cache_MakeLRU: active link");
+	frame_overflow_t *o;
+
+	while ((o = frame_overflow)) {
+		frame_overflow = o->next;
+		Q_free(o);
 	}
 
-	cache_head.lru_next->lru_prev = cs;
-	cs->lru_next = cache_head.lru_next;
-	cs->lru_prev = &cache_head;
-	cache_head.lru_next = cs;
+	// make room for all of it next time
+	if (frame_overflow_used) {
+		frame_overflows++;
+		while (frame_size < frame_peak) {
+			frame_size *= 2;
+		}
+		Q_free(frame_base);
+		frame_base = (byte *) Q_malloc(frame_size);
+	}
+
+	frame_lastpeak = frame_peak;
+	frame_maxpeak = max(frame_maxpeak, frame_peak);
+	frame_peak = frame_used = frame_overflow_used = 0;
+	frame_last = NULL;
 }
 
 /*
-============
-Cache_TryAlloc
+===============================================================================
 
-Looks for a free block of memory between the high and low hunk marks
-Size should already include the header and padding
-============
+CACHE MEMORY
+
+Blocks are carved out of slabs of fixed size classes and never move.
+Callers hold a generational handle to the block instead of a pointer,
+so throwing a block out only has to bump its generation.
+
+===============================================================================
 */
-cache_system_t *Cache_TryAlloc(int size, qbool nobottom)
+
+#define CACHE_MIN_CLASS		256
+#define CACHE_MAX_CLASS		(4 * 1024 * 1024)	// bigger blocks get an allocation of their own
+#define CACHE_SLAB_SIZE		(256 * 1024)
+#define CACHE_MAX_CLASSES	64
+#define CACHE_MAX_BLOCKS	0xffff
+
+typedef struct cache_slab_s {
+	struct cache_slab_s	*prev, *next;
+	int					sizeclass;
+	int					numobjects;
+	int					numfree;
+	int					firstfree;	// first free object, free objects hold the index of the next one
+	byte				*data;
+} cache_slab_t;
+
+typedef struct cache_block_s {
+	void				*data;
+	cache_slab_t		*slab;		// NULL if allocated on its own
+	int					size;		// as requested
+	int					allocsize;	// including the size class rounding
+	cachetype_t			type;
+	unsigned int		generation;
+	qbool				used;
+	int					lru_prev, lru_next;	// blocks of the same type, -1 terminated
+	int					nextfree;
+	char				name[16];
+} cache_block_t;
+
+typedef struct cache_class_s {
+	int					size;
+	int					numslabs;
+	cache_slab_t		*slabs;
+} cache_class_t;
+
+typedef struct cache_typeinfo_s {
+	char				*name;
+	cvar_t				*budget;	// in megabytes, 0 is no limit
+	int					lru_head, lru_tail;	// most and least recently used
+	int					count;
+	int					used;
+	int					allocated;
+	int					evictions;
+} cache_typeinfo_t;
+
+cvar_t cache_budget_models = {"cache_budget_models", "128"};
+cvar_t cache_budget_skins = {"cache_budget_skins", "32"};
+cvar_t cache_budget_sounds = {"cache_budget_sounds", "64"};
+
+static cache_class_t cache_classes[CACHE_MAX_CLASSES];
+static int cache_numclasses;
+
+static cache_block_t *cache_blocks;
+static int cache_numblocks, cache_maxblocks;
+static int cache_firstfreeblock = -1;
+
+static cache_typeinfo_t cache_types[CACHE_NUMTYPES] = {
+	{ "models", &cache_budget_models, -1, -1 },
+	{ "skins", &cache_budget_skins, -1, -1 },
+	{ "sounds", &cache_budget_sounds, -1, -1 },
+};
+
+static int cache_slabbytes, cache_largebytes;
+
+static cache_block_t *Cache_Block(cache_user_t *c)
+{
+	int index = (int) c->index - 1;
+	cache_block_t *cb;
+
+	if (index < 0 || index >= cache_numblocks) {
+		return NULL;
+	}
+
+	cb = &cache_blocks[index];
+	if (!cb->used || cb->generation != c->generation) {
+		return NULL;
+	}
+
+	return cb;
+}
+
+static int Cache_SizeClass(int size)
 {
-	cache_system_t *cs, *new_block;
+	int i;
 
-	// is the cache completely empty?
-	if (!nobottom && cache_head.prev == &cache_head) {
-		if (hunk_size - hunk_high_used - hunk_low_used < size) {
-			Sys_Error("Cache_TryAlloc: %i is greater than free hunk", size);
+	for (i = 0; i < cache_numclasses; i++) {
+		if (size <= cache_classes[i].size) {
+			return i;
 		}
+	}
 
-		new_block = (cache_system_t *)(hunk_base + hunk_low_used);
-		memset(new_block, 0, sizeof(*new_block));
-		new_block->size = size;
+	return -1;
+}
 
-		cache_head.prev = cache_head.next = new_block;
-		new_block->prev = new_block->next = &cache_head;
+static void Cache_UnlinkLRU(cache_block_t *cb)
+{
+	cache_typeinfo_t *t = &cache_types[cb->type];
 
-		Cache_MakeLRU(new_block);
-		return new_block;
+	if (cb->lru_prev >= 0) {
+		cache_blocks[cb->lru_prev].lru_next = cb->lru_next;
+	}
+	else {
+		t->lru_head = cb->lru_next;
 	}
 
-	// search from the bottom up for space
-	new_block = (cache_system_t *)(hunk_base + hunk_low_used);
-	cs = cache_head.next;
+	if (cb->lru_next >= 0) {
+		cache_blocks[cb->lru_next].lru_prev = cb->lru_prev;
+	}
+	else {
+		t->lru_tail = cb->lru_prev;
+	}
 
-	do {
-		if (!nobottom || cs != cache_head.next) {
-			if ((byte *)cs - (byte *)new_block >= size) {
-				// found space
-				memset(new_block, 0, sizeof(*new_block));
-				new_block->size = size;
+	cb->lru_prev = cb->lru_next = -1;
+}
 
-				new_block->next = cs;
-				new_block->prev = cs->prev;
-				cs->prev->next = new_block;
-				cs->prev = new_block;
+static void Cache_MakeLRU(cache_block_t *cb)
+{
+	cache_typeinfo_t *t = &cache_types[cb->type];
+	int index = cb - cache_blocks;
 
-				Cache_MakeLRU(new_block);
+	cb->lru_prev = -1;
+	cb->lru_next = t->lru_head;
+	if (t->lru_head >= 0) {
+		cache_blocks[t->lru_head].lru_prev = index;
+	}
+	t->lru_head = index;
+	if (t->lru_tail < 0) {
+		t->lru_tail = index;
+	}
+}
 
-				return new_block;
-			}
+static void *Cache_SlabAlloc(int sizeclass, cache_slab_t **slab_out)
+{
+	cache_class_t *cl = &cache_classes[sizeclass];
+	cache_slab_t *slab;
+	int i;
+	byte *obj;
+
+	for (slab = cl->slabs; slab; slab = slab->next) {
+		if (slab->numfree) {
+			break;
+		}
+	}
+
+	if (!slab) {
+		slab = (cache_slab_t *) Q_calloc(1, sizeof(*slab));
+		slab->sizeclass = sizeclass;
+		slab->numobjects = max(1, CACHE_SLAB_SIZE / cl->size);
+		slab->numfree = slab->numobjects;
+		slab->data = (byte *) Q_malloc(slab->numobjects * cl->size);
+		for (i = 0; i < slab->numobjects; i++) {
+			*(int *)(slab->data + i * cl->size) = (i + 1 < slab->numobjects) ? i + 1 : -1;
 		}
+		slab->firstfree = 0;
 
-		// continue looking
-		new_block = (cache_system_t *)((byte *)cs + cs->size);
-		cs = cs->next;
-	} while (cs != &cache_head);
+		slab->next = cl->slabs;
+		if (cl->slabs) {
+			cl->slabs->prev = slab;
+		}
+		cl->slabs = slab;
+		cl->numslabs++;
+		cache_slabbytes += slab->numobjects * cl->size;
+	}
 
-	// try to allocate one at the very end
-	if (hunk_base + hunk_size - hunk_high_used - (byte *)new_block >= size) {
-		memset(new_block, 0, sizeof(*new_block));
-		new_block->size = size;
+	obj = slab->data + slab->firstfree * cl->size;
+	slab->firstfree = *(int *) obj;
+	slab->numfree--;
 
-		new_block->next = &cache_head;
-		new_block->prev = cache_head.prev;
-		cache_head.prev->next = new_block;
-		cache_head.prev = new_block;
+	*slab_out = slab;
+	return obj;
+}
 
-		Cache_MakeLRU(new_block);
+static void Cache_SlabFree(cache_slab_t *slab, void *data)
+{
+	cache_class_t *cl = &cache_classes[slab->sizeclass];
+	int index = ((byte *) data - slab->data) / cl->size;
 
-		return new_block;
+	*(int *) data = slab->firstfree;
+	slab->firstfree = index;
+	slab->numfree++;
+
+	// give empty slabs back, but keep one around so a class that is in use doesn't thrash
+	if (slab->numfree == slab->numobjects && cl->numslabs > 1) {
+		if (slab->prev) {
+			slab->prev->next = slab->next;
+		}
+		else {
+			cl->slabs = slab->next;
+		}
+		if (slab->next) {
+			slab->next->prev = slab->prev;
+		}
+		cl->numslabs--;
+		cache_slabbytes -= slab->numobjects * cl->size;
+		Q_free(slab->data);
+		Q_free(slab);
+	}
+}
+
+static void Cache_FreeBlock(cache_block_t *cb)
+{
+	cache_typeinfo_t *t = &cache_types[cb->type];
+
+	Cache_UnlinkLRU(cb);
+
+	if (cb->slab) {
+		Cache_SlabFree(cb->slab, cb->data);
+	}
+	else {
+		cache_largebytes -= cb->allocsize;
+		Q_free(cb->data);
 	}
 
-	return NULL; // couldn't allocate
+	t->count--;
+	t->used -= cb->size;
+	t->allocated -= cb->allocsize;
+
+	cb->data = NULL;
+	cb->slab = NULL;
+	cb->used = false;
+	cb->generation++;	// invalidates all handles to it
+	cb->nextfree = cache_firstfreeblock;
+	cache_firstfreeblock = cb - cache_blocks;
 }
 
 /*
@@ -517,9 +723,26 @@ Throw everything out, so new data will be demand cached
 */
 void Cache_Flush(void)
 {
-	while (cache_head.next != &cache_head) {
-		Cache_Free(cache_head.next->user); // reclaim the space
+	cache_slab_t *slab, *next;
+	int i;
+
+	for (i = 0; i < cache_numblocks; i++) {
+		if (cache_blocks[i].used) {
+			Cache_FreeBlock(&cache_blocks[i]);
+		}
 	}
+
+	// the slab kept around by each class is empty now too
+	for (i = 0; i < cache_numclasses; i++) {
+		for (slab = cache_classes[i].slabs; slab; slab = next) {
+			next = slab->next;
+			Q_free(slab->data);
+			Q_free(slab);
+		}
+		cache_classes[i].slabs = NULL;
+		cache_classes[i].numslabs = 0;
+	}
+	cache_slabbytes = 0;
 #ifndef SERVERONLY
 	Mod_ClearSimpleTextures();
 #endif
@@ -533,10 +756,14 @@ Cache_Print
 */
 void Cache_Print(void)
 {
-	cache_system_t *cd;
+	cache_block_t *cb;
+	int i;
 
-	for (cd = cache_head.next; cd != &cache_head; cd = cd->next) {
-		Con_Printf("%5.1f kB : %s\n", (cd->size / (float)(1024)), cd->name);
+	for (i = 0; i < CACHE_NUMTYPES; i++) {
+		for (cb = (cache_types[i].lru_head >= 0) ? &cache_blocks[cache_types[i].lru_head] : NULL; cb;
+			cb = (cb->lru_next >= 0) ? &cache_blocks[cb->lru_next] : NULL) {
+			Con_Printf("%5.1f kB : %s (%s)\n", (cb->size / (float)(1024)), cb->name, cache_types[i].name);
+		}
 	}
 }
 
@@ -548,9 +775,58 @@ Cache_Report
 */
 void Cache_Report(void)
 {
-	Con_Printf("%4.1f of %4.1f megabyte data cache free\n",
-		(float)(hunk_size - hunk_high_used - hunk_low_used) / (1024 * 1024),
-		(float)hunk_size / (1024 * 1024));
+	Con_Printf("%4.1f megabyte data cache in use, %4.1f allocated\n",
+		(float)(cache_types[CACHE_MODEL].used + cache_types[CACHE_SKIN].used + cache_types[CACHE_SOUND].used) / (1024 * 1024),
+		(float)(cache_slabbytes + cache_largebytes) / (1024 * 1024));
+}
+
+/*
+============
+Cache_Stats_f
+
+Budget use per type and how much of the slab memory is actually used
+============
+*/
+void Cache_Stats_f(void)
+{
+	cache_typeinfo_t *t;
+	cache_class_t *cl;
+	cache_slab_t *slab;
+	int i, objects, free_objects, used_bytes, slab_bytes;
+
+	Con_Printf("type      blocks     used kB    alloc kB   budget kB  evicted\n");
+	for (i = 0; i < CACHE_NUMTYPES; i++) {
+		t = &cache_types[i];
+		Con_Printf("%-8s  %6d  %10d  %10d  %10d  %7d\n", t->name, t->count, t->used / 1024, t->allocated / 1024,
+			t->budget->integer * 1024, t->evictions);
+	}
+
+	Con_Printf("\nclass kB  slabs  objects   free\n");
+	used_bytes = slab_bytes = 0;
+	for (i = 0; i < cache_numclasses; i++) {
+		cl = &cache_classes[i];
+		if (!cl->numslabs) {
+			continue;
+		}
+
+		objects = free_objects = 0;
+		for (slab = cl->slabs; slab; slab = slab->next) {
+			objects += slab->numobjects;
+			free_objects += slab->numfree;
+		}
+		used_bytes += (objects - free_objects) * cl->size;
+		slab_bytes += objects * cl->size;
+		Con_Printf("%8.2f  %5d  %7d  %5d\n", cl->size / 1024.0f, cl->numslabs, objects, free_objects);
+	}
+
+	Con_Printf("\nslabs %d kB, %d kB of it free, %d kB in large blocks\n", slab_bytes / 1024, (slab_bytes - used_bytes) / 1024, cache_largebytes / 1024);
+	used_bytes = cache_types[CACHE_MODEL].used + cache_types[CACHE_SKIN].used + cache_types[CACHE_SOUND].used;
+	if (slab_bytes + cache_largebytes) {
+		Con_Printf("fragmentation %.1f%%\n", 100.0f * (1.0f - (float) used_bytes / (slab_bytes + cache_largebytes)));
+	}
+
+	Con_Printf("\nframe memory: last frame peak %d kB, highest %d kB, size %d kB, overflowed %d times\n",
+		frame_lastpeak / 1024, frame_maxpeak / 1024, frame_size / 1024, frame_overflows);
 }
 
 /*
@@ -561,11 +837,18 @@ Cache_Init
 */
 void Cache_Init(void)
 {
-	cache_head.next = cache_head.prev = &cache_head;
-	cache_head.lru_next = cache_head.lru_prev = &cache_head;
+	int size, step;
 
-#ifndef WITH_DP_MEM
-	// If DP mem is used then we can't add commands untill Cmd_Init() executed.
+	// four classes for each power of two, so rounding wastes at most a fifth of a block
+	cache_numclasses = 0;
+	for (size = CACHE_MIN_CLASS; size < CACHE_MAX_CLASS; size *= 2) {
+		for (step = 0; step < 4 && cache_numclasses < CACHE_MAX_CLASSES; step++) {
+			cache_classes[cache_numclasses++].size = size + step * (size / 4);
+		}
+	}
+
+#ifdef SERVERONLY
+	// the client registers them from Host_Init once the command system is up
 	Cache_Init_Commands();
 #endif
 }
@@ -575,8 +858,15 @@ void Cache_Init_Commands(void)
 	Cmd_AddCommand("flush", Cache_Flush);
 	Cmd_AddCommand("cache_print", Cache_Print);
 	Cmd_AddCommand("cache_report", Cache_Report);
+	Cmd_AddCommand("mem_stats", Cache_Stats_f);
 
 	Cmd_AddCommand("hunk_print", Hunk_Print_f);
+
+	Cvar_SetCurrentGroup(CVAR_GROUP_SYSTEM_SETTINGS);
+	Cvar_Register(&cache_budget_models);
+	Cvar_Register(&cache_budget_skins);
+	Cvar_Register(&cache_budget_sounds);
+	Cvar_ResetCurrentGroup();
 }
 
 #ifndef WITH_DP_MEM
@@ -589,21 +879,15 @@ Frees the memory and removes it from the LRU list
 */
 void Cache_Free(cache_user_t *c)
 {
-	cache_system_t *cs;
+	cache_block_t *cb;
 
-	if (!c->data) {
+	if (!(cb = Cache_Block(c))) {
 		Sys_Error("Cache_Free: not allocated");
 	}
 
-	cs = ((cache_system_t *)c->data) - 1;
-
-	cs->prev->next = cs->next;
-	cs->next->prev = cs->prev;
-	cs->next = cs->prev = NULL;
-
-	c->data = NULL;
-
-	Cache_UnlinkLRU(cs);
+	Cache_FreeBlock(cb);
+	c->index = 0;
+	c->generation = 0;
 }
 
 /*
@@ -613,19 +897,19 @@ Cache_Check
 */
 void *Cache_Check(cache_user_t *c)
 {
-	cache_system_t *cs;
+	cache_block_t *cb;
 
-	if (!c->data) {
+	if (!(cb = Cache_Block(c))) {
 		return NULL;
 	}
 
-	cs = ((cache_system_t *)c->data) - 1;
-
 	// move to head of LRU
-	Cache_UnlinkLRU(cs);
-	Cache_MakeLRU(cs);
+	if (cache_types[cb->type].lru_head != cb - cache_blocks) {
+		Cache_UnlinkLRU(cb);
+		Cache_MakeLRU(cb);
+	}
 
-	return c->data;
+	return cb->data;
 }
 
 /*
@@ -633,11 +917,14 @@ void *Cache_Check(cache_user_t *c)
 Cache_Alloc
 ==============
 */
-void *Cache_Alloc(cache_user_t *c, int size, char *name)
+void *Cache_Alloc(cache_user_t *c, int size, char *name, cachetype_t type)
 {
-	cache_system_t *cs;
+	cache_typeinfo_t *t = &cache_types[type];
+	cache_block_t *cb;
+	int sizeclass, allocsize, index;
+	double budget;
 
-	if (c->data) {
+	if (Cache_Block(c)) {
 		Sys_Error("Cache_Alloc: already allocated");
 	}
 
@@ -645,28 +932,56 @@ void *Cache_Alloc(cache_user_t *c, int size, char *name)
 		Sys_Error("Cache_Alloc: size %i", size);
 	}
 
-	size = (size + sizeof(cache_system_t) + 15) & ~15;
+	sizeclass = Cache_SizeClass(size);
+	allocsize = (sizeclass >= 0) ? cache_classes[sizeclass].size : ((size + 15) & ~15);
 
-	// find memory for it
-	while (1) {
-		cs = Cache_TryAlloc(size, false);
-		if (cs) {
-			strlcpy(cs->name, name, sizeof(cs->name));
-			c->data = (void *)(cs + 1);
-			cs->user = c;
-			break;
-		}
+	// throw out the least recently used blocks of this type until it fits its budget
+	budget = t->budget->value * 1024 * 1024;
+	while (budget > 0 && t->lru_tail >= 0 && t->allocated + allocsize > budget) {
+		Cache_FreeBlock(&cache_blocks[t->lru_tail]);
+		t->evictions++;
+	}
 
-		// free the least recently used cahedat
-		if (cache_head.lru_prev == &cache_head) {
-			Sys_Error("Cache_Alloc: out of memory");
+	if (cache_firstfreeblock >= 0) {
+		index = cache_firstfreeblock;
+		cache_firstfreeblock = cache_blocks[index].nextfree;
+	}
+	else {
+		if (cache_numblocks >= CACHE_MAX_BLOCKS) {
+			Sys_Error("Cache_Alloc: too many blocks");
+		}
+		if (cache_numblocks == cache_maxblocks) {
+			cache_maxblocks = max(256, cache_maxblocks * 2);
+			cache_blocks = (cache_block_t *) Q_realloc(cache_blocks, cache_maxblocks * sizeof(cache_block_t));
+			memset(cache_blocks + cache_numblocks, 0, (cache_maxblocks - cache_numblocks) * sizeof(cache_block_t));
 		}
+		index = cache_numblocks++;
+	}
 
-		// not enough memory at all
-		Cache_Free(cache_head.lru_prev->user);
+	cb = &cache_blocks[index];
+	if (sizeclass >= 0) {
+		cb->data = Cache_SlabAlloc(sizeclass, &cb->slab);
+	}
+	else {
+		cb->data = Q_malloc(allocsize);
+		cb->slab = NULL;
+		cache_largebytes += allocsize;
 	}
+	cb->size = size;
+	cb->allocsize = allocsize;
+	cb->type = type;
+	cb->used = true;
+	strlcpy(cb->name, name, sizeof(cb->name));
+	Cache_MakeLRU(cb);
+
+	t->count++;
+	t->used += size;
+	t->allocated += allocsize;
+
+	c->index = index + 1;
+	c->generation = cb->generation;
 
-	return Cache_Check(c);
+	return cb->data;
 }
 #endif
 //============================================================================
@@ -39,12 +39,23 @@ server allocations when changing to a higher video mode.
 
 
 Cache_??? Cache memory is for objects that can be dynamically loaded and
-can usefully stay persistent between levels.  The size of the cache
-fluctuates from level to level.
+can usefully stay persistent between levels.  It lives outside of the hunk
+in slabs of fixed size classes, so blocks never move.  Each kind of object
+has its own budget and the least recently used ones of that kind are thrown
+out when it is exceeded.
 
-To allocate a cachable object
+To allocate a cachable object, keep a cache_user_t and call Cache_Alloc on
+it.  The cache_user_t only holds a handle, Cache_Check returns the data or
+NULL once the block has been thrown out.
 
 
+Frame_??? Frame memory is for strings and buffers that are only needed until
+the end of the current host frame, like macro expansions.  It is a bump
+allocator that is thrown away as a whole at the start of every frame, so it
+never has to be freed.  Frame_LowMark/Frame_FreeToLowMark give memory back
+early when a loop would otherwise pile up a lot of it, including anything
+that had to be allocated outside the arena.  Main thread only.
+
 Temp_??? Temp memory is used for file loading and surface caching.  The size
 of the cache memory is adjusted so that there is a minimum of 512k remaining
 for temp memory.
@@ -64,8 +75,6 @@ surface cache
 
 <--- high hunk used
 
-cachable memory
-
 <--- low hunk used
 
 client and server low hunk allocations
@@ -99,9 +108,18 @@ void Hunk_Check (void);
 
 typedef struct cache_user_s
 {
-	void *data;
+	unsigned int index;			// block index + 1, 0 if nothing was allocated
+	unsigned int generation;	// of the block when it was handed out
 } cache_user_t;
 
+typedef enum cachetype_e
+{
+	CACHE_MODEL,
+	CACHE_SKIN,
+	CACHE_SOUND,
+	CACHE_NUMTYPES
+} cachetype_t;
+
 void Cache_Flush (void);
 
 void *Cache_Check (cache_user_t *c);
@@ -110,12 +128,28 @@ void *Cache_Check (cache_user_t *c);
 
 void Cache_Free (cache_user_t *c);
 
-void *Cache_Alloc (cache_user_t *c, int size, char *name);
-// Returns NULL if all purgeable data was tossed and there still
-// wasn't enough room.
+void *Cache_Alloc (cache_user_t *c, int size, char *name, cachetype_t type);
+// Throws out the least recently used blocks of the same type if
+// its budget would be exceeded.
 
 void Cache_Report (void);
 
+void *Frame_Alloc (int size);
+// returns 0 filled memory that stays valid until the next Frame_Reset
+char *Frame_Strdup (const char *s);
+char *Frame_Printf (const char *fmt, ...);
+void Frame_Trim (void *buf, int size);
+// shrinks a buffer sized to the worst case, if it is still the last allocation
+typedef struct frame_mark_s {
+	int		used;
+	void	*overflow;
+	int		overflow_used;
+} frame_mark_t;
+frame_mark_t Frame_LowMark (void);
+void Frame_FreeToLowMark (frame_mark_t mark);
+void Frame_Reset (void);
+// called at the start of each host frame
+
 void Cache_Init_Commands (void);
 
 #endif /* !__ZONE_H__ */